@@ -63,6 +63,7 @@
 #include "hal_key.h"
 //#include "hal_lcd.h"
 #include "hal_led.h"
+#include "hal_log.h"
 #include "hal_sleep.h"
 #include "hal_timer.h"
 #include "hal_types.h"
@@ -147,6 +148,11 @@ void HalDriverInit (void)
   HalUARTInit();
 #endif
 
+  /* LOG */
+#if (defined HAL_LOG) && (HAL_LOG == TRUE)
+  HalLogInit();
+#endif
+
   /* KEY */
 #if (defined HAL_KEY) && (HAL_KEY == TRUE)
   HalKeyInit();
@@ -231,6 +237,15 @@ uint16 Hal_ProcessEvent( uint8 task_id, uint16 events )
     return events ^ HAL_KEY_EVENT;
   }
 
+  if (events & HAL_KEY_GESTURE_EVENT)
+  {
+#if (defined HAL_KEY) && (HAL_KEY == TRUE)
+    /* Long press time reached */
+    HalKeyPoll();
+#endif
+    return events ^ HAL_KEY_GESTURE_EVENT;
+  }
+
 #if defined POWER_SAVING
   if ( events & HAL_SLEEP_TIMER_EVENT )
   {
@@ -278,6 +293,11 @@ void Hal_ProcessPoll ()
 #if (defined HAL_UART) && (HAL_UART == TRUE)
   HalUARTPoll();
 #endif
+
+  /* LOG Poll */
+#if (defined HAL_LOG) && (HAL_LOG == TRUE)
+  HalLogPoll();
+#endif
   
   /* SPI Poll */
 #if (defined HAL_SPI) && (HAL_SPI == TRUE)
@@ -66,6 +66,7 @@ extern "C"
 #define PERIOD_RSSI_RESET_EVT               0x0040
 #define HAL_LED_BLINK_EVENT                 0x0020
 #define HAL_KEY_EVENT                       0x0010
+#define HAL_KEY_GESTURE_EVENT               0x0008
 
 #if defined POWER_SAVING
 #define HAL_SLEEP_TIMER_EVENT               0x0004
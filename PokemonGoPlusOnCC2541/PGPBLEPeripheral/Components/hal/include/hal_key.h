@@ -74,6 +74,13 @@ extern "C"
 #define HAL_PUSH_BUTTON  0x01  // Only Button 
 
 #define HAL_KEY_STATE_NORMAL          0x00
+
+/* Gestures, passed in the state argument of the key callback */
+#define HAL_KEY_GESTURE_NONE          0x00
+#define HAL_KEY_GESTURE_CLICK         0x01  // Short press, reported on release
+#define HAL_KEY_GESTURE_DOUBLE        0x02  // Short press soon after a click; reported instead of a second CLICK
+#define HAL_KEY_GESTURE_PRESS         0x03  // Released before a long press
+#define HAL_KEY_GESTURE_LONG          0x04  // Held down for the long press time
   
 /**************************************************************************************************
  * TYPEDEFS
@@ -87,10 +87,20 @@ extern "C"
 #define HAL_LED_DEFAULT_FLASH_COUNT   50
 #define HAL_LED_DEFAULT_FLASH_TIME    1000
 
+/* Brightness levels for HalLedSetLevel/HalLedFade */
+#define HAL_LED_LEVEL_OFF             0
+#define HAL_LED_LEVEL_MAX             255
+
 /*********************************************************************
  * TYPEDEFS
  */
 
+/* One step of an LED pattern: on time followed by off time (msec) */
+typedef struct
+{
+  uint16 on;
+  uint16 off;
+} HalLedStep_t;
 
 /*********************************************************************
  * GLOBAL VARIABLES
@@ -111,6 +121,26 @@ extern uint8 HalLedSet( uint8 led, uint8 mode );
  */
 extern void HalLedBlink( uint8 leds, uint8 cnt, uint8 duty, uint16 time );
 
+/*
+ * Play a sequence of on/off steps on the LED, cnt times (0 = continuous).
+ */
+extern void HalLedPattern( uint8 leds, const HalLedStep_t *pSteps, uint8 numSteps, uint8 cnt );
+
+/*
+ * Set LED brightness (PWM when HAL_LED_PWM is TRUE, otherwise on/off).
+ */
+extern void HalLedSetLevel( uint8 leds, uint8 level );
+
+/*
+ * Set the red, green and blue LED levels in one call.
+ */
+extern void HalLedSetColor( uint8 red, uint8 green, uint8 blue );
+
+/*
+ * Ramp LED brightness to level over time PWM periods (about 1 ms each).
+ */
+extern void HalLedFade( uint8 leds, uint8 level, uint16 time );
+
 /*
  * Put LEDs in sleep state - store current values
  */
@@ -121,6 +151,11 @@ extern void HalLedEnterSleep( void );
  */
 extern void HalLedExitSleep( void );
 
+/*
+ * TRUE when the sleep hooks above have nothing to save or switch off
+ */
+extern uint8 HalLedSleepIdle( void );
+
 /*
  * Return LED state
  */
@@ -0,0 +1,226 @@
+/******************************************************************************
+
+ @file  hal_log.h
+
+ @brief This file contains the interface to the binary debug log ring.
+
+ Group: WCS, BTS
+ Target Device: CC2540, CC2541
+
+ ******************************************************************************
+ 
+ Copyright (c) 2006-2016, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.4.2.2
+ Release Date: 2016-06-09 06:57:09
+ *****************************************************************************/
+
+
+#ifndef HAL_LOG_H
+#define HAL_LOG_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/***************************************************************************************************
+ *                                             INCLUDES
+ ***************************************************************************************************/
+#include "hal_board.h"
+#include "hal_uart.h"
+
+/***************************************************************************************************
+ *                                            CONSTANTS
+ ***************************************************************************************************/
+
+/*
+   Frame format on the wire (all fields are one byte unless noted):
+
+     HAL_LOG_SYNC | id | len | args[len] | fcs
+
+   fcs is the XOR of id, len and every argument byte. Multi-byte arguments are
+   little endian. Nothing is formatted on target; tools/hal_log_decode.py reads
+   the *LOG_ID_* tables (including the format string in the trailing comment)
+   and turns the stream back into text on the host.
+*/
+#define HAL_LOG_SYNC                0xA5
+#define HAL_LOG_FRAME_OVERHEAD      4
+
+/* Size of the log ring in bytes. Must be a power of 2 and no larger than 256 */
+#ifndef HAL_LOG_BUF_SIZE
+#define HAL_LOG_BUF_SIZE            128
+#endif
+
+/* Largest argument block accepted for one event */
+#ifndef HAL_LOG_ARGS_MAX
+#define HAL_LOG_ARGS_MAX            16
+#endif
+
+/* UART port the ring is drained to */
+#ifndef HAL_LOG_PORT
+#define HAL_LOG_PORT                HAL_UART_PORT_1
+#endif
+
+/* Log levels. Calls above HAL_LOG_LEVEL are removed by the preprocessor */
+#define HAL_LOG_LEVEL_NONE          0
+#define HAL_LOG_LEVEL_ERROR         1
+#define HAL_LOG_LEVEL_WARN          2
+#define HAL_LOG_LEVEL_INFO          3
+#define HAL_LOG_LEVEL_DEBUG         4
+
+#ifndef HAL_LOG_LEVEL
+#define HAL_LOG_LEVEL               HAL_LOG_LEVEL_INFO
+#endif
+
+/*
+   Event IDs. The comment after each ID is the host-side format string:
+     {u8} {u16} {x8} {x16} consume one argument, {hex} dumps the remaining bytes.
+   Never reuse or renumber an ID, only append. IDs are allocated by module:
+     0x00 - 0x3F  HAL and application (this file)
+     0x40 - 0x5F  pgpDeviceControl.c
+     0x60 - 0x7F  pgpCertificate.c
+*/
+#define HAL_LOG_ID_DROPPED          0x00  /* "*** {u8} log frames dropped ***" */
+#define HAL_LOG_ID_BOOT             0x01  /* "BOOT" */
+#define HAL_LOG_ID_PWRMGR_HOLD      0x02  /* "PWRMGR reason {u8} held for {u16} s" */
+#define HAL_LOG_ID_KEY_DOWN         0x10  /* "KEY down" */
+#define HAL_LOG_ID_KEY_UP           0x11  /* "KEY UP {u16} ms" */
+#define HAL_LOG_ID_KEY_GESTURE      0x12  /* "KEY gesture {u8}" */
+#define HAL_LOG_ID_GAPROLE_ADV      0x20  /* "GAPROLE_ADVERTISING" */
+#define HAL_LOG_ID_GAPROLE_CONN     0x21  /* "GAPROLE_CONNECTED" */
+#define HAL_LOG_ID_GAPROLE_WAIT     0x22  /* "GAPROLE_WAITING" */
+#define HAL_LOG_ID_ADV_STEP         0x23  /* "ADV step {u8}" */
+#define HAL_LOG_ID_CONN_PARAM       0x24  /* "CONN param profile {u8}" */
+#define HAL_LOG_ID_ATT_MTU          0x25  /* "ATT MTU {u16}" */
+#define HAL_LOG_ID_PASSCODE         0x30  /* "ProcessPasscodeCB" */
+#define HAL_LOG_ID_PAIR_START       0x31  /* "Pairing started" */
+#define HAL_LOG_ID_PAIR_OK          0x32  /* "Pairing success" */
+#define HAL_LOG_ID_PAIR_BONDED_DEV  0x33  /* "Paired device" */
+#define HAL_LOG_ID_PAIR_FAIL        0x34  /* "Pairing fail: {u8}" */
+#define HAL_LOG_ID_BOND_OK          0x35  /* "Bonding success" */
+
+/***************************************************************************************************
+ *                                              MACROS
+ ***************************************************************************************************/
+
+/*
+   One macro set per level:
+     HAL_LOG_<LEVEL>( id, pArgs, len )  - event with an argument block
+     HAL_LOG_<LEVEL>_U16( id, value )   - event with one 16-bit argument
+     HAL_LOG_<LEVEL>_DUMP( id, pArgs, len ) - block of any length, split into
+                                          frames of HAL_LOG_ARGS_MAX bytes
+   A level that is compiled out expands to nothing, so its arguments are not
+   evaluated and cost neither code nor cycles. An enabled level evaluates each
+   argument once.
+*/
+#define HAL_LOG_PUT_U16( id, value )  st( \
+  uint16 halLogValue = (value); \
+  uint8 halLogU16[2]; \
+  halLogU16[0] = LO_UINT16( halLogValue ); \
+  halLogU16[1] = HI_UINT16( halLogValue ); \
+  (void)HalLogEvent( (id), halLogU16, 2 ); \
+)
+
+#if (defined HAL_LOG) && (HAL_LOG == TRUE) && (HAL_LOG_LEVEL >= HAL_LOG_LEVEL_ERROR)
+  #define HAL_LOG_ERROR( id, pArgs, len )   (void)HalLogEvent( (id), (pArgs), (len) )
+  #define HAL_LOG_ERROR_U16( id, value )    HAL_LOG_PUT_U16( (id), (value) )
+  #define HAL_LOG_ERROR_DUMP( id, pArgs, len ) (void)HalLogDump( (id), (pArgs), (len) )
+#else
+  #define HAL_LOG_ERROR( id, pArgs, len )
+  #define HAL_LOG_ERROR_U16( id, value )
+  #define HAL_LOG_ERROR_DUMP( id, pArgs, len )
+#endif
+
+#if (defined HAL_LOG) && (HAL_LOG == TRUE) && (HAL_LOG_LEVEL >= HAL_LOG_LEVEL_WARN)
+  #define HAL_LOG_WARN( id, pArgs, len )    (void)HalLogEvent( (id), (pArgs), (len) )
+  #define HAL_LOG_WARN_U16( id, value )     HAL_LOG_PUT_U16( (id), (value) )
+  #define HAL_LOG_WARN_DUMP( id, pArgs, len ) (void)HalLogDump( (id), (pArgs), (len) )
+#else
+  #define HAL_LOG_WARN( id, pArgs, len )
+  #define HAL_LOG_WARN_U16( id, value )
+  #define HAL_LOG_WARN_DUMP( id, pArgs, len )
+#endif
+
+#if (defined HAL_LOG) && (HAL_LOG == TRUE) && (HAL_LOG_LEVEL >= HAL_LOG_LEVEL_INFO)
+  #define HAL_LOG_INFO( id, pArgs, len )    (void)HalLogEvent( (id), (pArgs), (len) )
+  #define HAL_LOG_INFO_U16( id, value )     HAL_LOG_PUT_U16( (id), (value) )
+  #define HAL_LOG_INFO_DUMP( id, pArgs, len ) (void)HalLogDump( (id), (pArgs), (len) )
+#else
+  #define HAL_LOG_INFO( id, pArgs, len )
+  #define HAL_LOG_INFO_U16( id, value )
+  #define HAL_LOG_INFO_DUMP( id, pArgs, len )
+#endif
+
+#if (defined HAL_LOG) && (HAL_LOG == TRUE) && (HAL_LOG_LEVEL >= HAL_LOG_LEVEL_DEBUG)
+  #define HAL_LOG_DEBUG( id, pArgs, len )   (void)HalLogEvent( (id), (pArgs), (len) )
+  #define HAL_LOG_DEBUG_U16( id, value )    HAL_LOG_PUT_U16( (id), (value) )
+  #define HAL_LOG_DEBUG_DUMP( id, pArgs, len ) (void)HalLogDump( (id), (pArgs), (len) )
+#else
+  #define HAL_LOG_DEBUG( id, pArgs, len )
+  #define HAL_LOG_DEBUG_U16( id, value )
+  #define HAL_LOG_DEBUG_DUMP( id, pArgs, len )
+#endif
+
+/***************************************************************************************************
+ *                                            FUNCTIONS - API
+ ***************************************************************************************************/
+
+/*
+ * Initialize the log ring
+ */
+extern void HalLogInit( void );
+
+/*
+ * Queue one event frame. Never blocks; returns FALSE if the frame was dropped.
+ */
+extern uint8 HalLogEvent( uint8 id, uint8 *pArgs, uint8 len );
+
+/*
+ * Queue a block of any length as consecutive frames with the same id.
+ */
+extern uint8 HalLogDump( uint8 id, uint8 *pArgs, uint8 len );
+
+/*
+ * Move whole frames from the ring into the UART Tx buffer
+ */
+extern void HalLogPoll( void );
+
+/***************************************************************************************************
+***************************************************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -53,6 +53,33 @@ extern "C"
 {
 #endif
 
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Slept time histogram: bin 0 counts sleeps under 2 ms, bin n sleeps of
+// 2^n to 2^(n+1) ms and the last bin everything longer
+#define HAL_SLEEP_HIST_BINS       12
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// Sleep statistics since reset; every counter wraps at 65535
+typedef struct
+{
+  uint16 sleeps;                        // PM2/PM3 entries
+  uint16 fastPath;                      // entries that skipped the key/LED hooks
+  uint16 deep;                          // PM3 entries, not in hist: the sleep timer stops
+  uint16 halts;                         // PM0 halts while the buzzer sounds
+  uint16 skipped;                       // timeout too short or the LL refused
+  uint16 wakeRF;                        // sleep timer, ahead of a radio event
+  uint16 wakeTimer;                     // sleep timer, for an OSAL timer
+  uint16 wakePort;                      // I/O port interrupt
+  uint16 wakeOther;                     // nothing pending, sleep was aborted
+  uint16 hist[HAL_SLEEP_HIST_BINS];     // slept time
+} halSleepStats_t;
+
 /*********************************************************************
  * FUNCTIONS
  */
@@ -82,6 +109,12 @@ extern void halSleepExit(void);
  */
 extern void halSetMaxSleepLoopTime(uint32 rolloverTime);
 
+/*
+ * Sleep statistics collected by halSleep()
+ */
+extern const halSleepStats_t *halSleepGetStats( void );
+extern void halSleepResetStats( void );
+
 /*********************************************************************
 *********************************************************************/
 
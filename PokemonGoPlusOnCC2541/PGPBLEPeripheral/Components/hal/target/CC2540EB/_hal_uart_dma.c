@@ -303,6 +303,12 @@ typedef struct
 #define HAL_UART_DMA_CLR_RDY_OUT()     (DMA_RDYOut = 1)
 #define HAL_UART_DMA_SET_RDY_OUT()     (DMA_RDYOut = 0)
 
+// Hold and release PWRMGR_REASON_UART once per handshake, however many RdyIn edges it sees.
+#define DMA_PM_HOLD()     st( if (!dmaPmHold) { dmaPmHold = TRUE;  \
+                                                (void)osal_pwrmgr_hold(PWRMGR_REASON_UART); } )
+#define DMA_PM_RELEASE()  st( if (dmaPmHold)  { dmaPmHold = FALSE; \
+                                                (void)osal_pwrmgr_release(PWRMGR_REASON_UART); } )
+
 #define HAL_UART_DMA_RDY_IN()          (DMA_RDYIn == 0)
 #define HAL_UART_DMA_RDY_OUT()         (DMA_RDYOut == 0)
 
@@ -341,6 +347,7 @@ typedef struct
 // The following two variables are only used when POWER_SAVING is defined.
 static volatile uint8 dmaRdyIsr;
 static uint8 dmaRdyDly;  // Minimum delay before allowing sleep after detecting RdyIn de-asserted.
+static uint8 dmaPmHold;  // PWRMGR_REASON_UART is held; every RdyIn edge re-asserts, one release.
 
 static uartDMACfg_t dmaCfg;
 
@@ -725,7 +732,7 @@ static void HalUARTPollDMA(void)
 
       if (dmaRdyDly == 0)
       {
-        (void)osal_set_event(Hal_TaskID, HAL_PWRMGR_HOLD_EVENT);
+        DMA_PM_HOLD();
       }
 
       if ((dmaRdyDly = ST0) == 0)  // Reserve zero to signify that the delay expired.
@@ -737,7 +744,7 @@ static void HalUARTPollDMA(void)
     else if ((dmaRdyDly != 0) && (!DMA_PM_DLY || ((uint8)(ST0 - dmaRdyDly) > DMA_PM_DLY)))
     {
       dmaRdyDly = 0;
-      (void)osal_set_event(Hal_TaskID, HAL_PWRMGR_CONSERVE_EVENT);
+      DMA_PM_RELEASE();
     }
   }
   PxIEN |= DMA_RDYIn_BIT;
@@ -996,7 +1003,7 @@ HAL_ISR_FUNCTION(port1Isr, P1INT_VECTOR)
 
 #ifdef POWER_SAVING
   CLEAR_SLEEP_MODE();
- (void)osal_pwrmgr_task_state(Hal_TaskID, PWRMGR_HOLD);
+  DMA_PM_HOLD();
 
 #if HAL_UART_TX_BY_ISR 
   if ( dmaCfg.txHead == dmaCfg.txTail )
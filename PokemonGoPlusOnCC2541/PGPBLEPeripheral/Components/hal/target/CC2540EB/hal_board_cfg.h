@@ -350,6 +350,12 @@ st( \
 #define BLINK_LEDS
 #endif
 
+/* Set to TRUE to dim the LEDs with Timer1/Timer4 PWM, FALSE for on/off only. Off by default:
+   Timer1 and Timer4 are then free for the application, and no LED holds the device out of PM2 */
+#ifndef HAL_LED_PWM
+#define HAL_LED_PWM FALSE
+#endif
+
 /* Set to TRUE enable KEY usage, FALSE disable it */
 #ifndef HAL_KEY
 #define HAL_KEY TRUE
@@ -394,6 +400,11 @@ st( \
 #define HAL_UART_SPI  0
 #endif
 
+/* Set to TRUE to send debug events through the binary log ring, FALSE disable it */
+#ifndef HAL_LOG
+#define HAL_LOG HAL_UART
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -57,7 +57,9 @@
  *                                            CONSTANTS
  **************************************************************************************************/
 
-/* Defines for Timer 3 */
+/* Defines for Timer 3. A tone is made in hardware alone: the timer counts modulo T3CC0 and
+   channel 1 toggles P1.4 on each compare, with no Timer3 interrupt. Note changes are timed by
+   HAL_BUZZER_EVENT, one wakeup per note. */
 #define HAL_T3_CC0_VALUE                125   /* provides pulse width of 125 usec */
 #define HAL_T3_TIMER_CTL_DIV1           0x00  /* Clock pre-scaled by 1 */
 #define HAL_T3_TIMER_CTL_DIV2           0x20  /* Clock pre-scaled by 2 */
@@ -83,7 +85,10 @@
 /* Defines for each output pin assignment */
 #define HAL_BUZZER_ENABLE_PIN  P1_4
 
-#define MELODYMAXLEN 32
+/* Time each tone of an arpeggio sounds before the next one (msec) */
+#ifndef HAL_BUZZER_ARPEGGIO_STEP
+#define HAL_BUZZER_ARPEGGIO_STEP  20
+#endif
 
 /**************************************************************************************************
  *                                              MACROS
@@ -95,13 +100,32 @@
  *                                            TYPEDEFS
  **************************************************************************************************/
 
+/* Timer3 setting for one tone */
+typedef struct
+{
+  uint8 ctl;    /* T3CTL divider bits */
+  uint8 cc0;    /* T3CC0, the timer counts 0..cc0 and toggles the output */
+} halBuzzerTone_t;
+
 /**************************************************************************************************
  *                                        GLOBAL VARIABLES
  **************************************************************************************************/
 /* Function to call when ringing of buzzer is complete */
 static halBuzzerCBack_t pHalBuzzerRingCompleteNotificationFunction;
-static uint8 melodyPtr[MELODYMAXLEN];
-static uint8 nowPlaying,melodyLen;
+/* Melody being played, read in place; the caller keeps it valid until the callback */
+static const uint8 *pMelody;
+static uint16 nowPlaying,melodyLen;
+
+/* Arpeggio being played: its tones (inside the melody), count, next tone and time left */
+static const uint8 *pArpTones;
+static uint8 arpCount,arpIdx;
+static uint16 arpLeft;
+
+/* Generated by tools/hal_buzzer_tones.py, exact to within 6 cents */
+static CONST halBuzzerTone_t halBuzzerToneTable[] =
+{
+  HAL_BUZZER_TONE_TABLE
+};
 
 /*********************************************************************
  * EXTERNAL VARIABLES
@@ -111,8 +135,6 @@ static uint8 nowPlaying,melodyLen;
  * EXTERNAL FUNCTIONS
  */
 
-extern void* memcpy(void *dest, const void *src, size_t len);
-
 /**************************************************************************************************
  *                                        FUNCTIONS - Local
  **************************************************************************************************/
@@ -148,17 +170,36 @@ void HalBuzzerInit( void )
   melodyLen=0;
 }
 
-void HalBuzzerPlay(uint8 *melody,uint8 len,halBuzzerCBack_t buzzerCback){
+/**************************************************************************************************
+ * @fn      HalBuzzerPlay
+ *
+ * @brief   Play a melody of (tone, duration in 25 ms) byte pairs. The melody is not copied, so
+ *          its length is not limited, but it must stay valid until buzzerCback is called
+ *          (normally a CONST table). While a tone sounds halSleep only halts the CPU in PM0,
+ *          since Timer3 needs the 32 MHz clock; during rests and after the melody the device
+ *          sleeps normally.
+ *
+ * @param   melody - tone/duration pairs
+ *          len - length of melody in bytes
+ *          buzzerCback - called when the melody is finished
+ *
+ * @return  None
+ **************************************************************************************************/
+void HalBuzzerPlay(const uint8 *melody,uint16 len,halBuzzerCBack_t buzzerCback){
   /* Register the callback fucntion */
   pHalBuzzerRingCompleteNotificationFunction = buzzerCback;
 
-  if (len>MELODYMAXLEN) len=MELODYMAXLEN;
-  memcpy(melodyPtr, melody, len);
+  pMelody=melody;
   melodyLen=len;
   nowPlaying=0;
+
+  /* Drop what is left of a chord from the melody this one replaces */
+  pArpTones=NULL;
+  arpCount=0;
+  arpIdx=0;
+  arpLeft=0;
   
   HalBuzzerTone();
-  (void)osal_set_event(Hal_TaskID, HAL_PWRMGR_HOLD_EVENT);//https://e2e.ti.com/support/wireless_connectivity/bluetooth_low_energy/f/538/t/315110
 }
 
 
@@ -185,36 +226,22 @@ void HalBuzzerRing( uint16 msec,uint8 tone)
     T3CTL = HAL_T3_TIMER_CTL_CLEAR | HAL_T3_TIMER_CTL_OPMODE_MODULO;
     P1SEL &= (uint8) ~HAL_BUZZER_P1_GPIO_PINS;
   }else{
-    /* Configure output pin as peripheral since we're using T3 to generate */
-    P1SEL |= (uint8) HAL_BUZZER_P1_GPIO_PINS;     //buzzer in P1.4 T3 output1
-    uint8 buf_T3CTL,buf_T3CC0;
-    buf_T3CTL=HAL_T3_TIMER_CTL_OPMODE_MODULO;
-    if (tone>=HAL_BUZZER_TONE_B4&&tone<=HAL_BUZZER_TONE_A5){
-      buf_T3CTL|=HAL_T3_TIMER_CTL_DIV128;
-    }else if(tone>=HAL_BUZZER_TONE_B5&&tone<=HAL_BUZZER_TONE_A6){
-      buf_T3CTL|=HAL_T3_TIMER_CTL_DIV64;
-    }else if(tone>=HAL_BUZZER_TONE_B6&&tone<=HAL_BUZZER_TONE_C7){
-      buf_T3CTL|=HAL_T3_TIMER_CTL_DIV32;
+    const halBuzzerTone_t *pTone;
+
+    /* Notes outside the timer's range are played in the nearest octave it can reach */
+    while (tone < HAL_BUZZER_TONE_FIRST){
+      tone += 12;
     }
-    switch (tone%7){
-      case HAL_BUZZER_TONE_B4%7:
-        buf_T3CC0=253-1;break;
-      case HAL_BUZZER_TONE_C5%7:
-        buf_T3CC0=239-1;break;
-      case HAL_BUZZER_TONE_D5%7:
-        buf_T3CC0=213-1;break;
-      case HAL_BUZZER_TONE_E5%7:
-        buf_T3CC0=190-1;break;
-      case HAL_BUZZER_TONE_F5%7:
-        buf_T3CC0=179-1;break;
-      case HAL_BUZZER_TONE_G5%7:
-        buf_T3CC0=159-1;break;
-      case HAL_BUZZER_TONE_A5%7:
-        buf_T3CC0=142-1;break; 
+    while (tone > HAL_BUZZER_TONE_LAST){
+      tone -= 12;
     }
+    pTone = &halBuzzerToneTable[tone - HAL_BUZZER_TONE_FIRST];
+
+    /* Configure output pin as peripheral since we're using T3 to generate */
+    P1SEL |= (uint8) HAL_BUZZER_P1_GPIO_PINS;     //buzzer in P1.4 T3 output1
     T3CCTL1 = HAL_T3_TIMER_CCTL_MODE_COMPARE | HAL_T3_TIMER_CCTL_CMP_TOGGLE;
-    T3CTL = buf_T3CTL;
-    T3CC0 = buf_T3CC0; //Modulo, repeatedly count from 0x00 to !!T3CC0!!
+    T3CTL = pTone->ctl | HAL_T3_TIMER_CTL_OPMODE_MODULO;
+    T3CC0 = pTone->cc0; //Modulo, repeatedly count from 0x00 to !!T3CC0!!
     /* Start it */
     T3CTL |= HAL_T3_TIMER_CTL_START;
   }
@@ -227,14 +254,59 @@ void HalBuzzerRing( uint16 msec,uint8 tone)
 }
 
 void HalBuzzerTone( void ){
-  if (nowPlaying<melodyLen){
-    HalBuzzerRing(((uint16)(melodyPtr[nowPlaying+1]))*25,melodyPtr[nowPlaying]);
+  uint8 tone;
+  uint16 msec;
+
+  if (!arpLeft && (nowPlaying+1<melodyLen)){
+    tone=pMelody[nowPlaying];
+    msec=((uint16)(pMelody[nowPlaying+1]))*25;
     nowPlaying+=2;
+
+    if (!(tone & HAL_BUZZER_ARPEGGIO)){
+      HalBuzzerRing(msec,tone);
+      return;
+    }
+
+    /* Chord: its tones follow the duration byte */
+    arpCount=tone & ~HAL_BUZZER_ARPEGGIO;
+    if (arpCount>melodyLen-nowPlaying){
+      arpCount=(uint8)(melodyLen-nowPlaying);
+    }
+    pArpTones=&pMelody[nowPlaying];
+    nowPlaying+=arpCount;
+    arpIdx=0;
+    arpLeft=arpCount ? msec : 0;
+    if (!arpLeft){
+      HalBuzzerRing(msec,HAL_BUZZER_TONE_NONE);
+      return;
+    }
+  }
+
+  if (arpLeft){
+    msec=(arpLeft>HAL_BUZZER_ARPEGGIO_STEP) ? HAL_BUZZER_ARPEGGIO_STEP : arpLeft;
+    arpLeft-=msec;
+    HalBuzzerRing(msec,pArpTones[arpIdx]);
+    if (++arpIdx>=arpCount){
+      arpIdx=0;
+    }
   }else{
     HalBuzzerStop();
   }
 }
 
+/**************************************************************************************************
+ * @fn      HalBuzzerActive
+ *
+ * @brief   Tell whether Timer3 is generating a tone, in which case the 32 MHz clock must run
+ *
+ * @param   None
+ *
+ * @return  TRUE while a tone sounds
+ **************************************************************************************************/
+bool HalBuzzerActive( void ){
+  return ((T3CTL & HAL_T3_TIMER_CTL_START) ? TRUE : FALSE);
+}
+
 /**************************************************************************************************
  * @fn      HalBuzzerStop
  *
@@ -249,12 +321,17 @@ void HalBuzzerStop( void )
   /* Setting T3CTL to 0 disables it and masks the overflow interrupt */
   T3CTL = 0;
 
+  /* A stopped melody leaves no chord behind */
+  pArpTones = NULL;
+  arpCount = 0;
+  arpIdx = 0;
+  arpLeft = 0;
+
   /* Return output pin to GPIO */
   P1SEL &= (uint8) ~HAL_BUZZER_P1_GPIO_PINS;
   
   osal_stop_timerEx(Hal_TaskID,HAL_BUZZER_EVENT);
   
-  (void)osal_set_event(Hal_TaskID, HAL_PWRMGR_CONSERVE_EVENT);//https://e2e.ti.com/support/wireless_connectivity/bluetooth_low_energy/f/538/t/315110
   /* Inform application that buzzer is done */
   if (pHalBuzzerRingCompleteNotificationFunction != NULL)
   {
@@ -57,35 +57,18 @@ extern "C" {
  */
 
 #include "comdef.h"
+#include "hal_buzzer_tones.h"
 
 /* ------------------------------------------------------------------------------------------------
  *                                          Constants
  * ------------------------------------------------------------------------------------------------
  */
-#define HAL_BUZZER_TONE_NONE    0
-//#define HAL_BUZZER_TONE_C4      1
-//#define HAL_BUZZER_TONE_D4      2
-//#define HAL_BUZZER_TONE_E4      3
-//#define HAL_BUZZER_TONE_F4      4
-//#define HAL_BUZZER_TONE_G4      5
-//#define HAL_BUZZER_TONE_A4      6
-//T3 frequency starts 488Hz
-#define HAL_BUZZER_TONE_B4      7       
-#define HAL_BUZZER_TONE_C5      8
-#define HAL_BUZZER_TONE_D5      9
-#define HAL_BUZZER_TONE_E5     10
-#define HAL_BUZZER_TONE_F5     11
-#define HAL_BUZZER_TONE_G5     12
-#define HAL_BUZZER_TONE_A5     13
-#define HAL_BUZZER_TONE_B5     14
-#define HAL_BUZZER_TONE_C6     15
-#define HAL_BUZZER_TONE_D6     16
-#define HAL_BUZZER_TONE_E6     17
-#define HAL_BUZZER_TONE_F6     18
-#define HAL_BUZZER_TONE_G6     19
-#define HAL_BUZZER_TONE_A6     20
-#define HAL_BUZZER_TONE_B6     21
-#define HAL_BUZZER_TONE_C7     22
+//Tones are MIDI note numbers, see hal_buzzer_tones.h. T3 frequency starts 488Hz (B4),
+//lower notes are played an octave (or more) up.
+
+//Melody entry that plays a chord as an arpeggio: (HAL_BUZZER_ARPEGGIO | n), duration,
+//followed by the n tones of the chord, which are cycled every HAL_BUZZER_ARPEGGIO_STEP ms
+#define HAL_BUZZER_ARPEGGIO     0x80
    
 /* ------------------------------------------------------------------------------------------------
  *                                           Typedefs
@@ -116,7 +99,7 @@ typedef void (*halBuzzerCBack_t) (void);
  */
 void HalBuzzerInit( void );
 
-void HalBuzzerPlay(uint8 *melody,uint8 len,halBuzzerCBack_t buzzerCback);
+void HalBuzzerPlay(const uint8 *melody,uint16 len,halBuzzerCBack_t buzzerCback);
 
 /**************************************************************************************************
  * @fn          HalBuzzerRing
@@ -151,6 +134,9 @@ void HalBuzzerTone( void );
 
 void HalBuzzerStop( void );
 
+/* TRUE while Timer3 generates a tone; used by halSleep to stay in PM0 */
+bool HalBuzzerActive( void );
+
 #ifdef __cplusplus
 };
 #endif
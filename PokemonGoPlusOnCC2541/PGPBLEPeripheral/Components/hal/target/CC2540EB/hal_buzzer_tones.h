@@ -0,0 +1,134 @@
+/**************************************************************************************************
+  Filename:       hal_buzzer_tones.h
+
+  Description:    Timer3 settings for every MIDI note the buzzer can play.
+
+                  Generated by tools/hal_buzzer_tones.py - do not edit.
+**************************************************************************************************/
+#ifndef HAL_BUZZER_TONES_H
+#define HAL_BUZZER_TONES_H
+
+/* Tones are MIDI note numbers; 0 is a rest */
+#define HAL_BUZZER_TONE_NONE    0
+#define HAL_BUZZER_TONE_B4      71
+#define HAL_BUZZER_TONE_C5      72
+#define HAL_BUZZER_TONE_CS5     73
+#define HAL_BUZZER_TONE_D5      74
+#define HAL_BUZZER_TONE_DS5     75
+#define HAL_BUZZER_TONE_E5      76
+#define HAL_BUZZER_TONE_F5      77
+#define HAL_BUZZER_TONE_FS5     78
+#define HAL_BUZZER_TONE_G5      79
+#define HAL_BUZZER_TONE_GS5     80
+#define HAL_BUZZER_TONE_A5      81
+#define HAL_BUZZER_TONE_AS5     82
+#define HAL_BUZZER_TONE_B5      83
+#define HAL_BUZZER_TONE_C6      84
+#define HAL_BUZZER_TONE_CS6     85
+#define HAL_BUZZER_TONE_D6      86
+#define HAL_BUZZER_TONE_DS6     87
+#define HAL_BUZZER_TONE_E6      88
+#define HAL_BUZZER_TONE_F6      89
+#define HAL_BUZZER_TONE_FS6     90
+#define HAL_BUZZER_TONE_G6      91
+#define HAL_BUZZER_TONE_GS6     92
+#define HAL_BUZZER_TONE_A6      93
+#define HAL_BUZZER_TONE_AS6     94
+#define HAL_BUZZER_TONE_B6      95
+#define HAL_BUZZER_TONE_C7      96
+#define HAL_BUZZER_TONE_CS7     97
+#define HAL_BUZZER_TONE_D7      98
+#define HAL_BUZZER_TONE_DS7     99
+#define HAL_BUZZER_TONE_E7     100
+#define HAL_BUZZER_TONE_F7     101
+#define HAL_BUZZER_TONE_FS7    102
+#define HAL_BUZZER_TONE_G7     103
+#define HAL_BUZZER_TONE_GS7    104
+#define HAL_BUZZER_TONE_A7     105
+#define HAL_BUZZER_TONE_AS7    106
+#define HAL_BUZZER_TONE_B7     107
+#define HAL_BUZZER_TONE_C8     108
+#define HAL_BUZZER_TONE_CS8    109
+#define HAL_BUZZER_TONE_D8     110
+#define HAL_BUZZER_TONE_DS8    111
+#define HAL_BUZZER_TONE_E8     112
+#define HAL_BUZZER_TONE_F8     113
+#define HAL_BUZZER_TONE_FS8    114
+#define HAL_BUZZER_TONE_G8     115
+#define HAL_BUZZER_TONE_GS8    116
+#define HAL_BUZZER_TONE_A8     117
+#define HAL_BUZZER_TONE_AS8    118
+#define HAL_BUZZER_TONE_B8     119
+#define HAL_BUZZER_TONE_C9     120
+#define HAL_BUZZER_TONE_CS9    121
+#define HAL_BUZZER_TONE_D9     122
+#define HAL_BUZZER_TONE_DS9    123
+#define HAL_BUZZER_TONE_E9     124
+#define HAL_BUZZER_TONE_F9     125
+#define HAL_BUZZER_TONE_FS9    126
+#define HAL_BUZZER_TONE_G9     127
+
+#define HAL_BUZZER_TONE_FIRST   71
+#define HAL_BUZZER_TONE_LAST    127
+
+/* T3CTL divider bits and T3CC0 for HAL_BUZZER_TONE_FIRST .. HAL_BUZZER_TONE_LAST */
+#define HAL_BUZZER_TONE_TABLE \
+  { 0xE0, 252 },  /* B4      493.9 Hz ->    494.1 Hz  +0.66 cents */ \
+  { 0xE0, 238 },  /* C5      523.3 Hz ->    523.0 Hz  -0.79 cents */ \
+  { 0xE0, 224 },  /* CS5     554.4 Hz ->    555.6 Hz  +3.71 cents */ \
+  { 0xE0, 212 },  /* D5      587.3 Hz ->    586.9 Hz  -1.40 cents */ \
+  { 0xE0, 200 },  /* DS5     622.3 Hz ->    621.9 Hz  -1.01 cents */ \
+  { 0xE0, 189 },  /* E5      659.3 Hz ->    657.9 Hz  -3.58 cents */ \
+  { 0xE0, 178 },  /* F5      698.5 Hz ->    698.3 Hz  -0.33 cents */ \
+  { 0xE0, 168 },  /* FS5     740.0 Hz ->    739.6 Hz  -0.80 cents */ \
+  { 0xE0, 158 },  /* G5      784.0 Hz ->    786.2 Hz  +4.79 cents */ \
+  { 0xE0, 149 },  /* GS5     830.6 Hz ->    833.3 Hz  +5.67 cents */ \
+  { 0xE0, 141 },  /* A5      880.0 Hz ->    880.3 Hz  +0.55 cents */ \
+  { 0xE0, 133 },  /* AS5     932.3 Hz ->    932.8 Hz  +0.94 cents */ \
+  { 0xC0, 252 },  /* B5      987.8 Hz ->    988.1 Hz  +0.66 cents */ \
+  { 0xC0, 238 },  /* C6     1046.5 Hz ->   1046.0 Hz  -0.79 cents */ \
+  { 0xC0, 224 },  /* CS6    1108.7 Hz ->   1111.1 Hz  +3.71 cents */ \
+  { 0xC0, 212 },  /* D6     1174.7 Hz ->   1173.7 Hz  -1.40 cents */ \
+  { 0xC0, 200 },  /* DS6    1244.5 Hz ->   1243.8 Hz  -1.01 cents */ \
+  { 0xC0, 189 },  /* E6     1318.5 Hz ->   1315.8 Hz  -3.58 cents */ \
+  { 0xC0, 178 },  /* F6     1396.9 Hz ->   1396.6 Hz  -0.33 cents */ \
+  { 0xC0, 168 },  /* FS6    1480.0 Hz ->   1479.3 Hz  -0.80 cents */ \
+  { 0xC0, 158 },  /* G6     1568.0 Hz ->   1572.3 Hz  +4.79 cents */ \
+  { 0xC0, 149 },  /* GS6    1661.2 Hz ->   1666.7 Hz  +5.67 cents */ \
+  { 0xC0, 141 },  /* A6     1760.0 Hz ->   1760.6 Hz  +0.55 cents */ \
+  { 0xC0, 133 },  /* AS6    1864.7 Hz ->   1865.7 Hz  +0.94 cents */ \
+  { 0xA0, 252 },  /* B6     1975.5 Hz ->   1976.3 Hz  +0.66 cents */ \
+  { 0xA0, 238 },  /* C7     2093.0 Hz ->   2092.1 Hz  -0.79 cents */ \
+  { 0xA0, 224 },  /* CS7    2217.5 Hz ->   2222.2 Hz  +3.71 cents */ \
+  { 0xA0, 212 },  /* D7     2349.3 Hz ->   2347.4 Hz  -1.40 cents */ \
+  { 0xA0, 200 },  /* DS7    2489.0 Hz ->   2487.6 Hz  -1.01 cents */ \
+  { 0xA0, 189 },  /* E7     2637.0 Hz ->   2631.6 Hz  -3.58 cents */ \
+  { 0xA0, 178 },  /* F7     2793.8 Hz ->   2793.3 Hz  -0.33 cents */ \
+  { 0xA0, 168 },  /* FS7    2960.0 Hz ->   2958.6 Hz  -0.80 cents */ \
+  { 0xA0, 158 },  /* G7     3136.0 Hz ->   3144.7 Hz  +4.79 cents */ \
+  { 0xA0, 149 },  /* GS7    3322.4 Hz ->   3333.3 Hz  +5.67 cents */ \
+  { 0xA0, 141 },  /* A7     3520.0 Hz ->   3521.1 Hz  +0.55 cents */ \
+  { 0xA0, 133 },  /* AS7    3729.3 Hz ->   3731.3 Hz  +0.94 cents */ \
+  { 0x80, 252 },  /* B7     3951.1 Hz ->   3952.6 Hz  +0.66 cents */ \
+  { 0x80, 238 },  /* C8     4186.0 Hz ->   4184.1 Hz  -0.79 cents */ \
+  { 0x80, 224 },  /* CS8    4434.9 Hz ->   4444.4 Hz  +3.71 cents */ \
+  { 0x80, 212 },  /* D8     4698.6 Hz ->   4694.8 Hz  -1.40 cents */ \
+  { 0x80, 200 },  /* DS8    4978.0 Hz ->   4975.1 Hz  -1.01 cents */ \
+  { 0x80, 189 },  /* E8     5274.0 Hz ->   5263.2 Hz  -3.58 cents */ \
+  { 0x80, 178 },  /* F8     5587.7 Hz ->   5586.6 Hz  -0.33 cents */ \
+  { 0x80, 168 },  /* FS8    5919.9 Hz ->   5917.2 Hz  -0.80 cents */ \
+  { 0x80, 158 },  /* G8     6271.9 Hz ->   6289.3 Hz  +4.79 cents */ \
+  { 0x80, 149 },  /* GS8    6644.9 Hz ->   6666.7 Hz  +5.67 cents */ \
+  { 0x80, 141 },  /* A8     7040.0 Hz ->   7042.3 Hz  +0.55 cents */ \
+  { 0x80, 133 },  /* AS8    7458.6 Hz ->   7462.7 Hz  +0.94 cents */ \
+  { 0x60, 252 },  /* B8     7902.1 Hz ->   7905.1 Hz  +0.66 cents */ \
+  { 0x60, 238 },  /* C9     8372.0 Hz ->   8368.2 Hz  -0.79 cents */ \
+  { 0x60, 224 },  /* CS9    8869.8 Hz ->   8888.9 Hz  +3.71 cents */ \
+  { 0x60, 212 },  /* D9     9397.3 Hz ->   9389.7 Hz  -1.40 cents */ \
+  { 0x60, 200 },  /* DS9    9956.1 Hz ->   9950.2 Hz  -1.01 cents */ \
+  { 0x60, 189 },  /* E9    10548.1 Hz ->  10526.3 Hz  -3.58 cents */ \
+  { 0x60, 178 },  /* F9    11175.3 Hz ->  11173.2 Hz  -0.33 cents */ \
+  { 0x60, 168 },  /* FS9   11839.8 Hz ->  11834.3 Hz  -0.80 cents */ \
+  { 0x60, 158 }   /* G9    12543.9 Hz ->  12578.6 Hz  +4.79 cents */ \
+
+#endif
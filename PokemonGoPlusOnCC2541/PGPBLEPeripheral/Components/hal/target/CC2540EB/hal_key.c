@@ -83,6 +83,16 @@
        interrupts.  The default is the make the S1 switch on the EB work more
        reliably.
 
+ NOTE: On this board the key is handled on edges only. After each debounced
+       edge the port interrupt is pointed at the opposite edge, so press and
+       release both interrupt and nothing is polled while the key is held.
+       HalKeyPoll() turns the edges into one gesture (click, double click,
+       press, long press) and calls the callback once with the gesture in
+       the state argument. A click is reported on release; a double click
+       is a CLICK followed by a DOUBLE, so no click waits for a second one.
+       Debounce runs on HAL_KEY_EVENT and the long press timeout on
+       HAL_KEY_GESTURE_EVENT, so neither timer replaces the other.
+
 *********************************************************************/
 
 /**************************************************************************************************
@@ -106,6 +116,24 @@
 
 #define HAL_KEY_DEBOUNCE_VALUE  25
 
+/* Gesture timing (msec) */
+#ifndef HAL_KEY_CLICK_TIME
+#define HAL_KEY_CLICK_TIME          300   /* Shorter presses are clicks */
+#endif
+#ifndef HAL_KEY_DOUBLE_CLICK_TIME
+#define HAL_KEY_DOUBLE_CLICK_TIME   250   /* Max gap between a click and the press of a double click */
+#endif
+#ifndef HAL_KEY_LONG_PRESS_TIME
+#define HAL_KEY_LONG_PRESS_TIME     2500  /* Held this long is a long press */
+#endif
+
+/* Gesture engine states */
+#define HAL_KEY_ENGINE_IDLE         0     /* Key up, nothing pending */
+#define HAL_KEY_ENGINE_PRESSED      1     /* Key down, long press timer running */
+#define HAL_KEY_ENGINE_HELD         2     /* Long press reported, waiting for release */
+#define HAL_KEY_ENGINE_RELEASED     3     /* Click reported; a press soon after is a double click */
+#define HAL_KEY_ENGINE_PRESSED2     4     /* Second press of a double click, long press timer running */
+
 /* CPU port interrupt */
 #define HAL_KEY_CPU_PORT_0_IF P0IF
 
@@ -133,7 +161,8 @@
 /**************************************************************************************************
  *                                        GLOBAL VARIABLES
  **************************************************************************************************/
-static uint8 halKeySavedKeys;     /* used to store previous key state in polling mode */
+static uint8 halKeyGestureState;  /* HAL_KEY_ENGINE_IDLE etc. */
+static uint32 halKeyGestureTime;  /* Clock at the edge that started the current state */
 static halKeyCBack_t pHalKeyProcessFunction;
 static uint8 HalKeyConfigured;
 bool Hal_KeyIntEnable;            /* interrupt enable/disable flag */
@@ -143,6 +172,9 @@ bool Hal_KeyIntEnable;            /* interrupt enable/disable flag */
  **************************************************************************************************/
 void halProcessKeyInterrupt(void);
 uint8 halGetJoyKeyInput(void);
+static void halKeyArmEdge(uint8 keys);
+static void halKeyStartTimer(uint16 timeout);
+static void halKeyStopTimer(void);
 
 
 
@@ -162,7 +194,7 @@ uint8 halGetJoyKeyInput(void);
  **************************************************************************************************/
 void HalKeyInit( void )
 {
-  halKeySavedKeys = 0;  // Initialize previous key to 0.
+  halKeyGestureState = HAL_KEY_ENGINE_IDLE;
 
   HAL_KEY_SW_1_SEL &= ~(HAL_KEY_SW_1_BIT);    /* Set pin function to GPIO */
   HAL_KEY_SW_1_DIR &= ~(HAL_KEY_SW_1_BIT);    /* Set pin direction to Input */
@@ -203,7 +235,7 @@ void HalKeyConfig (bool interruptEnable, halKeyCBack_t cback)
   if (Hal_KeyIntEnable)
   {
     HAL_KEY_SW_1_ICTL |= HAL_KEY_SW_1_ICTLBIT; /* enable interrupt generation at port */    
-    HAL_KEY_SW_1_PXIFG = ~(HAL_KEY_SW_1_BIT);  /* Clear any pending interrupt */
+    halKeyArmEdge( HalKeyRead() );             /* Wait for the next edge, clears pending interrupt */
 
     /* Do this only after the hal_key is configured - to work with sleep stuff */
     if (HalKeyConfigured == TRUE)
@@ -248,7 +280,10 @@ uint8 HalKeyRead ( void )
 /**************************************************************************************************
  * @fn      HalKeyPoll
  *
- * @brief   Called by hal_driver to poll the keys
+ * @brief   Called by hal_driver on HAL_KEY_EVENT and HAL_KEY_GESTURE_EVENT. With interrupts that
+ *          is only when the debounce or long-press time runs out, never periodically while the key
+ *          is held. Classifies the press and invokes the callback once per gesture, with the
+ *          gesture (HAL_KEY_GESTURE_*) in the state argument.
  *
  * @param   None
  *
@@ -256,56 +291,166 @@ uint8 HalKeyRead ( void )
  **************************************************************************************************/
 void HalKeyPoll (void)
 {
-  //this is called every 100ms when key is pressed
-  uint8 keys = 0;
-  uint8 notify = 0;
-  
-  if (!(HAL_KEY_SW_1_PORT & HAL_KEY_SW_1_BIT))    /* Key is active low */
+  uint8 keys;
+  uint8 gesture = HAL_KEY_GESTURE_NONE;
+  uint16 elapsed;
+  uint32 now;
+
+  keys = HalKeyRead();
+  now = osal_GetSystemClock();
+  elapsed = ((now - halKeyGestureTime) > 0xFFFF) ? 0xFFFF : (uint16)(now - halKeyGestureTime);
+
+  if (Hal_KeyIntEnable)
   {
-    keys |= HAL_PUSH_BUTTON;
+    halKeyArmEdge( keys );
   }
- 
-  /* If interrupts are not enabled, previous key status and current key status
-   * are compared to find out if a key has changed status.
-   */
-  if (!Hal_KeyIntEnable)
+
+  switch (halKeyGestureState)
   {
-    if (keys == halKeySavedKeys)
-    {
-      /* Exit - since no keys have changed */
-      return;
-    }
-    else
-    {
-      notify = 1;
-    }
+    case HAL_KEY_ENGINE_IDLE:
+      if (keys)
+      {
+        halKeyGestureState = HAL_KEY_ENGINE_PRESSED;
+        halKeyGestureTime = now;
+        halKeyStartTimer( HAL_KEY_LONG_PRESS_TIME );
+      }
+      break;
+
+    case HAL_KEY_ENGINE_PRESSED:
+    case HAL_KEY_ENGINE_PRESSED2:
+      if (!keys)
+      {
+        halKeyStopTimer();
+        if (elapsed < HAL_KEY_CLICK_TIME)
+        {
+          /* Reported now; a press within the double click time makes the next click a DOUBLE */
+          gesture = (halKeyGestureState == HAL_KEY_ENGINE_PRESSED) ? HAL_KEY_GESTURE_CLICK :
+                                                                     HAL_KEY_GESTURE_DOUBLE;
+          halKeyGestureState = (gesture == HAL_KEY_GESTURE_CLICK) ? HAL_KEY_ENGINE_RELEASED :
+                                                                    HAL_KEY_ENGINE_IDLE;
+          halKeyGestureTime = now;
+        }
+        else
+        {
+          gesture = HAL_KEY_GESTURE_PRESS;
+          halKeyGestureState = HAL_KEY_ENGINE_IDLE;
+        }
+      }
+      else if (elapsed >= HAL_KEY_LONG_PRESS_TIME)
+      {
+        /* Report as soon as the time is reached, the release is ignored */
+        gesture = HAL_KEY_GESTURE_LONG;
+        halKeyGestureState = HAL_KEY_ENGINE_HELD;
+      }
+      else
+      {
+        halKeyStartTimer( HAL_KEY_LONG_PRESS_TIME - elapsed );
+      }
+      break;
+
+    case HAL_KEY_ENGINE_HELD:
+      if (!keys)
+      {
+        halKeyGestureState = HAL_KEY_ENGINE_IDLE;
+      }
+      break;
+
+    case HAL_KEY_ENGINE_RELEASED:
+      /* No timer runs here: the gap is only measured when the key goes down again */
+      if (keys)
+      {
+        halKeyGestureState = (elapsed < HAL_KEY_DOUBLE_CLICK_TIME) ? HAL_KEY_ENGINE_PRESSED2 :
+                                                                     HAL_KEY_ENGINE_PRESSED;
+        halKeyGestureTime = now;
+        halKeyStartTimer( HAL_KEY_LONG_PRESS_TIME );
+      }
+      break;
+
+    default:
+      halKeyGestureState = HAL_KEY_ENGINE_IDLE;
+      break;
+  }
+
+  /* Invoke Callback once per gesture */
+  if ((gesture != HAL_KEY_GESTURE_NONE) && (pHalKeyProcessFunction))
+  {
+    (pHalKeyProcessFunction) (HAL_PUSH_BUTTON, gesture);
+  }
+}
+
+
+/**************************************************************************************************
+ * @fn      halKeyArmEdge
+ *
+ * @brief   Point the port interrupt at the next transition of the key: falling edge (press) while
+ *          the key is up, rising edge (release) while it is down.
+ *
+ * @param   keys - key state the edge is chosen for
+ *
+ * @return  None
+ **************************************************************************************************/
+static void halKeyArmEdge (uint8 keys)
+{
+  if (keys)
+  {
+    PICTL &= ~(HAL_KEY_SW_1_EDGEBIT);  /* Rising edge: release */
   }
   else
   {
-    /* Key interrupt handled here */
-    if (keys)
-    {
-      notify = 1;
-    }
+    PICTL |= HAL_KEY_SW_1_EDGEBIT;     /* Falling edge: press */
   }
 
-  /* Store the current keys for comparation next time */
-  halKeySavedKeys = keys;
+  /* Changing the edge may flag an interrupt, PxIFG has to be cleared before PxIF */
+  HAL_KEY_SW_1_PXIFG = ~(HAL_KEY_SW_1_BIT);
+  HAL_KEY_CPU_PORT_0_IF = 0;
 
-  /* Invoke Callback if new keys were depressed */
-  if (notify && (pHalKeyProcessFunction))
+  /* The key moved while the edge was being changed; debounce it like an edge */
+  if (HalKeyRead() != keys)
   {
-    (pHalKeyProcessFunction) (keys, HAL_KEY_STATE_NORMAL);
+    osal_start_timerEx (Hal_TaskID, HAL_KEY_EVENT, HAL_KEY_DEBOUNCE_VALUE);
+  }
+}
 
+
+/**************************************************************************************************
+ * @fn      halKeyStartTimer
+ *
+ * @brief   Wake the key service after timeout. OSAL timers run off the sleep timer, so the device
+ *          stays in PM2 until then. Not needed when polling, the poll comes round anyway.
+ *
+ * @param   timeout - msec
+ *
+ * @return  None
+ **************************************************************************************************/
+static void halKeyStartTimer (uint16 timeout)
+{
+  if (Hal_KeyIntEnable)
+  {
+    osal_start_timerEx (Hal_TaskID, HAL_KEY_GESTURE_EVENT, timeout);
   }
 }
 
 
+/**************************************************************************************************
+ * @fn      halKeyStopTimer
+ *
+ * @brief   Cancel the long press timeout once the key is released, so it costs no wakeup.
+ *
+ * @param   None
+ *
+ * @return  None
+ **************************************************************************************************/
+static void halKeyStopTimer (void)
+{
+  osal_stop_timerEx (Hal_TaskID, HAL_KEY_GESTURE_EVENT);
+}
+
+
 /**************************************************************************************************
  * @fn      halProcessKeyInterrupt
  *
- * @brief   Checks to see if it's a valid key interrupt, saves interrupt driven key states for
- *          processing by HalKeyRead(), and debounces keys by scheduling HalKeyRead() 25ms later.
+ * @brief   Checks to see if it's a valid key interrupt and debounces the key by scheduling
+ *          HalKeyPoll() 25ms after the last edge.
  *
  * @param
  *
@@ -55,25 +55,53 @@
 #include "hal_drivers.h"
 #include "hal_led.h"
 #include "osal.h"
+#include "OSAL_PwrMgr.h"
 #include "hal_board.h"
 
+/***************************************************************************************************
+ *                                             CONSTANTS
+ ***************************************************************************************************/
+
+#if (defined HAL_LED_PWM) && (HAL_LED_PWM == TRUE)
+/*
+ * PWM channels, in LED bit order:
+ *   HAL_LED_1_RED   P1.0  Timer1 channel 2, alternative 2 location
+ *   HAL_LED_2_BLUE  P1.1  Timer1 channel 1, alternative 2 location
+ *   HAL_LED_3_GREEN P2.0  Timer4 channel 0, alternative 2 location
+ * Both timers count 256 ticks of 250 kHz, so one PWM period is 1.024 ms. Timer1 also paces the
+ * fades: its overflow interrupt is only enabled while a fade is running.
+ */
+#define HAL_LED_PWM_NUM_LEDS        3
+#define HAL_LED_PWM_T1_LEDS         (HAL_LED_1_RED | HAL_LED_2_BLUE)
+#define HAL_LED_PWM_T1CTL           0x0E    /* Tick/128, modulo mode (T1CC0 sets the period) */
+#define HAL_LED_PWM_T4CTL           0xF4    /* Tick/128, start, clear counter, free running */
+#define HAL_LED_PWM_CCTL            0x24    /* Compare mode, clear output on compare-up, set on 0 */
+#define HAL_LED_PWM_PERCFG_T1CFG    0x40
+#define HAL_LED_PWM_PERCFG_T4CFG    0x10
+#define HAL_LED_PWM_TIMIF_OVFIM     0x40
+#define HAL_LED_PWM_T1STAT_OVFIF    0x20
+#endif /* HAL_LED_PWM */
+
 /***************************************************************************************************
  *                                              TYPEDEFS
  ***************************************************************************************************/
 
 /* LED control structure */
 typedef struct {
-  uint8 mode;       /* Operation mode */
-  uint8 left;       /* Blink cycles left */
-  uint8 onPct;      /* On cycle percentage */
-  uint16 time;      /* On/off cycle time (msec) */
-  uint32 next;      /* Time for next change */
+  uint8 mode;                   /* Operation mode */
+  uint8 left;                   /* Pattern repeats left */
+  uint8 step;                   /* Current step in pattern */
+  uint8 numSteps;               /* Number of steps in pattern */
+  const HalLedStep_t *pSteps;   /* Pattern being played */
+  HalLedStep_t blink;           /* One step pattern set up by HalLedBlink */
+  uint16 wait;                  /* Time left in current on/off phase (msec) */
 } HalLedControl_t;
 
 typedef struct
 {
   HalLedControl_t HalLedControlTable[HAL_LED_DEFAULT_MAX_LEDS];
   uint8           sleepActive;
+  uint32          lastUpdate;   /* System clock when wait times were last advanced */
 } HalLedStatus_t;
 
 /***************************************************************************************************
@@ -92,6 +120,15 @@ static uint8 preBlinkState;            // Original State before going to blink m
   static HalLedStatus_t HalLedStatusControl;
 #endif
 
+#if (defined HAL_LED_PWM) && (HAL_LED_PWM == TRUE)
+static uint8 halLedPwmActive;                          // LEDs whose pin is driven by a timer
+static volatile uint8 halLedPwmFading;                 // LEDs with a fade in progress
+static uint8 halLedPwmTarget[HAL_LED_PWM_NUM_LEDS];    // Level at the end of the fade
+static uint16 halLedPwmLevel[HAL_LED_PWM_NUM_LEDS];    // Current level, 8.8 fixed point
+static int16 halLedPwmStep[HAL_LED_PWM_NUM_LEDS];      // Level change per PWM period, 8.8
+static uint16 halLedPwmLeft[HAL_LED_PWM_NUM_LEDS];     // PWM periods left in the fade
+#endif
+
 /***************************************************************************************************
  *                                            LOCAL FUNCTION
  ***************************************************************************************************/
@@ -101,6 +138,18 @@ void HalLedUpdate (void);
 void HalLedOnOff (uint8 leds, uint8 mode);
 #endif /* HAL_LED */
 
+#if (defined (BLINK_LEDS)) && (HAL_LED == TRUE)
+static void halLedStart (uint8 led, HalLedControl_t *sts, const HalLedStep_t *pSteps, uint8 numSteps, uint8 cnt);
+static void halLedNextPhase (uint8 led, HalLedControl_t *sts);
+#endif /* BLINK_LEDS && HAL_LED */
+
+#if (defined HAL_LED_PWM) && (HAL_LED_PWM == TRUE)
+static void halLedPwmAttach (uint8 led);
+static void halLedPwmDetach (uint8 leds);
+static void halLedPwmWrite (uint8 idx, uint8 level);
+static void halLedPwmSettle (void);
+#endif /* HAL_LED_PWM */
+
 /***************************************************************************************************
  *                                            FUNCTIONS - API
  ***************************************************************************************************/
@@ -216,12 +265,20 @@ void HalLedBlink (uint8 leds, uint8 numBlinks, uint8 percent, uint16 period)
 {
 #if (defined (BLINK_LEDS)) && (HAL_LED == TRUE)
   uint8 led;
+  uint16 on;
   HalLedControl_t *sts;
 
   if (leds && percent && period)
   {
     if (percent < 100)
     {
+      /* Split the period once here so HalLedUpdate never has to divide */
+      on = (uint16)(((uint32)period * percent) / 100);
+      if (!on)
+      {
+        on = 1;
+      }
+
       led = HAL_LED_1_RED;
       leds &= HAL_LED_ALL;
       sts = HalLedStatusControl.HalLedControlTable;
@@ -230,17 +287,9 @@ void HalLedBlink (uint8 leds, uint8 numBlinks, uint8 percent, uint16 period)
       {
         if (leds & led)
         {
-          /* Store the current state of the led before going to blinking if not already blinking */
-          if(sts->mode < HAL_LED_MODE_BLINK )
-          	preBlinkState |= (led & HalLedState);
-
-          sts->mode  = HAL_LED_MODE_OFF;                    /* Stop previous blink */
-          sts->time  = period;                              /* Time for one on/off cycle */
-          sts->onPct = percent;                             /* % of cycle LED is on */
-          sts->left  = numBlinks;                           /* Number of blink cycles */
-          if (!numBlinks) sts->mode |= HAL_LED_MODE_FLASH;  /* Continuous */
-          sts->next = osal_GetSystemClock();                /* Start now */
-          sts->mode |= HAL_LED_MODE_BLINK;                  /* Enable blinking */
+          sts->blink.on  = on;                              /* Time on in each cycle */
+          sts->blink.off = period - on;                     /* Time off in each cycle */
+          halLedStart (led, sts, &sts->blink, 1, numBlinks);
           leds ^= led;
         }
         led <<= 1;
@@ -271,11 +320,275 @@ void HalLedBlink (uint8 leds, uint8 numBlinks, uint8 percent, uint16 period)
 #endif /* BLINK_LEDS && HAL_LED */
 }
 
+/***************************************************************************************************
+ * @fn      HalLedPattern
+ *
+ * @brief   Play a sequence of on/off steps on the leds. All leds share the blink timer, so any
+ *          number of patterns costs one wakeup per on/off edge.
+ *
+ * @param   leds       - bit mask value of leds to play the pattern on
+ *          pSteps     - steps to play; must stay valid while the pattern runs (normally CONST)
+ *          numSteps   - number of steps in pSteps
+ *          cnt        - number of times to play the whole pattern, 0 for continuous
+ *
+ * @return  None
+ ***************************************************************************************************/
+void HalLedPattern (uint8 leds, const HalLedStep_t *pSteps, uint8 numSteps, uint8 cnt)
+{
+#if (defined (BLINK_LEDS)) && (HAL_LED == TRUE)
+  uint8 led;
+  uint8 i;
+  uint16 total;
+  HalLedControl_t *sts;
+
+  /* A pattern with no time in it would never yield the blink timer */
+  total = 0;
+  for (i = 0; (pSteps != NULL) && (i < numSteps); i++)
+  {
+    total |= pSteps[i].on | pSteps[i].off;
+  }
+
+  if (leds && total)
+  {
+    led = HAL_LED_1_RED;
+    leds &= HAL_LED_ALL;
+    sts = HalLedStatusControl.HalLedControlTable;
+
+    while (leds)
+    {
+      if (leds & led)
+      {
+        halLedStart (led, sts, pSteps, numSteps, cnt);
+        leds ^= led;
+      }
+      led <<= 1;
+      sts++;
+    }
+    // Cancel any overlapping timer for blink events
+    osal_stop_timerEx(Hal_TaskID, HAL_LED_BLINK_EVENT);
+    osal_set_event (Hal_TaskID, HAL_LED_BLINK_EVENT);
+  }
+  else
+  {
+    HalLedSet (leds, HAL_LED_MODE_OFF);                     /* Nothing to play, turn off */
+  }
+#elif (HAL_LED == TRUE)
+  (void) pSteps;
+  (void) numSteps;
+  (void) cnt;
+  HalLedOnOff (leds, (leds & HalLedState) ? HAL_LED_MODE_OFF : HAL_LED_MODE_ON);  /* Toggle */
+#else
+  // HAL LED is disabled, suppress unused argument warnings
+  (void) leds;
+  (void) pSteps;
+  (void) numSteps;
+  (void) cnt;
+#endif /* BLINK_LEDS && HAL_LED */
+}
+
+/***************************************************************************************************
+ * @fn      HalLedSetLevel
+ *
+ * @brief   Set the brightness of the leds. Levels between off and max are produced by the timers;
+ *          off and max hand the pin back to GPIO.
+ *
+ * @param   leds       - bit mask value of leds
+ *          level      - HAL_LED_LEVEL_OFF .. HAL_LED_LEVEL_MAX
+ *
+ * @return  None
+ ***************************************************************************************************/
+void HalLedSetLevel (uint8 leds, uint8 level)
+{
+  HalLedFade (leds, level, 0);
+}
+
+/***************************************************************************************************
+ * @fn      HalLedSetColor
+ *
+ * @brief   Mix a colour from the red, green and blue leds
+ *
+ * @param   red, green, blue - level of each led, HAL_LED_LEVEL_OFF .. HAL_LED_LEVEL_MAX
+ *
+ * @return  None
+ ***************************************************************************************************/
+void HalLedSetColor (uint8 red, uint8 green, uint8 blue)
+{
+  HalLedFade (HAL_LED_1_RED, red, 0);
+  HalLedFade (HAL_LED_2_BLUE, blue, 0);
+  HalLedFade (HAL_LED_3_GREEN, green, 0);
+}
+
+/***************************************************************************************************
+ * @fn      HalLedFade
+ *
+ * @brief   Ramp the leds from their present level to a new one. The step size is worked out here
+ *          once; the Timer1 overflow interrupt then moves the compare values every PWM period, so
+ *          no OSAL event is used until the fade ends at off or max. Stops any blink on the leds.
+ *
+ * @param   leds       - bit mask value of leds
+ *          level      - final level, HAL_LED_LEVEL_OFF .. HAL_LED_LEVEL_MAX
+ *          time       - length of the fade in PWM periods (1.024 ms), 0 to jump straight there
+ *
+ * @return  None
+ ***************************************************************************************************/
+void HalLedFade (uint8 leds, uint8 level, uint16 time)
+{
+#if (defined HAL_LED_PWM) && (HAL_LED_PWM == TRUE)
+  uint8 led;
+  uint8 idx;
+  halIntState_t intState;
+  HalLedControl_t *sts;
+
+  led = HAL_LED_1_RED;
+  leds &= HAL_LED_ALL;
+  sts = HalLedStatusControl.HalLedControlTable;
+
+  for (idx = 0; leds; idx++)
+  {
+    if (leds & led)
+    {
+      /* Stop any blink, the led now belongs to the fade */
+      sts->mode = (level != HAL_LED_LEVEL_OFF) ? HAL_LED_MODE_ON : HAL_LED_MODE_OFF;
+      preBlinkState &= (led ^ 0xFF);
+
+      HAL_ENTER_CRITICAL_SECTION(intState);
+
+      if (!(halLedPwmActive & led))
+      {
+        halLedPwmLevel[idx] = (HalLedState & led) ? ((uint16)HAL_LED_LEVEL_MAX << 8) : 0;
+      }
+      halLedPwmTarget[idx] = level;
+
+      if ((time > 1) && (level != (uint8)(halLedPwmLevel[idx] >> 8)))
+      {
+        halLedPwmAttach (led);
+        halLedPwmStep[idx] = (int16)((((int32)level << 8) - (int32)halLedPwmLevel[idx]) / (int32)time);
+        halLedPwmLeft[idx] = time;
+        halLedPwmFading |= led;
+        HalLedState |= led;
+      }
+      else
+      {
+        halLedPwmFading &= (led ^ 0xFF);
+        halLedPwmLevel[idx] = (uint16)level << 8;
+
+        if ((level == HAL_LED_LEVEL_OFF) || (level == HAL_LED_LEVEL_MAX))
+        {
+          HalLedOnOff (led, (level != HAL_LED_LEVEL_OFF) ? HAL_LED_MODE_ON : HAL_LED_MODE_OFF);
+        }
+        else
+        {
+          halLedPwmAttach (led);
+          halLedPwmWrite (idx, level);
+          HalLedState |= led;
+        }
+      }
+
+      if (halLedPwmFading)
+      {
+        T1IE = 1;                                           /* Fades run off Timer1 overflow */
+      }
+
+      HAL_EXIT_CRITICAL_SECTION(intState);
+
+      leds ^= led;
+    }
+    led <<= 1;
+    sts++;
+  }
+#else
+  (void) time;
+  HalLedSet (leds, (level != HAL_LED_LEVEL_OFF) ? HAL_LED_MODE_ON : HAL_LED_MODE_OFF);
+#endif /* HAL_LED_PWM */
+}
+
+#if (defined (BLINK_LEDS)) && (HAL_LED == TRUE)
+/***************************************************************************************************
+ * @fn      halLedStart
+ *
+ * @brief   Load a pattern into one led's control block. The first HalLedUpdate turns it on.
+ *
+ * @param   led        - single led bit
+ *          sts        - control block of that led
+ *          pSteps     - steps to play
+ *          numSteps   - number of steps in pSteps
+ *          cnt        - number of times to play the pattern, 0 for continuous
+ *
+ * @return  None
+ ***************************************************************************************************/
+static void halLedStart (uint8 led, HalLedControl_t *sts, const HalLedStep_t *pSteps, uint8 numSteps, uint8 cnt)
+{
+  /* Store the current state of the led before going to blinking if not already blinking */
+  if (sts->mode < HAL_LED_MODE_BLINK)
+  {
+    preBlinkState |= (led & HalLedState);
+  }
+
+  sts->mode     = HAL_LED_MODE_OFF;                         /* Stop previous blink */
+  sts->pSteps   = pSteps;
+  sts->numSteps = numSteps;
+  sts->step     = 0;
+  sts->left     = cnt;                                      /* Number of pattern repeats */
+  if (!cnt) sts->mode |= HAL_LED_MODE_FLASH;                /* Continuous */
+  sts->wait     = 0;                                        /* Start now */
+  sts->mode    |= HAL_LED_MODE_BLINK;                       /* Enable blinking */
+}
+
+/***************************************************************************************************
+ * @fn      halLedNextPhase
+ *
+ * @brief   Move one led to its next on/off phase and load the phase length into sts->wait.
+ *
+ * @param   led        - single led bit
+ *          sts        - control block of that led
+ *
+ * @return  None
+ ***************************************************************************************************/
+static void halLedNextPhase (uint8 led, HalLedControl_t *sts)
+{
+  if (sts->mode & HAL_LED_MODE_ON)
+  {
+    sts->mode &= ~HAL_LED_MODE_ON;                          /* Say it's not on */
+    HalLedOnOff (led, HAL_LED_MODE_OFF);                    /* Turn it off */
+    sts->wait = sts->pSteps[sts->step].off;
+
+    if (++sts->step >= sts->numSteps)
+    {
+      sts->step = 0;
+      if (!(sts->mode & HAL_LED_MODE_FLASH))
+      {
+        sts->left--;                                        /* Not continuous, reduce count */
+      }
+    }
+  }
+  else if (!(sts->left) && !(sts->mode & HAL_LED_MODE_FLASH))
+  {
+    sts->mode ^= HAL_LED_MODE_BLINK;                        /* No more blinks */
+    sts->wait = 0;
+    /* After blinking, set the LED back to the state before it blinks */
+    HalLedSet (led, ((preBlinkState & led)!=0)?HAL_LED_MODE_ON:HAL_LED_MODE_OFF);
+    /* Clear the saved bit */
+    preBlinkState &= (led ^ 0xFF);
+  }
+  else
+  {
+    sts->mode |= HAL_LED_MODE_ON;                           /* Say it's on */
+    sts->wait = sts->pSteps[sts->step].on;
+    if (sts->wait)
+    {
+      HalLedOnOff (led, HAL_LED_MODE_ON);                   /* Turn it on */
+    }
+  }
+}
+#endif /* BLINK_LEDS && HAL_LED */
+
 #if (HAL_LED == TRUE)
 /***************************************************************************************************
  * @fn      HalLedUpdate
  *
- * @brief   Update leds to work with blink
+ * @brief   Update leds to work with blink. Called on HAL_LED_BLINK_EVENT; the on/off times were
+ *          worked out when the blink was started, so this only subtracts the time since the last
+ *          update from each led and re-arms the one shared timer for the earliest next edge.
  *
  * @param   none
  *
@@ -284,74 +597,62 @@ void HalLedBlink (uint8 leds, uint8 numBlinks, uint8 percent, uint16 period)
 void HalLedUpdate (void)
 {
   uint8 led;
-  uint8 pct;
   uint8 leds;
   HalLedControl_t *sts;
   uint32 time;
+  uint16 elapsed;
+  uint16 over;
   uint16 next;
-  uint16 wait;
 
-  next = 0;
-  led  = HAL_LED_1_RED;
-  leds = HAL_LED_ALL;
-  sts = HalLedStatusControl.HalLedControlTable;
+#if (defined HAL_LED_PWM) && (HAL_LED_PWM == TRUE)
+  /* Fades that ended at off or max go back to plain GPIO */
+  halLedPwmSettle();
+#endif
 
   /* Check if sleep is active or not */
   if (!HalLedStatusControl.sleepActive)
   {
+    /* One clock read per update, every led is advanced by the same amount */
+    time = osal_GetSystemClock();
+    time -= HalLedStatusControl.lastUpdate;
+    elapsed = (time > 0xFFFF) ? 0xFFFF : (uint16)time;
+    HalLedStatusControl.lastUpdate += time;
+
+    next = 0;
+    led  = HAL_LED_1_RED;
+    leds = HAL_LED_ALL;
+    sts = HalLedStatusControl.HalLedControlTable;
+
     while (leds)
     {
       if (leds & led)
       {
         if (sts->mode & HAL_LED_MODE_BLINK)
         {
-          time = osal_GetSystemClock();
-          if (time >= sts->next)
+          if (sts->wait > elapsed)
           {
-            if (sts->mode & HAL_LED_MODE_ON)
-            {
-              pct = 100 - sts->onPct;               /* Percentage of cycle for off */
-              sts->mode &= ~HAL_LED_MODE_ON;        /* Say it's not on */
-              HalLedOnOff (led, HAL_LED_MODE_OFF);  /* Turn it off */
-
-              if ( !(sts->mode & HAL_LED_MODE_FLASH) )
-              {
-                sts->left--;                         // Not continuous, reduce count
-              }
-            }
-            else if ( !(sts->left) && !(sts->mode & HAL_LED_MODE_FLASH) )
-            {
-              sts->mode ^= HAL_LED_MODE_BLINK;       // No more blinks
-            }
-            else
+            sts->wait -= elapsed;                   /* Time left */
+          }
+          else
+          {
+            /* Phase is over, skip any zero length phases that follow it. A led just started has
+               no phase to be late for, whatever the time since the last update. */
+            over = (sts->wait) ? (elapsed - sts->wait) : 0;
+            do
             {
-              pct = sts->onPct;                      // Percentage of cycle for on
-              sts->mode |= HAL_LED_MODE_ON;          // Say it's on
-              HalLedOnOff( led, HAL_LED_MODE_ON );   // Turn it on
-            }
+              halLedNextPhase (led, sts);
+            } while (!sts->wait && (sts->mode & HAL_LED_MODE_BLINK));
+
+            /* The late part of this update comes off the new phase, so timer latency does not add up */
             if (sts->mode & HAL_LED_MODE_BLINK)
             {
-              wait = (((uint32)pct * (uint32)sts->time) / 100);
-              sts->next = time + wait;
-            }
-            else
-            {
-              /* no more blink, no more wait */
-              wait = 0;
-              /* After blinking, set the LED back to the state before it blinks */
-              HalLedSet (led, ((preBlinkState & led)!=0)?HAL_LED_MODE_ON:HAL_LED_MODE_OFF);
-              /* Clear the saved bit */
-              preBlinkState &= (led ^ 0xFF);
+              sts->wait = (sts->wait > over) ? (sts->wait - over) : 1;
             }
           }
-          else
-          {
-            wait = sts->next - time;  /* Time left */
-          }
 
-          if (!next || ( wait && (wait < next) ))
+          if ((sts->mode & HAL_LED_MODE_BLINK) && (!next || (sts->wait < next)))
           {
-            next = wait;
+            next = sts->wait;
           }
         }
         leds ^= led;
@@ -415,6 +716,14 @@ void HalLedOnOff (uint8 leds, uint8 mode)
     }
   }
 
+#if (defined HAL_LED_PWM) && (HAL_LED_PWM == TRUE)
+  /* The GPIO level is set, now take the pins back from the timers */
+  if (leds & halLedPwmActive)
+  {
+    halLedPwmDetach (leds & halLedPwmActive);
+  }
+#endif
+
   /* Remember current state */
   if (mode)
   {
@@ -427,6 +736,225 @@ void HalLedOnOff (uint8 leds, uint8 mode)
 }
 #endif /* HAL_LED */
 
+#if (defined HAL_LED_PWM) && (HAL_LED_PWM == TRUE)
+/***************************************************************************************************
+ * @fn      halLedPwmAttach
+ *
+ * @brief   Hand one led pin to its timer channel, starting the timers on first use. The timers stop
+ *          in PM2/PM3, so PWRMGR_REASON_LED_PWM is held while any led is on PWM.
+ *
+ * @param   led        - single led bit
+ *
+ * @return  None
+ ***************************************************************************************************/
+static void halLedPwmAttach (uint8 led)
+{
+  if (halLedPwmActive & led)
+  {
+    return;
+  }
+
+  if (!halLedPwmActive)
+  {
+    /* Timer1 runs whenever any led is on PWM, it paces the fades of all three */
+    PERCFG |= HAL_LED_PWM_PERCFG_T1CFG;
+    T1CCTL0 = 0;
+    T1CC0L = 0xFF;
+    T1CC0H = 0;
+    TIMIF |= HAL_LED_PWM_TIMIF_OVFIM;
+    T1CTL = HAL_LED_PWM_T1CTL;
+#ifdef POWER_SAVING
+    (void)osal_pwrmgr_hold(PWRMGR_REASON_LED_PWM);
+#endif
+  }
+
+  if (led & HAL_LED_1_RED)
+  {
+    T1CCTL2 = HAL_LED_PWM_CCTL;
+    P1SEL |= LED1_BV;
+  }
+  else if (led & HAL_LED_2_BLUE)
+  {
+    T1CCTL1 = HAL_LED_PWM_CCTL;
+    P1SEL |= LED2_BV;
+  }
+  else
+  {
+    PERCFG |= HAL_LED_PWM_PERCFG_T4CFG;
+    T4CCTL0 = HAL_LED_PWM_CCTL;
+    T4CTL = HAL_LED_PWM_T4CTL;
+    P2SEL |= LED3_BV;
+  }
+
+  halLedPwmActive |= led;
+}
+
+/***************************************************************************************************
+ * @fn      halLedPwmDetach
+ *
+ * @brief   Give led pins back to GPIO and stop the timers once no led is on PWM
+ *
+ * @param   leds       - bit mask of leds currently on PWM
+ *
+ * @return  None
+ ***************************************************************************************************/
+static void halLedPwmDetach (uint8 leds)
+{
+  if (leds & HAL_LED_1_RED)
+  {
+    P1SEL &= (uint8) ~LED1_BV;
+    T1CCTL2 = 0;
+  }
+  if (leds & HAL_LED_2_BLUE)
+  {
+    P1SEL &= (uint8) ~LED2_BV;
+    T1CCTL1 = 0;
+  }
+  if (leds & HAL_LED_3_GREEN)
+  {
+    P2SEL &= (uint8) ~LED3_BV;
+    T4CCTL0 = 0;
+    T4CTL = 0;
+  }
+
+  halLedPwmActive &= (leds ^ 0xFF);
+  halLedPwmFading &= (leds ^ 0xFF);
+
+  if (!halLedPwmActive)
+  {
+    T1IE = 0;
+    T1CTL = 0;
+#ifdef POWER_SAVING
+    (void)osal_pwrmgr_release(PWRMGR_REASON_LED_PWM);
+#endif
+  }
+}
+
+/***************************************************************************************************
+ * @fn      halLedPwmWrite
+ *
+ * @brief   Load the compare register of one led
+ *
+ * @param   idx        - led number, 0 = red, 1 = blue, 2 = green
+ *          level      - duty cycle in 1/256
+ *
+ * @return  None
+ ***************************************************************************************************/
+static void halLedPwmWrite (uint8 idx, uint8 level)
+{
+  if (idx == 0)
+  {
+    T1CC2L = level;
+    T1CC2H = 0;
+  }
+  else if (idx == 1)
+  {
+    T1CC1L = level;
+    T1CC1H = 0;
+  }
+  else
+  {
+    T4CC0 = level;
+  }
+}
+
+/***************************************************************************************************
+ * @fn      halLedPwmSettle
+ *
+ * @brief   Hand leds whose fade ended at off or max back to GPIO, so a fully on or off led neither
+ *          keeps the timers running nor keeps the device out of sleep.
+ *
+ * @param   none
+ *
+ * @return  None
+ ***************************************************************************************************/
+static void halLedPwmSettle (void)
+{
+  uint8 led;
+  uint8 idx;
+  uint8 done;
+
+  done = halLedPwmActive & ~halLedPwmFading;
+  led = HAL_LED_1_RED;
+
+  for (idx = 0; idx < HAL_LED_PWM_NUM_LEDS; idx++)
+  {
+    if ((done & led) &&
+        ((halLedPwmTarget[idx] == HAL_LED_LEVEL_OFF) || (halLedPwmTarget[idx] == HAL_LED_LEVEL_MAX)))
+    {
+      HalLedOnOff (led, (halLedPwmTarget[idx] != HAL_LED_LEVEL_OFF) ? HAL_LED_MODE_ON : HAL_LED_MODE_OFF);
+    }
+    led <<= 1;
+  }
+}
+
+/***************************************************************************************************
+ * @fn      halLedPwmIsr
+ *
+ * @brief   Timer1 overflow, once per PWM period while a fade is running. Moves each fading led one
+ *          step and wakes the HAL task only when a fade ends at off or max.
+ *
+ * @param   none
+ *
+ * @return  None
+ ***************************************************************************************************/
+HAL_ISR_FUNCTION( halLedPwmIsr, T1_VECTOR )
+{
+  uint8 led;
+  uint8 idx;
+  uint8 fading;
+  uint8 settle;
+
+  HAL_ENTER_ISR();
+
+  /* T1STAT has to be cleared before T1IF */
+  T1STAT = (uint8) ~HAL_LED_PWM_T1STAT_OVFIF;
+  T1IF = 0;
+
+  fading = halLedPwmFading;
+  settle = FALSE;
+  led = HAL_LED_1_RED;
+
+  for (idx = 0; idx < HAL_LED_PWM_NUM_LEDS; idx++)
+  {
+    if (fading & led)
+    {
+      if (--halLedPwmLeft[idx])
+      {
+        halLedPwmLevel[idx] += (uint16)halLedPwmStep[idx];
+      }
+      else
+      {
+        /* Land exactly on the target, the step was rounded */
+        halLedPwmLevel[idx] = (uint16)halLedPwmTarget[idx] << 8;
+        fading &= (led ^ 0xFF);
+        if ((halLedPwmTarget[idx] == HAL_LED_LEVEL_OFF) || (halLedPwmTarget[idx] == HAL_LED_LEVEL_MAX))
+        {
+          settle = TRUE;
+        }
+      }
+      halLedPwmWrite (idx, (uint8)(halLedPwmLevel[idx] >> 8));
+    }
+    led <<= 1;
+  }
+
+  halLedPwmFading = fading;
+  if (!fading)
+  {
+    T1IE = 0;
+  }
+
+  if (settle)
+  {
+    (void)osal_set_event(Hal_TaskID, HAL_LED_BLINK_EVENT);
+  }
+
+  HAL_EXIT_ISR();
+
+  return;
+}
+#endif /* HAL_LED_PWM */
+
 /***************************************************************************************************
  * @fn      HalGetLedState
  *
@@ -499,6 +1027,25 @@ void HalLedExitSleep( void )
 #endif /* BLINK_LEDS */
 }
 
+/***************************************************************************************************
+ * @fn      HalLedSleepIdle
+ *
+ * @brief   Tell halSleep() whether the enter/exit hooks can be skipped. They only save and switch
+ *          off HAL_LED_EXCEPT_RED_BLUE; blinking leds are rescheduled by HAL_LED_BLINK_EVENT anyway.
+ *
+ * @param   none
+ *
+ * @return  TRUE when none of those leds is lit
+ ***************************************************************************************************/
+uint8 HalLedSleepIdle( void )
+{
+#if (HAL_LED == TRUE)
+  return ( (HalLedState & HAL_LED_EXCEPT_RED_BLUE) == 0 );
+#else
+  return ( TRUE );
+#endif /* HAL_LED */
+}
+
 /***************************************************************************************************
 ***************************************************************************************************/
 
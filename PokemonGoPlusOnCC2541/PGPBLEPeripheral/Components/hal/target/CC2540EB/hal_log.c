@@ -0,0 +1,300 @@
+/******************************************************************************
+
+ @file  hal_log.c
+
+ @brief This file contains a lock-free single producer / single consumer ring
+        that carries compact binary log frames to the UART.
+
+ Group: WCS, BTS
+ Target Device: CC2540, CC2541
+
+ ******************************************************************************
+ 
+ Copyright (c) 2006-2016, Texas Instruments Incorporated
+ All rights reserved.
+
+ IMPORTANT: Your use of this Software is limited to those specific rights
+ granted under the terms of a software license agreement between the user
+ who downloaded the software, his/her employer (which must be your employer)
+ and Texas Instruments Incorporated (the "License"). You may not use this
+ Software unless you agree to abide by the terms of the License. The License
+ limits your use, and you acknowledge, that the Software may not be modified,
+ copied or distributed unless embedded on a Texas Instruments microcontroller
+ or used solely and exclusively in conjunction with a Texas Instruments radio
+ frequency transceiver, which is integrated into your product. Other than for
+ the foregoing purpose, you may not use, reproduce, copy, prepare derivative
+ works of, modify, distribute, perform, display or sell this Software and/or
+ its documentation for any purpose.
+
+ YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+ PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+ INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+ NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+ TEXAS INSTRUMENTS OR ITS LICENSORS BE LIABLE OR OBLIGATED UNDER CONTRACT,
+ NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+ LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+ INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+ OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+ OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+ (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+ Should you have any questions regarding your right to use this Software,
+ contact Texas Instruments Incorporated at www.TI.com.
+
+ ******************************************************************************
+ Release Name: ble_sdk_1.4.2.2
+ Release Date: 2016-06-09 06:57:09
+ *****************************************************************************/
+
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include "hal_board_cfg.h"
+#include "hal_defs.h"
+#include "hal_mcu.h"
+#include "hal_types.h"
+#include "hal_uart.h"
+#include "hal_log.h"
+
+#if (defined HAL_LOG) && (HAL_LOG == TRUE)
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#if (HAL_LOG_BUF_SIZE & (HAL_LOG_BUF_SIZE - 1)) || (HAL_LOG_BUF_SIZE > 256)
+  #error "HAL_LOG_BUF_SIZE must be a power of 2 no larger than 256"
+#endif
+
+#define HAL_LOG_IDX_MASK            (HAL_LOG_BUF_SIZE - 1)
+
+/*********************************************************************
+ * MACROS
+ */
+
+#define HAL_LOG_IDX_INCR(IDX)       ((uint8)((IDX) + 1) & HAL_LOG_IDX_MASK)
+
+// One byte is always kept free so that head == tail means empty.
+#define HAL_LOG_FREE(HEAD, TAIL)    (HAL_LOG_IDX_MASK - ((uint8)((HEAD) - (TAIL)) & HAL_LOG_IDX_MASK))
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+/*
+ * Ring with one consumer. halLogHead is only written by HalLogEvent() and
+ * halLogTail only by HalLogPoll(); both are single bytes so each side reads
+ * the other's index atomically. HalLogEvent() may be called from interrupts
+ * as well as tasks, so it reserves, fills and publishes a frame inside a
+ * critical section. It publishes the new head only after the whole frame is
+ * in the buffer, so the consumer never sees a partial frame. HalLogPoll()
+ * runs in task context only.
+ */
+static uint8 halLogBuf[HAL_LOG_BUF_SIZE];
+static volatile uint8 halLogHead;
+static volatile uint8 halLogTail;
+
+// Frames lost since the last successful write; reported by a HAL_LOG_ID_DROPPED frame.
+static uint8 halLogDropped;
+
+// Staging area for one frame on its way to the UART; kept off the 8051 stack.
+static uint8 halLogFrame[HAL_LOG_ARGS_MAX + HAL_LOG_FRAME_OVERHEAD];
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static uint8 halLogPutFrame( uint8 head, uint8 id, uint8 *pArgs, uint8 len );
+
+/******************************************************************************
+ * @fn      HalLogInit
+ *
+ * @brief   Initialize the log ring
+ *
+ * @param   none
+ *
+ * @return  none
+ *****************************************************************************/
+void HalLogInit( void )
+{
+  halLogHead = 0;
+  halLogTail = 0;
+  halLogDropped = 0;
+}
+
+/******************************************************************************
+ * @fn      HalLogEvent
+ *
+ * @brief   Queue one binary event frame. The frame is either queued whole or
+ *          dropped and counted; the caller never waits on the UART. May be
+ *          called from interrupts.
+ *
+ * @param   id    - HAL_LOG_ID_* event identifier
+ *          pArgs - argument bytes, may be NULL if len is 0
+ *          len   - number of argument bytes, truncated to HAL_LOG_ARGS_MAX
+ *
+ * @return  TRUE if the frame was queued, FALSE if it was dropped
+ *****************************************************************************/
+uint8 HalLogEvent( uint8 id, uint8 *pArgs, uint8 len )
+{
+  halIntState_t intState;
+  uint8 head;
+  uint8 need;
+
+  if ( len > HAL_LOG_ARGS_MAX )
+  {
+    len = HAL_LOG_ARGS_MAX;
+  }
+
+  need = len + HAL_LOG_FRAME_OVERHEAD;
+  // An interrupt that logs must not claim the same bytes of the ring
+  HAL_ENTER_CRITICAL_SECTION( intState );
+  head = halLogHead;
+
+  if ( halLogDropped != 0 )
+  {
+    need += HAL_LOG_FRAME_OVERHEAD + 1;
+  }
+
+  if ( HAL_LOG_FREE( head, halLogTail ) < need )
+  {
+    if ( halLogDropped != 0xFF )
+    {
+      halLogDropped++;
+    }
+    HAL_EXIT_CRITICAL_SECTION( intState );
+    return FALSE;
+  }
+
+  if ( halLogDropped != 0 )
+  {
+    head = halLogPutFrame( head, HAL_LOG_ID_DROPPED, &halLogDropped, 1 );
+    halLogDropped = 0;
+  }
+
+  head = halLogPutFrame( head, id, pArgs, len );
+
+  // Publish the frame(s) to the consumer.
+  halLogHead = head;
+  HAL_EXIT_CRITICAL_SECTION( intState );
+
+  return TRUE;
+}
+
+/******************************************************************************
+ * @fn      HalLogDump
+ *
+ * @brief   Queue a block longer than HAL_LOG_ARGS_MAX as consecutive frames
+ *          with the same id, each carrying up to HAL_LOG_ARGS_MAX bytes.
+ *          Stops at the first frame that is dropped, so the host sees a
+ *          prefix of the block followed by a HAL_LOG_ID_DROPPED frame.
+ *
+ * @param   id    - HAL_LOG_ID_* event identifier
+ *          pArgs - bytes to dump
+ *          len   - number of bytes
+ *
+ * @return  TRUE if the whole block was queued, FALSE otherwise
+ *****************************************************************************/
+uint8 HalLogDump( uint8 id, uint8 *pArgs, uint8 len )
+{
+  do
+  {
+    uint8 cnt = ( len > HAL_LOG_ARGS_MAX ) ? HAL_LOG_ARGS_MAX : len;
+
+    if ( HalLogEvent( id, pArgs, cnt ) == FALSE )
+    {
+      return FALSE;
+    }
+
+    pArgs += cnt;
+    len -= cnt;
+  } while ( len != 0 );
+
+  return TRUE;
+}
+
+/******************************************************************************
+ * @fn      HalLogPoll
+ *
+ * @brief   Move whole frames from the ring into the UART Tx buffer. Stops at
+ *          the first frame the UART driver cannot take and retries on the
+ *          next poll, keeping the MCU awake until the ring is empty. Task
+ *          context only.
+ *
+ * @param   none
+ *
+ * @return  none
+ *****************************************************************************/
+void HalLogPoll( void )
+{
+  uint8 head = halLogHead;
+  uint8 tail = halLogTail;
+
+  while ( tail != head )
+  {
+    uint8 idx = tail;
+    uint8 cnt = halLogBuf[(uint8)(tail + 2) & HAL_LOG_IDX_MASK] + HAL_LOG_FRAME_OVERHEAD;
+    uint8 i;
+
+    for ( i = 0; i < cnt; i++ )
+    {
+      halLogFrame[i] = halLogBuf[idx];
+      idx = HAL_LOG_IDX_INCR( idx );
+    }
+
+    if ( HalUARTWrite( HAL_LOG_PORT, halLogFrame, cnt ) == 0 )
+    {
+      break;
+    }
+
+    tail = idx;
+    halLogTail = tail;
+  }
+
+  if ( tail != head )
+  {
+    CLEAR_SLEEP_MODE();
+  }
+}
+
+/******************************************************************************
+ * @fn      halLogPutFrame
+ *
+ * @brief   Copy one frame into the ring without publishing it.
+ *
+ * @param   head  - index to start writing at
+ *          id    - event identifier
+ *          pArgs - argument bytes
+ *          len   - number of argument bytes
+ *
+ * @return  index just past the frame
+ *****************************************************************************/
+static uint8 halLogPutFrame( uint8 head, uint8 id, uint8 *pArgs, uint8 len )
+{
+  uint8 fcs = id ^ len;
+
+  halLogBuf[head] = HAL_LOG_SYNC;
+  head = HAL_LOG_IDX_INCR( head );
+  halLogBuf[head] = id;
+  head = HAL_LOG_IDX_INCR( head );
+  halLogBuf[head] = len;
+  head = HAL_LOG_IDX_INCR( head );
+
+  while ( len-- )
+  {
+    fcs ^= *pArgs;
+    halLogBuf[head] = *pArgs++;
+    head = HAL_LOG_IDX_INCR( head );
+  }
+
+  halLogBuf[head] = fcs;
+
+  return HAL_LOG_IDX_INCR( head );
+}
+
+#endif /* HAL_LOG */
+
+/******************************************************************************
+******************************************************************************/
@@ -55,6 +55,9 @@
 #include "hal_sleep.h"
 #include "hal_led.h"
 #include "hal_key.h"
+#if (defined HAL_BUZZER) && (HAL_BUZZER == TRUE)
+#include "hal_buzzer.h"
+#endif
 #include "OSAL.h"
 #include "OSAL_Timers.h"
 #include "OSAL_Tasks.h"
@@ -218,6 +221,9 @@ static uint8 wakeForRF;
 static bool halSleepInt = FALSE;
 #endif // HAL_SLEEP_DEBUG_POWER_MODE
 
+// Wake reasons and slept time, read over the air by the diagnostics service.
+static halSleepStats_t halSleepStats;
+
 /*******************************************************************************
  * GLOBAL VARIABLES
  */
@@ -238,6 +244,7 @@ void halSetSleepMode(void);
 void   halSleepSetTimer( uint32 sleepTime, uint32 timeout );
 uint32 halSleepReadTimer( void );
 uint32 TimerElapsed( void );
+static void halSleepRecordWake( uint32 sleepTimer );
 
 /*******************************************************************************
  * @fn          halSleep
@@ -288,6 +295,7 @@ void halSleep( uint32 osal_timeout )
   uint32 timeout;
   uint32 llTimeout;
   uint32 sleepTimer;
+  uint8 fastPath;
 
 #ifdef DEBUG_GPIO
   // TEMP
@@ -342,6 +350,15 @@ void halSleep( uint32 osal_timeout )
   // HAL_SLEEP_PM3 is entered only if the timeout is zero
   halPwrMgtMode = (timeout == 0) ? HAL_SLEEP_DEEP : HAL_SLEEP_TIMER;
 
+#if (defined HAL_BUZZER) && (HAL_BUZZER == TRUE)
+  // Timer3 stops without the 32MHz clock, so while a tone sounds only halt
+  // the CPU; the sleep timer, radio and any other interrupt still wake it.
+  if ( HalBuzzerActive() )
+  {
+    halPwrMgtMode = HAL_SLEEP_OFF;
+  }
+#endif // HAL_BUZZER
+
 #ifdef DEBUG_GPIO
   // TEMP
   P1_0 = 0;
@@ -360,21 +377,51 @@ void halSleep( uint32 osal_timeout )
     HAL_ASSERT( HAL_INTERRUPTS_ARE_ENABLED() );
     HAL_DISABLE_INTERRUPTS();
 
+    // PM0: clocks and radio stay up, the CPU halts until the next interrupt
+    if ( halPwrMgtMode == HAL_SLEEP_OFF )
+    {
+      if ( halSleepPconValue )
+      {
+        if ( timeout != 0 )
+        {
+          halSleepSetTimer( sleepTimer, (timeout > MAX_SLEEP_TIME) ? MAX_SLEEP_TIME : timeout );
+        }
+
+        HAL_SLEEP_PREP_POWER_MODE(halPwrMgtMode);
+        HAL_ENABLE_INTERRUPTS();
+
+        // interrupts are disabled after this function
+        HAL_SLEEP_SET_POWER_MODE();
+
+        halSleepStats.halts++;
+      }
+    }
     // check if radio allows sleep, and if so, preps system for shutdown
-    if ( halSleepPconValue && ( LL_PowerOffReq(halPwrMgtMode) == LL_SLEEP_REQUEST_ALLOWED ) )
+    else if ( halSleepPconValue && ( LL_PowerOffReq(halPwrMgtMode) == LL_SLEEP_REQUEST_ALLOWED ) )
     {
+      // The key and LED hooks only have work while a LED they switch off is
+      // lit; most naps (connection events, blink timers) skip them.
+#if (defined HAL_LED) && (HAL_LED == TRUE) && !defined (HAL_SLEEP_DEBUG_LED)
+      fastPath = HalLedSleepIdle();
+#else
+      fastPath = TRUE;
+#endif
+
+      if ( !fastPath )
+      {
 #if ((defined HAL_KEY) && (HAL_KEY == TRUE))
-      // get peripherals ready for sleep
-      HalKeyEnterSleep();
+        // get peripherals ready for sleep
+        HalKeyEnterSleep();
 #endif // ((defined HAL_KEY) && (HAL_KEY == TRUE))
 
+#if (defined HAL_LED) && (HAL_LED == TRUE) && !defined (HAL_SLEEP_DEBUG_LED)
+        // use this to turn LEDs off during sleep
+        HalLedEnterSleep();
+#endif
+      }
+
 #ifdef HAL_SLEEP_DEBUG_LED
       HAL_TURN_OFF_LED3();
-#else
-      // use this to turn LEDs off during sleep
-#if (defined HAL_LED) && (HAL_LED == TRUE)
-      HalLedEnterSleep();
-#endif //(defined HAL_LED) && (HAL_LED == TRUE)
 #endif // HAL_SLEEP_DEBUG_LED
 
       // enable sleep timer interrupt
@@ -417,6 +464,13 @@ void halSleep( uint32 osal_timeout )
       P1_0 = 1;
 #endif // DEBUG_GPIO
 
+      // the waking interrupt is still pending, so its flag names the reason
+      halSleepRecordWake( sleepTimer );
+      if ( fastPath )
+      {
+        halSleepStats.fastPath++;
+      }
+
       // check if ST interrupt pending, and if not, clear wakeForRF flag
       // Note: This is needed in case we are not woken by the sleep timer but
       //       by for example a key press. In this case, the flag has to be
@@ -442,21 +496,32 @@ void halSleep( uint32 osal_timeout )
 
 #ifdef HAL_SLEEP_DEBUG_LED
       HAL_TURN_ON_LED3();
-#else //!HAL_SLEEP_DEBUG_LED
-      // use this to turn LEDs back on after sleep
-#if (defined HAL_LED) && (HAL_LED == TRUE)
-      HalLedExitSleep();
-#endif //(defined HAL_LED) && (HAL_LED == TRUE)
 #endif // HAL_SLEEP_DEBUG_LED
 
+      if ( !fastPath )
+      {
+#if (defined HAL_LED) && (HAL_LED == TRUE) && !defined (HAL_SLEEP_DEBUG_LED)
+        // use this to turn LEDs back on after sleep
+        HalLedExitSleep();
+#endif
+
 #if ((defined HAL_KEY) && (HAL_KEY == TRUE))
-      // handle peripherals
-      (void)HalKeyExitSleep();
+        // handle peripherals
+        (void)HalKeyExitSleep();
 #endif // ((defined HAL_KEY) && (HAL_KEY == TRUE))
+      }
+    }
+    else
+    {
+      halSleepStats.skipped++;
     }
 
     HAL_ENABLE_INTERRUPTS();
   }
+  else
+  {
+    halSleepStats.skipped++;
+  }
 
 #ifdef DEBUG_GPIO
       // TEMP
@@ -467,6 +532,109 @@ void halSleep( uint32 osal_timeout )
 }
 
 
+/*******************************************************************************
+ * @fn          halSleepRecordWake
+ *
+ * @brief       Count a PM2/PM3 sleep by wake reason and slept time. Called
+ *              right after wake with interrupts disabled, so the flag of the
+ *              interrupt that woke the device has not been cleared yet.
+ *
+ * input parameters
+ *
+ * @param       sleepTimer - Sleep timer snapshot taken before sleep.
+ *
+ * output parameters
+ *
+ * @param       None.
+ *
+ * @return      None.
+ */
+static void halSleepRecordWake( uint32 sleepTimer )
+{
+  uint32 ms;
+  uint8 bin = 0;
+
+  halSleepStats.sleeps++;
+
+  if ( IRCON & 0x80 )
+  {
+    if ( wakeForRF == TRUE )
+    {
+      halSleepStats.wakeRF++;
+    }
+    else
+    {
+      halSleepStats.wakeTimer++;
+    }
+  }
+  else if ( P0IF || P1IF || P2IF )
+  {
+    halSleepStats.wakePort++;
+  }
+  else
+  {
+    // an ISR cleared halSleepPconValue before PCON was written
+    halSleepStats.wakeOther++;
+  }
+
+  if ( halPwrMgtMode == HAL_SLEEP_DEEP )
+  {
+    halSleepStats.deep++;
+    return;
+  }
+
+  // 24 bit sleep timer, about 32 ticks per ms
+  ms = ((halSleepReadTimer() - sleepTimer) & 0x00FFFFFF) >> 5;
+  while ( (ms >>= 1) && (bin < HAL_SLEEP_HIST_BINS - 1) )
+  {
+    bin++;
+  }
+  halSleepStats.hist[bin]++;
+}
+
+
+/*******************************************************************************
+ * @fn          halSleepGetStats
+ *
+ * @brief       Return the sleep statistics collected since the last reset.
+ *
+ * input parameters
+ *
+ * @param       None.
+ *
+ * output parameters
+ *
+ * @param       None.
+ *
+ * @return      Pointer to the statistics.
+ */
+const halSleepStats_t *halSleepGetStats( void )
+{
+  return( &halSleepStats );
+}
+
+
+/*******************************************************************************
+ * @fn          halSleepResetStats
+ *
+ * @brief       Clear the sleep statistics.
+ *
+ * input parameters
+ *
+ * @param       None.
+ *
+ * output parameters
+ *
+ * @param       None.
+ *
+ * @return      None.
+ */
+void halSleepResetStats( void )
+{
+  osal_memset( &halSleepStats, 0, sizeof( halSleepStats ) );
+}
+
+
 /*******************************************************************************
  * @fn          halSleepSetTimer
  *
@@ -55,6 +55,7 @@
 #include "OSAL_Tasks.h"
 #include "OSAL_Timers.h"
 #include "OSAL_PwrMgr.h"
+#include "hal_log.h"
 
 #ifdef USE_ICALL
 #include <ICall.h>
@@ -103,9 +104,20 @@ uint8 pwrmgr_initialized = FALSE;
  * LOCAL VARIABLES
  */
 
+/* Named holds: statistics, start of the current hold, and bit masks of the
+ * reasons currently held and already warned about.
+ */
+static pwrmgr_hold_stats_t pwrmgr_holds[PWRMGR_NUM_REASONS];
+static uint32 pwrmgr_hold_start[PWRMGR_NUM_REASONS];
+static uint8 pwrmgr_hold_reasons;
+static uint8 pwrmgr_hold_warned;
+
 /*********************************************************************
  * LOCAL FUNCTION PROTOTYPES
  */
+#if defined( POWER_SAVING ) && !(defined USE_ICALL || defined OSAL_PORT2TIRTOS)
+static void osal_pwrmgr_check_holds( void );
+#endif /* POWER_SAVING */
 
 /*********************************************************************
  * FUNCTIONS
@@ -225,6 +237,204 @@ uint8 osal_pwrmgr_task_state( uint8 task_id, uint8 state )
   return ( SUCCESS );
 }
 
+/*********************************************************************
+ * @fn      osal_pwrmgr_hold
+ *
+ * @brief   Hold the device awake for a named reason. Unlike the task
+ *          state, holds nest, so two users of one task cannot release
+ *          each other's hold.
+ *
+ * @param   reason - PWRMGR_REASON_*
+ *
+ * @return  SUCCESS, INVALIDPARAMETER or FAILURE if the nesting overflows
+ */
+uint8 osal_pwrmgr_hold( uint8 reason )
+{
+  halIntState_t intState;
+  pwrmgr_hold_stats_t *pHold;
+  uint8 status = SUCCESS;
+
+  if ( reason >= PWRMGR_NUM_REASONS )
+    return ( INVALIDPARAMETER );
+
+  pHold = &pwrmgr_holds[reason];
+
+  HAL_ENTER_CRITICAL_SECTION( intState );
+
+  if ( pHold->count == 0xFF )
+  {
+    status = FAILURE;
+  }
+  else if ( pHold->count++ == 0 )
+  {
+    pwrmgr_hold_start[reason] = osal_GetSystemClock();
+    pwrmgr_hold_reasons |= BV( reason );
+    pHold->holds++;
+  }
+
+  HAL_EXIT_CRITICAL_SECTION( intState );
+
+  return ( status );
+}
+
+/*********************************************************************
+ * @fn      osal_pwrmgr_release
+ *
+ * @brief   Release one hold of a named reason. The last release adds
+ *          the hold time to the reason's statistics.
+ *
+ * @param   reason - PWRMGR_REASON_*
+ *
+ * @return  SUCCESS, INVALIDPARAMETER or FAILURE if the reason isn't held
+ */
+uint8 osal_pwrmgr_release( uint8 reason )
+{
+  halIntState_t intState;
+  pwrmgr_hold_stats_t *pHold;
+  uint32 held;
+  uint8 status = SUCCESS;
+
+  if ( reason >= PWRMGR_NUM_REASONS )
+    return ( INVALIDPARAMETER );
+
+  pHold = &pwrmgr_holds[reason];
+
+  HAL_ENTER_CRITICAL_SECTION( intState );
+
+  if ( pHold->count == 0 )
+  {
+    status = FAILURE;
+  }
+  else if ( --pHold->count == 0 )
+  {
+    held = osal_GetSystemClock() - pwrmgr_hold_start[reason];
+    pHold->total += held;
+    if ( held > pHold->longest )
+    {
+      pHold->longest = held;
+    }
+    pwrmgr_hold_reasons &= ~BV( reason );
+    pwrmgr_hold_warned &= ~BV( reason );
+  }
+
+  HAL_EXIT_CRITICAL_SECTION( intState );
+
+  return ( status );
+}
+
+/*********************************************************************
+ * @fn      osal_pwrmgr_hold_stats
+ *
+ * @brief   Copy the hold statistics of one reason, counting a hold
+ *          still in progress up to now.
+ *
+ * @param   reason - PWRMGR_REASON_*
+ *          pStats - where to copy the statistics
+ *
+ * @return  SUCCESS or INVALIDPARAMETER
+ */
+uint8 osal_pwrmgr_hold_stats( uint8 reason, pwrmgr_hold_stats_t *pStats )
+{
+  halIntState_t intState;
+  uint32 held;
+
+  if ( reason >= PWRMGR_NUM_REASONS )
+    return ( INVALIDPARAMETER );
+
+  HAL_ENTER_CRITICAL_SECTION( intState );
+
+  *pStats = pwrmgr_holds[reason];
+  if ( pStats->count )
+  {
+    held = osal_GetSystemClock() - pwrmgr_hold_start[reason];
+    pStats->total += held;
+    if ( held > pStats->longest )
+    {
+      pStats->longest = held;
+    }
+  }
+
+  HAL_EXIT_CRITICAL_SECTION( intState );
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      osal_pwrmgr_reset_stats
+ *
+ * @brief   Clear the hold statistics. Outstanding holds stay held and
+ *          are timed from now.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void osal_pwrmgr_reset_stats( void )
+{
+  halIntState_t intState;
+  uint32 now;
+  uint8 reason;
+
+  HAL_ENTER_CRITICAL_SECTION( intState );
+
+  now = osal_GetSystemClock();
+  for ( reason = 0; reason < PWRMGR_NUM_REASONS; reason++ )
+  {
+    pwrmgr_holds[reason].holds = 0;
+    pwrmgr_holds[reason].overruns = 0;
+    pwrmgr_holds[reason].total = 0;
+    pwrmgr_holds[reason].longest = 0;
+    pwrmgr_hold_start[reason] = now;
+  }
+  pwrmgr_hold_warned = 0;
+
+  HAL_EXIT_CRITICAL_SECTION( intState );
+}
+
+#if defined( POWER_SAVING ) && !(defined USE_ICALL || defined OSAL_PORT2TIRTOS)
+/*********************************************************************
+ * @fn      osal_pwrmgr_check_holds
+ *
+ * @brief   Count and log, once per hold, any named hold that has lasted
+ *          longer than PWRMGR_HOLD_WARN_TIME. A hold that is never
+ *          released keeps the device out of sleep for good.
+ *
+ * @param   none.
+ *
+ * @return  none.
+ */
+static void osal_pwrmgr_check_holds( void )
+{
+  uint8 reason;
+  uint32 held;
+
+  for ( reason = 0; reason < PWRMGR_NUM_REASONS; reason++ )
+  {
+    if ( (pwrmgr_hold_reasons & ~pwrmgr_hold_warned) & BV( reason ) )
+    {
+      held = osal_GetSystemClock() - pwrmgr_hold_start[reason];
+      if ( held > PWRMGR_HOLD_WARN_TIME )
+      {
+        pwrmgr_hold_warned |= BV( reason );
+        pwrmgr_holds[reason].overruns++;
+
+#if (defined HAL_LOG) && (HAL_LOG == TRUE) && (HAL_LOG_LEVEL >= HAL_LOG_LEVEL_WARN)
+        {
+          uint8 args[3];
+          uint16 secs = (uint16)(held / 1000);
+
+          args[0] = reason;
+          args[1] = LO_UINT16( secs );
+          args[2] = HI_UINT16( secs );
+          HAL_LOG_WARN( HAL_LOG_ID_PWRMGR_HOLD, args, 3 );
+        }
+#endif
+      }
+    }
+  }
+}
+#endif /* POWER_SAVING */
+
 #if defined( POWER_SAVING ) && !(defined USE_ICALL || defined OSAL_PORT2TIRTOS)
 /*********************************************************************
  * @fn      osal_pwrmgr_powerconserve
@@ -244,8 +454,8 @@ void osal_pwrmgr_powerconserve( void )
   // Should we even look into power conservation
   if ( pwrmgr_attribute.pwrmgr_device != PWRMGR_ALWAYS_ON )
   {
-    // Are all tasks in agreement to conserve
-    if ( pwrmgr_attribute.pwrmgr_task_state == 0 )
+    // Are all tasks in agreement to conserve, with no named hold
+    if ( (pwrmgr_attribute.pwrmgr_task_state == 0) && (pwrmgr_hold_reasons == 0) )
     {
       // Hold off interrupts.
       HAL_ENTER_CRITICAL_SECTION( intState );
@@ -259,6 +469,10 @@ void osal_pwrmgr_powerconserve( void )
       // Put the processor into sleep mode
       OSAL_SET_CPU_INTO_SLEEP( next );
     }
+    else if ( pwrmgr_hold_reasons )
+    {
+      osal_pwrmgr_check_holds();
+    }
   }
 }
 #endif /* POWER_SAVING */
@@ -78,6 +78,18 @@ typedef struct
 #endif /* !defined USE_ICALL && !defined OSAL_PORT2TIRTOS */
 } pwrmgr_attribute_t;
 
+/* Hold statistics of one reason since the last osal_pwrmgr_reset_stats().
+ * Counters wrap; times are in ms and include a hold still in progress.
+ */
+typedef struct
+{
+  uint8  count;     /* holds outstanding (nesting depth) */
+  uint16 holds;     /* times the reason went from released to held */
+  uint16 overruns;  /* holds that lasted longer than PWRMGR_HOLD_WARN_TIME */
+  uint32 total;     /* cumulative time held */
+  uint32 longest;   /* longest single hold */
+} pwrmgr_hold_stats_t;
+
 /* With PWRMGR_ALWAYS_ON selection, there is no power savings and the
  * device is most likely on mains power. The PWRMGR_BATTERY selection allows
  * the HAL sleep manager to enter SLEEP LITE state or SLEEP DEEP state.
@@ -91,6 +103,19 @@ typedef struct
 #define PWRMGR_CONSERVE 0
 #define PWRMGR_HOLD     1
 
+/* Named reasons for osal_pwrmgr_hold(). Holds nest per reason; the device
+ * conserves power again once every hold of every reason is released. At
+ * most 8 reasons; only append, tools/diag_decode.py reads this list.
+ */
+#define PWRMGR_REASON_LED_PWM     0   /* LED timers stop in PM2/PM3 */
+#define PWRMGR_REASON_UART        1   /* UART DMA ready-in handshake */
+#define PWRMGR_NUM_REASONS        2
+
+/* A hold lasting longer than this (ms) is counted and logged once */
+#if !defined PWRMGR_HOLD_WARN_TIME
+#define PWRMGR_HOLD_WARN_TIME     30000
+#endif
+
 
 /*********************************************************************
  * GLOBAL VARIABLES
@@ -133,6 +158,24 @@ extern pwrmgr_attribute_t pwrmgr_attribute;
    */
   extern void osal_pwrmgr_device( uint8 pwrmgr_device );
 
+  /*
+   * Hold the device awake for a named reason (PWRMGR_REASON_*). Holds nest:
+   * every osal_pwrmgr_hold() needs one osal_pwrmgr_release() of the same
+   * reason. Both may be called from an ISR.
+   */
+  extern uint8 osal_pwrmgr_hold( uint8 reason );
+  extern uint8 osal_pwrmgr_release( uint8 reason );
+
+  /*
+   * Copy the hold statistics of one reason.
+   */
+  extern uint8 osal_pwrmgr_hold_stats( uint8 reason, pwrmgr_hold_stats_t *pStats );
+
+  /*
+   * Clear the hold statistics; outstanding holds stay held.
+   */
+  extern void osal_pwrmgr_reset_stats( void );
+
   /*
    * This function is called from the main OSAL loop when there are
    * no events scheduled and shouldn't be called from anywhere else.
@@ -233,12 +233,33 @@ extern "C"
 #define GATT_PARAM_NUM_PREPARE_WRITES    0 // RW  uint8
 
 // To make the size of the pointer type be platform/compiler independent
-#define PTR_TYPE                         unsigned int *
+#if !defined( PTR_TYPE )
+  #define PTR_TYPE                       unsigned int *
+#endif
 
 // GATT local read or write operation
 #define GATT_LOCAL_READ                  0xFF
 #define GATT_LOCAL_WRITE                 0xFE
-  
+
+// Notifications held for retry when the link layer has no TX buffer left.
+// One entry per connection and characteristic; a later update of a queued
+// characteristic is coalesced into it.
+#if !defined( GATT_NOTI_QUEUE_SIZE )
+  #define GATT_NOTI_QUEUE_SIZE           4
+#endif
+
+// Client Characteristic Configuration tables handed out by
+// GATTServApp_AllocCharCfg(): one per notifying characteristic across all
+// services (Button Notif, SFIDA Commands, Battery Level and the two OAD
+// characteristics), each with one entry per connection the stack supports.
+#if !defined( GATT_CCC_POOL_SIZE )
+  #define GATT_CCC_POOL_SIZE             5
+#endif
+
+#if !defined( GATT_CCC_POOL_CONNS )
+  #define GATT_CCC_POOL_CONNS            1
+#endif
+
 /*********************************************************************
  * VARIABLES
  */
@@ -250,6 +271,10 @@ extern "C"
 // The number of attribute records in a given attribute table
 #define GATT_NUM_ATTRS( attrs )          ( sizeof( attrs ) / sizeof( gattAttribute_t ) )
 
+// Position of an attribute record within its attribute table; profile
+// callbacks switch on it instead of comparing attribute UUIDs
+#define GATT_ATTR_IDX( attrs, pAttr )    ( (uint8)( (pAttr) - (attrs) ) )
+
 // The handle of a service is the handle of the first attribute
 #define GATT_SERVICE_HANDLE( attrs )     ( (attrs)[0].handle )
 
@@ -630,6 +655,56 @@ extern bStatus_t GATTServApp_ProcessCharCfg( gattCharCfg_t *charCfgTbl, uint8 *p
                                         uint16 numAttrs, uint8 taskId,
                                         pfnGATTReadAttrCB_t pfnReadAttrCB );
 
+/**
+ * @brief   Process Client Charateristic Configuration change for a known
+ *          characteristic value attribute, without searching the table.
+ *
+ * @param   charCfgTbl - characteristic configuration table.
+ * @param   pAttr - characteristic value attribute record.
+ * @param   authenticated - whether an authenticated link is required.
+ * @param   taskId - task to be notified of confirmation.
+ * @param   pfnReadAttrCB - read callback function pointer.
+ *
+ * @return  Success or Failure
+ */
+extern bStatus_t GATTServApp_ProcessCharCfgAttr( gattCharCfg_t *charCfgTbl, gattAttribute_t *pAttr,
+                                            uint8 authenticated, uint8 taskId,
+                                            pfnGATTReadAttrCB_t pfnReadAttrCB );
+
+/**
+ * @brief   Take a Client Characteristic Configuration table from the
+ *          static pool and initialize it. Tables are never returned; a
+ *          service takes its tables once, when it is added.
+ *
+ * @return  Pointer to the table. NULL if the pool is used up or the stack
+ *          supports more connections than GATT_CCC_POOL_CONNS.
+ */
+extern gattCharCfg_t *GATTServApp_AllocCharCfg( void );
+
+/**
+ * @brief   Enable the notification retry queue. A notification that
+ *          GATTServApp_ProcessCharCfg() cannot send for lack of buffers is
+ *          queued, and the end of each connection event on that link sets
+ *          the given task event, on which the task calls
+ *          GATTServApp_ProcessNotiQueue(). Without this call a failed
+ *          notification is dropped.
+ *
+ * @param   taskId - task to receive the retry event
+ * @param   event - task event to set
+ *
+ * @return  none
+ */
+extern void GATTServApp_InitNotiQueue( uint8 taskId, uint16 event );
+
+/**
+ * @brief   Send the queued notifications, oldest first, until the link
+ *          runs out of buffers again. Entries of closed links or of clients
+ *          that turned notifications off are dropped.
+ *
+ * @return  none
+ */
+extern void GATTServApp_ProcessNotiQueue( void );
+
 /**
  * @brief   Build and send the GATT_CLIENT_CHAR_CFG_UPDATED_EVENT to
  *          the application.
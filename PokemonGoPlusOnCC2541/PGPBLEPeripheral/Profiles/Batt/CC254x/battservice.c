@@ -50,6 +50,7 @@
  */
 #include "bcomdef.h"
 #include "OSAL.h"
+#include "osal_snv.h"
 #include "hal_adc.h"
 #include "linkdb.h"
 #include "att.h"
@@ -69,12 +70,23 @@
  * CONSTANTS
  */
 
-// ADC voltage levels
-#define BATT_ADC_LEVEL_3V           409
-#define BATT_ADC_LEVEL_2V           273
+// Oversampling: BATT_ADC_SAMPLES 10-bit conversions are summed and the sum
+// is shifted right by BATT_ADC_EXTRA_BITS, giving a 12-bit result. Each extra
+// bit needs 4x the samples; the ADC's own noise provides the dither.
+#define BATT_ADC_SAMPLES            16
+#define BATT_ADC_EXTRA_BITS         2
+
+// Largest decimated ADC code (511 is full scale for a 10-bit reading)
+#define BATT_ADC_MAX_CODE           (511 << BATT_ADC_EXTRA_BITS)
+
+// Minimum change in percent before a new level is reported
+#ifndef BATT_LEVEL_HYSTERESIS
+#define BATT_LEVEL_HYSTERESIS       3
+#endif
 
 #define BATT_LEVEL_VALUE_IDX        2 // Position of battery level in attribute array
 #define BATT_LEVEL_VALUE_CCCD_IDX   3 // Position of battery level CCCD in attribute array
+#define BATT_LEVEL_REPORT_REF_IDX   4 // Position of battery level report reference in attribute array
 
 #define BATT_LEVEL_VALUE_LEN        1
 
@@ -87,6 +99,13 @@
  * TYPEDEFS
  */
 
+// One point of the discharge curve
+typedef struct
+{
+  uint16 mV;
+  uint8 percent;
+} battCurvePoint_t;
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -126,8 +145,27 @@ static battServiceTeardownCB_t battServiceTeardownCB = NULL;
 // Measurement calculation callback
 static battServiceCalcCB_t battServiceCalcCB = NULL;
 
-static uint16 battMinLevel = BATT_ADC_LEVEL_2V; // For VDD/3 measurements
-static uint16 battMaxLevel = BATT_ADC_LEVEL_3V; // For VDD/3 measurements
+// Battery voltage at full ADC scale
+static uint16 battFullScale = BATT_FULL_SCALE_VDD;
+
+// Per-device calibration, loaded from SNV
+static battCal_t battCal = { BATT_CAL_GAIN_UNITY, 0 };
+
+// Last calibrated battery voltage in mV
+static uint16 battVoltage;
+
+// CR2032 lithium coin cell discharge curve under pulsed BLE load, highest
+// voltage first. The cell reads near 3.0V when fresh, delivers over half its
+// capacity above 2.9V and is spent at 2.0V, the CC2541's minimum supply.
+// The level is interpolated linearly between points.
+static CONST battCurvePoint_t battCurve[] =
+{
+  { 3000, 100 },
+  { 2900,  42 },
+  { 2740,  18 },
+  { 2440,   6 },
+  { 2000,   0 }
+};
 
 // Critical battery level setting
 static uint8 battCriticalLevel;
@@ -228,6 +266,7 @@ static bStatus_t battWriteAttrCB( uint16 connHandle, gattAttribute_t *pAttr,
 
 static void battNotifyCB( linkDBItem_t *pLinkItem );
 static uint8 battMeasure( void );
+static uint8 battCurveLookup( uint16 mV );
 static void battNotifyLevel( void );
 
 /*********************************************************************
@@ -257,16 +296,20 @@ bStatus_t Batt_AddService( void )
 {
   uint8 status;
 
-  // Allocate Client Characteristic Configuration table
-  battLevelClientCharCfg = (gattCharCfg_t *)osal_mem_alloc( sizeof ( gattCharCfg_t ) * 
-                                                            linkDBNumConns );
+  // Allocate and initialize the Client Characteristic Configuration table
+  battLevelClientCharCfg = GATTServApp_AllocCharCfg();
   if ( battLevelClientCharCfg == NULL )
   {
     return ( bleMemAllocError );
   }
-  
-  // Initialize Client Characteristic Configuration attributes
-  GATTServApp_InitCharCfg( INVALID_CONNHANDLE, battLevelClientCharCfg );
+
+  // Load the calibration, keeping unity gain if the device was never calibrated
+  if ( osal_snv_read( BATT_NVID_CAL, sizeof ( battCal_t ), &battCal ) != SUCCESS ||
+       battCal.gain == 0 )
+  {
+    battCal.gain = BATT_CAL_GAIN_UNITY;
+    battCal.offset = 0;
+  }
 
   // Register GATT attribute list and CBs with GATT Server App
   status = GATTServApp_RegisterService( battAttrTbl,
@@ -321,6 +364,18 @@ bStatus_t Batt_SetParameter( uint8 param, uint8 len, void *value )
       }
       break;
 
+    case BATT_PARAM_CALIBRATION:
+      if ( len == sizeof ( battCal_t ) && ((battCal_t *)value)->gain != 0 )
+      {
+        battCal = *((battCal_t *)value);
+        ret = osal_snv_write( BATT_NVID_CAL, sizeof ( battCal_t ), &battCal );
+      }
+      else
+      {
+        ret = bleInvalidRange;
+      }
+      break;
+
     default:
       ret = INVALIDPARAMETER;
       break;
@@ -359,6 +414,14 @@ bStatus_t Batt_GetParameter( uint8 param, void *value )
       *((uint16*)value) = GATT_SERVICE_HANDLE( battAttrTbl );
       break;
 
+    case BATT_PARAM_CALIBRATION:
+      *((battCal_t*)value) = battCal;
+      break;
+
+    case BATT_PARAM_VOLTAGE:
+      *((uint16*)value) = battVoltage;
+      break;
+
     case BATT_PARAM_BATT_LEVEL_IN_REPORT:
       {
         hidRptMap_t *pRpt = (hidRptMap_t *)value;
@@ -385,9 +448,10 @@ bStatus_t Batt_GetParameter( uint8 param, void *value )
  * @brief       Measure the battery level and update the battery
  *              level value in the service characteristics.  If
  *              the battery level-state characteristic is configured
- *              for notification and the battery level has changed
- *              since the last measurement, then a notification
- *              will be sent.
+ *              for notification and the battery level has moved
+ *              by at least BATT_LEVEL_HYSTERESIS since the last
+ *              notification, or crossed the critical level, then
+ *              a notification will be sent.
  *
  * @return      Success
  */
@@ -397,8 +461,12 @@ bStatus_t Batt_MeasLevel( void )
 
   level = battMeasure();
 
-  // If level has gone down
-  if (level < battLevel)
+  // Ignore noise around the reported level, but always report an empty
+  // battery and every crossing of the critical level
+  if ( ( level + BATT_LEVEL_HYSTERESIS <= battLevel ) ||
+       ( level >= battLevel + BATT_LEVEL_HYSTERESIS ) ||
+       ( level == 0 && battLevel != 0 ) ||
+       ( ( level < battCriticalLevel ) != ( battLevel < battCriticalLevel ) ) )
   {
     // Update level
     battLevel = level;
@@ -416,21 +484,20 @@ bStatus_t Batt_MeasLevel( void )
  * @brief   Set up which ADC source is to be used. Defaults to VDD/3.
  *
  * @param   adc_ch - ADC Channel, e.g. HAL_ADC_CHN_AIN6
- * @param   minVal - max battery level
- * @param   maxVal - min battery level
+ * @param   fullScale - battery voltage in mV at full ADC scale
  * @param   sCB - HW setup callback
  * @param   tCB - HW tear down callback
- * @param   cCB - percentage calculation callback
+ * @param   cCB - percentage calculation callback, NULL for the
+ *                built-in CR2032 coin cell curve
  *
  * @return  none.
  */
-void Batt_Setup( uint8 adc_ch, uint16 minVal, uint16 maxVal,
+void Batt_Setup( uint8 adc_ch, uint16 fullScale,
                  battServiceSetupCB_t sCB, battServiceTeardownCB_t tCB,
                  battServiceCalcCB_t cCB )
 {
   battServiceAdcCh = adc_ch;
-  battMinLevel = minVal;
-  battMaxLevel = maxVal;
+  battFullScale = fullScale;
 
   battServiceSetupCB = sCB;
   battServiceTeardownCB = tCB;
@@ -463,33 +530,35 @@ static bStatus_t battReadAttrCB( uint16 connHandle, gattAttribute_t *pAttr,
     return ( ATT_ERR_ATTR_NOT_LONG );
   }
 
-  uint16 uuid = BUILD_UINT16( pAttr->type.uuid[0], pAttr->type.uuid[1] );
-
-  // Measure battery level if reading level
-  if ( uuid == BATT_LEVEL_UUID )
+  switch ( GATT_ATTR_IDX( battAttrTbl, pAttr ) )
   {
-    uint8 level;
+    // Measure battery level if reading level
+    case BATT_LEVEL_VALUE_IDX:
+      {
+        uint8 level;
 
-    level = battMeasure();
+        level = battMeasure();
 
-    // If level has gone down
-    if (level < battLevel)
-    {
-      // Update level
-      battLevel = level;
-    }
+        // If level has gone down
+        if (level < battLevel)
+        {
+          // Update level
+          battLevel = level;
+        }
 
-    *pLen = 1;
-    pValue[0] = battLevel;
-  }
-  else if ( uuid == GATT_REPORT_REF_UUID )
-  {
-    *pLen = HID_REPORT_REF_LEN;
-    osal_memcpy( pValue, pAttr->pValue, HID_REPORT_REF_LEN );
-  }
-  else
-  {
-    status = ATT_ERR_ATTR_NOT_FOUND;
+        *pLen = 1;
+        pValue[0] = battLevel;
+      }
+      break;
+
+    case BATT_LEVEL_REPORT_REF_IDX:
+      *pLen = HID_REPORT_REF_LEN;
+      osal_memcpy( pValue, pAttr->pValue, HID_REPORT_REF_LEN );
+      break;
+
+    default:
+      status = ATT_ERR_ATTR_NOT_FOUND;
+      break;
   }
 
   return ( status );
@@ -515,10 +584,9 @@ static bStatus_t battWriteAttrCB( uint16 connHandle, gattAttribute_t *pAttr,
 {
   bStatus_t status = SUCCESS;
 
-  uint16 uuid = BUILD_UINT16( pAttr->type.uuid[0], pAttr->type.uuid[1]);
-  switch ( uuid )
+  switch ( GATT_ATTR_IDX( battAttrTbl, pAttr ) )
   {
-    case GATT_CLIENT_CHAR_CFG_UUID:
+    case BATT_LEVEL_VALUE_CCCD_IDX:
       status = GATTServApp_ProcessCCCWriteReq( connHandle, pAttr, pValue, len,
                                                offset, GATT_CLIENT_CFG_NOTIFY );
       if ( status == SUCCESS )
@@ -585,44 +653,17 @@ static void battNotifyCB( linkDBItem_t *pLinkItem )
  * @brief   Measure the battery level with the ADC and return
  *          it as a percentage 0-100%.
  *
+ *          The ADC is oversampled and decimated to 12 bits,
+ *          scaled to mV, corrected with the per-device
+ *          calibration and mapped through the discharge curve.
+ *
  * @return  Battery level.
  */
 static uint8 battMeasure( void )
 {
-  uint16 adc;
-  uint8 percent;
-
-  /**
-   * Battery level conversion from ADC to a percentage:
-   *
-   * The maximum ADC value for the battery voltage level is 511 for a
-   * 10-bit conversion.  The ADC value is references vs. 1.25v and
-   * this maximum value corresponds to a voltage of 3.75v.
-   *
-   * For a coin cell battery 3.0v = 100%.  The minimum operating
-   * voltage of the CC2540 is 2.0v so 2.0v = 0%.
-   *
-   * To convert a voltage to an ADC value use:
-   *
-   *   (v/3)/1.25 * 511 = adc
-   *
-   * 3.0v = 409 ADC
-   * 2.0v = 273 ADC
-   *
-   * We need to map ADC values from 409-273 to 100%-0%.
-   *
-   * Normalize the ADC values to zero:
-   *
-   * 409 - 273 = 136
-   *
-   * And convert ADC range to percentage range:
-   *
-   * percent/adc = 100/136 = 25/34
-   *
-   * Resulting in the final equation, with round:
-   *
-   * percent = ((adc - 273) * 25) + 33 / 34
-   */
+  uint16 sum = 0;
+  uint32 mV;
+  uint8 i;
 
   // Call measurement setup callback
   if (battServiceSetupCB != NULL)
@@ -630,9 +671,12 @@ static uint8 battMeasure( void )
     battServiceSetupCB();
   }
 
-  // Configure ADC and perform a read
+  // Configure ADC and sum the conversions; 16 x 511 fits in 16 bits
   HalAdcSetReference( HAL_ADC_REF_125V );
-  adc = HalAdcRead( battServiceAdcCh, HAL_ADC_RESOLUTION_10 );
+  for ( i = 0; i < BATT_ADC_SAMPLES; i++ )
+  {
+    sum += HalAdcRead( battServiceAdcCh, HAL_ADC_RESOLUTION_10 );
+  }
 
   // Call measurement teardown callback
   if (battServiceTeardownCB != NULL)
@@ -640,33 +684,67 @@ static uint8 battMeasure( void )
     battServiceTeardownCB();
   }
 
-  if (adc >= battMaxLevel)
+  // Decimate and scale to mV, rounding to nearest
+  sum >>= BATT_ADC_EXTRA_BITS;
+  mV = ( (uint32)sum * battFullScale + ( BATT_ADC_MAX_CODE / 2 ) ) / BATT_ADC_MAX_CODE;
+
+  // Apply the calibration, clamping at 0 mV
+  mV = ( mV * battCal.gain ) >> 14;
+  if ( battCal.offset < 0 && mV < (uint16)( -battCal.offset ) )
   {
-    percent = 100;
+    mV = 0;
   }
-  else if (adc <= battMinLevel)
+  else
   {
-    percent = 0;
+    mV += battCal.offset;
   }
-  else
+
+  battVoltage = ( mV > 0xFFFF ) ? 0xFFFF : (uint16)mV;
+
+  if (battServiceCalcCB != NULL)
   {
-    if (battServiceCalcCB != NULL)
-    {
-      percent = battServiceCalcCB(adc);
-    }
-    else
-    {
-      uint16 range =  battMaxLevel - battMinLevel + 1;
+    return battServiceCalcCB( battVoltage );
+  }
+
+  return battCurveLookup( battVoltage );
+}
 
-      // optional if you want to keep it even, otherwise just take floor of divide
-      // range += (range & 1);
-      range >>= 2; // divide by 4
+/*********************************************************************
+ * @fn      battCurveLookup
+ *
+ * @brief   Map a battery voltage to a level by linear interpolation
+ *          between the points of the discharge curve.
+ *
+ * @param   mV - calibrated battery voltage
+ *
+ * @return  Battery level 0-100%.
+ */
+static uint8 battCurveLookup( uint16 mV )
+{
+  const battCurvePoint_t *pHi = battCurve;
+  const battCurvePoint_t *pLo;
+  uint8 i;
+
+  if ( mV >= pHi->mV )
+  {
+    return pHi->percent;
+  }
+
+  for ( i = 1; i < sizeof ( battCurve ) / sizeof ( battCurve[0] ); i++ )
+  {
+    pLo = &battCurve[i];
+    if ( mV >= pLo->mV )
+    {
+      uint16 span = pHi->mV - pLo->mV;
 
-      percent = (uint8) ((((adc - battMinLevel) * 25) + (range - 1)) / range);
+      return pLo->percent +
+             (uint8)( ( (uint16)( mV - pLo->mV ) * ( pHi->percent - pLo->percent ) +
+                        ( span / 2 ) ) / span );
     }
+    pHi = pLo;
   }
 
-  return percent;
+  return 0;
 }
 
 /*********************************************************************
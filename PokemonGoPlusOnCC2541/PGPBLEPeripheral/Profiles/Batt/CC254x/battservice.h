@@ -66,6 +66,8 @@ extern "C"
 #define BATT_PARAM_CRITICAL_LEVEL       1
 #define BATT_PARAM_SERVICE_HANDLE       2
 #define BATT_PARAM_BATT_LEVEL_IN_REPORT 3
+#define BATT_PARAM_CALIBRATION          4  // battCal_t, stored in SNV on write
+#define BATT_PARAM_VOLTAGE              5  // uint16, last calibrated reading in mV
 
 // Callback events
 #define BATT_LEVEL_NOTI_ENABLED         1
@@ -74,6 +76,15 @@ extern "C"
 // HID Report IDs for the service
 #define HID_RPT_ID_BATT_LEVEL_IN        4  // Battery Level input report ID
 
+// SNV item holding the per-device calibration
+#define BATT_NVID_CAL                   BLE_NVID_CUST_START
+
+// Calibration gain of exactly 1.0 (Q14)
+#define BATT_CAL_GAIN_UNITY             0x4000
+
+// ADC full scale of the VDD/3 channel against the 1.25V reference, in mV
+#define BATT_FULL_SCALE_VDD             3750
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -84,12 +95,20 @@ typedef void (*battServiceCB_t)(uint8 event);
 // Battery measure HW setup function
 typedef void (*battServiceSetupCB_t)(void);
 
-// Battery measure percentage calculation function
-typedef uint8 (*battServiceCalcCB_t)(uint16 adcVal);
+// Battery measure percentage calculation function, called with the
+// calibrated battery voltage in mV
+typedef uint8 (*battServiceCalcCB_t)(uint16 mV);
 
 // Battery measure HW teardown function
 typedef void (*battServiceTeardownCB_t)(void);
 
+// Per-device calibration: mV = (raw mV * gain >> 14) + offset
+typedef struct
+{
+  uint16 gain;    // Q14, BATT_CAL_GAIN_UNITY = 1.0
+  int16 offset;   // mV
+} battCal_t;
+
 /*********************************************************************
  * MACROS
  */
@@ -161,9 +180,9 @@ extern bStatus_t Batt_GetParameter( uint8 param, void *value );
  * @brief       Measure the battery level and update the battery
  *              level value in the service characteristics.  If
  *              the battery level-state characteristic is configured
- *              for notification and the battery level has changed
- *              since the last measurement, then a notification
- *              will be sent.
+ *              for notification and the battery level has moved
+ *              by at least BATT_LEVEL_HYSTERESIS since the last
+ *              notification, then a notification will be sent.
  *
  * @return      Success or Failure
  */
@@ -175,15 +194,16 @@ extern bStatus_t Batt_MeasLevel( void );
  * @brief   Set up which ADC source is to be used. Defaults to VDD/3.
  *
  * @param   adc_ch - ADC Channel, e.g. HAL_ADC_CHN_AIN6
- * @param   minVal - max battery level
- * @param   maxVal - min battery level
+ * @param   fullScale - battery voltage in mV at full ADC scale, e.g.
+ *                      BATT_FULL_SCALE_VDD or 1250 / divider ratio
  * @param   sCB - HW setup callback
  * @param   tCB - HW tear down callback
- * @param   cCB - percentage calculation callback
+ * @param   cCB - percentage calculation callback, NULL for the
+ *                built-in CR2032 coin cell curve
  *
  * @return  none.
  */
-extern void Batt_Setup( uint8 adc_ch, uint16 minVal, uint16 maxVal,
+extern void Batt_Setup( uint8 adc_ch, uint16 fullScale,
                         battServiceSetupCB_t sCB, battServiceTeardownCB_t tCB,
                         battServiceCalcCB_t cCB );
 
@@ -0,0 +1,269 @@
+/**************************************************************************************************
+  Filename:       diagservice.c
+
+  Description:    Diagnostics service exposing the sleep statistics collected by the HAL
+                  and the power manager hold statistics collected by OSAL. Anyone can read
+                  them; clearing them takes an authenticated link. The application only
+                  adds the service in builds with FEATURE_DIAG.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "bcomdef.h"
+#include "OSAL.h"
+#include "OSAL_PwrMgr.h"
+#include "hal_sleep.h"
+#include "linkdb.h"
+#include "att.h"
+#include "gatt.h"
+#include "gatt_uuid.h"
+#include "gattservapp.h"
+
+#include "diagservice.h"
+
+/*********************************************************************
+ * MACROS
+ */
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+/*********************************************************************
+ * EXTERNAL VARIABLES
+ */
+
+/*********************************************************************
+ * EXTERNAL FUNCTIONS
+ */
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Snapshots taken by a read at offset 0, so the Read Blob requests that
+// follow return one consistent set of counters
+static uint8 diagSleepStats[DIAG_SLEEP_STATS_LEN];
+static uint8 diagPowerHolds[DIAG_POWER_HOLDS_LEN];
+
+/*********************************************************************
+ * Profile Attributes - Table
+ */
+
+// UUIDs, properties, descriptions and the attribute table, generated from
+// diagservice.gatt by tools/gatt_gen.py
+#include "diagservice_attrs.h"
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+static bStatus_t diagReadAttrCB( uint16 connHandle, gattAttribute_t *pAttr,
+                                 uint8 *pValue, uint8 *pLen, uint16 offset,
+                                 uint8 maxLen, uint8 method );
+static bStatus_t diagWriteAttrCB( uint16 connHandle, gattAttribute_t *pAttr,
+                                  uint8 *pValue, uint8 len, uint16 offset,
+                                  uint8 method );
+static void diagSnapshotSleepStats( void );
+static void diagSnapshotPowerHolds( void );
+
+/*********************************************************************
+ * PROFILE CALLBACKS
+ */
+// Diagnostics Service Callbacks
+CONST gattServiceCBs_t diagCBs =
+{
+  diagReadAttrCB,  // Read callback function pointer
+  diagWriteAttrCB, // Write callback function pointer
+  NULL             // Authorization callback function pointer
+};
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      Diag_AddService
+ *
+ * @brief   Initializes the diagnostics service by registering
+ *          GATT attributes with the GATT server.
+ *
+ * @return  Success or Failure
+ */
+bStatus_t Diag_AddService( void )
+{
+  // Register GATT attribute list and CBs with GATT Server App
+  return GATTServApp_RegisterService( diagAttrTbl,
+                                      GATT_NUM_ATTRS( diagAttrTbl ),
+                                      GATT_MAX_ENCRYPT_KEY_SIZE,
+                                      &diagCBs );
+}
+
+/*********************************************************************
+ * @fn          diagReadAttrCB
+ *
+ * @brief       Read an attribute. The statistics are longer than the
+ *              default MTU, so Read Blob continues from the snapshot that
+ *              the first read (offset 0) took.
+ *
+ * @param       connHandle - connection message was received on
+ * @param       pAttr - pointer to attribute
+ * @param       pValue - pointer to data to be read
+ * @param       pLen - length of data to be read
+ * @param       offset - offset of the first octet to be read
+ * @param       maxLen - maximum length of data to be read
+ * @param       method - type of read message
+ *
+ * @return      SUCCESS, blePending or Failure
+ */
+static bStatus_t diagReadAttrCB( uint16 connHandle, gattAttribute_t *pAttr,
+                                 uint8 *pValue, uint8 *pLen, uint16 offset,
+                                 uint8 maxLen, uint8 method )
+{
+  uint8 len;
+
+  switch ( GATT_ATTR_IDX( diagAttrTbl, pAttr ) )
+  {
+    case DIAG_SLEEP_STATS_VALUE_IDX:
+      len = DIAG_SLEEP_STATS_LEN;
+      if ( offset == 0 )
+      {
+        diagSnapshotSleepStats();
+      }
+      break;
+
+    case DIAG_POWER_HOLDS_VALUE_IDX:
+      len = DIAG_POWER_HOLDS_LEN;
+      if ( offset == 0 )
+      {
+        diagSnapshotPowerHolds();
+      }
+      break;
+
+    default:
+      return ( ATT_ERR_ATTR_NOT_FOUND );
+  }
+
+  if ( offset > len )
+  {
+    return ( ATT_ERR_INVALID_OFFSET );
+  }
+
+  *pLen = MIN( maxLen, len - offset );
+  osal_memcpy( pValue, pAttr->pValue + offset, *pLen );
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      diagWriteAttrCB
+ *
+ * @brief   Validate attribute data prior to a write operation. Any write to
+ *          a statistics characteristic clears those statistics; the
+ *          GATT server only lets it through on an authenticated link.
+ *
+ * @param   connHandle - connection message was received on
+ * @param   pAttr - pointer to attribute
+ * @param   pValue - pointer to data to be written
+ * @param   len - length of data
+ * @param   offset - offset of the first octet to be written
+ * @param   method - type of write message
+ *
+ * @return  SUCCESS, blePending or Failure
+ */
+static bStatus_t diagWriteAttrCB( uint16 connHandle, gattAttribute_t *pAttr,
+                                  uint8 *pValue, uint8 len, uint16 offset,
+                                  uint8 method )
+{
+  if ( offset > 0 )
+  {
+    return ( ATT_ERR_ATTR_NOT_LONG );
+  }
+
+  switch ( GATT_ATTR_IDX( diagAttrTbl, pAttr ) )
+  {
+    case DIAG_SLEEP_STATS_VALUE_IDX:
+      halSleepResetStats();
+      break;
+
+    case DIAG_POWER_HOLDS_VALUE_IDX:
+      osal_pwrmgr_reset_stats();
+      break;
+
+    default:
+      return ( ATT_ERR_ATTR_NOT_FOUND );
+  }
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      diagSnapshotSleepStats
+ *
+ * @brief   Serialize the sleep statistics, little-endian.
+ *
+ * @return  none
+ */
+static void diagSnapshotSleepStats( void )
+{
+  const uint16 *pCount = (const uint16 *)halSleepGetStats();
+  uint8 *p = diagSleepStats;
+  uint8 i;
+
+  *p++ = DIAG_SLEEP_STATS_VERSION;
+  *p++ = HAL_SLEEP_HIST_BINS;
+
+  for ( i = 0; i < sizeof( halSleepStats_t ) / sizeof( uint16 ); i++ )
+  {
+    *p++ = LO_UINT16( pCount[i] );
+    *p++ = HI_UINT16( pCount[i] );
+  }
+}
+
+/*********************************************************************
+ * @fn      diagSnapshotPowerHolds
+ *
+ * @brief   Serialize the power manager hold statistics, little-endian.
+ *
+ * @return  none
+ */
+static void diagSnapshotPowerHolds( void )
+{
+  pwrmgr_hold_stats_t stats;
+  uint8 *p = diagPowerHolds;
+  uint8 reason;
+
+  *p++ = DIAG_POWER_HOLDS_VERSION;
+  *p++ = PWRMGR_NUM_REASONS;
+
+  for ( reason = 0; reason < PWRMGR_NUM_REASONS; reason++ )
+  {
+    (void)osal_pwrmgr_hold_stats( reason, &stats );
+
+    *p++ = stats.count;
+    *p++ = LO_UINT16( stats.holds );
+    *p++ = HI_UINT16( stats.holds );
+    *p++ = LO_UINT16( stats.overruns );
+    *p++ = HI_UINT16( stats.overruns );
+    *p++ = BREAK_UINT32( stats.total, 0 );
+    *p++ = BREAK_UINT32( stats.total, 1 );
+    *p++ = BREAK_UINT32( stats.total, 2 );
+    *p++ = BREAK_UINT32( stats.total, 3 );
+    *p++ = BREAK_UINT32( stats.longest, 0 );
+    *p++ = BREAK_UINT32( stats.longest, 1 );
+    *p++ = BREAK_UINT32( stats.longest, 2 );
+    *p++ = BREAK_UINT32( stats.longest, 3 );
+  }
+}
+
+
+/*********************************************************************
+*********************************************************************/
@@ -0,0 +1,77 @@
+/**************************************************************************************************
+  Filename:       diagservice.h
+
+  Description:    Diagnostics service definitions and prototypes.
+**************************************************************************************************/
+
+#ifndef DIAGSERVICE_H
+#define DIAGSERVICE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "hal_sleep.h"
+#include "OSAL_PwrMgr.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Diagnostics service and characteristic UUIDs, on the TI 128-bit base
+#define DIAG_SERV_UUID                0xFFD0
+#define DIAG_SLEEP_STATS_UUID         0xFFD1
+#define DIAG_POWER_HOLDS_UUID         0xFFD2
+
+// Sleep Stats value: version, number of histogram bins, then every
+// halSleepStats_t field as a little-endian uint16 in declaration order.
+// Writing any value over an authenticated link clears the statistics.
+#define DIAG_SLEEP_STATS_VERSION      1
+#define DIAG_SLEEP_STATS_LEN          (2 + sizeof( halSleepStats_t ))
+
+// Power Holds value: version, number of reasons, then for every
+// PWRMGR_REASON_* in order: count (1 byte), holds and overruns (2 bytes),
+// total and longest hold in ms (4 bytes), all little-endian.
+// Writing any value over an authenticated link clears the statistics.
+#define DIAG_POWER_HOLDS_VERSION      1
+#define DIAG_POWER_HOLD_LEN           13
+#define DIAG_POWER_HOLDS_LEN          (2 + PWRMGR_NUM_REASONS * DIAG_POWER_HOLD_LEN)
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/*********************************************************************
+ * MACROS
+ */
+
+/*********************************************************************
+ * Profile Callbacks
+ */
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+/*********************************************************************
+ * @fn      Diag_AddService
+ *
+ * @brief   Initializes the diagnostics service by registering
+ *          GATT attributes with the GATT server.
+ *
+ * @return  Success or Failure
+ */
+extern bStatus_t Diag_AddService( void );
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DIAGSERVICE_H */
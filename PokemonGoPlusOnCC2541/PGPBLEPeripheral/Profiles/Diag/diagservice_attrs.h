@@ -0,0 +1,101 @@
+/**************************************************************************************************
+  Filename:       diagservice_attrs.h
+
+  Description:    Attribute table of the Diagnostics service, included once by
+                  diagservice.c after the characteristic values it points to.
+
+                  Generated by tools/gatt_gen.py from diagservice.gatt - do not edit.
+**************************************************************************************************/
+#ifndef DIAGSERVICE_ATTRS_H
+#define DIAGSERVICE_ATTRS_H
+
+/* Positions in diagAttrTbl */
+#define DIAG_SLEEP_STATS_VALUE_IDX       2
+#define DIAG_POWER_HOLDS_VALUE_IDX       5
+
+/* Service and characteristic UUIDs */
+CONST uint8 diagServUUID[ATT_UUID_SIZE] =
+{
+  TI_BASE_UUID_128( DIAG_SERV_UUID )
+};
+
+CONST uint8 diagSleepStatsUUID[ATT_UUID_SIZE] =
+{
+  TI_BASE_UUID_128( DIAG_SLEEP_STATS_UUID )
+};
+
+CONST uint8 diagPowerHoldsUUID[ATT_UUID_SIZE] =
+{
+  TI_BASE_UUID_128( DIAG_POWER_HOLDS_UUID )
+};
+
+static CONST gattAttrType_t diagService = { ATT_UUID_SIZE, diagServUUID };
+
+/* Sleep Stats */
+static CONST uint8 diagSleepStatsProps = GATT_PROP_READ | GATT_PROP_WRITE;
+static CONST uint8 diagSleepStatsUserDesp[] = "Sleep Stats";
+
+/* Power Holds */
+static CONST uint8 diagPowerHoldsProps = GATT_PROP_READ | GATT_PROP_WRITE;
+static CONST uint8 diagPowerHoldsUserDesp[] = "Power Holds";
+
+static gattAttribute_t diagAttrTbl[] =
+{
+  /* Diagnostics Service */
+  {
+    { ATT_BT_UUID_SIZE, primaryServiceUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)&diagService
+  },
+
+  /* Sleep Stats Declaration */
+  {
+    { ATT_BT_UUID_SIZE, characterUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)&diagSleepStatsProps
+  },
+
+  /* Sleep Stats Value */
+  {
+    { ATT_UUID_SIZE, diagSleepStatsUUID },
+    GATT_PERMIT_READ | GATT_PERMIT_AUTHEN_WRITE,
+    0,
+    diagSleepStats
+  },
+
+  /* Sleep Stats User Description */
+  {
+    { ATT_BT_UUID_SIZE, charUserDescUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)diagSleepStatsUserDesp
+  },
+
+  /* Power Holds Declaration */
+  {
+    { ATT_BT_UUID_SIZE, characterUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)&diagPowerHoldsProps
+  },
+
+  /* Power Holds Value */
+  {
+    { ATT_UUID_SIZE, diagPowerHoldsUUID },
+    GATT_PERMIT_READ | GATT_PERMIT_AUTHEN_WRITE,
+    0,
+    diagPowerHolds
+  },
+
+  /* Power Holds User Description */
+  {
+    { ATT_BT_UUID_SIZE, charUserDescUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)diagPowerHoldsUserDesp
+  }
+};
+
+#endif
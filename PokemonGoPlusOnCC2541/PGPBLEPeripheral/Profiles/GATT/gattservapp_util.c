@@ -49,7 +49,9 @@
  * INCLUDES
  */
 #include "bcomdef.h"
+#include "OSAL.h"
 #include "linkdb.h"
+#include "hci.h"
 
 #include "gatt.h"
 #include "gattservapp.h"
@@ -58,6 +60,11 @@
  * MACROS
  */
 
+// The link is out of buffers for now; the notification can be retried
+#define GATT_NOTI_RETRY( status )  ( ( (status) == MSG_BUFFER_NOT_AVAIL ) || \
+                                     ( (status) == bleMemAllocError )     || \
+                                     ( (status) == bleNoResources ) )
+
 /*********************************************************************
  * CONSTANTS
  */
@@ -66,6 +73,16 @@
  * TYPEDEFS
  */
 
+// Queued notification; the value is read when it is finally sent
+typedef struct
+{
+  uint16 connHandle;
+  gattCharCfg_t *charCfgTbl;
+  gattAttribute_t *pAttr;
+  pfnGATTReadAttrCB_t pfnReadAttrCB;
+  uint8 authenticated;
+} gattServAppNoti_t;
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -82,6 +99,18 @@
  * LOCAL VARIABLES
  */
 
+// Client Characteristic Configuration tables, handed out in order
+static gattCharCfg_t gattServApp_CharCfgPool[GATT_CCC_POOL_SIZE][GATT_CCC_POOL_CONNS];
+static uint8 gattServApp_CharCfgUsed = 0;
+
+// Notification retry queue, oldest first
+static gattServAppNoti_t gattServApp_NotiQueue[GATT_NOTI_QUEUE_SIZE];
+static uint8 gattServApp_NotiCount = 0;
+
+// Task and event set at the end of each connection event while queued
+static uint8 gattServApp_NotiTaskId = INVALID_TASK_ID;
+static uint16 gattServApp_NotiEvent = 0;
+
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
@@ -91,6 +120,10 @@ static gattCharCfg_t *gattServApp_FindCharCfgItem( uint16 connHandle,
 static bStatus_t gattServApp_SendNotiInd( uint16 connHandle, uint8 cccValue,
                                           uint8 authenticated, gattAttribute_t *pAttr,
                                           uint8 taskId, pfnGATTReadAttrCB_t pfnReadAttrCB );
+static uint8 gattServApp_NotiQueued( uint16 connHandle );
+static bStatus_t gattServApp_QueueNoti( uint16 connHandle, gattCharCfg_t *charCfgTbl,
+                                        uint8 authenticated, gattAttribute_t *pAttr,
+                                        pfnGATTReadAttrCB_t pfnReadAttrCB );
 
 /*********************************************************************
  * API FUNCTIONS
@@ -134,6 +167,33 @@ void GATTServApp_InitCharCfg( uint16 connHandle, gattCharCfg_t *charCfgTbl )
   }
 }
 
+/*********************************************************************
+ * @fn      GATTServApp_AllocCharCfg
+ *
+ * @brief   Take a client characteristic configuration table from the
+ *          static pool and initialize it. The stack reads the tables
+ *          through GATT_CCC_TBL(), so each one keeps the gattCharCfg_t
+ *          layout with an entry per connection.
+ *
+ * @return  Pointer to the table. NULL if the pool is used up or the stack
+ *          supports more connections than GATT_CCC_POOL_CONNS.
+ */
+gattCharCfg_t *GATTServApp_AllocCharCfg( void )
+{
+  gattCharCfg_t *charCfgTbl;
+
+  if ( ( gattServApp_CharCfgUsed == GATT_CCC_POOL_SIZE ) ||
+       ( linkDBNumConns > GATT_CCC_POOL_CONNS ) )
+  {
+    return ( (gattCharCfg_t *)NULL );
+  }
+
+  charCfgTbl = gattServApp_CharCfgPool[gattServApp_CharCfgUsed++];
+  GATTServApp_InitCharCfg( INVALID_CONNHANDLE, charCfgTbl );
+
+  return ( charCfgTbl );
+}
+
 /*********************************************************************
  * @fn      GATTServApp_ProcessCharCfg
  *
@@ -154,8 +214,7 @@ bStatus_t GATTServApp_ProcessCharCfg( gattCharCfg_t *charCfgTbl, uint8 *pValue,
                                       uint16 numAttrs, uint8 taskId,
                                       pfnGATTReadAttrCB_t pfnReadAttrCB )
 {
-  uint8 i;
-  bStatus_t status = SUCCESS;
+  gattAttribute_t *pAttr;
 
   // Verify input parameters
   if ( ( charCfgTbl == NULL ) || ( pValue == NULL ) ||
@@ -163,7 +222,46 @@ bStatus_t GATTServApp_ProcessCharCfg( gattCharCfg_t *charCfgTbl, uint8 *pValue,
   {
     return ( INVALIDPARAMETER );
   }
-  
+
+  // Find the characteristic value attribute, once for all clients
+  pAttr = GATTServApp_FindAttr( attrTbl, numAttrs, pValue );
+  if ( pAttr == NULL )
+  {
+    return ( SUCCESS );
+  }
+
+  return ( GATTServApp_ProcessCharCfgAttr( charCfgTbl, pAttr, authenticated,
+                                           taskId, pfnReadAttrCB ) );
+}
+
+/*********************************************************************
+ * @fn      GATTServApp_ProcessCharCfgAttr
+ *
+ * @brief   Process Client Charateristic Configuration change for a
+ *          characteristic value attribute the caller already holds,
+ *          typically &attrTbl[<VALUE>_IDX]; no table search is made.
+ *
+ * @param   charCfgTbl - characteristic configuration table.
+ * @param   pAttr - characteristic value attribute record.
+ * @param   authenticated - whether an authenticated link is required.
+ * @param   taskId - task to be notified of confirmation.
+ * @param   pfnReadAttrCB - read callback function pointer.
+ *
+ * @return  Success or Failure
+ */
+bStatus_t GATTServApp_ProcessCharCfgAttr( gattCharCfg_t *charCfgTbl, gattAttribute_t *pAttr,
+                                          uint8 authenticated, uint8 taskId,
+                                          pfnGATTReadAttrCB_t pfnReadAttrCB )
+{
+  uint8 i;
+  bStatus_t status = SUCCESS;
+
+  // Verify input parameters
+  if ( ( charCfgTbl == NULL ) || ( pAttr == NULL ) || ( pfnReadAttrCB == NULL ) )
+  {
+    return ( INVALIDPARAMETER );
+  }
+
   for ( i = 0; i < linkDBNumConns; i++ )
   {
     gattCharCfg_t *pItem = &(charCfgTbl[i]);
@@ -171,23 +269,35 @@ bStatus_t GATTServApp_ProcessCharCfg( gattCharCfg_t *charCfgTbl, uint8 *pValue,
     if ( ( pItem->connHandle != INVALID_CONNHANDLE ) &&
          ( pItem->value != GATT_CFG_NO_OPERATION ) )
     {
-      gattAttribute_t *pAttr;
-
-      // Find the characteristic value attribute
-      pAttr = GATTServApp_FindAttr( attrTbl, numAttrs, pValue );
-      if ( pAttr != NULL )
+      if ( pItem->value & GATT_CLIENT_CFG_NOTIFY )
       {
-        if ( pItem->value & GATT_CLIENT_CFG_NOTIFY )
+        bStatus_t notiStatus;
+
+        // Updates queued earlier on this link go out first
+        if ( gattServApp_NotiQueued( pItem->connHandle ) )
         {
-           status |= gattServApp_SendNotiInd( pItem->connHandle, GATT_CLIENT_CFG_NOTIFY, 
-                                              authenticated, pAttr, taskId, pfnReadAttrCB );
+          notiStatus = gattServApp_QueueNoti( pItem->connHandle, charCfgTbl, authenticated,
+                                              pAttr, pfnReadAttrCB );
         }
-        
-        if ( pItem->value & GATT_CLIENT_CFG_INDICATE )
+        else
         {
-           status |= gattServApp_SendNotiInd( pItem->connHandle, GATT_CLIENT_CFG_INDICATE, 
-                                              authenticated, pAttr, taskId, pfnReadAttrCB );
+          notiStatus = gattServApp_SendNotiInd( pItem->connHandle, GATT_CLIENT_CFG_NOTIFY,
+                                                authenticated, pAttr, taskId, pfnReadAttrCB );
+          if ( GATT_NOTI_RETRY( notiStatus ) &&
+               ( gattServApp_QueueNoti( pItem->connHandle, charCfgTbl, authenticated,
+                                        pAttr, pfnReadAttrCB ) == SUCCESS ) )
+          {
+            notiStatus = SUCCESS;
+          }
         }
+
+        status |= notiStatus;
+      }
+
+      if ( pItem->value & GATT_CLIENT_CFG_INDICATE )
+      {
+         status |= gattServApp_SendNotiInd( pItem->connHandle, GATT_CLIENT_CFG_INDICATE, 
+                                            authenticated, pAttr, taskId, pfnReadAttrCB );
       }
     }
   } // for
@@ -195,6 +305,89 @@ bStatus_t GATTServApp_ProcessCharCfg( gattCharCfg_t *charCfgTbl, uint8 *pValue,
   return ( status );
 }
 
+/*********************************************************************
+ * @fn      GATTServApp_InitNotiQueue
+ *
+ * @brief   Enable the notification retry queue. A notification that
+ *          cannot be sent for lack of buffers is queued and retried when
+ *          the task receives the given event, set at the end of each
+ *          connection event on that link.
+ *
+ * @param   taskId - task to receive the retry event
+ * @param   event - task event to set
+ *
+ * @return  none
+ */
+void GATTServApp_InitNotiQueue( uint8 taskId, uint16 event )
+{
+  gattServApp_NotiTaskId = taskId;
+  gattServApp_NotiEvent = event;
+  gattServApp_NotiCount = 0;
+}
+
+/*********************************************************************
+ * @fn      GATTServApp_ProcessNotiQueue
+ *
+ * @brief   Send the queued notifications, oldest first. An entry the link
+ *          still has no buffer for stays queued, and so do the entries
+ *          behind it on the same link. Entries of closed links or of
+ *          clients that turned notifications off are dropped.
+ *
+ * @return  none
+ */
+void GATTServApp_ProcessNotiQueue( void )
+{
+  uint16 done[GATT_NOTI_QUEUE_SIZE];
+  uint8 numDone = 0;
+  uint8 kept = 0;
+  uint8 i, j;
+
+  for ( i = 0; i < gattServApp_NotiCount; i++ )
+  {
+    gattServAppNoti_t *pNoti = &(gattServApp_NotiQueue[i]);
+    bStatus_t status = SUCCESS;
+
+    for ( j = 0; j < kept; j++ )
+    {
+      if ( gattServApp_NotiQueue[j].connHandle == pNoti->connHandle )
+      {
+        // An older entry on this link is still waiting
+        status = MSG_BUFFER_NOT_AVAIL;
+        break;
+      }
+    }
+
+    if ( ( status == SUCCESS ) && linkDB_Up( pNoti->connHandle ) &&
+         ( GATTServApp_ReadCharCfg( pNoti->connHandle, pNoti->charCfgTbl ) &
+           GATT_CLIENT_CFG_NOTIFY ) )
+    {
+      status = gattServApp_SendNotiInd( pNoti->connHandle, GATT_CLIENT_CFG_NOTIFY,
+                                        pNoti->authenticated, pNoti->pAttr,
+                                        INVALID_TASK_ID, pNoti->pfnReadAttrCB );
+    }
+
+    if ( GATT_NOTI_RETRY( status ) )
+    {
+      gattServApp_NotiQueue[kept++] = *pNoti;
+    }
+    else
+    {
+      done[numDone++] = pNoti->connHandle;
+    }
+  }
+
+  gattServApp_NotiCount = kept;
+
+  // Links with nothing left to send no longer need the connection event notice
+  for ( i = 0; i < numDone; i++ )
+  {
+    if ( !gattServApp_NotiQueued( done[i] ) && linkDB_Up( done[i] ) )
+    {
+      (void)HCI_EXT_ConnEventNoticeCmd( done[i], gattServApp_NotiTaskId, 0 );
+    }
+  }
+}
+
 /*********************************************************************
  * @fn          GATTServApp_FindAttr
  *
@@ -437,6 +630,87 @@ static bStatus_t gattServApp_SendNotiInd( uint16 connHandle, uint8 cccValue,
   return ( status );
 }
 
+/*********************************************************************
+ * @fn      gattServApp_NotiQueued
+ *
+ * @brief   Check whether notifications are queued for a link.
+ *
+ * @param   connHandle - connection handle.
+ *
+ * @return  TRUE if at least one is queued, FALSE otherwise
+ */
+static uint8 gattServApp_NotiQueued( uint16 connHandle )
+{
+  uint8 i;
+
+  for ( i = 0; i < gattServApp_NotiCount; i++ )
+  {
+    if ( gattServApp_NotiQueue[i].connHandle == connHandle )
+    {
+      return ( TRUE );
+    }
+  }
+
+  return ( FALSE );
+}
+
+/*********************************************************************
+ * @fn      gattServApp_QueueNoti
+ *
+ * @brief   Queue a notification for retry after the next connection
+ *          event. A characteristic already queued for the link is not
+ *          queued again: its value is read when it is sent, so the latest
+ *          update wins.
+ *
+ * @param   connHandle - connection handle.
+ * @param   charCfgTbl - characteristic configuration table.
+ * @param   authenticated - whether an authenticated link is required.
+ * @param   pAttr - characteristic value attribute record.
+ * @param   pfnReadAttrCB - read callback function pointer.
+ *
+ * @return  SUCCESS, or bleNoResources if the queue is full or disabled
+ */
+static bStatus_t gattServApp_QueueNoti( uint16 connHandle, gattCharCfg_t *charCfgTbl,
+                                        uint8 authenticated, gattAttribute_t *pAttr,
+                                        pfnGATTReadAttrCB_t pfnReadAttrCB )
+{
+  gattServAppNoti_t *pNoti;
+  uint8 i;
+
+  if ( gattServApp_NotiTaskId == INVALID_TASK_ID )
+  {
+    return ( bleNoResources );
+  }
+
+  for ( i = 0; i < gattServApp_NotiCount; i++ )
+  {
+    if ( ( gattServApp_NotiQueue[i].connHandle == connHandle ) &&
+         ( gattServApp_NotiQueue[i].pAttr == pAttr ) )
+    {
+      // Coalesced
+      return ( SUCCESS );
+    }
+  }
+
+  if ( gattServApp_NotiCount == GATT_NOTI_QUEUE_SIZE )
+  {
+    return ( bleNoResources );
+  }
+
+  pNoti = &(gattServApp_NotiQueue[gattServApp_NotiCount++]);
+  pNoti->connHandle = connHandle;
+  pNoti->charCfgTbl = charCfgTbl;
+  pNoti->pAttr = pAttr;
+  pNoti->pfnReadAttrCB = pfnReadAttrCB;
+  pNoti->authenticated = authenticated;
+
+  // Retry at the end of the next connection event on this link
+  (void)HCI_EXT_ConnEventNoticeCmd( connHandle, gattServApp_NotiTaskId,
+                                    gattServApp_NotiEvent );
+
+  return ( SUCCESS );
+}
+
 
 /****************************************************************************
 ****************************************************************************/
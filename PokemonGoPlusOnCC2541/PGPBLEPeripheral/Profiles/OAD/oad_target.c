@@ -73,6 +73,9 @@
 
 #define OAD_FLASH_PAGE_MULT  ((uint16)(HAL_FLASH_PAGE_SIZE / HAL_FLASH_WORD_SIZE))
 
+#define OAD_IMG_IDENTIFY_VALUE_IDX  2 // Position of image identify value in attribute array
+#define OAD_IMG_BLOCK_VALUE_IDX     6 // Position of image block value in attribute array
+
 #if defined (FEATURE_OAD_SECURE) && defined (HAL_IMAGE_A)
   // Enabled to ONLY build a BOOTSTRAP Encrypted Image-A (for programming over
   // BEM, not BIM). Comment line below to build a non-bootstrap Encrypted Image-A.
@@ -252,6 +255,9 @@ static const __code aes_hdr_t _aesHdr = {
 
 static uint16 oadBlkNum = 0, oadBlkTot = 0xFFFF;
 
+// Application write callback
+static oadTargetWriteCB_t oadTargetWriteCB = NULL;
+
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
@@ -294,34 +300,32 @@ static uint8 checkDL(void);
  */
 bStatus_t OADTarget_AddService(void)
 {
-  // Allocate Client Characteristic Configuration table
-  oadImgIdentifyConfig = (gattCharCfg_t *)osal_mem_alloc( sizeof(gattCharCfg_t) *
-                                                          linkDBNumConns);
-  if (oadImgIdentifyConfig == NULL)
-  {
-    return ( bleMemAllocError );
-  }
-  
-  // Allocate Client Characteristic Configuration table
-  oadImgBlockConfig = (gattCharCfg_t *)osal_mem_alloc( sizeof(gattCharCfg_t) *
-                                                       linkDBNumConns);
-  
-  if (oadImgBlockConfig == NULL)
+  // Allocate and initialize the Client Characteristic Configuration tables
+  oadImgIdentifyConfig = GATTServApp_AllocCharCfg();
+  oadImgBlockConfig = GATTServApp_AllocCharCfg();
+  if ( (oadImgIdentifyConfig == NULL) || (oadImgBlockConfig == NULL) )
   {
-    // Free already allocated data
-    osal_mem_free( oadImgIdentifyConfig );
-    
     return ( bleMemAllocError );
   }
-  
-  // Initialize Client Characteristic Configuration attributes
-  GATTServApp_InitCharCfg( INVALID_CONNHANDLE, oadImgIdentifyConfig );
-  GATTServApp_InitCharCfg( INVALID_CONNHANDLE, oadImgBlockConfig );
 
   return GATTServApp_RegisterService(oadAttrTbl, GATT_NUM_ATTRS(oadAttrTbl),
                                      GATT_MAX_ENCRYPT_KEY_SIZE, &oadCBs);
 }
 
+/*********************************************************************
+ * @fn      OADTarget_Register
+ *
+ * @brief   Register a callback for writes to the OAD service.
+ *
+ * @param   pfnWriteCB - callback, or NULL
+ *
+ * @return  none
+ */
+void OADTarget_Register( oadTargetWriteCB_t pfnWriteCB )
+{
+  oadTargetWriteCB = pfnWriteCB;
+}
+
 /*********************************************************************
  * @fn      oadReadAttrCB
  *
@@ -386,6 +390,11 @@ static bStatus_t oadWriteAttrCB(uint16 connHandle, gattAttribute_t *pAttr,
   }
   else
   {
+    if ( oadTargetWriteCB != NULL )
+    {
+      oadTargetWriteCB( connHandle );
+    }
+
     // 128-bit UUID
     if (osal_memcmp(pAttr->type.uuid, oadCharUUID[OAD_CHAR_IMG_IDENTIFY], ATT_UUID_SIZE))
     {
@@ -547,25 +556,20 @@ static void oadImgBlockReq(uint16 connHandle, uint16 blkNum)
   // If notifications enabled
   if ( value & GATT_CLIENT_CFG_NOTIFY )
   {
-    gattAttribute_t *pAttr = GATTServApp_FindAttr(oadAttrTbl, GATT_NUM_ATTRS(oadAttrTbl),
-                                                  oadCharVals+OAD_CHAR_IMG_BLOCK);
-    if ( pAttr != NULL )
+    attHandleValueNoti_t noti;
+    
+    noti.pValue = GATT_bm_alloc(connHandle, ATT_HANDLE_VALUE_NOTI,
+                                OAD_IMG_BLK_NUM_SIZE, NULL);
+    if ( noti.pValue != NULL )
     {
-      attHandleValueNoti_t noti;
-      
-      noti.pValue = GATT_bm_alloc(connHandle, ATT_HANDLE_VALUE_NOTI,
-                                  OAD_IMG_BLK_NUM_SIZE, NULL);
-      if ( noti.pValue != NULL )
-      {
-        noti.handle = pAttr->handle;
-        noti.len = OAD_IMG_BLK_NUM_SIZE;
-        noti.pValue[0] = LO_UINT16(blkNum);
-        noti.pValue[1] = HI_UINT16(blkNum);
+      noti.handle = oadAttrTbl[OAD_IMG_BLOCK_VALUE_IDX].handle;
+      noti.len = OAD_IMG_BLK_NUM_SIZE;
+      noti.pValue[0] = LO_UINT16(blkNum);
+      noti.pValue[1] = HI_UINT16(blkNum);
 
-        if ( GATT_Notification(connHandle, &noti, FALSE) != SUCCESS )
-        {
-          GATT_bm_free((gattMsg_t *)&noti, ATT_HANDLE_VALUE_NOTI);
-        }
+      if ( GATT_Notification(connHandle, &noti, FALSE) != SUCCESS )
+      {
+        GATT_bm_free((gattMsg_t *)&noti, ATT_HANDLE_VALUE_NOTI);
       }
     }
   }
@@ -588,30 +592,25 @@ static void oadImgIdentifyReq(uint16 connHandle, img_hdr_t *pImgHdr)
   // If notifications enabled
   if ( value & GATT_CLIENT_CFG_NOTIFY )
   {
-    gattAttribute_t *pAttr = GATTServApp_FindAttr(oadAttrTbl, GATT_NUM_ATTRS(oadAttrTbl),
-                                                  oadCharVals+OAD_CHAR_IMG_IDENTIFY);
-    if ( pAttr != NULL )
+    attHandleValueNoti_t noti;
+    
+    noti.pValue = GATT_bm_alloc(connHandle, ATT_HANDLE_VALUE_NOTI,
+                                OAD_IMG_HDR_SIZE, NULL);
+    if ( noti.pValue != NULL )
     {
-      attHandleValueNoti_t noti;
-      
-      noti.pValue = GATT_bm_alloc(connHandle, ATT_HANDLE_VALUE_NOTI,
-                                  OAD_IMG_HDR_SIZE, NULL);
-      if ( noti.pValue != NULL )
-      {
-        noti.handle = pAttr->handle;
-        noti.len = OAD_IMG_HDR_SIZE;
-        noti.pValue[0] = LO_UINT16(pImgHdr->ver);
-        noti.pValue[1] = HI_UINT16(pImgHdr->ver);
+      noti.handle = oadAttrTbl[OAD_IMG_IDENTIFY_VALUE_IDX].handle;
+      noti.len = OAD_IMG_HDR_SIZE;
+      noti.pValue[0] = LO_UINT16(pImgHdr->ver);
+      noti.pValue[1] = HI_UINT16(pImgHdr->ver);
 
-        noti.pValue[2] = LO_UINT16(pImgHdr->len);
-        noti.pValue[3] = HI_UINT16(pImgHdr->len);
+      noti.pValue[2] = LO_UINT16(pImgHdr->len);
+      noti.pValue[3] = HI_UINT16(pImgHdr->len);
 
-        (void)osal_memcpy(noti.pValue+4, pImgHdr->uid, sizeof(pImgHdr->uid));
+      (void)osal_memcpy(noti.pValue+4, pImgHdr->uid, sizeof(pImgHdr->uid));
 
-        if ( GATT_Notification(connHandle, &noti, FALSE) != SUCCESS )
-        {
-          GATT_bm_free((gattMsg_t *)&noti, ATT_HANDLE_VALUE_NOTI);
-        }
+      if ( GATT_Notification(connHandle, &noti, FALSE) != SUCCESS )
+      {
+        GATT_bm_free((gattMsg_t *)&noti, ATT_HANDLE_VALUE_NOTI);
       }
     }
   }
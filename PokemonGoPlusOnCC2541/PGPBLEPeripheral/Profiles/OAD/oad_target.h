@@ -105,6 +105,10 @@ extern const __code img_hdr_t _imgHdr;
  * TYPEDEFS
  */
 
+// Called on every write to an OAD characteristic, e.g. to keep the
+// connection fast while an image is being transferred
+typedef void (*oadTargetWriteCB_t)( uint16 connHandle );
+
 /*********************************************************************
  * @fn      OADTarget_AddService
  *
@@ -115,6 +119,17 @@ extern const __code img_hdr_t _imgHdr;
  */
 bStatus_t OADTarget_AddService( void );
 
+/*********************************************************************
+ * @fn      OADTarget_Register
+ *
+ * @brief   Register a callback for writes to the OAD service.
+ *
+ * @param   pfnWriteCB - callback, or NULL
+ *
+ * @return  none
+ */
+void OADTarget_Register( oadTargetWriteCB_t pfnWriteCB );
+
 /*********************************************************************
 *********************************************************************/
 
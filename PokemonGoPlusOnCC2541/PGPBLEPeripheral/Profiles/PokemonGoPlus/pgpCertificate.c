@@ -61,12 +61,9 @@
 #include "gapbondmgr.h"
 
 #include "pgpCertificate.h"
+#include "osal_cbtimer.h"
 
-#if (defined HAL_UART) && (HAL_UART == TRUE)
-#include <stdio.h>
-#include <stdlib.h>
-#include "hal_uart.h"
-#endif
+#include "hal_log.h"
 
 /*********************************************************************
  * MACROS
@@ -76,7 +73,11 @@
  * CONSTANTS
  */
 
-#define SERVAPP_NUM_ATTR_SUPPORTED        11
+// Log event IDs (see hal_log.h, range 0x60 - 0x7F)
+#define PGP_CERT_LOG_ID_READ              0x60  /* "pgpCertificate read handle: {x16}" */
+#define PGP_CERT_LOG_ID_WRITE             0x61  /* "pgpCertificate write handle: {x16} Off:{u16} Len:{u8}" */
+#define PGP_CERT_LOG_ID_WRITE_DATA        0x62  /* "  {hex}" */
+#define PGP_CERT_LOG_ID_WRITE_OK          0x63  /* "OK" */
 
 /*********************************************************************
  * TYPEDEFS
@@ -86,29 +87,6 @@
  * GLOBAL VARIABLES
  */
 
-// Certificate Service UUID: 0x8E37                      
-CONST uint8 certificateServUUID[ATT_UUID_SIZE] =         
-{              
-    CERTIFICATE_SERVICE_BASE_UUID_128(CERTIFICATE_SERV_UUID),             
-};             
-               
-// Central to SFIDA UUID: 0x8E38                      
-CONST uint8 centralToSfidaCharUUID[ATT_UUID_SIZE] =        
-{              
-    CERTIFICATE_SERVICE_BASE_UUID_128(CENTRAL_TO_SFIDA_CHAR_UUID),            
-};             
-// Sfida commands UUID: 0x8E39                      
-CONST uint8 sfidaCommandsCharUUID[ATT_UUID_SIZE] =        
-{              
-    CERTIFICATE_SERVICE_BASE_UUID_128(SFIDA_COMMANDS_CHAR_UUID),            
-};     
-// SFIDA to Central UUID: 0x8E3A                      
-CONST uint8 sfidaToCentralCharUUID[ATT_UUID_SIZE] =        
-{              
-    CERTIFICATE_SERVICE_BASE_UUID_128(SFIDA_TO_CENTRAL_CHAR_UUID),            
-};     
-
-
 /*********************************************************************
  * EXTERNAL VARIABLES
  */
@@ -123,144 +101,39 @@ CONST uint8 sfidaToCentralCharUUID[ATT_UUID_SIZE] =
 
 static pgpCertificateCBs_t *pgpCertificate_AppCBs = NULL;
 
+// Execute Write staging. The stack hands over a long write one fragment at a
+// time and stops at the first one refused, so the fragments are assembled
+// here and the characteristic takes the value once all have been accepted.
+static uint8 *pgpCertificate_ExecWriteChar = NULL;   // characteristic written, NULL if none
+static uint8 *pgpCertificate_ExecWriteCharLen;
+static uint8 pgpCertificate_ExecWriteParam;
+static bStatus_t pgpCertificate_ExecWriteStatus;
+static uint8 pgpCertificate_ExecWriteLen;
+static uint8 pgpCertificate_ExecWriteBuf[PGP_CERT_CHAR_MAX_LEN];
+
 /*********************************************************************
  * Profile Attributes - variables
  */
 
-// Certificate Service attribute                      
-static CONST gattAttrType_t pgpCertificateService = { ATT_UUID_SIZE, certificateServUUID};     
-//-------------------------------------------------------------------
-// Certificate Service Central to SFIDA Properties    
-static uint8 centralToSfidaCharProps = GATT_PROP_READ | GATT_PROP_WRITE;                       
-
 // Central to SFIDA Value
 static uint8 centralToSfidaCharLen = 0;
-static uint8 centralToSfidaChar[36] = {0};                    
-
-// Certificate Service Central to SFIDA User Description           
-static uint8 centralToSfidaCharUserDesp[] = "Central to Sfida\0";        
-
-//-------------------------------------------------------------------
-// Certificate Service Sfida commands Properties    
-static uint8 sfidaCommandsCharProps = GATT_PROP_READ | GATT_PROP_WRITE | GATT_PROP_NOTIFY;                       
+static uint8 centralToSfidaChar[PGP_CERT_CHAR_MAX_LEN] = {0};
 
 // Sfida commands Value
 static uint8 sfidaCommandsCharLen = 0;
-static uint8 sfidaCommandsChar[36] = {0};                   
-
-// Sfida commands Notif Configuration.                                       
-static gattCharCfg_t *sfidaCommandsCharConfig;        
-
-// Device Control Service Sfida commands User Description           
-static uint8 sfidaCommandsCharUserDesp[] = "Sfida commands\0";  
-
-//-------------------------------------------------------------------
-// Certificate Service SFIDA to Central Properties    
-static uint8 sfidaToCentralCharProps = GATT_PROP_READ | GATT_PROP_WRITE;                       
+static uint8 sfidaCommandsChar[PGP_CERT_CHAR_MAX_LEN] = {0};
 
 // SFIDA to Central Value
 static uint8 sfidaToCentralCharLen = 0;
-static uint8 sfidaToCentralChar[36] = {0};                   
-
-// Device Control Service SFIDA to Central User Description           
-static uint8 sfidaToCentralCharUserDesp[] = "Sfida to Central\0";  
+static uint8 sfidaToCentralChar[PGP_CERT_CHAR_MAX_LEN] = {0};
 
 /*********************************************************************
  * Profile Attributes - Table
  */
 
-static gattAttribute_t pgpCertificateAttrTbl[SERVAPP_NUM_ATTR_SUPPORTED] = 
-{
-  // Certificate Service
-  { 
-    { ATT_BT_UUID_SIZE, primaryServiceUUID }, /* type */
-    GATT_PERMIT_READ,                         /* permissions */
-    0,                                        /* handle */
-    (uint8 *)&pgpCertificateService           /* pValue */
-  },
-  
-    // Central to SFIDA Declaration                                 
-  {                                                               
-    { ATT_BT_UUID_SIZE, characterUUID },                          
-    GATT_PERMIT_READ,                                             
-    0,                                                            
-    &centralToSfidaCharProps                                           
-  },                                                              
-                                                                  
-  // Central to SFIDA Value                                    
-  {                                                               
-    { ATT_UUID_SIZE, centralToSfidaCharUUID },                         
-    GATT_PERMIT_READ | GATT_PERMIT_WRITE,                         
-    0,                                                            
-    centralToSfidaChar                                                
-  },                                                              
-                                                                  
-  // Central to SFIDA User Description                            
-  {                                                               
-    { ATT_BT_UUID_SIZE, charUserDescUUID },                       
-    GATT_PERMIT_READ,                                             
-    0,                                                            
-    centralToSfidaCharUserDesp                                         
-  },                                                              
-  
-  
-    // Sfida Commands Declaration                                 
-  {                                                               
-    { ATT_BT_UUID_SIZE, characterUUID },                          
-    GATT_PERMIT_READ,                                             
-    0,                                                            
-    &sfidaCommandsCharProps                                           
-  },                                                              
-                                                                  
-  // Sfida Commands Value                                    
-  {                                                               
-    { ATT_UUID_SIZE, sfidaCommandsCharUUID },                         
-    GATT_PERMIT_READ | GATT_PERMIT_WRITE,                         
-    0,                                                            
-    sfidaCommandsChar                                                
-  },                              
-  
-  // Sfida Commands configuration                               
-  {                                                               
-    { ATT_BT_UUID_SIZE, clientCharCfgUUID },                      
-    GATT_PERMIT_READ | GATT_PERMIT_WRITE,                         
-    0,                                                            
-    (uint8 *)&sfidaCommandsCharConfig                                 
-  },   
-                                                                  
-  // Sfida Commands User Description                            
-  {                                                               
-    { ATT_BT_UUID_SIZE, charUserDescUUID },                       
-    GATT_PERMIT_READ,                                             
-    0,                                                            
-    sfidaCommandsCharUserDesp                                         
-  },                                                              
-
-    
-  // SFIDA to Central,  Declaration                                 
-  {                                                               
-    { ATT_BT_UUID_SIZE, characterUUID },                          
-    GATT_PERMIT_READ,                                             
-    0,                                                            
-    &sfidaToCentralCharProps                                           
-  },                                                              
-                                                                  
-  // SFIDA to Central,  Value                                    
-  {                                                               
-    { ATT_UUID_SIZE, sfidaToCentralCharUUID },                         
-    GATT_PERMIT_READ | GATT_PERMIT_WRITE,                         
-    0,                                                            
-    sfidaToCentralChar                                                
-  },                                                              
-                                                                  
-  // SFIDA to Central,  User Description                            
-  {                                                               
-    { ATT_BT_UUID_SIZE, charUserDescUUID },                       
-    GATT_PERMIT_READ,                                             
-    0,                                                            
-    sfidaToCentralCharUserDesp                                         
-  },                                                                   
-};
+// UUIDs, properties, descriptions, CCC table and the attribute table,
+// generated from pgpCertificate.gatt by tools/gatt_gen.py
+#include "pgpCertificate_attrs.h"
 
 /*********************************************************************
  * LOCAL FUNCTIONS
@@ -271,6 +144,14 @@ static bStatus_t pgpCertificate_ReadAttrCB( uint16 connHandle, gattAttribute_t *
 static bStatus_t pgpCertificate_WriteAttrCB( uint16 connHandle, gattAttribute_t *pAttr,
      uint8 *pValue, uint8 len, uint16 offset,
      uint8 method );
+static bStatus_t pgpCertificate_ReadValue( uint8 *pBuf, uint8 bufLen, uint8 *pValue,
+                                           uint8 *pLen, uint16 offset, uint8 maxLen );
+static bStatus_t pgpCertificate_WriteValue( uint8 param, uint8 *pBuf, uint8 *pBufLen,
+                                            uint8 *pValue, uint8 len, uint16 offset,
+                                            uint8 method );
+static bStatus_t pgpCertificate_StoreValue( uint8 *pBuf, uint8 *pBufLen, uint8 *pValue,
+                                            uint8 len, uint16 offset );
+static void pgpCertificate_ExecWriteDoneCB( uint8 *pData );
 
 /*********************************************************************
  * PROFILE CALLBACKS
@@ -287,27 +168,6 @@ CONST gattServiceCBs_t pgpCertificateCBs =
  * PUBLIC FUNCTIONS
  */
 
-bStatus_t utilExtractUuid16Certificate(gattAttribute_t *pAttr, uint16 *pUuid)
-{
-  bStatus_t status = SUCCESS;
-
-  if (pAttr->type.len == ATT_BT_UUID_SIZE )
-  {
-    // 16-bit UUID direct
-    *pUuid = BUILD_UINT16( pAttr->type.uuid[0], pAttr->type.uuid[1]);
-  }
-  else if (pAttr->type.len == ATT_UUID_SIZE)
-  {
-    // 16-bit UUID extracted bytes 0 and 1 for this service
-    *pUuid = BUILD_UINT16( pAttr->type.uuid[0], pAttr->type.uuid[1]);
-  } else {
-    *pUuid = 0xFFFF;
-    status = FAILURE;
-  }
-
-  return status;
-}
-
 /*********************************************************************
  * @fn      PgpCertificate_AddService
  *
@@ -323,17 +183,13 @@ bStatus_t PgpCertificate_AddService( uint32 services )
 {
   uint8 status;
   
-  // Allocate Client Characteristic Configuration table
-  sfidaCommandsCharConfig = (gattCharCfg_t *)osal_mem_alloc( sizeof(gattCharCfg_t) *
-                                                              linkDBNumConns );
-  if ( sfidaCommandsCharConfig == NULL )
-  {     
-    return ( bleMemAllocError );
+  // Allocate and initialize the Client Characteristic Configuration table
+  status = pgpCertificateAllocCharCfg();
+  if ( status != SUCCESS )
+  {
+    return ( status );
   }
-  
-  // Initialize Client Characteristic Configuration attributes
-  GATTServApp_InitCharCfg( INVALID_CONNHANDLE, sfidaCommandsCharConfig );
-  
+
   // Register GATT attribute list and CBs with GATT Server App
   status = GATTServApp_RegisterService( pgpCertificateAttrTbl, 
                                           GATT_NUM_ATTRS( pgpCertificateAttrTbl ),
@@ -399,9 +255,9 @@ bStatus_t PgpCertificate_SetParameter( uint8 param, uint8 len, void *value )
         (void)memcpy(sfidaCommandsChar, value, len);
         sfidaCommandsCharLen=len;
         // See if Notification has been enabled                                               
-        GATTServApp_ProcessCharCfg( sfidaCommandsCharConfig, sfidaCommandsChar, FALSE,               
-                                    pgpCertificateAttrTbl, GATT_NUM_ATTRS( pgpCertificateAttrTbl ),       
-                                    INVALID_TASK_ID, pgpCertificate_ReadAttrCB );           
+        GATTServApp_ProcessCharCfgAttr( sfidaCommandsCharConfig,
+                                        &pgpCertificateAttrTbl[SFIDA_COMMANDS_VALUE_IDX], FALSE,
+                                        INVALID_TASK_ID, pgpCertificate_ReadAttrCB );
       }else{
         ret = bleInvalidRange;
       }
@@ -479,12 +335,7 @@ static bStatus_t pgpCertificate_ReadAttrCB( uint16 connHandle, gattAttribute_t *
     uint8 *pValue, uint8 *pLen, uint16 offset,
     uint8 maxLen, uint8 method )
 {
-  uint16 uuid;
   bStatus_t status = SUCCESS;
-  
-  #if (defined HAL_UART) && (HAL_UART == TRUE)
-    HalUARTWrite ( HAL_UART_PORT_1, "pgpCertificate_ReadAttrCB\n", 26 );
-  #endif
 
   // If attribute permissions require authorization to read, return error
   if ( gattPermitAuthorRead( pAttr->permissions ) )
@@ -493,49 +344,27 @@ static bStatus_t pgpCertificate_ReadAttrCB( uint16 connHandle, gattAttribute_t *
     return ( ATT_ERR_INSUFFICIENT_AUTHOR );
   }
   
-  // Make sure it's not a blob operation (no attributes in the profile are long)
-  if ( offset > 0 )
-  {
-    return ( ATT_ERR_ATTR_NOT_LONG );
-  }
- 
-  
-  if (utilExtractUuid16Certificate(pAttr,&uuid) == FAILURE) {                                      
-    // Invalid handle                                                                   
-    *pLen = 0;                                                                          
-    return ATT_ERR_INVALID_HANDLE;                                                      
-  }                                                                                     
-  
-  #if (defined HAL_UART) && (HAL_UART == TRUE)
+  HAL_LOG_DEBUG_U16( PGP_CERT_LOG_ID_READ, pAttr->handle );
+
+  switch ( GATT_ATTR_IDX( pgpCertificateAttrTbl, pAttr ) )
   {
-    char buf[32];
-    sprintf(buf,"UUID: %04X\n",uuid);
-    uint8 strLength=strlen(buf);
-    HalUARTWrite ( HAL_UART_PORT_1, (uint8 *)buf, strLength );
-  }
-  #endif
-  
-  switch ( uuid )                                                                       
-  {                                                                                     
-    // No need for "GATT_SERVICE_UUID" or "GATT_CLIENT_CHAR_CFG_UUID" cases;            
-    // gattserverapp handles those reads                                                
-                                                                                        
-    // characteristics 1 has read permissions                                           
-    // characteristic 2 does not have read permissions, but because it                  
-    //   can be sent as a notification, it is included here                             
-  case CENTRAL_TO_SFIDA_CHAR_UUID:
-    *pLen = centralToSfidaCharLen;
-    (void) memcpy(pValue, pAttr->pValue, *pLen);  
+    // No need for the service or client characteristic configuration cases;
+    // gattserverapp handles those reads
+
+    // sfida commands is also sent as a notification, so it is included here
+  case CENTRAL_TO_SFIDA_VALUE_IDX:
+    status = pgpCertificate_ReadValue( centralToSfidaChar, centralToSfidaCharLen,
+                                       pValue, pLen, offset, maxLen );
     break;
-  case SFIDA_COMMANDS_CHAR_UUID:
-    *pLen = sfidaCommandsCharLen;
-    (void) memcpy(pValue, pAttr->pValue, *pLen);  
+  case SFIDA_COMMANDS_VALUE_IDX:
+    status = pgpCertificate_ReadValue( sfidaCommandsChar, sfidaCommandsCharLen,
+                                       pValue, pLen, offset, maxLen );
     break;
-  case SFIDA_TO_CENTRAL_CHAR_UUID:
-    *pLen = sfidaToCentralCharLen;
-    (void) memcpy(pValue, pAttr->pValue, *pLen);  
-    break;    
-                                                                                        
+  case SFIDA_TO_CENTRAL_VALUE_IDX:
+    status = pgpCertificate_ReadValue( sfidaToCentralChar, sfidaToCentralCharLen,
+                                       pValue, pLen, offset, maxLen );
+    break;
+
   default:                                                                              
     // Should never get here! (characteristics 3 and 4 do not have read permissions)    
     *pLen = 0;                                                                          
@@ -565,11 +394,7 @@ static bStatus_t pgpCertificate_WriteAttrCB( uint16 connHandle, gattAttribute_t
 {
   bStatus_t status = SUCCESS;
   uint8 notifyApp = 0xFF;
-  uint16 uuid; 
-  
-  #if (defined HAL_UART) && (HAL_UART == TRUE)
-    HalUARTWrite ( HAL_UART_PORT_1, "pgpCertificate_WriteAttrCB\n", 26 );
-  #endif
+  uint8 idx = GATT_ATTR_IDX( pgpCertificateAttrTbl, pAttr );
   
   // If attribute permissions require authorization to write, return error
   if ( gattPermitAuthorWrite( pAttr->permissions ) )
@@ -578,80 +403,41 @@ static bStatus_t pgpCertificate_WriteAttrCB( uint16 connHandle, gattAttribute_t
     return ( ATT_ERR_INSUFFICIENT_AUTHOR );
   }
   
-  if (utilExtractUuid16Certificate(pAttr,&uuid) == FAILURE) {                                       
-    // Invalid handle                                                                    
-    return ATT_ERR_INVALID_HANDLE;                                                       
-  }      
-  
-  #if (defined HAL_UART) && (HAL_UART == TRUE)
+#if (defined HAL_LOG) && (HAL_LOG == TRUE) && (HAL_LOG_LEVEL >= HAL_LOG_LEVEL_DEBUG)
   {
-    char buf[96];
-    sprintf(buf,"UUID: %04X\n",uuid);
-    uint8 strLength=strlen(buf);
-    HalUARTWrite ( HAL_UART_PORT_1, (uint8 *)buf, strLength );
-    if (uuid!=GATT_CLIENT_CHAR_CFG_UUID){
-      sprintf(buf,"Off:%d Len%d\n",offset, len);
-      strLength=strlen(buf);
-      HalUARTWrite ( HAL_UART_PORT_1, (uint8 *)buf, strLength );
-      char* buf_ptr = buf;
-      for (unsigned char i = 0; i < len; i++){
-         buf_ptr += sprintf(buf_ptr, "%02X", pValue[i]);
-      }sprintf(buf_ptr,"\n");*(buf_ptr + 1) = '\0';
-      strLength=strlen(buf);
-      HalUARTWrite ( HAL_UART_PORT_1, (uint8 *)buf, strLength );
+    uint8 args[5] = { LO_UINT16( pAttr->handle ), HI_UINT16( pAttr->handle ),
+                      LO_UINT16( offset ), HI_UINT16( offset ), len };
+    HAL_LOG_DEBUG( PGP_CERT_LOG_ID_WRITE, args, sizeof( args ) );
+    if ( ( idx != SFIDA_COMMANDS_CCCD_IDX ) && ( len != 0 ) )
+    {
+      // The value is dumped straight from the ATT buffer, no copy or formatting,
+      // in as many frames as it takes.
+      HAL_LOG_DEBUG_DUMP( PGP_CERT_LOG_ID_WRITE_DATA, pValue, len );
     }
   }
-  #endif  
+#endif
  
-  switch ( uuid )
+  switch ( idx )
   {
-    case CENTRAL_TO_SFIDA_CHAR_UUID:                                                             
-    case SFIDA_COMMANDS_CHAR_UUID:
-    case SFIDA_TO_CENTRAL_CHAR_UUID:
-
-      //Validate the value
-      // Make sure it's not a blob oper
-      if ( offset == 0 )
-      {
-        if ( len > sizeof(centralToSfidaChar) )
-        {
-          status = ATT_ERR_INVALID_VALUE_SIZE;
-        }
-      }
-      else
-      {
-        status = ATT_ERR_ATTR_NOT_LONG;
-      }
-        
-      //Write the value
-      if ( status == SUCCESS )
-      {           
-        #if (defined HAL_UART) && (HAL_UART == TRUE)
-          HalUARTWrite ( HAL_UART_PORT_1, "OK\n", 3 );
-        #endif
-        
-        (void)memcpy(pAttr->pValue, pValue, len);      
-
-        if( pAttr->pValue == centralToSfidaChar )
-        {
-          notifyApp = CENTRAL_TO_SFIDA_CHAR;
-          centralToSfidaCharLen=len;
-        }
-        else if( pAttr->pValue == sfidaCommandsChar )
-        {
-          notifyApp = SFIDA_COMMANDS_CHAR;
-          sfidaCommandsCharLen = len;
-        }
-        else if( pAttr->pValue == sfidaToCentralChar )
-        {
-          notifyApp = SFIDA_TO_CENTRAL_CHAR;
-          sfidaToCentralCharLen=len;
-        }
-      }
-             
+    case CENTRAL_TO_SFIDA_VALUE_IDX:
+      status = pgpCertificate_WriteValue( CENTRAL_TO_SFIDA_CHAR, centralToSfidaChar,
+                                          &centralToSfidaCharLen, pValue, len, offset, method );
+      notifyApp = CENTRAL_TO_SFIDA_CHAR;
+      break;
+
+    case SFIDA_COMMANDS_VALUE_IDX:
+      status = pgpCertificate_WriteValue( SFIDA_COMMANDS_CHAR, sfidaCommandsChar,
+                                          &sfidaCommandsCharLen, pValue, len, offset, method );
+      notifyApp = SFIDA_COMMANDS_CHAR;
+      break;
+
+    case SFIDA_TO_CENTRAL_VALUE_IDX:
+      status = pgpCertificate_WriteValue( SFIDA_TO_CENTRAL_CHAR, sfidaToCentralChar,
+                                          &sfidaToCentralCharLen, pValue, len, offset, method );
+      notifyApp = SFIDA_TO_CENTRAL_CHAR;
       break;
 
-    case GATT_CLIENT_CHAR_CFG_UUID:
+    case SFIDA_COMMANDS_CCCD_IDX:
       status = GATTServApp_ProcessCCCWriteReq( connHandle, pAttr, pValue, len,
                                                  offset, GATT_CLIENT_CFG_NOTIFY );
       if (pValue[0]==GATT_CLIENT_CFG_NOTIFY) notifyApp = SFIDA_COMMANDS_NOTIFY_SET;     //inform App when notification is set
@@ -663,6 +449,22 @@ static bStatus_t pgpCertificate_WriteAttrCB( uint16 connHandle, gattAttribute_t
       break;
   }
 
+  if ( status != SUCCESS )
+  {
+    notifyApp = 0xFF;
+  }
+  else if ( notifyApp != 0xFF )
+  {
+    HAL_LOG_DEBUG( PGP_CERT_LOG_ID_WRITE_OK, NULL, 0 );
+  }
+
+  // A fragment of a long write is only staged; the application hears about
+  // it once the whole Execute Write request has been applied.
+  if ( ( method == ATT_EXECUTE_WRITE_REQ ) && ( notifyApp != SFIDA_COMMANDS_NOTIFY_SET ) )
+  {
+    notifyApp = 0xFF;
+  }
+
   // If a charactersitic value changed then callback function to notify application of change
   if ( (notifyApp != 0xFF ) && pgpCertificate_AppCBs && pgpCertificate_AppCBs->pfnPgpCertificateChange )
   {
@@ -672,5 +474,167 @@ static bStatus_t pgpCertificate_WriteAttrCB( uint16 connHandle, gattAttribute_t
   return ( status );
 }
 
+/*********************************************************************
+ * @fn      pgpCertificate_ReadValue
+ *
+ * @brief   Copy a characteristic value, or the part of it from offset on
+ *          for a Read Blob request.
+ *
+ * @param   pBuf - characteristic value
+ * @param   bufLen - current length of the value
+ * @param   pValue - pointer to data to be read
+ * @param   pLen - length of data read
+ * @param   offset - offset of the first octet to be read
+ * @param   maxLen - maximum length of data to be read
+ *
+ * @return  SUCCESS or ATT_ERR_INVALID_OFFSET
+ */
+static bStatus_t pgpCertificate_ReadValue( uint8 *pBuf, uint8 bufLen, uint8 *pValue,
+                                           uint8 *pLen, uint16 offset, uint8 maxLen )
+{
+  if ( offset > bufLen )
+  {
+    return ( ATT_ERR_INVALID_OFFSET );
+  }
+
+  *pLen = MIN( maxLen, bufLen - offset );
+  (void)memcpy( pValue, &pBuf[offset], *pLen );
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      pgpCertificate_WriteValue
+ *
+ * @brief   Write a characteristic value, or stage one fragment of a long
+ *          write. The first fragment of an Execute Write starts from the
+ *          current value and arms pgpCertificate_ExecWriteDoneCB, which
+ *          applies the staged value if no fragment was refused. One
+ *          Execute Write request may write one characteristic.
+ *
+ * @param   param - profile parameter ID of the characteristic
+ * @param   pBuf - characteristic value, PGP_CERT_CHAR_MAX_LEN bytes
+ * @param   pBufLen - current length of the value, updated
+ * @param   pValue - pointer to data to be written
+ * @param   len - length of data
+ * @param   offset - offset of the first octet to be written
+ * @param   method - type of write message
+ *
+ * @return  SUCCESS, ATT_ERR_INVALID_OFFSET, ATT_ERR_INVALID_VALUE_SIZE,
+ *          ATT_ERR_PREPARE_QUEUE_FULL or ATT_ERR_INSUFFICIENT_RESOURCES
+ */
+static bStatus_t pgpCertificate_WriteValue( uint8 param, uint8 *pBuf, uint8 *pBufLen,
+                                            uint8 *pValue, uint8 len, uint16 offset,
+                                            uint8 method )
+{
+  bStatus_t status;
+
+  if ( method != ATT_EXECUTE_WRITE_REQ )
+  {
+    return ( pgpCertificate_StoreValue( pBuf, pBufLen, pValue, len, offset ) );
+  }
+
+  if ( pgpCertificate_ExecWriteChar == NULL )
+  {
+    // The stack calls back once per queued fragment and gives no sign of
+    // the last one; the timer runs once it has gone through them all
+    if ( osal_CbTimerStart( pgpCertificate_ExecWriteDoneCB, NULL, 0, NULL ) != SUCCESS )
+    {
+      return ( ATT_ERR_INSUFFICIENT_RESOURCES );
+    }
+
+    pgpCertificate_ExecWriteChar = pBuf;
+    pgpCertificate_ExecWriteCharLen = pBufLen;
+    pgpCertificate_ExecWriteParam = param;
+    pgpCertificate_ExecWriteStatus = SUCCESS;
+    pgpCertificate_ExecWriteLen = *pBufLen;
+    (void)memcpy( pgpCertificate_ExecWriteBuf, pBuf, *pBufLen );
+  }
+
+  if ( pgpCertificate_ExecWriteStatus != SUCCESS )
+  {
+    status = pgpCertificate_ExecWriteStatus;
+  }
+  else if ( pgpCertificate_ExecWriteChar != pBuf )
+  {
+    status = ATT_ERR_PREPARE_QUEUE_FULL;
+  }
+  else
+  {
+    status = pgpCertificate_StoreValue( pgpCertificate_ExecWriteBuf, &pgpCertificate_ExecWriteLen,
+                                        pValue, len, offset );
+  }
+
+  // One refused fragment drops the whole write
+  pgpCertificate_ExecWriteStatus = status;
+
+  return ( status );
+}
+
+/*********************************************************************
+ * @fn      pgpCertificate_StoreValue
+ *
+ * @brief   Store a value, or one fragment of a long write. Fragments
+ *          arrive in offset order, so each one ends the value.
+ *
+ * @param   pBuf - value, PGP_CERT_CHAR_MAX_LEN bytes
+ * @param   pBufLen - current length of the value, updated
+ * @param   pValue - pointer to data to be written
+ * @param   len - length of data
+ * @param   offset - offset of the first octet to be written
+ *
+ * @return  SUCCESS, ATT_ERR_INVALID_OFFSET or ATT_ERR_INVALID_VALUE_SIZE
+ */
+static bStatus_t pgpCertificate_StoreValue( uint8 *pBuf, uint8 *pBufLen, uint8 *pValue,
+                                            uint8 len, uint16 offset )
+{
+  if ( offset > *pBufLen )
+  {
+    return ( ATT_ERR_INVALID_OFFSET );
+  }
+
+  if ( offset + len > PGP_CERT_CHAR_MAX_LEN )
+  {
+    return ( ATT_ERR_INVALID_VALUE_SIZE );
+  }
+
+  (void)memcpy( &pBuf[offset], pValue, len );
+  *pBufLen = (uint8)( offset + len );
+
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * @fn      pgpCertificate_ExecWriteDoneCB
+ *
+ * @brief   Apply the value an Execute Write request staged and tell the
+ *          application, unless the stack refused the request for one of
+ *          its fragments. Runs from a zero-length callback timer, after
+ *          the stack has handed over every queued fragment.
+ *
+ * @param   pData - not used
+ *
+ * @return  none
+ */
+static void pgpCertificate_ExecWriteDoneCB( uint8 *pData )
+{
+  uint8 *pChar = pgpCertificate_ExecWriteChar;
+
+  pgpCertificate_ExecWriteChar = NULL;
+
+  if ( ( pChar == NULL ) || ( pgpCertificate_ExecWriteStatus != SUCCESS ) )
+  {
+    return;
+  }
+
+  (void)memcpy( pChar, pgpCertificate_ExecWriteBuf, pgpCertificate_ExecWriteLen );
+  *pgpCertificate_ExecWriteCharLen = pgpCertificate_ExecWriteLen;
+
+  if ( pgpCertificate_AppCBs && pgpCertificate_AppCBs->pfnPgpCertificateChange )
+  {
+    pgpCertificate_AppCBs->pfnPgpCertificateChange( pgpCertificate_ExecWriteParam );
+  }
+}
+
 /*********************************************************************
 *********************************************************************/
@@ -71,7 +71,22 @@ extern "C"
 #define SFIDA_COMMANDS_CHAR                   1  //RW
 #define SFIDA_TO_CENTRAL_CHAR                 2  //RW
 #define SFIDA_COMMANDS_NOTIFY_SET             3
-    
+
+// Longest value each characteristic holds. Values longer than ATT_MTU - 3
+// are read with Read Blob and written with Prepare/Execute Write; the
+// default GATT_MAX_NUM_PREPARE_WRITES (5) of 18 bytes covers 80 at the
+// default MTU. A long write takes effect whole or not at all, and writes one
+// characteristic per Execute Write. A SFIDA Commands notification carries
+// the first ATT_MTU - 3 bytes of the connection's MTU; tools/link_model.py
+// counts the PDUs.
+#if !defined PGP_CERT_CHAR_MAX_LEN
+  #define PGP_CERT_CHAR_MAX_LEN               80
+#endif
+
+#if PGP_CERT_CHAR_MAX_LEN > 255
+  #error "PGP_CERT_CHAR_MAX_LEN must fit the uint8 parameter length"
+#endif
+
 // UUID for CERTIFICATE_SERVICE service                          
 #define CERTIFICATE_SERV_UUID                  0x8E37    
 /* The 16 bit UUID listen above is only a part of the 
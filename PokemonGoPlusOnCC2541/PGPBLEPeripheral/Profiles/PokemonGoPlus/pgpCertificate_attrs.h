@@ -0,0 +1,157 @@
+/**************************************************************************************************
+  Filename:       pgpCertificate_attrs.h
+
+  Description:    Attribute table of the Certificate service, included once by
+                  pgpCertificate.c after the characteristic values it points to.
+
+                  Generated by tools/gatt_gen.py from pgpCertificate.gatt - do not edit.
+**************************************************************************************************/
+#ifndef PGPCERTIFICATE_ATTRS_H
+#define PGPCERTIFICATE_ATTRS_H
+
+/* Positions in pgpCertificateAttrTbl */
+#define CENTRAL_TO_SFIDA_VALUE_IDX       2
+#define SFIDA_COMMANDS_VALUE_IDX         5
+#define SFIDA_COMMANDS_CCCD_IDX          6
+#define SFIDA_TO_CENTRAL_VALUE_IDX       9
+
+/* Service and characteristic UUIDs */
+CONST uint8 certificateServUUID[ATT_UUID_SIZE] =
+{
+  CERTIFICATE_SERVICE_BASE_UUID_128( CERTIFICATE_SERV_UUID )
+};
+
+CONST uint8 centralToSfidaCharUUID[ATT_UUID_SIZE] =
+{
+  CERTIFICATE_SERVICE_BASE_UUID_128( CENTRAL_TO_SFIDA_CHAR_UUID )
+};
+
+CONST uint8 sfidaCommandsCharUUID[ATT_UUID_SIZE] =
+{
+  CERTIFICATE_SERVICE_BASE_UUID_128( SFIDA_COMMANDS_CHAR_UUID )
+};
+
+CONST uint8 sfidaToCentralCharUUID[ATT_UUID_SIZE] =
+{
+  CERTIFICATE_SERVICE_BASE_UUID_128( SFIDA_TO_CENTRAL_CHAR_UUID )
+};
+
+static CONST gattAttrType_t pgpCertificateService = { ATT_UUID_SIZE, certificateServUUID };
+
+/* Central to Sfida */
+static CONST uint8 centralToSfidaCharProps = GATT_PROP_READ | GATT_PROP_WRITE;
+static CONST uint8 centralToSfidaCharUserDesp[] = "Central to Sfida";
+
+/* Sfida commands */
+static CONST uint8 sfidaCommandsCharProps = GATT_PROP_READ | GATT_PROP_WRITE | GATT_PROP_NOTIFY;
+static gattCharCfg_t *sfidaCommandsCharConfig;
+static CONST uint8 sfidaCommandsCharUserDesp[] = "Sfida commands";
+
+/* Sfida to Central */
+static CONST uint8 sfidaToCentralCharProps = GATT_PROP_READ | GATT_PROP_WRITE;
+static CONST uint8 sfidaToCentralCharUserDesp[] = "Sfida to Central";
+
+static gattAttribute_t pgpCertificateAttrTbl[] =
+{
+  /* Certificate Service */
+  {
+    { ATT_BT_UUID_SIZE, primaryServiceUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)&pgpCertificateService
+  },
+
+  /* Central to Sfida Declaration */
+  {
+    { ATT_BT_UUID_SIZE, characterUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)&centralToSfidaCharProps
+  },
+
+  /* Central to Sfida Value */
+  {
+    { ATT_UUID_SIZE, centralToSfidaCharUUID },
+    GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+    0,
+    centralToSfidaChar
+  },
+
+  /* Central to Sfida User Description */
+  {
+    { ATT_BT_UUID_SIZE, charUserDescUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)centralToSfidaCharUserDesp
+  },
+
+  /* Sfida commands Declaration */
+  {
+    { ATT_BT_UUID_SIZE, characterUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)&sfidaCommandsCharProps
+  },
+
+  /* Sfida commands Value */
+  {
+    { ATT_UUID_SIZE, sfidaCommandsCharUUID },
+    GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+    0,
+    sfidaCommandsChar
+  },
+
+  /* Sfida commands Client Characteristic Configuration */
+  {
+    { ATT_BT_UUID_SIZE, clientCharCfgUUID },
+    GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+    0,
+    (uint8 *)&sfidaCommandsCharConfig
+  },
+
+  /* Sfida commands User Description */
+  {
+    { ATT_BT_UUID_SIZE, charUserDescUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)sfidaCommandsCharUserDesp
+  },
+
+  /* Sfida to Central Declaration */
+  {
+    { ATT_BT_UUID_SIZE, characterUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)&sfidaToCentralCharProps
+  },
+
+  /* Sfida to Central Value */
+  {
+    { ATT_UUID_SIZE, sfidaToCentralCharUUID },
+    GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+    0,
+    sfidaToCentralChar
+  },
+
+  /* Sfida to Central User Description */
+  {
+    { ATT_BT_UUID_SIZE, charUserDescUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)sfidaToCentralCharUserDesp
+  }
+};
+
+/* Take the Client Characteristic Configuration tables from the shared pool */
+static bStatus_t pgpCertificateAllocCharCfg( void )
+{
+  sfidaCommandsCharConfig = GATTServApp_AllocCharCfg();
+  if ( sfidaCommandsCharConfig == NULL )
+  {
+    return ( bleMemAllocError );
+  }
+
+  return ( SUCCESS );
+}
+
+#endif
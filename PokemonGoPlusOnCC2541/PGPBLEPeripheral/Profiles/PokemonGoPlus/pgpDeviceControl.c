@@ -62,11 +62,7 @@
 
 #include "pgpDeviceControl.h"
 
-#if (defined HAL_UART) && (HAL_UART == TRUE)
-#include <stdio.h>
-#include <stdlib.h>
-#include "hal_uart.h"
-#endif
+#include "hal_log.h"
 
 /*********************************************************************
  * MACROS
@@ -76,8 +72,9 @@
  * CONSTANTS
  */
 
-//need to update if RW is updated or more char
-#define SERVAPP_NUM_ATTR_SUPPORTED        14    
+// Log event IDs (see hal_log.h, range 0x40 - 0x5F)
+#define PGP_DC_LOG_ID_READ                0x40  /* "pgpDeviceControl read handle: {x16}" */
+#define PGP_DC_LOG_ID_WRITE               0x41  /* "pgpDeviceControl write handle: {x16}" */
 
 /*********************************************************************
  * TYPEDEFS
@@ -87,34 +84,6 @@
  * GLOBAL VARIABLES
  */
    
-// Device Control Service UUID: 0x9AEB                      
-CONST uint8 deviceControlServUUID[ATT_UUID_SIZE] =         
-{                                                     
-    DEVICE_CONTROL_SERVICE_BASE_UUID_128(DEVICE_CONTROL_SERV_UUID),             
-};                                                    
-                                                      
-// Led Vibrate Ctrl UUID: 0x9AEC                      
-CONST uint8 ledVibrateCtrlCharUUID[ATT_UUID_SIZE] =        
-{                                                     
-    DEVICE_CONTROL_SERVICE_BASE_UUID_128(LED_VIBRATE_CTRL_CHAR_UUID),            
-};                                                    
-// Button Notif UUID: 0x9AED                      
-CONST uint8 buttonNotifCharUUID[ATT_UUID_SIZE] =        
-{                                                     
-    DEVICE_CONTROL_SERVICE_BASE_UUID_128(BUTTON_NOTIF_CHAR_UUID),            
-};     
-// Fw Update Request UUID: 0x9AEF                      
-CONST uint8 fwUpdateRequestCharUUID[ATT_UUID_SIZE] =        
-{                                                     
-    DEVICE_CONTROL_SERVICE_BASE_UUID_128(FW_UPDATE_REQUEST_CHAR_UUID),            
-};     
-// Fw Version UUID: 0x9AF0                      
-CONST uint8 fwVersionCharUUID[ATT_UUID_SIZE] =        
-{                                                     
-    DEVICE_CONTROL_SERVICE_BASE_UUID_128(FW_VERSION_CHAR_UUID),            
-};        
-
-
 /*********************************************************************
  * EXTERNAL VARIABLES
  */
@@ -129,178 +98,29 @@ CONST uint8 fwVersionCharUUID[ATT_UUID_SIZE] =
 
 static pgpDeviceControlCBs_t *pgpDeviceControl_AppCBs = NULL;
 
-/*********************************************************************                    
- * Service Attributes - variables                                                         
- */                                                                                       
-
-// Device Control Service attribute                                                             
-static CONST gattAttrType_t pgpDeviceControlService = { ATT_UUID_SIZE, deviceControlServUUID};     
-//-------------------------------------------------------------------
-// Device Control Service Led Vibrate Ctrl Properties                                           
-static uint8 ledVibrateCtrlCharProps = GATT_PROP_READ | GATT_PROP_WRITE;                       
-
-// Led Vibrate Ctrl Value                                                                 
-static uint8 ledVibrateCtrlChar = 0;                                                           
-
-// Device Control Service Led Vibrate Ctrl User Description                                     
-static uint8 ledVibrateCtrlCharUserDesp[] = "Led Vibrate Ctrl\0";        
-
-//-------------------------------------------------------------------
-// Device Control Service Button Notif Properties                                           
-static uint8 buttonNotifCharProps = GATT_PROP_NOTIFY;                                       
-
-// Button Notif Value                                                                 
-static uint8 buttonNotifChar = 0;                                                           
-
-// Device Control Service Button Notif Configuration.                                       
-static gattCharCfg_t *buttonNotifCharConfig;                                                
-
-// Device Control Service Button Notif User Description                                     
-static uint8 buttonNotifCharUserDesp[] = "Button Notif\0"; 
-
-//-------------------------------------------------------------------
-// Device Control Service Fw Update Request Properties                                           
-static uint8 fwUpdateRequestCharProps = GATT_PROP_READ | GATT_PROP_WRITE;                       
-
-// Fw Update Request Value                                                                 
-static uint8 fwUpdateRequestChar = 0;                                                           
+/*********************************************************************
+ * Service Attributes - variables
+ */
 
-// Device Control Service Fw Update Request User Description                                     
-static uint8 fwUpdateRequestCharUserDesp[] = "Fw Update Request\0";  
+// Led Vibrate Ctrl Value
+static uint8 ledVibrateCtrlChar = 0;
 
-//-------------------------------------------------------------------
-// Device Control Service Fw Version Properties                                           
-static uint8 fwVersionCharProps = GATT_PROP_READ;                       
+// Button Notif Value
+static uint8 buttonNotifChar = 0;
 
-// Fw Version Value                                                                 
-static uint8 fwVersionChar = 0;                                                           
+// Fw Update Request Value
+static uint8 fwUpdateRequestChar = 0;
 
-// Device Control Service Fw Version User Description                                     
-static uint8 fwVersionCharUserDesp[] = "Fw Version\0";                              
-                            
+// Fw Version Value
+static uint8 fwVersionChar = 0;
 
 /*********************************************************************
  * Profile Attributes - Table
  */
 
-static gattAttribute_t pgpDeviceControlAttrTbl[SERVAPP_NUM_ATTR_SUPPORTED] = 
-{
-  // Device Control Service
-  { 
-    { ATT_BT_UUID_SIZE, primaryServiceUUID }, /* type */
-    GATT_PERMIT_READ,                         /* permissions */
-    0,                                        /* handle */
-    (uint8 *)&pgpDeviceControlService         /* pValue */
-  },
-  
-    // Led Vibrate Ctrl Declaration                                 
-  {                                                               
-    { ATT_BT_UUID_SIZE, characterUUID },                          
-    GATT_PERMIT_READ,                                             
-    0,                                                            
-    &ledVibrateCtrlCharProps                                           
-  },                                                              
-                                                                  
-  // Led Vibrate Ctrl Value                                    
-  {                                                               
-    { ATT_UUID_SIZE, ledVibrateCtrlCharUUID },                         
-    GATT_PERMIT_READ | GATT_PERMIT_WRITE,                         
-    0,                                                            
-    &ledVibrateCtrlChar                                                
-  },                                                              
-                                                                  
-  // Led Vibrate Ctrl User Description                            
-  {                                                               
-    { ATT_BT_UUID_SIZE, charUserDescUUID },                       
-    GATT_PERMIT_READ,                                             
-    0,                                                            
-    ledVibrateCtrlCharUserDesp                                         
-  },                                                              
-                                                                  
-   
-  // Button Notif Declaration                                 
-  {                                                               
-    { ATT_BT_UUID_SIZE, characterUUID },                          
-    GATT_PERMIT_READ,                                             
-    0,                                                            
-    &buttonNotifCharProps                                           
-  },                                                              
-                                                                  
-  // Button Notif Value                                      
-  {                                                               
-    { ATT_UUID_SIZE, buttonNotifCharUUID },                         
-    0,                                                            
-    0,                                                            
-    &buttonNotifChar                                                
-  },                                                              
-                                                                  
-  // Button Notif configuration                               
-  {                                                               
-    { ATT_BT_UUID_SIZE, clientCharCfgUUID },                      
-    GATT_PERMIT_READ | GATT_PERMIT_WRITE,                         
-    0,                                                            
-    (uint8 *)&buttonNotifCharConfig                                 
-  },                                                              
-                                                                  
-  // Button Notif User Description                            
-  {                                                               
-    { ATT_BT_UUID_SIZE, charUserDescUUID },                       
-    GATT_PERMIT_READ,                                             
-    0,                                                            
-    buttonNotifCharUserDesp                                         
-  },  
-  
-  
-    // Fw Update Request Declaration                                 
-  {                                                               
-    { ATT_BT_UUID_SIZE, characterUUID },                          
-    GATT_PERMIT_READ,                                             
-    0,                                                            
-    &fwUpdateRequestCharProps                                           
-  },                                                              
-                                                                  
-  // Fw Update Request Value                                    
-  {                                                               
-    { ATT_UUID_SIZE, fwUpdateRequestCharUUID },                         
-    GATT_PERMIT_READ | GATT_PERMIT_WRITE,                         
-    0,                                                            
-    &fwUpdateRequestChar                                                
-  },                                                              
-                                                                  
-  // Fw Update Request User Description                            
-  {                                                               
-    { ATT_BT_UUID_SIZE, charUserDescUUID },                       
-    GATT_PERMIT_READ,                                             
-    0,                                                            
-    fwUpdateRequestCharUserDesp                                         
-  },                                                              
-
-    
-    // Fw Version Declaration                                 
-  {                                                               
-    { ATT_BT_UUID_SIZE, characterUUID },                          
-    GATT_PERMIT_READ,                                             
-    0,                                                            
-    &fwVersionCharProps                                           
-  },                                                              
-                                                                  
-  // Fw Version Value                                    
-  {                                                               
-    { ATT_UUID_SIZE, fwVersionCharUUID },                         
-    GATT_PERMIT_READ,                         
-    0,                                                            
-    &fwVersionChar                                                
-  },                                                              
-                                                                  
-  // Fw Version User Description                            
-  {                                                               
-    { ATT_BT_UUID_SIZE, charUserDescUUID },                       
-    GATT_PERMIT_READ,                                             
-    0,                                                            
-    fwVersionCharUserDesp                                         
-  },                                                              
-
-};
+// UUIDs, properties, descriptions, CCC table and the attribute table,
+// generated from pgpDeviceControl.gatt by tools/gatt_gen.py
+#include "pgpDeviceControl_attrs.h"
 
 /*********************************************************************
  * LOCAL FUNCTIONS
@@ -327,27 +147,6 @@ CONST gattServiceCBs_t pgpDeviceControlCBs =
  * PUBLIC FUNCTIONS
  */
 
-bStatus_t utilExtractUuid16(gattAttribute_t *pAttr, uint16 *pUuid)
-{
-  bStatus_t status = SUCCESS;
-
-  if (pAttr->type.len == ATT_BT_UUID_SIZE )
-  {
-    // 16-bit UUID direct
-    *pUuid = BUILD_UINT16( pAttr->type.uuid[0], pAttr->type.uuid[1]);
-  }
-  else if (pAttr->type.len == ATT_UUID_SIZE)
-  {
-    // 16-bit UUID extracted bytes 0 and 1 for this service
-    *pUuid = BUILD_UINT16( pAttr->type.uuid[0], pAttr->type.uuid[1]);
-  } else {
-    *pUuid = 0xFFFF;
-    status = FAILURE;
-  }
-
-  return status;
-}
-
 /*********************************************************************
  * @fn      PgpDeviceControl_AddService
  *
@@ -363,17 +162,12 @@ bStatus_t PgpDeviceControl_AddService( uint32 services )
 {
   uint8 status;
   
-  // Allocate Client Characteristic Configuration table
-  buttonNotifCharConfig = (gattCharCfg_t *)osal_mem_alloc( sizeof(gattCharCfg_t) *
-                                                              linkDBNumConns );
-  if ( buttonNotifCharConfig == NULL )
-  {     
-    return ( bleMemAllocError );
+  // Allocate and initialize the Client Characteristic Configuration table
+  status = pgpDeviceControlAllocCharCfg();
+  if ( status != SUCCESS )
+  {
+    return ( status );
   }
-  
-  // Initialize Client Characteristic Configuration attributes
-  GATTServApp_InitCharCfg( INVALID_CONNHANDLE, buttonNotifCharConfig );
-  
 
   // Register GATT attribute list and CBs with GATT Server App
   status = GATTServApp_RegisterService( pgpDeviceControlAttrTbl, 
@@ -445,9 +239,9 @@ bStatus_t PgpDeviceControl_SetParameter( uint8 param, uint8 len, void *value )
         buttonNotifChar = *((uint8*)value);                                                     
                                                                                               
         // See if Notification has been enabled                                               
-        GATTServApp_ProcessCharCfg( buttonNotifCharConfig, &buttonNotifChar, FALSE,               
-                                    pgpDeviceControlAttrTbl, GATT_NUM_ATTRS( pgpDeviceControlAttrTbl ),       
-                                    INVALID_TASK_ID, pgpDeviceControl_ReadAttrCB );                   
+        GATTServApp_ProcessCharCfgAttr( buttonNotifCharConfig,
+                                        &pgpDeviceControlAttrTbl[BUTTON_NOTIF_VALUE_IDX], FALSE,
+                                        INVALID_TASK_ID, pgpDeviceControl_ReadAttrCB );
       }                                                                                       
       else                                                                                    
       {                                                                                       
@@ -547,13 +341,8 @@ static bStatus_t pgpDeviceControl_ReadAttrCB( uint16 connHandle, gattAttribute_t
                                            uint8 *pValue, uint8 *pLen, uint16 offset,
                                            uint8 maxLen, uint8 method )
 {
-  uint16 uuid;
   bStatus_t status = SUCCESS;
   
-  #if (defined HAL_UART) && (HAL_UART == TRUE)
-    HalUARTWrite ( HAL_UART_PORT_1, "pgpDeviceControl_ReadAttrCB\n", 28 );
-  #endif
-
   // If attribute permissions require authorization to read, return error
   if ( gattPermitAuthorRead( pAttr->permissions ) )
   {
@@ -568,33 +357,19 @@ static bStatus_t pgpDeviceControl_ReadAttrCB( uint16 connHandle, gattAttribute_t
   }
  
   
-  if (utilExtractUuid16(pAttr,&uuid) == FAILURE) {                                      
-    // Invalid handle                                                                   
-    *pLen = 0;                                                                          
-    return ATT_ERR_INVALID_HANDLE;                                                      
-  }
-  
-  #if (defined HAL_UART) && (HAL_UART == TRUE)
+  HAL_LOG_DEBUG_U16( PGP_DC_LOG_ID_READ, pAttr->handle );
+
+  switch ( GATT_ATTR_IDX( pgpDeviceControlAttrTbl, pAttr ) )
   {
-    char buf[32];
-    sprintf(buf,"UUID: %04X\n",uuid);
-    uint8 strLength=strlen(buf);
-    HalUARTWrite ( HAL_UART_PORT_1, (uint8 *)buf, strLength );
-  }
-  #endif
-                                                                                        
-  switch ( uuid )                                                                       
-  {                                                                                     
-    // No need for "GATT_SERVICE_UUID" or "GATT_CLIENT_CHAR_CFG_UUID" cases;            
-    // gattserverapp handles those reads                                                
-                                                                                        
-    // characteristics 1 has read permissions                                           
-    // characteristic 2 does not have read permissions, but because it                  
-    //   can be sent as a notification, it is included here                             
-  case LED_VIBRATE_CTRL_CHAR_UUID:                                                             
-  case BUTTON_NOTIF_CHAR_UUID:
-  case FW_UPDATE_REQUEST_CHAR_UUID:
-  case FW_VERSION_CHAR_UUID:
+    // No need for the service or client characteristic configuration cases;
+    // gattserverapp handles those reads
+
+    // button notif does not have read permissions, but because it
+    //   can be sent as a notification, it is included here
+  case LED_VIBRATE_CTRL_VALUE_IDX:
+  case BUTTON_NOTIF_VALUE_IDX:
+  case FW_UPDATE_REQUEST_VALUE_IDX:
+  case FW_VERSION_VALUE_IDX:
     *pLen = 1;                                                                          
     pValue[0] = *pAttr->pValue;                                                         
     break;                                                                              
@@ -628,11 +403,6 @@ static bStatus_t pgpDeviceControl_WriteAttrCB( uint16 connHandle, gattAttribute_
 {
   bStatus_t status = SUCCESS;
   uint8 notifyApp = 0xFF;
-  uint16 uuid; 
-  
-  #if (defined HAL_UART) && (HAL_UART == TRUE)
-    HalUARTWrite ( HAL_UART_PORT_1, "pgpDeviceControl_ReadAttrCB\n", 29 );
-  #endif
   
   // If attribute permissions require authorization to write, return error
   if ( gattPermitAuthorWrite( pAttr->permissions ) )
@@ -641,24 +411,12 @@ static bStatus_t pgpDeviceControl_WriteAttrCB( uint16 connHandle, gattAttribute_
     return ( ATT_ERR_INSUFFICIENT_AUTHOR );
   }
   
-  if (utilExtractUuid16(pAttr,&uuid) == FAILURE) {                                       
-    // Invalid handle                                                                    
-    return ATT_ERR_INVALID_HANDLE;                                                       
-  }   
-  
-  #if (defined HAL_UART) && (HAL_UART == TRUE)
-  {
-    char buf[32];
-    sprintf(buf,"UUID: %04X\n",uuid);
-    uint8 strLength=strlen(buf);
-    HalUARTWrite ( HAL_UART_PORT_1, (uint8 *)buf, strLength );
-  }
-  #endif
+  HAL_LOG_DEBUG_U16( PGP_DC_LOG_ID_WRITE, pAttr->handle );
  
-  switch ( uuid )
+  switch ( GATT_ATTR_IDX( pgpDeviceControlAttrTbl, pAttr ) )
   {
-    case LED_VIBRATE_CTRL_CHAR_UUID:
-    case FW_UPDATE_REQUEST_CHAR_UUID:
+    case LED_VIBRATE_CTRL_VALUE_IDX:
+    case FW_UPDATE_REQUEST_VALUE_IDX:
 
       //Validate the value
       // Make sure it's not a blob oper
@@ -692,7 +450,7 @@ static bStatus_t pgpDeviceControl_WriteAttrCB( uint16 connHandle, gattAttribute_
              
       break;
 
-    case GATT_CLIENT_CHAR_CFG_UUID:
+    case BUTTON_NOTIF_CCCD_IDX:
       status = GATTServApp_ProcessCCCWriteReq( connHandle, pAttr, pValue, len,
                                                  offset, GATT_CLIENT_CFG_NOTIFY );
       break;
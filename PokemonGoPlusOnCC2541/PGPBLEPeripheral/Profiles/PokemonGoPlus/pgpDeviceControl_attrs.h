@@ -0,0 +1,191 @@
+/**************************************************************************************************
+  Filename:       pgpDeviceControl_attrs.h
+
+  Description:    Attribute table of the Device Control service, included once by
+                  pgpDeviceControl.c after the characteristic values it points to.
+
+                  Generated by tools/gatt_gen.py from pgpDeviceControl.gatt - do not edit.
+**************************************************************************************************/
+#ifndef PGPDEVICECONTROL_ATTRS_H
+#define PGPDEVICECONTROL_ATTRS_H
+
+/* Positions in pgpDeviceControlAttrTbl */
+#define LED_VIBRATE_CTRL_VALUE_IDX       2
+#define BUTTON_NOTIF_VALUE_IDX           5
+#define BUTTON_NOTIF_CCCD_IDX            6
+#define FW_UPDATE_REQUEST_VALUE_IDX      9
+#define FW_VERSION_VALUE_IDX             12
+
+/* Service and characteristic UUIDs */
+CONST uint8 deviceControlServUUID[ATT_UUID_SIZE] =
+{
+  DEVICE_CONTROL_SERVICE_BASE_UUID_128( DEVICE_CONTROL_SERV_UUID )
+};
+
+CONST uint8 ledVibrateCtrlCharUUID[ATT_UUID_SIZE] =
+{
+  DEVICE_CONTROL_SERVICE_BASE_UUID_128( LED_VIBRATE_CTRL_CHAR_UUID )
+};
+
+CONST uint8 buttonNotifCharUUID[ATT_UUID_SIZE] =
+{
+  DEVICE_CONTROL_SERVICE_BASE_UUID_128( BUTTON_NOTIF_CHAR_UUID )
+};
+
+CONST uint8 fwUpdateRequestCharUUID[ATT_UUID_SIZE] =
+{
+  DEVICE_CONTROL_SERVICE_BASE_UUID_128( FW_UPDATE_REQUEST_CHAR_UUID )
+};
+
+CONST uint8 fwVersionCharUUID[ATT_UUID_SIZE] =
+{
+  DEVICE_CONTROL_SERVICE_BASE_UUID_128( FW_VERSION_CHAR_UUID )
+};
+
+static CONST gattAttrType_t pgpDeviceControlService = { ATT_UUID_SIZE, deviceControlServUUID };
+
+/* Led Vibrate Ctrl */
+static CONST uint8 ledVibrateCtrlCharProps = GATT_PROP_READ | GATT_PROP_WRITE;
+static CONST uint8 ledVibrateCtrlCharUserDesp[] = "Led Vibrate Ctrl";
+
+/* Button Notif */
+static CONST uint8 buttonNotifCharProps = GATT_PROP_NOTIFY;
+static gattCharCfg_t *buttonNotifCharConfig;
+static CONST uint8 buttonNotifCharUserDesp[] = "Button Notif";
+
+/* Fw Update Request */
+static CONST uint8 fwUpdateRequestCharProps = GATT_PROP_READ | GATT_PROP_WRITE;
+static CONST uint8 fwUpdateRequestCharUserDesp[] = "Fw Update Request";
+
+/* Fw Version */
+static CONST uint8 fwVersionCharProps = GATT_PROP_READ;
+static CONST uint8 fwVersionCharUserDesp[] = "Fw Version";
+
+static gattAttribute_t pgpDeviceControlAttrTbl[] =
+{
+  /* Device Control Service */
+  {
+    { ATT_BT_UUID_SIZE, primaryServiceUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)&pgpDeviceControlService
+  },
+
+  /* Led Vibrate Ctrl Declaration */
+  {
+    { ATT_BT_UUID_SIZE, characterUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)&ledVibrateCtrlCharProps
+  },
+
+  /* Led Vibrate Ctrl Value */
+  {
+    { ATT_UUID_SIZE, ledVibrateCtrlCharUUID },
+    GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+    0,
+    &ledVibrateCtrlChar
+  },
+
+  /* Led Vibrate Ctrl User Description */
+  {
+    { ATT_BT_UUID_SIZE, charUserDescUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)ledVibrateCtrlCharUserDesp
+  },
+
+  /* Button Notif Declaration */
+  {
+    { ATT_BT_UUID_SIZE, characterUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)&buttonNotifCharProps
+  },
+
+  /* Button Notif Value */
+  {
+    { ATT_UUID_SIZE, buttonNotifCharUUID },
+    0,
+    0,
+    &buttonNotifChar
+  },
+
+  /* Button Notif Client Characteristic Configuration */
+  {
+    { ATT_BT_UUID_SIZE, clientCharCfgUUID },
+    GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+    0,
+    (uint8 *)&buttonNotifCharConfig
+  },
+
+  /* Button Notif User Description */
+  {
+    { ATT_BT_UUID_SIZE, charUserDescUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)buttonNotifCharUserDesp
+  },
+
+  /* Fw Update Request Declaration */
+  {
+    { ATT_BT_UUID_SIZE, characterUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)&fwUpdateRequestCharProps
+  },
+
+  /* Fw Update Request Value */
+  {
+    { ATT_UUID_SIZE, fwUpdateRequestCharUUID },
+    GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+    0,
+    &fwUpdateRequestChar
+  },
+
+  /* Fw Update Request User Description */
+  {
+    { ATT_BT_UUID_SIZE, charUserDescUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)fwUpdateRequestCharUserDesp
+  },
+
+  /* Fw Version Declaration */
+  {
+    { ATT_BT_UUID_SIZE, characterUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)&fwVersionCharProps
+  },
+
+  /* Fw Version Value */
+  {
+    { ATT_UUID_SIZE, fwVersionCharUUID },
+    GATT_PERMIT_READ,
+    0,
+    &fwVersionChar
+  },
+
+  /* Fw Version User Description */
+  {
+    { ATT_BT_UUID_SIZE, charUserDescUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8 *)fwVersionCharUserDesp
+  }
+};
+
+/* Take the Client Characteristic Configuration tables from the shared pool */
+static bStatus_t pgpDeviceControlAllocCharCfg( void )
+{
+  buttonNotifCharConfig = GATTServApp_AllocCharCfg();
+  if ( buttonNotifCharConfig == NULL )
+  {
+    return ( bleMemAllocError );
+  }
+
+  return ( SUCCESS );
+}
+
+#endif
@@ -57,6 +57,7 @@
 #include "att.h"
 #include "gatt.h"
 #include "osal_snv.h"
+#include "hal_log.h"
 
 #include "peripheral.h"
 #include "gapbondmgr.h"
@@ -980,7 +981,9 @@ static void gapRole_ProcessGattEvent(gattMsgEvent_t *pMsg)
       break;
       
     case ATT_MTU_UPDATED_EVENT:
-      // MTU size updated
+      // MTU size updated. Notifications are sized from the connection's MTU
+      // by GATT_bm_alloc(), so nothing else needs to follow it.
+      HAL_LOG_INFO_U16( HAL_LOG_ID_ATT_MTU, pMsg->msg.mtuEvt.MTU );
       break;
       
     default:
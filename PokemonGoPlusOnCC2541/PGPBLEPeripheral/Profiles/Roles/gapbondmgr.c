@@ -130,6 +130,17 @@
 // Macros to calculate the GATT index/offset in to NV space
 #define gattCfgNvID(Idx)                    ((Idx) + BLE_NVID_GATT_CFG_START)
 
+// NV ID of the connection order of the bonds, the first one after the last bond
+#define bondLRUNvID                         (calcNvID(GAP_BONDINGS_MAX, GAP_BOND_REC_ID_OFFSET))
+
+#if ( ( GAP_BONDINGS_MAX * GAP_BOND_REC_IDS ) + 1 > ( BLE_NVID_GAP_BOND_END - BLE_NVID_GAP_BOND_START + 1 ) )
+  #error "GAP_BONDINGS_MAX: the bond records do not fit in the GAP bond NV IDs"
+#endif
+
+#if ( GAP_BONDINGS_MAX > ( BLE_NVID_GATT_CFG_END - BLE_NVID_GATT_CFG_START + 1 ) )
+  #error "GAP_BONDINGS_MAX: the characteristic configurations do not fit in the GATT NV IDs"
+#endif
+
 // Key Size Limits
 #define MIN_ENC_KEYSIZE                     7  //!< Minimum number of bytes for the encryption key
 #define MAX_ENC_KEYSIZE                     16 //!< Maximum number of bytes for the encryption key
@@ -210,6 +221,30 @@ static const gapBondCBs_t *pGapBondCB = NULL;
 // Local RAM shadowed bond records
 static gapBondRec_t bonds[GAP_BONDINGS_MAX] = {0};
 
+#if ( GAP_BOND_IRK_CACHE == TRUE )
+// Local RAM shadowed device IRKs, all 0xFF's for a bond without one
+static uint8 bondIRKs[GAP_BONDINGS_MAX][KEYLEN];
+#endif
+
+// Last private address resolved and its bond. The same address again costs
+// no AES operation; a rotated one tries that bond first, which costs one
+// AES operation more when the address belongs to another bond.
+static uint8 lastRPA[B_ADDR_LEN];
+static uint8 lastRPAIdx = GAP_BONDINGS_MAX;
+
+#if ( GAP_BOND_CFG_CACHE == TRUE )
+// Characteristic configuration of the last bond read or written, as it is
+// in NV but not inverted. A reconnection of that bond restores it from here.
+static gapBondCharCfg_t cfgCache[GAP_CHAR_CFG_MAX];
+static uint8 cfgCacheIdx = GAP_BONDINGS_MAX;
+#endif
+
+#if ( GAP_BOND_LRU_EVICT == TRUE )
+// Connection order of the bonds: 0 for the bond that connected last,
+// GAP_BONDINGS_MAX-1 for the one that connected longest ago. Saved in NV.
+static uint8 bondAge[GAP_BONDINGS_MAX];
+#endif
+
 static uint8 autoSyncWhiteList = FALSE;
 
 static uint8 eraseAllBonds = FALSE;
@@ -233,6 +268,8 @@ static uint8 reconnectAddrIdx = GAP_BONDINGS_MAX;
  * LOCAL FUNCTIONS
  */
 static uint8 gapBondMgrUpdateCharCfg( uint8 idx, uint16 attrHandle, uint16 value );
+static bStatus_t gapBondMgrReadCharCfg( uint8 idx, gapBondCharCfg_t *charCfgTbl );
+static void gapBondMgrWriteCharCfg( uint8 idx, gapBondCharCfg_t *charCfgTbl );
 static gapBondCharCfg_t *gapBondMgrFindCharCfgItem( uint16 attrHandle,
                                                     gapBondCharCfg_t *charCfgTbl );
 static void gapBondMgrInvertCharCfgItem( gapBondCharCfg_t *charCfgTbl );
@@ -242,11 +279,18 @@ static bStatus_t gapBondMgrGetPublicAddr( uint8 idx, uint8 *pAddr );
 static uint8 gapBondMgrFindReconnectAddr( uint8 *pReconnectAddr );
 static uint8 gapBondMgrFindAddr( uint8 *pDevAddr );
 static uint8 gapBondMgrResolvePrivateAddr( uint8 *pAddr );
+static uint8 gapBondMgrMatchIRK( uint8 idx, uint8 *pDevAddr );
 static void gapBondMgrReadBonds( void );
 static uint8 gapBondMgrFindEmpty( void );
+#if ( GAP_BOND_LRU_EVICT == TRUE )
+static uint8 gapBondMgrFindOldest( void );
+static void gapBondMgrTouchBond( uint8 idx );
+static void gapBondMgrReadBondAge( void );
+#endif
 static uint8 gapBondMgrBondTotal( void );
 static bStatus_t gapBondMgrEraseAllBondings( void );
 static bStatus_t gapBondMgrEraseBonding( uint8 idx );
+static bStatus_t gapBondMgrEraseItem( osalSnvId_t id, osalSnvLen_t len, void *pBuf );
 static uint8 gapBondMgr_ProcessOSALMsg( osal_event_hdr_t *pMsg );
 static void gapBondMgr_ProcessGATTMsg( gattMsgEvent_t *pMsg );
 static void gapBondMgr_ProcessGATTServMsg( gattEventHdr_t *pMsg );
@@ -658,6 +702,10 @@ bStatus_t GAPBondMgr_LinkEst( uint8 addrType, uint8 *pDevAddr, uint16 connHandle
     smSigningInfo_t signingInfo;
     gapBondCharCfg_t charCfg[GAP_CHAR_CFG_MAX]; // Space to read a char cfg record from NV
 
+#if ( GAP_BOND_LRU_EVICT == TRUE )
+    gapBondMgrTouchBond( idx );
+#endif
+
     // On peripheral, load the key information for the bonding
     // On central and initiaiting security, load key to initiate encyption
     gapBondMgrBondReq( connHandle, idx, stateFlags, role,
@@ -678,12 +726,10 @@ bStatus_t GAPBondMgr_LinkEst( uint8 addrType, uint8 *pDevAddr, uint16 connHandle
     }
 
     // Load the characteristic configuration
-    if ( osal_snv_read( gattCfgNvID(idx), sizeof ( charCfg ), charCfg ) == SUCCESS )
+    if ( gapBondMgrReadCharCfg( idx, charCfg ) == SUCCESS )
     {
       uint8 i;
 
-      gapBondMgrInvertCharCfgItem( charCfg );
-
       for ( i = 0; i < GAP_CHAR_CFG_MAX; i++ )
       {
         gapBondCharCfg_t *pItem = &(charCfg[i]);
@@ -1288,6 +1334,9 @@ static uint8 gapBondMgrChangeState( uint8 idx, uint16 state, uint8 set )
       bondRec.stateFlags = stateFlags;
       VOID osal_snv_write( mainRecordNvID(idx), sizeof ( gapBondRec_t ), &bondRec );
     }
+
+    // Keep the RAM shadow in step for gapBondMgrGetStateFlags
+    bonds[idx].stateFlags = stateFlags;
     
     return ( TRUE );
   }
@@ -1309,20 +1358,15 @@ static uint8 gapBondMgrChangeState( uint8 idx, uint16 state, uint8 set )
  */
 static uint8 gapBondMgrUpdateCharCfg( uint8 idx, uint16 attrHandle, uint16 value )
 {
-  gapBondRec_t bondRec;   // Space to read a Bond record from NV
-
-  // Look for public address that is used (not all 0xFF's)
-  if ( ( osal_snv_read( mainRecordNvID(idx), sizeof ( gapBondRec_t ), &bondRec ) == SUCCESS )
-       && ( osal_isbufset( bondRec.publicAddr, 0xFF, B_ADDR_LEN ) == FALSE ) )
+  // Look for public address that is used (not all 0xFF's) in the RAM shadow
+  if ( osal_isbufset( bonds[idx].publicAddr, 0xFF, B_ADDR_LEN ) == FALSE )
   {
     gapBondCharCfg_t charCfg[GAP_CHAR_CFG_MAX]; // Space to read a char cfg record from NV
 
-    if ( osal_snv_read( gattCfgNvID(idx), sizeof ( charCfg ), charCfg ) == SUCCESS )
+    if ( gapBondMgrReadCharCfg( idx, charCfg ) == SUCCESS )
     {
       uint8 update = FALSE;
 
-      gapBondMgrInvertCharCfgItem( charCfg );
-
       if ( attrHandle == GATT_INVALID_HANDLE )
       {
         if ( osal_isbufset( (uint8 *)charCfg, 0x00, sizeof ( charCfg ) ) == FALSE )
@@ -1341,7 +1385,7 @@ static uint8 gapBondMgrUpdateCharCfg( uint8 idx, uint16 attrHandle, uint16 value
           if ( ( value == GATT_CFG_NO_OPERATION ) ||
                ( ( pItem = gapBondMgrFindCharCfgItem( GATT_INVALID_HANDLE, charCfg ) ) == NULL ) )
           {
-            return ( FALSE ); // No empty entry found
+            return ( FALSE ); // No empty entry found: the CCC is not saved (see GAP_CHAR_CFG_MAX)
           }
 
           pItem->attrHandle = attrHandle;
@@ -1364,8 +1408,7 @@ static uint8 gapBondMgrUpdateCharCfg( uint8 idx, uint16 attrHandle, uint16 value
       // Update the characteristic configuration of the bonded device.
       if ( update )
       {
-        gapBondMgrInvertCharCfgItem( charCfg );
-        VOID osal_snv_write( gattCfgNvID(idx), sizeof( charCfg ), charCfg );
+        gapBondMgrWriteCharCfg( idx, charCfg );
       }
     }
 
@@ -1375,6 +1418,68 @@ static uint8 gapBondMgrUpdateCharCfg( uint8 idx, uint16 attrHandle, uint16 value
   return ( FALSE );
 }
 
+/*********************************************************************
+ * @fn      gapBondMgrReadCharCfg
+ *
+ * @brief   Read the Characteristic Configuration table of a bond, from
+ *          the RAM copy if it holds that bond, from NV otherwise.
+ *
+ * @param   idx - Bond NV index
+ * @param   charCfgTbl - place to put the table, not inverted
+ *
+ * @return  SUCCESS if read, NV read status otherwise.
+ */
+static bStatus_t gapBondMgrReadCharCfg( uint8 idx, gapBondCharCfg_t *charCfgTbl )
+{
+  uint8 status;
+
+#if ( GAP_BOND_CFG_CACHE == TRUE )
+  if ( idx == cfgCacheIdx )
+  {
+    VOID osal_memcpy( charCfgTbl, cfgCache, sizeof ( cfgCache ) );
+
+    return ( SUCCESS );
+  }
+#endif
+
+  status = osal_snv_read( gattCfgNvID(idx), GAP_CHAR_CFG_MAX * sizeof ( gapBondCharCfg_t ),
+                          charCfgTbl );
+  if ( status == SUCCESS )
+  {
+    gapBondMgrInvertCharCfgItem( charCfgTbl );
+
+#if ( GAP_BOND_CFG_CACHE == TRUE )
+    VOID osal_memcpy( cfgCache, charCfgTbl, sizeof ( cfgCache ) );
+    cfgCacheIdx = idx;
+#endif
+  }
+
+  return ( status );
+}
+
+/*********************************************************************
+ * @fn      gapBondMgrWriteCharCfg
+ *
+ * @brief   Write the Characteristic Configuration table of a bond to NV
+ *          and to the RAM copy.
+ *
+ * @param   idx - Bond NV index
+ * @param   charCfgTbl - table, not inverted; inverted on return
+ *
+ * @return  none
+ */
+static void gapBondMgrWriteCharCfg( uint8 idx, gapBondCharCfg_t *charCfgTbl )
+{
+#if ( GAP_BOND_CFG_CACHE == TRUE )
+  VOID osal_memcpy( cfgCache, charCfgTbl, sizeof ( cfgCache ) );
+  cfgCacheIdx = idx;
+#endif
+
+  gapBondMgrInvertCharCfgItem( charCfgTbl );
+  VOID osal_snv_write( gattCfgNvID(idx), GAP_CHAR_CFG_MAX * sizeof ( gapBondCharCfg_t ),
+                       charCfgTbl );
+}
+
 /*********************************************************************
  * @fn      gapBondMgrFindCharCfgItem
  *
@@ -1452,6 +1557,17 @@ static uint8 gapBondMgrAddBond( gapBondRec_t *pBondRec, gapAuthCompleteEvent_t *
     {
       bondIdx = gapBondMgrFindEmpty();
     }
+
+#if ( GAP_BOND_LRU_EVICT == TRUE )
+    if ( bondIdx >= GAP_BONDINGS_MAX )
+    {
+      // All in use: replace the bond that connected longest ago
+      uint8 idx = gapBondMgrFindOldest();
+
+      VOID gapBondMgrEraseBonding( idx );
+      bondIdx = idx;
+    }
+#endif
   }
 
   if ( bondIdx < GAP_BONDINGS_MAX )
@@ -1472,7 +1588,20 @@ static uint8 gapBondMgrAddBond( gapBondRec_t *pBondRec, gapAuthCompleteEvent_t *
 
       // Update Bond RAM Shadow just with the newly added bond entry
       VOID osal_memcpy( &(bonds[bondIdx]), pBondRec, sizeof ( gapBondRec_t ) );
-      
+      if ( lastRPAIdx == bondIdx )
+      {
+        lastRPAIdx = GAP_BONDINGS_MAX;
+      }
+#if ( GAP_BOND_CFG_CACHE == TRUE )
+      if ( cfgCacheIdx == bondIdx )
+      {
+        cfgCacheIdx = GAP_BONDINGS_MAX;
+      }
+#endif
+#if ( GAP_BOND_LRU_EVICT == TRUE )
+      gapBondMgrTouchBond( bondIdx );
+#endif
+
       // Keep the OSAL message to store the security keys later - will be freed then
       pAuthEvt = pPkt;
     }
@@ -1494,6 +1623,9 @@ static uint8 gapBondMgrAddBond( gapBondRec_t *pBondRec, gapAuthCompleteEvent_t *
       else if ( pAuthEvt->pIdentityInfo )
       {
         VOID osal_snv_write( devIRKNvID(bondIdx), KEYLEN, pAuthEvt->pIdentityInfo->irk );
+#if ( GAP_BOND_IRK_CACHE == TRUE )
+        VOID osal_memcpy( bondIRKs[bondIdx], pAuthEvt->pIdentityInfo->irk, KEYLEN );
+#endif
         pAuthEvt->pIdentityInfo = NULL;
       }
       // If available, save the connected device's Signature information
@@ -1527,7 +1659,8 @@ static uint8 gapBondMgrAddBond( gapBondRec_t *pBondRec, gapAuthCompleteEvent_t *
 /*********************************************************************
  * @fn      gapBondMgrGetStateFlags
  *
- * @brief   Gets the state flags field of a bond record in NV
+ * @brief   Gets the state flags field of a bond record from the RAM
+ *          shadow, which gapBondMgrChangeState keeps in step with NV.
  *
  * @param   idx
  *
@@ -1535,14 +1668,7 @@ static uint8 gapBondMgrAddBond( gapBondRec_t *pBondRec, gapAuthCompleteEvent_t *
  */
 static uint8 gapBondMgrGetStateFlags( uint8 idx )
 {
-  gapBondRec_t bondRec;
-
-  if ( osal_snv_read( mainRecordNvID(idx), sizeof ( gapBondRec_t ), &bondRec ) == SUCCESS )
-  {
-    return ( bondRec.stateFlags );
-  }
-
-  return ( 0 );
+  return ( (uint8)bonds[idx].stateFlags );
 }
 
 /*********************************************************************
@@ -1644,22 +1770,67 @@ static uint8 gapBondMgrFindAddr( uint8 *pDevAddr )
 static uint8 gapBondMgrResolvePrivateAddr( uint8 *pDevAddr )
 {
   uint8 idx;
-  for ( idx = 0; idx < GAP_BONDINGS_MAX; idx++ )
+
+  // Same address as last time, nothing to compute
+  if ( ( lastRPAIdx < GAP_BONDINGS_MAX ) &&
+       osal_memcmp( lastRPA, pDevAddr, B_ADDR_LEN ) )
   {
-    uint8 IRK[KEYLEN];
+    return ( lastRPAIdx );
+  }
 
-    // Read in NV IRK Record and compare resovable address
-    if ( osal_snv_read( devIRKNvID(idx), KEYLEN, IRK ) == SUCCESS )
+  // A new address most likely comes from the device that resolved last
+  if ( ( lastRPAIdx < GAP_BONDINGS_MAX ) && gapBondMgrMatchIRK( lastRPAIdx, pDevAddr ) )
+  {
+    idx = lastRPAIdx;
+  }
+  else
+  {
+    for ( idx = 0; idx < GAP_BONDINGS_MAX; idx++ )
     {
-      if ( ( osal_isbufset( IRK, 0xFF, KEYLEN ) == FALSE ) &&
-           ( GAP_ResolvePrivateAddr( IRK, pDevAddr ) == SUCCESS ) )
+      if ( ( idx != lastRPAIdx ) && gapBondMgrMatchIRK( idx, pDevAddr ) )
       {
-        return ( idx ); // Found it
+        break; // Found it
       }
     }
   }
 
-  return ( GAP_BONDINGS_MAX );
+  if ( idx < GAP_BONDINGS_MAX )
+  {
+    VOID osal_memcpy( lastRPA, pDevAddr, B_ADDR_LEN );
+    lastRPAIdx = idx;
+  }
+
+  return ( idx );
+}
+
+/*********************************************************************
+ * @fn      gapBondMgrMatchIRK
+ *
+ * @brief   Check a resolvable private address against the IRK of one
+ *          bond. Bonds without an IRK are skipped without an AES
+ *          operation.
+ *
+ * @param   idx - bond index
+ * @param   pDevAddr - device address to resolve
+ *
+ * @return  TRUE if the bond's IRK resolves the address, FALSE otherwise
+ */
+static uint8 gapBondMgrMatchIRK( uint8 idx, uint8 *pDevAddr )
+{
+#if ( GAP_BOND_IRK_CACHE == TRUE )
+  uint8 *IRK = bondIRKs[idx];
+#else
+  uint8 IRK[KEYLEN];
+
+  // Read in NV IRK Record
+  if ( osal_snv_read( devIRKNvID(idx), KEYLEN, IRK ) != SUCCESS )
+  {
+    return ( FALSE );
+  }
+#endif
+
+  return ( ( osal_isbufset( IRK, 0xFF, KEYLEN ) == FALSE ) &&
+           ( GAP_ResolvePrivateAddr( IRK, pDevAddr ) == SUCCESS ) );
 }
 
 /*********************************************************************
@@ -1684,8 +1855,25 @@ static void gapBondMgrReadBonds( void )
       VOID osal_memset( bonds[idx].reconnectAddr, 0xFF, B_ADDR_LEN );
       bonds[idx].stateFlags = 0;
     }
+
+#if ( GAP_BOND_IRK_CACHE == TRUE )
+    if ( osal_snv_read( devIRKNvID(idx), KEYLEN, bondIRKs[idx] ) != SUCCESS )
+    {
+      VOID osal_memset( bondIRKs[idx], 0xFF, KEYLEN );
+    }
+#endif
   }
 
+  // The bonds may have changed under the cached address and configuration
+  lastRPAIdx = GAP_BONDINGS_MAX;
+#if ( GAP_BOND_CFG_CACHE == TRUE )
+  cfgCacheIdx = GAP_BONDINGS_MAX;
+#endif
+
+#if ( GAP_BOND_LRU_EVICT == TRUE )
+  gapBondMgrReadBondAge();
+#endif
+
   if ( autoSyncWhiteList )
   {
     gapBondMgr_SyncWhiteList();
@@ -1721,6 +1909,107 @@ static uint8 gapBondMgrFindEmpty( void )
   return ( GAP_BONDINGS_MAX );
 }
 
+#if ( GAP_BOND_LRU_EVICT == TRUE )
+/*********************************************************************
+ * @fn      gapBondMgrFindOldest
+ *
+ * @brief   Find the bond that connected longest ago.
+ *
+ * @param   none
+ *
+ * @return  index to the oldest bonding (0 - (GAP_BONDINGS_MAX-1))
+ */
+static uint8 gapBondMgrFindOldest( void )
+{
+  uint8 idx;
+  uint8 oldest = 0;
+
+  for ( idx = 1; idx < GAP_BONDINGS_MAX; idx++ )
+  {
+    if ( bondAge[idx] > bondAge[oldest] )
+    {
+      oldest = idx;
+    }
+  }
+
+  return ( oldest );
+}
+
+/*********************************************************************
+ * @fn      gapBondMgrTouchBond
+ *
+ * @brief   Make a bond the one that connected last. NV is only written
+ *          when the order changes, so a phone that reconnects again and
+ *          again costs no flash write.
+ *
+ * @param   idx - bonding index
+ *
+ * @return  none
+ */
+static void gapBondMgrTouchBond( uint8 idx )
+{
+  uint8 i;
+
+  if ( bondAge[idx] == 0 )
+  {
+    return;
+  }
+
+  for ( i = 0; i < GAP_BONDINGS_MAX; i++ )
+  {
+    if ( bondAge[i] < bondAge[idx] )
+    {
+      bondAge[i]++;
+    }
+  }
+  bondAge[idx] = 0;
+
+  VOID osal_snv_write( bondLRUNvID, sizeof ( bondAge ), bondAge );
+}
+
+/*********************************************************************
+ * @fn      gapBondMgrReadBondAge
+ *
+ * @brief   Read the connection order of the bonds from NV. Without a
+ *          valid one, as after an update from a firmware that did not
+ *          keep it, the bonds are taken to have connected in index order.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void gapBondMgrReadBondAge( void )
+{
+  uint8 seen[GAP_BONDINGS_MAX];
+  uint8 idx;
+
+  VOID osal_memset( seen, FALSE, sizeof ( seen ) );
+
+  if ( osal_snv_read( bondLRUNvID, sizeof ( bondAge ), bondAge ) == SUCCESS )
+  {
+    // Each age must appear once
+    for ( idx = 0; idx < GAP_BONDINGS_MAX; idx++ )
+    {
+      if ( ( bondAge[idx] >= GAP_BONDINGS_MAX ) || seen[bondAge[idx]] )
+      {
+        break;
+      }
+      seen[bondAge[idx]] = TRUE;
+    }
+
+    if ( idx == GAP_BONDINGS_MAX )
+    {
+      return;
+    }
+  }
+
+  for ( idx = 0; idx < GAP_BONDINGS_MAX; idx++ )
+  {
+    bondAge[idx] = idx;
+  }
+}
+#endif // GAP_BOND_LRU_EVICT
+
 /*********************************************************************
  * @fn      gapBondMgrBondTotal
  *
@@ -1815,24 +2104,39 @@ static bStatus_t gapBondMgrEraseBonding( uint8 idx )
   if ( ( osal_snv_read( mainRecordNvID(idx), sizeof ( gapBondRec_t ), &bondRec ) == SUCCESS )
        && (osal_isbufset( bondRec.publicAddr, 0xFF, B_ADDR_LEN ) == FALSE) )
   {
-    gapBondLTK_t ltk;
-    gapBondCharCfg_t charCfg[GAP_CHAR_CFG_MAX];
+    union
+    {
+      gapBondLTK_t ltk;
+      gapBondCharCfg_t charCfg[GAP_CHAR_CFG_MAX];
+    } work;   // Work space, large enough for any bond item
 
     VOID osal_memset( &bondRec, 0xFF, sizeof ( gapBondRec_t ) );
-    VOID osal_memset( &ltk, 0xFF, sizeof ( gapBondLTK_t ) );
 
-    VOID osal_memset( charCfg, 0xFF, sizeof ( charCfg ) );
-
-    // Write out FF's over the entire bond entry.
+    // Write out FF's over the entire bond entry. Keys the device never
+    // distributed have no NV item and are not created.
     ret = osal_snv_write( mainRecordNvID(idx), sizeof ( gapBondRec_t ), &bondRec );
-    ret |= osal_snv_write( localLTKNvID(idx), sizeof ( gapBondLTK_t ), &ltk );
-    ret |= osal_snv_write( devLTKNvID(idx), sizeof ( gapBondLTK_t ), &ltk );
-    ret |= osal_snv_write( devIRKNvID(idx), KEYLEN, ltk.LTK );
-    ret |= osal_snv_write( devCSRKNvID(idx), KEYLEN, ltk.LTK );
-    ret |= osal_snv_write( devSignCounterNvID(idx), sizeof ( uint32 ), ltk.LTK );
+    ret |= gapBondMgrEraseItem( localLTKNvID(idx), sizeof ( gapBondLTK_t ), &work );
+    ret |= gapBondMgrEraseItem( devLTKNvID(idx), sizeof ( gapBondLTK_t ), &work );
+    ret |= gapBondMgrEraseItem( devIRKNvID(idx), KEYLEN, &work );
+    ret |= gapBondMgrEraseItem( devCSRKNvID(idx), KEYLEN, &work );
+    ret |= gapBondMgrEraseItem( devSignCounterNvID(idx), sizeof ( uint32 ), &work );
 
     // Write out FF's over the charactersitic configuration entry.
-    ret |= osal_snv_write( gattCfgNvID(idx), sizeof ( charCfg ), charCfg );
+    ret |= gapBondMgrEraseItem( gattCfgNvID(idx), sizeof ( work.charCfg ), &work );
+
+#if ( GAP_BOND_IRK_CACHE == TRUE )
+    VOID osal_memset( bondIRKs[idx], 0xFF, KEYLEN );
+#endif
+    if ( lastRPAIdx == idx )
+    {
+      lastRPAIdx = GAP_BONDINGS_MAX;
+    }
+#if ( GAP_BOND_CFG_CACHE == TRUE )
+    if ( cfgCacheIdx == idx )
+    {
+      cfgCacheIdx = GAP_BONDINGS_MAX;
+    }
+#endif
   }
   else
   {
@@ -1842,6 +2146,31 @@ static bStatus_t gapBondMgrEraseBonding( uint8 idx )
   return ( ret );
 }
 
+/*********************************************************************
+ * @fn      gapBondMgrEraseItem
+ *
+ * @brief   Write all 0xFF's over a bond NV item, if it exists.
+ *
+ * @param   id - NV ID of the item
+ * @param   len - item length
+ * @param   pBuf - work space of len bytes
+ *
+ * @return  SUCCESS if erased or not there.
+ *          Otherwise, NV_OPER_FAILED for failure.
+ */
+static bStatus_t gapBondMgrEraseItem( osalSnvId_t id, osalSnvLen_t len, void *pBuf )
+{
+  if ( osal_snv_read( id, len, pBuf ) != SUCCESS )
+  {
+    return ( SUCCESS );
+  }
+
+  // An item already erased is not written again by osal_snv_write
+  VOID osal_memset( pBuf, 0xFF, len );
+
+  return ( osal_snv_write( id, len, pBuf ) );
+}
+
 /*********************************************************************
  * @brief   Task Initialization function.
  *
@@ -2002,6 +2331,13 @@ uint8 GAPBondMgr_CheckNVLen( uint8 id, uint8 len )
 {
   uint8 stat = FAILURE;
 
+#if ( GAP_BOND_LRU_EVICT == TRUE )
+  if ( id == bondLRUNvID )
+  {
+    return ( ( len == GAP_BONDINGS_MAX ) ? SUCCESS : FAILURE );
+  }
+#endif
+
   // Convert to index
   switch ( (id - BLE_NVID_GAP_BOND_START) % GAP_BOND_REC_IDS )
   {
@@ -89,11 +89,30 @@ extern "C"
  */
 
 #if !defined ( GAP_BONDINGS_MAX )
-  #define GAP_BONDINGS_MAX    10    //!< Maximum number of bonds that can be saved in NV.
+  #define GAP_BONDINGS_MAX    10    //!< Maximum number of bonds that can be saved in NV. At most 10: bounded by the GAP bond and GATT configuration NV ID ranges in bcomdef.h.
 #endif
 
 #if !defined ( GAP_CHAR_CFG_MAX )
   #define GAP_CHAR_CFG_MAX    4    //!< Maximum number of characteristic configuration that can be saved in NV.
+                               //!< The first 4 CCCs a bonded client enables are kept; a CCC enabled after them is not saved and
+                               //!< is off on reconnection. With the 5 CCCs of this firmware that is in practice one of the OAD
+                               //!< CCCs, which the OAD client enables again on each connection. Changing this changes the length
+                               //!< of the NV record, so existing bonds fail to read.
+#endif
+
+#if !defined ( GAP_BOND_IRK_CACHE )
+  #define GAP_BOND_IRK_CACHE  TRUE //!< Keep each bond's IRK in RAM (KEYLEN bytes per bond) instead of reading NV to resolve an address.
+                                   //!< The last address resolved is kept with it: that address again costs no AES operation and a new
+                                   //!< address of the same bond costs one. A new address of any other bond costs one AES operation more
+                                   //!< than a search in bond order, spent on the bond that resolved last.
+#endif
+
+#if !defined ( GAP_BOND_CFG_CACHE )
+  #define GAP_BOND_CFG_CACHE  TRUE //!< Keep the characteristic configuration of the last bond used in RAM, so its reconnection restores it without reading NV.
+#endif
+
+#if !defined ( GAP_BOND_LRU_EVICT )
+  #define GAP_BOND_LRU_EVICT  TRUE //!< When all bonds are in use, a new bond replaces the least recently connected one instead of failing to be saved.
 #endif
 /** @defgroup GAPBOND_CONSTANTS_NAME GAP Bond Manager Constants
  * @{
@@ -56,6 +56,7 @@
 #include "hal_drivers.h"
 #include "hal_led.h"
 #include "hal_uart.h"
+#include "hal_log.h"
 
 /* OSAL */
 #include "OSAL.h"
@@ -114,8 +115,8 @@ int main(void)
     uartConfig.intEnable          = FALSE;
     uartConfig.callBackFunc       = NULL;
     (void)HalUARTOpen( HAL_UART_PORT_1, &uartConfig );
-    HalUARTWrite ( HAL_UART_PORT_1, "BOOT\n", 5 );
   #endif
+  HAL_LOG_INFO( HAL_LOG_ID_BOOT, NULL, 0 );
 
   #if defined ( POWER_SAVING )
     osal_pwrmgr_device( PWRMGR_BATTERY );
@@ -60,16 +60,14 @@
 #include "hal_key.h"
 #include "hal_uart.h"
 #include "hal_buzzer.h"
+#include "hal_log.h"
 
-#if (defined HAL_UART) && (HAL_UART == TRUE)
-#include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
-#endif
 
 #include "gatt.h"
 
 #include "hci.h"
+#include "linkdb.h"
 
 #include "gapgattserver.h"
 #include "gattservapp.h"
@@ -83,6 +81,9 @@
 
 #include "simpleBLEPeripheral.h"
 #include "battservice.h"
+#if defined FEATURE_DIAG
+#include "diagservice.h"
+#endif
 
 #if defined FEATURE_OAD
   #include "oad.h"
@@ -100,9 +101,6 @@
 // How often to perform periodic event
 #define SBP_PERIODIC_EVT_PERIOD                   0
 
-// What is the advertising interval when device is discoverable (units of 625us, 160=100ms)
-#define DEFAULT_ADVERTISING_INTERVAL          160
-
 // Limited discoverable mode advertises for 30.72s, and then stops
 // General discoverable mode advertises indefinitely
 // We don't want to advertise too long, we want it to enter sleep
@@ -117,14 +115,16 @@
 // Maximum connection interval (units of 1.25ms, 800=1000ms) if automatic parameter update request is enabled
 #define DEFAULT_DESIRED_MAX_CONN_INTERVAL     800
 
-// Slave latency to use if automatic parameter update request is enabled
-#define DEFAULT_DESIRED_SLAVE_LATENCY         0
+// Slave latency to use if automatic parameter update request is enabled.
+// iOS requires max interval * (latency + 1) <= 2s.
+#define DEFAULT_DESIRED_SLAVE_LATENCY         1
 
 // Supervision timeout value (units of 10ms, 1000=10s) if automatic parameter update request is enabled
 #define DEFAULT_DESIRED_CONN_TIMEOUT          1000
 
-// Whether to enable automatic parameter update request when a connection is formed
-#define DEFAULT_ENABLE_UPDATE_REQUEST         TRUE
+// Whether to enable automatic parameter update request when a connection is formed.
+// Off: the connection parameter manager below picks parameters from the activity.
+#define DEFAULT_ENABLE_UPDATE_REQUEST         FALSE
 
 // Connection Pause Peripheral time value (in seconds)
 #define DEFAULT_CONN_PAUSE_PERIPHERAL         6
@@ -140,13 +140,63 @@
 // Battery level is critical when it is less than this %
 #define DEFAULT_BATT_CRITICAL_LEVEL           6 
 
-// Battery measurement period in ms
+// Battery measurement period in ms. The period starts at DEFAULT_BATT_PERIOD
+// and doubles after every measurement that moved less than BATT_STABLE_MV,
+// up to BATT_PERIOD_MAX.
 #define DEFAULT_BATT_PERIOD                   15000
+#define BATT_PERIOD_MAX                       240000
+
+// Voltage change between measurements below which the battery is stable
+#define BATT_STABLE_MV                        10
+
+// A measurement due within 1/2^BATT_PIGGYBACK_SHIFT of the period is taken
+// early when the application is awake anyway, saving a dedicated wakeup
+#define BATT_PIGGYBACK_SHIFT                  2
+
+// Indices into advPolicy[]
+#define ADV_POLICY_DIRECTED                   0
+#define ADV_POLICY_BURST                      1
+#define ADV_POLICY_STEPS                      ( sizeof( advPolicy ) / sizeof( advPolicy[0] ) )
+#define ADV_POLICY_IDLE                       0xFF
+
+// Connection activities; the fastest profile any active one needs wins
+#define CONN_ACTIVITY_OAD                     0x01
+#define CONN_ACTIVITY_CERT                    0x02
+#define CONN_ACTIVITY_NOTIFY                  0x04
+
+// Indices into connParamProfiles[]
+#define CONN_PROFILE_FAST                     0
+#define CONN_PROFILE_NOTIFY                   1
+#define CONN_PROFILE_IDLE                     2
+#define CONN_PROFILE_NONE                     0xFF
+
+// An activity is dropped this many ms after it was last seen
+#define CONN_ACTIVITY_HOLD                    3000
+
+// Minimum time between two connection parameter update requests in ms
+#define CONN_PARAM_MIN_GAP                    5000
 
 /*********************************************************************
  * TYPEDEFS
  */
 
+// One step of the advertising policy
+typedef struct
+{
+  uint8 eventType;    // GAP_ADTYPE_ADV_IND or GAP_ADTYPE_ADV_HDC_DIRECT_IND
+  uint16 interval;    // units of 625us, unused for high duty cycle directed
+  uint16 duration;    // ms, 0 = until the stack ends it
+} advPolicyStep_t;
+
+// Connection parameters requested for one activity profile
+typedef struct
+{
+  uint16 minInterval;   // units of 1.25ms
+  uint16 maxInterval;   // units of 1.25ms
+  uint16 latency;       // connection events
+  uint16 timeout;       // units of 10ms
+} connParamProfile_t;
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -218,6 +268,49 @@ typedef enum
 }PAIRSTATUS;  
 static PAIRSTATUS gPairStatus = PAIRSTATUS_NO_PAIRED;//PAIRSTATUSnot paired by default 
 
+// Advertising policy. After a disconnect from a bonded central with a public
+// or static address the device first sends high duty cycle directed
+// advertisements to it (1.28s, ended by the controller); a button press or
+// boot starts at the 20ms burst. Each step then backs off to a longer
+// interval, and every step stays below the 30s limited discoverable timeout.
+// tools/adv_policy_model.py reads this table to estimate discovery latency
+// against average current.
+static CONST advPolicyStep_t advPolicy[] =
+{
+  { GAP_ADTYPE_ADV_HDC_DIRECT_IND,    0,     0 },   // bonded central only
+  { GAP_ADTYPE_ADV_IND,              32,  5000 },   // 20ms
+  { GAP_ADTYPE_ADV_IND,             244, 10000 },   // 152.5ms
+  { GAP_ADTYPE_ADV_IND,            1636, 15000 }    // 1022.5ms
+};
+
+// Current advertising step, or ADV_POLICY_IDLE
+static uint8 advPolicyStep = ADV_POLICY_IDLE;
+
+// Advertising was stopped to apply new parameters and restarts on GAPROLE_WAITING
+static uint8 advPolicyRestart = FALSE;
+
+// Identity of the last bonded central, target of directed advertising
+static uint8 advDirectValid = FALSE;
+static uint8 advDirectAddrType;
+static uint8 advDirectAddr[B_ADDR_LEN];
+
+// Connection parameter profiles, indexed by CONN_PROFILE_*
+static CONST connParamProfile_t connParamProfiles[] =
+{
+  {   6,  12, 0, 200 },                                       // OAD, certificate: 7.5-15ms
+  {  24,  40, 0, 300 },                                       // notification burst: 30-50ms
+  { DEFAULT_DESIRED_MIN_CONN_INTERVAL, DEFAULT_DESIRED_MAX_CONN_INTERVAL,
+    DEFAULT_DESIRED_SLAVE_LATENCY, DEFAULT_DESIRED_CONN_TIMEOUT }  // idle
+};
+
+// Active CONN_ACTIVITY_* bits and the last profile requested from the central
+static uint8 connActivity;
+static uint8 connParamProfile = CONN_PROFILE_NONE;
+
+// Current battery measurement period and the voltage it was measured at
+static uint32 battPeriod = DEFAULT_BATT_PERIOD;
+static uint16 battLastVoltage;
+
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
@@ -227,13 +320,27 @@ static void peripheralStateNotificationCB( gaprole_States_t newState );
 static void performPeriodicTask( void );
 static void pgpDeviceControlChangeCB( uint8 paramID );
 static void pgpCertificateChangeCB( uint8 paramID );
-static void simpleBLEPeripheral_HandleKeys( uint8 shift, uint8 keys );
+static void simpleBLEPeripheral_HandleKeys( uint8 gesture, uint8 keys );
 static void pokemonGoPlusBattPeriodicTask( void );
+static void pokemonGoPlusBattPiggyback( void );
 static void pokemonGoPlusBattCB(uint8 event);
-static void simpleBLEPeripheralBuzzerRing(uint8 *melody,uint8 len);
+static void simpleBLEPeripheral_AdvStart( uint8 reconnect );
+static void simpleBLEPeripheral_AdvApply( void );
+static void simpleBLEPeripheral_AdvNextStep( void );
+static void simpleBLEPeripheral_AdvWaiting( gaprole_States_t oldState );
+static void simpleBLEPeripheral_AdvSetPeer( uint16 connHandle );
+static void simpleBLEPeripheral_ConnActivity( uint8 activity );
+static void simpleBLEPeripheral_ConnParamUpdate( void );
+static void simpleBLEPeripheral_ConnParamStop( void );
+#if defined FEATURE_OAD
+static void simpleBLEPeripheral_OadWriteCB( uint16 connHandle );
+#endif
+#if defined KEY_BUZZER_FEEDBACK
+static void simpleBLEPeripheralBuzzerRing(const uint8 *melody,uint16 len);
 static void simpleBLEPeripheralBuzzerCompleteCback( void );
+#endif
 
-void ProcessPasscodeCB(uint8 *deviceAddr,uint16 connectionHandle,uint8 uiInputs,uint8 uiOutputs );
+static void ProcessPasscodeCB(uint8 *deviceAddr,uint16 connectionHandle,uint8 uiInputs,uint8 uiOutputs );
 static void ProcessPairStateCB( uint16 connHandle, uint8 state, uint8 status );
 
 /*********************************************************************
@@ -290,13 +397,9 @@ void SimpleBLEPeripheral_Init( uint8 task_id )
   
   // Setup the GAP Peripheral Role Profile
   {
-    #if defined( CC2540_MINIDK )
-      // For the CC2540DK-MINI keyfob, device doesn't start advertising until button is pressed
-      uint8 initial_advertising_enable = FALSE;
-    #else
-      // For other hardware platforms, device starts advertising upon initialization
-      uint8 initial_advertising_enable = TRUE;
-    #endif
+    // Advertising is started by the advertising policy once the device is up
+    // (see GAPROLE_STARTED), so the parameters of its first step are in place
+    uint8 initial_advertising_enable = FALSE;
 
     // By setting this to zero, the device will go into the waiting state after
     // being discoverable for 30.72 second, and will not being advertising again
@@ -329,16 +432,6 @@ void SimpleBLEPeripheral_Init( uint8 task_id )
   // Set the GAP Characteristics
   GGS_SetParameter( GGS_DEVICE_NAME_ATT, GAP_DEVICE_NAME_LEN, attDeviceName );
 
-  // Set advertising interval
-  {
-    uint16 advInt = DEFAULT_ADVERTISING_INTERVAL;
-
-    GAP_SetParamValue( TGAP_LIM_DISC_ADV_INT_MIN, advInt );
-    GAP_SetParamValue( TGAP_LIM_DISC_ADV_INT_MAX, advInt );
-    GAP_SetParamValue( TGAP_GEN_DISC_ADV_INT_MIN, advInt );
-    GAP_SetParamValue( TGAP_GEN_DISC_ADV_INT_MAX, advInt );
-  }
-
   // Setup the GAP Bond Manager
   {
     uint32 passkey = 0; // passkey "000000"
@@ -367,6 +460,9 @@ void SimpleBLEPeripheral_Init( uint8 task_id )
   PgpDeviceControl_AddService( GATT_ALL_SERVICES );  // Simple GATT Profile
   PgpCertificate_AddService( GATT_ALL_SERVICES );    // Simple GATT Profile
   Batt_AddService( );
+#if defined FEATURE_DIAG
+  Diag_AddService();                              // Sleep statistics
+#endif
 #if defined FEATURE_OAD
   VOID OADTarget_AddService();                    // OAD Profile
 #endif
@@ -424,6 +520,14 @@ void SimpleBLEPeripheral_Init( uint8 task_id )
   // Register for Battery service callback;
   Batt_Register ( pokemonGoPlusBattCB );
 
+  // Retry notifications that found the link layer out of buffers
+  GATTServApp_InitNotiQueue( simpleBLEPeripheral_TaskID, SBP_NOTI_RETRY_EVT );
+
+#if defined FEATURE_OAD
+  // Keep the connection fast while an image is transferred
+  OADTarget_Register( simpleBLEPeripheral_OadWriteCB );
+#endif
+
   // Enable clock divide on halt
   // This reduces active current while radio is active and CC254x MCU
   // is halted
@@ -464,6 +568,8 @@ uint16 SimpleBLEPeripheral_ProcessEvent( uint8 task_id, uint16 events )
       VOID osal_msg_deallocate( pMsg );
     }
 
+    pokemonGoPlusBattPiggyback();
+
     // return unprocessed events
     return (events ^ SYS_EVENT_MSG);
   }
@@ -503,6 +609,39 @@ uint16 SimpleBLEPeripheral_ProcessEvent( uint8 task_id, uint16 events )
     return (events ^ BATT_PERIODIC_EVT);
   } 
 
+  if ( events & SBP_ADV_STEP_EVT )
+  {
+    // Back off to the next advertising step
+    simpleBLEPeripheral_AdvNextStep();
+
+    return (events ^ SBP_ADV_STEP_EVT);
+  }
+
+  if ( events & SBP_CONN_ACTIVITY_EVT )
+  {
+    // Nothing happened for CONN_ACTIVITY_HOLD, fall back to idle
+    connActivity = 0;
+    simpleBLEPeripheral_ConnParamUpdate();
+
+    return (events ^ SBP_CONN_ACTIVITY_EVT);
+  }
+
+  if ( events & SBP_CONN_PARAM_EVT )
+  {
+    // Rate limit window over, request whatever is wanted now
+    simpleBLEPeripheral_ConnParamUpdate();
+
+    return (events ^ SBP_CONN_PARAM_EVT);
+  }
+
+  if ( events & SBP_NOTI_RETRY_EVT )
+  {
+    // A connection event ended with notifications still queued
+    GATTServApp_ProcessNotiQueue();
+
+    return (events ^ SBP_NOTI_RETRY_EVT);
+  }
+
   // Discard unknown events
   return 0;
 }
@@ -543,67 +682,53 @@ static void simpleBLEPeripheral_ProcessOSALMsg( osal_event_hdr_t *pMsg )
  *
  * @brief   Handles all key events for this device.
  *
- * @param   shift - true if in shift/alt.
+ * @param   gesture - HAL_KEY_GESTURE_* classified by the HAL
  * @param   keys - bit field for key events. Valid entries:
- *                 HAL_KEY_SW_2
- *                 HAL_KEY_SW_1
+ *                 HAL_PUSH_BUTTON
  *
  * @return  none
  */
-static void simpleBLEPeripheral_HandleKeys( uint8 shift, uint8 keys )
+static void simpleBLEPeripheral_HandleKeys( uint8 gesture, uint8 keys )
 {
-  static uint8 handleKeysSavedKeys=0;
-  static uint32 keyDownTime=0;
-
-  VOID shift;  // Intentionally unreferenced parameter
-
-  if ((keys & HAL_PUSH_BUTTON)!=(handleKeysSavedKeys & HAL_PUSH_BUTTON)){
-    if ( keys & HAL_PUSH_BUTTON ){
-      keyDownTime = osal_GetSystemClock();
-      #if (defined HAL_UART) && (HAL_UART == TRUE)
-        HalUARTWrite ( HAL_UART_PORT_1, "KEY down\n", 9 );
-      #endif
-    }else{
-      uint16 keyPressDuration=osal_GetSystemClock()-keyDownTime;
-      #if (defined HAL_UART) && (HAL_UART == TRUE)
-        HalUARTWrite ( HAL_UART_PORT_1, "KEY UP\n", 7 );
-        {
-          char buf[16];
-          sprintf(buf,"%d\n",keyPressDuration);
-          uint8 strLength=strlen(buf);
-          HalUARTWrite ( HAL_UART_PORT_1, (uint8 *)buf, strLength );
-        }
-      #endif
-      if (keyPressDuration<300){
+  if ( keys & HAL_PUSH_BUTTON ){
+    HAL_LOG_DEBUG( HAL_LOG_ID_KEY_GESTURE, &gesture, 1 );
+
+    // Any press while unconnected restarts the fast advertising burst
+    if ( gapProfileState != GAPROLE_CONNECTED )
+    {
+      simpleBLEPeripheral_AdvStart( FALSE );
+    }
+
+    switch ( gesture ){
+      // Each short press is one button press; a double click arrives as CLICK then DOUBLE
+      case HAL_KEY_GESTURE_CLICK:
+      case HAL_KEY_GESTURE_DOUBLE:
+      {
+        simpleBLEPeripheral_ConnActivity( CONN_ACTIVITY_NOTIFY );
+
         uint8 buttonValue=0x0F;
         PgpDeviceControl_SetParameter( BUTTON_NOTIF_CHAR, sizeof ( uint8 ), &buttonValue );
  
         uint8 data[]={3,0,0,0};
         PgpCertificate_SetParameter(SFIDA_COMMANDS_CHAR, 4, data);  
-          
-
-      }
-      if (keyPressDuration>2500){     //long press
-        uint8 current_adv_enabled_status;
-        GAPRole_GetParameter( GAPROLE_ADVERT_ENABLED, &current_adv_enabled_status );
-        if (!current_adv_enabled_status){
-          uint8 new_adv_enabled_status=true;
-          GAPRole_SetParameter( GAPROLE_ADVERT_ENABLED, sizeof( uint8 ), &new_adv_enabled_status );
-        }
-      }
-      { //test buzzer
-        //tone,duration(25ms).....
-        uint8 melody[]={
-          HAL_BUZZER_TONE_C6,5,HAL_BUZZER_TONE_D6,5,HAL_BUZZER_TONE_E6,5,HAL_BUZZER_TONE_F6,5,HAL_BUZZER_TONE_G6,5,
-          HAL_BUZZER_TONE_A6,5,HAL_BUZZER_TONE_B6,5,HAL_BUZZER_TONE_C7,5
-        };
-        simpleBLEPeripheralBuzzerRing( melody, 16 );
+        break;
       }
+
+      default:
+        break;
+    }
+#if defined KEY_BUZZER_FEEDBACK
+    { // Audible feedback for every gesture, only in builds that ask for it
+      //tone,duration(25ms).....  played in place, so it has to outlive the call
+      static CONST uint8 melody[]={
+        HAL_BUZZER_TONE_C6,5,HAL_BUZZER_TONE_D6,5,HAL_BUZZER_TONE_E6,5,HAL_BUZZER_TONE_F6,5,HAL_BUZZER_TONE_G6,5,
+        HAL_BUZZER_TONE_A6,5,HAL_BUZZER_TONE_B6,5,HAL_BUZZER_TONE_C7,5
+      };
+      simpleBLEPeripheralBuzzerRing( melody, sizeof( melody ) );
     }
+#endif
   }
   
-  
-  handleKeysSavedKeys=keys;
 /*
   if ( keys & HAL_KEY_SW_2 )
   {
@@ -672,8 +797,11 @@ static void peripheralStateNotificationCB( gaprole_States_t newState )
 #ifdef PLUS_BROADCASTER
   static uint8 first_conn_flag = 0;
 #endif // PLUS_BROADCASTER
-  
-  
+  gaprole_States_t oldState = gapProfileState;
+
+  // Update the state first; the handlers below may restart advertising
+  gapProfileState = newState;
+
   switch ( newState )
   {
     case GAPROLE_STARTED:
@@ -699,6 +827,10 @@ static void peripheralStateNotificationCB( gaprole_States_t newState )
 
         DevInfo_SetParameter(DEVINFO_SYSTEM_ID, DEVINFO_SYSTEM_ID_LEN, systemId);
 
+#if !defined( CC2540_MINIDK )
+        // The CC2540DK-MINI keyfob doesn't advertise until a button is pressed
+        simpleBLEPeripheral_AdvStart( FALSE );
+#endif
       }
       break;
 
@@ -706,9 +838,7 @@ static void peripheralStateNotificationCB( gaprole_States_t newState )
       {
         //Called when ADVERTISING Starts
         HalLedBlink( HAL_LED_2_BLUE, 0, 5, 2000 );
-        #if (defined HAL_UART) && (HAL_UART == TRUE)
-          HalUARTWrite ( HAL_UART_PORT_1, "GAPROLE_ADVERTISING\n", 20 );
-        #endif
+        HAL_LOG_INFO( HAL_LOG_ID_GAPROLE_ADV, NULL, 0 );
       }
       break;
 
@@ -735,9 +865,22 @@ static void peripheralStateNotificationCB( gaprole_States_t newState )
     case GAPROLE_CONNECTED:
       {        
         HalLedBlink( HAL_LED_2_BLUE, 0, 2, 5000 );
-        #if (defined HAL_UART) && (HAL_UART == TRUE)
-          HalUARTWrite ( HAL_UART_PORT_1, "GAPROLE_CONNECTED\n", 18 );
-        #endif
+        HAL_LOG_INFO( HAL_LOG_ID_GAPROLE_CONN, NULL, 0 );
+
+        // Advertising stopped with the connection; drop the policy
+        osal_stop_timerEx( simpleBLEPeripheral_TaskID, SBP_ADV_STEP_EVT );
+        advPolicyStep = ADV_POLICY_IDLE;
+        advPolicyRestart = FALSE;
+
+        // The certificate handshake follows right away. The first parameter
+        // request waits out TGAP(conn_pause_peripheral), so the handshake is
+        // held until CONN_ACTIVITY_HOLD after it and that request is FAST.
+        connActivity = CONN_ACTIVITY_CERT;
+        connParamProfile = CONN_PROFILE_NONE;
+        osal_start_timerEx( simpleBLEPeripheral_TaskID, SBP_CONN_ACTIVITY_EVT,
+                            DEFAULT_CONN_PAUSE_PERIPHERAL * 1000UL + CONN_ACTIVITY_HOLD );
+        osal_start_timerEx( simpleBLEPeripheral_TaskID, SBP_CONN_PARAM_EVT,
+                            DEFAULT_CONN_PAUSE_PERIPHERAL * 1000UL );
           
 #ifdef PLUS_BROADCASTER
         // Only turn advertising on for this state when we first connect
@@ -775,10 +918,14 @@ static void peripheralStateNotificationCB( gaprole_States_t newState )
       {
         //Called when ADVERTISING Ends
         HalLedSet(HAL_LED_2_BLUE, HAL_LED_MODE_OFF );
-        #if (defined HAL_UART) && (HAL_UART == TRUE)
-          HalUARTWrite ( HAL_UART_PORT_1, "GAPROLE_WAITING\n", 16 );
-        #endif
-          
+        HAL_LOG_INFO( HAL_LOG_ID_GAPROLE_WAIT, NULL, 0 );
+
+        simpleBLEPeripheral_ConnParamStop();
+        simpleBLEPeripheral_AdvWaiting( oldState );
+
+        // Drop the notifications still queued for the closed link
+        GATTServApp_ProcessNotiQueue();
+
 #ifdef PLUS_BROADCASTER                
         uint8 advertEnabled = TRUE;
       
@@ -794,7 +941,13 @@ static void peripheralStateNotificationCB( gaprole_States_t newState )
         #if (defined HAL_LCD) && (HAL_LCD == TRUE)
           //HalLcdWriteString( "Timed Out",  HAL_LCD_LINE_3 );
         #endif // (defined HAL_LCD) && (HAL_LCD == TRUE)
-          
+
+        simpleBLEPeripheral_ConnParamStop();
+        simpleBLEPeripheral_AdvWaiting( oldState );
+
+        // Drop the notifications still queued for the closed link
+        GATTServApp_ProcessNotiQueue();
+
 #ifdef PLUS_BROADCASTER
         // Reset flag for next connection.
         first_conn_flag = 0;
@@ -820,8 +973,6 @@ static void peripheralStateNotificationCB( gaprole_States_t newState )
 
   }
 
-  gapProfileState = newState;
-
 #if !defined( CC2540_MINIDK )
   VOID gapProfileState;     // added to prevent compiler warning with
                             // "CC2540 Slave" configurations
@@ -843,10 +994,13 @@ static void pokemonGoPlusBattCB(uint8 event)
 {
   if (event == BATT_LEVEL_NOTI_ENABLED)
   {
-    // if connected start periodic measurement
+    // if connected start periodic measurement, treating the first
+    // reading as a change so the period starts short
     if (gapProfileState == GAPROLE_CONNECTED)
     {
-      osal_start_timerEx( simpleBLEPeripheral_TaskID, BATT_PERIODIC_EVT, DEFAULT_BATT_PERIOD );
+      battPeriod = DEFAULT_BATT_PERIOD;
+      battLastVoltage = 0;
+      osal_start_timerEx( simpleBLEPeripheral_TaskID, BATT_PERIODIC_EVT, battPeriod );
     } 
   }
   else if (event == BATT_LEVEL_NOTI_DISABLED)
@@ -859,7 +1013,10 @@ static void pokemonGoPlusBattCB(uint8 event)
 /*********************************************************************
  * @fn      pokemonGoPlusBattPeriodicTask
  *
- * @brief   Perform a periodic task for battery measurement.
+ * @brief   Perform a periodic task for battery measurement. The
+ *          period stretches while the voltage is stable and drops
+ *          back to DEFAULT_BATT_PERIOD as soon as it moves or the
+ *          battery is critical.
  *
  * @param   none
  *
@@ -869,14 +1026,347 @@ static void pokemonGoPlusBattPeriodicTask( void )
 {
   if (gapProfileState == GAPROLE_CONNECTED)
   {
+    uint16 voltage;
+    uint16 delta;
+    uint8 level;
+
     // perform battery level check
     Batt_MeasLevel( );
-    
+
+    Batt_GetParameter( BATT_PARAM_VOLTAGE, &voltage );
+    Batt_GetParameter( BATT_PARAM_LEVEL, &level );
+
+    delta = ( voltage > battLastVoltage ) ? voltage - battLastVoltage
+                                          : battLastVoltage - voltage;
+    battLastVoltage = voltage;
+
+    if ( delta > BATT_STABLE_MV || level < DEFAULT_BATT_CRITICAL_LEVEL )
+    {
+      battPeriod = DEFAULT_BATT_PERIOD;
+    }
+    else if ( battPeriod < BATT_PERIOD_MAX )
+    {
+      battPeriod <<= 1;
+      if ( battPeriod > BATT_PERIOD_MAX )
+      {
+        battPeriod = BATT_PERIOD_MAX;
+      }
+    }
+
     // Restart timer
-    osal_start_timerEx( simpleBLEPeripheral_TaskID, BATT_PERIODIC_EVT, DEFAULT_BATT_PERIOD );
+    osal_start_timerEx( simpleBLEPeripheral_TaskID, BATT_PERIODIC_EVT, battPeriod );
+  }
+}
+
+/*********************************************************************
+ * @fn      pokemonGoPlusBattPiggyback
+ *
+ * @brief   Bring the next battery measurement forward if it is nearly
+ *          due. Called from paths where the MCU is already awake so the
+ *          ADC read does not cost a wakeup of its own. The measurement
+ *          runs as BATT_PERIODIC_EVT after the caller returns, never
+ *          inside a GATT callback.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void pokemonGoPlusBattPiggyback( void )
+{
+  uint32 remaining = osal_get_timeoutEx( simpleBLEPeripheral_TaskID, BATT_PERIODIC_EVT );
+
+  if ( remaining != 0 && remaining <= ( battPeriod >> BATT_PIGGYBACK_SHIFT ) )
+  {
+    osal_stop_timerEx( simpleBLEPeripheral_TaskID, BATT_PERIODIC_EVT );
+    osal_set_event( simpleBLEPeripheral_TaskID, BATT_PERIODIC_EVT );
+  }
+}
+
+/*********************************************************************
+ * @fn      simpleBLEPeripheral_AdvStart
+ *
+ * @brief   Start the advertising policy from its first step.
+ *
+ * @param   reconnect - TRUE after a disconnect, to try directed
+ *                      advertising to the last bonded central first
+ *
+ * @return  none
+ */
+static void simpleBLEPeripheral_AdvStart( uint8 reconnect )
+{
+  osal_stop_timerEx( simpleBLEPeripheral_TaskID, SBP_ADV_STEP_EVT );
+
+  advPolicyStep = ( reconnect && advDirectValid ) ? ADV_POLICY_DIRECTED : ADV_POLICY_BURST;
+
+  simpleBLEPeripheral_AdvApply();
+}
+
+/*********************************************************************
+ * @fn      simpleBLEPeripheral_AdvApply
+ *
+ * @brief   Program the current policy step and (re)start advertising.
+ *          The stack only picks up new parameters when advertising
+ *          starts, so running advertisements are stopped first and
+ *          the step is applied again from GAPROLE_WAITING.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void simpleBLEPeripheral_AdvApply( void )
+{
+  const advPolicyStep_t *pStep = &advPolicy[advPolicyStep];
+  uint8 eventType = pStep->eventType;
+  uint8 enable;
+
+  if ( gapProfileState == GAPROLE_ADVERTISING )
+  {
+    advPolicyRestart = TRUE;
+    enable = FALSE;
+    GAPRole_SetParameter( GAPROLE_ADVERT_ENABLED, sizeof( uint8 ), &enable );
+    return;
+  }
+
+  HAL_LOG_DEBUG( HAL_LOG_ID_ADV_STEP, &advPolicyStep, 1 );
+
+  GAPRole_SetParameter( GAPROLE_ADV_EVENT_TYPE, sizeof( uint8 ), &eventType );
+  if ( eventType == GAP_ADTYPE_ADV_HDC_DIRECT_IND )
+  {
+    GAPRole_SetParameter( GAPROLE_ADV_DIRECT_TYPE, sizeof( uint8 ), &advDirectAddrType );
+    GAPRole_SetParameter( GAPROLE_ADV_DIRECT_ADDR, B_ADDR_LEN, advDirectAddr );
+  }
+  else
+  {
+    GAP_SetParamValue( TGAP_LIM_DISC_ADV_INT_MIN, pStep->interval );
+    GAP_SetParamValue( TGAP_LIM_DISC_ADV_INT_MAX, pStep->interval );
+    GAP_SetParamValue( TGAP_GEN_DISC_ADV_INT_MIN, pStep->interval );
+    GAP_SetParamValue( TGAP_GEN_DISC_ADV_INT_MAX, pStep->interval );
+  }
+
+  enable = TRUE;
+  GAPRole_SetParameter( GAPROLE_ADVERT_ENABLED, sizeof( uint8 ), &enable );
+
+  if ( pStep->duration )
+  {
+    osal_start_timerEx( simpleBLEPeripheral_TaskID, SBP_ADV_STEP_EVT, pStep->duration );
+  }
+}
+
+/*********************************************************************
+ * @fn      simpleBLEPeripheral_AdvNextStep
+ *
+ * @brief   Back off to the next policy step, or stop advertising
+ *          after the last one.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void simpleBLEPeripheral_AdvNextStep( void )
+{
+  if ( advPolicyStep == ADV_POLICY_IDLE )
+  {
+    return;
+  }
+
+  if ( ++advPolicyStep < ADV_POLICY_STEPS )
+  {
+    simpleBLEPeripheral_AdvApply();
+  }
+  else
+  {
+    uint8 enable = FALSE;
+
+    advPolicyStep = ADV_POLICY_IDLE;
+    GAPRole_SetParameter( GAPROLE_ADVERT_ENABLED, sizeof( uint8 ), &enable );
   }
 }
 
+/*********************************************************************
+ * @fn      simpleBLEPeripheral_AdvWaiting
+ *
+ * @brief   Advertising has stopped. Called from the state callback
+ *          after gapProfileState is updated, so a step applied here
+ *          starts advertising again.
+ *
+ * @param   oldState - state advertising stopped from
+ *
+ * @return  none
+ */
+static void simpleBLEPeripheral_AdvWaiting( gaprole_States_t oldState )
+{
+  if ( oldState == GAPROLE_CONNECTED || oldState == GAPROLE_CONNECTED_ADV )
+  {
+    // Link dropped; the role restarts advertising with whatever we set now
+    simpleBLEPeripheral_AdvStart( TRUE );
+  }
+  else if ( advPolicyRestart )
+  {
+    advPolicyRestart = FALSE;
+    simpleBLEPeripheral_AdvApply();
+  }
+  else if ( advPolicyStep == ADV_POLICY_DIRECTED )
+  {
+    // The controller ends high duty cycle directed advertising after 1.28s
+    simpleBLEPeripheral_AdvNextStep();
+  }
+  else
+  {
+    // Limited discoverable timeout or advertising disabled elsewhere
+    osal_stop_timerEx( simpleBLEPeripheral_TaskID, SBP_ADV_STEP_EVT );
+    advPolicyStep = ADV_POLICY_IDLE;
+  }
+}
+
+/*********************************************************************
+ * @fn      simpleBLEPeripheral_AdvSetPeer
+ *
+ * @brief   Remember the address of a bonded central as the target of
+ *          directed advertising. A central using a private address
+ *          only accepts directed advertisements to its current one,
+ *          which changes, so directed advertising is left out for it
+ *          and reconnection starts at the burst.
+ *
+ * @param   connHandle - connection handle of the bonded link
+ *
+ * @return  none
+ */
+static void simpleBLEPeripheral_AdvSetPeer( uint16 connHandle )
+{
+  linkDBItem_t *pItem = linkDB_Find( connHandle );
+
+  if ( pItem == NULL )
+  {
+    return;
+  }
+
+  if ( ( pItem->addrType == ADDRTYPE_PUBLIC || pItem->addrType == ADDRTYPE_STATIC ) &&
+       GAPBondMgr_ResolveAddr( pItem->addrType, pItem->addr, advDirectAddr ) < GAP_BONDINGS_MAX )
+  {
+    advDirectAddrType = pItem->addrType;
+    advDirectValid = TRUE;
+  }
+  else
+  {
+    advDirectValid = FALSE;
+  }
+}
+
+/*********************************************************************
+ * @fn      simpleBLEPeripheral_ConnActivity
+ *
+ * @brief   Mark a connection activity as running. It stays set until
+ *          no activity was reported for CONN_ACTIVITY_HOLD ms. A
+ *          longer hold still running, as at the start of a connection,
+ *          is kept.
+ *
+ * @param   activity - CONN_ACTIVITY_* bit(s)
+ *
+ * @return  none
+ */
+static void simpleBLEPeripheral_ConnActivity( uint8 activity )
+{
+  if ( gapProfileState != GAPROLE_CONNECTED )
+  {
+    return;
+  }
+
+  connActivity |= activity;
+  if ( osal_get_timeoutEx( simpleBLEPeripheral_TaskID, SBP_CONN_ACTIVITY_EVT ) < CONN_ACTIVITY_HOLD )
+  {
+    osal_start_timerEx( simpleBLEPeripheral_TaskID, SBP_CONN_ACTIVITY_EVT, CONN_ACTIVITY_HOLD );
+  }
+
+  simpleBLEPeripheral_ConnParamUpdate();
+}
+
+/*********************************************************************
+ * @fn      simpleBLEPeripheral_ConnParamUpdate
+ *
+ * @brief   Request the parameters of the profile the current activity
+ *          needs. Requests are at least CONN_PARAM_MIN_GAP apart; a
+ *          change inside that window is picked up when it closes.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void simpleBLEPeripheral_ConnParamUpdate( void )
+{
+  const connParamProfile_t *pProfile;
+  uint8 profile;
+
+  if ( gapProfileState != GAPROLE_CONNECTED ||
+       osal_get_timeoutEx( simpleBLEPeripheral_TaskID, SBP_CONN_PARAM_EVT ) != 0 )
+  {
+    return;
+  }
+
+  if ( connActivity & ( CONN_ACTIVITY_OAD | CONN_ACTIVITY_CERT ) )
+  {
+    profile = CONN_PROFILE_FAST;
+  }
+  else if ( connActivity & CONN_ACTIVITY_NOTIFY )
+  {
+    profile = CONN_PROFILE_NOTIFY;
+  }
+  else
+  {
+    profile = CONN_PROFILE_IDLE;
+  }
+
+  if ( profile == connParamProfile )
+  {
+    return;
+  }
+
+  pProfile = &connParamProfiles[profile];
+  if ( GAPRole_SendUpdateParam( pProfile->minInterval, pProfile->maxInterval,
+                                pProfile->latency, pProfile->timeout,
+                                GAPROLE_NO_ACTION ) == SUCCESS )
+  {
+    HAL_LOG_INFO( HAL_LOG_ID_CONN_PARAM, &profile, 1 );
+    connParamProfile = profile;
+  }
+
+  osal_start_timerEx( simpleBLEPeripheral_TaskID, SBP_CONN_PARAM_EVT, CONN_PARAM_MIN_GAP );
+}
+
+/*********************************************************************
+ * @fn      simpleBLEPeripheral_ConnParamStop
+ *
+ * @brief   Forget connection activity when the link is gone.
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+static void simpleBLEPeripheral_ConnParamStop( void )
+{
+  osal_stop_timerEx( simpleBLEPeripheral_TaskID, SBP_CONN_ACTIVITY_EVT );
+  osal_stop_timerEx( simpleBLEPeripheral_TaskID, SBP_CONN_PARAM_EVT );
+  connActivity = 0;
+  connParamProfile = CONN_PROFILE_NONE;
+}
+
+#if defined FEATURE_OAD
+/*********************************************************************
+ * @fn      simpleBLEPeripheral_OadWriteCB
+ *
+ * @brief   OAD service write callback.
+ *
+ * @param   connHandle - connection the write came in on
+ *
+ * @return  none
+ */
+static void simpleBLEPeripheral_OadWriteCB( uint16 connHandle )
+{
+  VOID connHandle;
+
+  simpleBLEPeripheral_ConnActivity( CONN_ACTIVITY_OAD );
+}
+#endif
+
 /*********************************************************************
  * @fn      performPeriodicTask
  *
@@ -909,6 +1399,14 @@ static void pgpDeviceControlChangeCB( uint8 paramID )
 {
   uint8 newValue;
 
+  pokemonGoPlusBattPiggyback();
+
+  if ( paramID == FW_UPDATE_REQUEST_CHAR )
+  {
+    // A firmware update request is followed by the OAD transfer
+    simpleBLEPeripheral_ConnActivity( CONN_ACTIVITY_OAD );
+  }
+
   switch( paramID )
   {
     case LED_VIBRATE_CTRL_CHAR:
@@ -941,7 +1439,9 @@ static void pgpDeviceControlChangeCB( uint8 paramID )
  */
 static void pgpCertificateChangeCB( uint8 paramID )
 {
-  uint8 newValue[36];
+  uint8 newValue[PGP_CERT_CHAR_MAX_LEN];
+
+  simpleBLEPeripheral_ConnActivity( CONN_ACTIVITY_CERT );
 
   switch( paramID )
   {
@@ -990,14 +1490,13 @@ static void pgpCertificateChangeCB( uint8 paramID )
   }
 }
 
-static void simpleBLEPeripheralBuzzerRing(uint8 *melody,uint8 len)
+#if defined KEY_BUZZER_FEEDBACK
+static void simpleBLEPeripheralBuzzerRing(const uint8 *melody,uint16 len)
 {
   /* Provide feedback that calibration is complete */
 #if (defined HAL_BUZZER) && (HAL_BUZZER == TRUE)
-  /* Tell OSAL to not go to sleep because buzzer uses T3 */
-#if defined ( POWER_SAVING )
-  osal_pwrmgr_device( PWRMGR_ALWAYS_ON );
-#endif
+  /* No need to keep OSAL awake: halSleep stays in PM0 while T3 plays a tone.
+     The clock still must not be divided when the CPU halts, or the pitch drops */
   /* Ring buzzer */
   HCI_EXT_ClkDivOnHaltCmd( HCI_EXT_DISABLE_CLK_DIVIDE_ON_HALT );
   HalBuzzerPlay( melody, len , simpleBLEPeripheralBuzzerCompleteCback );
@@ -1007,22 +1506,17 @@ static void simpleBLEPeripheralBuzzerRing(uint8 *melody,uint8 len)
 static void simpleBLEPeripheralBuzzerCompleteCback( void )
 {
 #if (defined HAL_BUZZER) && (HAL_BUZZER == TRUE)
-  /* Tell OSAL it's OK to go to sleep */
-#if defined ( POWER_SAVING )
-  osal_pwrmgr_device( /*PWRMGR_ALWAYS_ON*/ PWRMGR_BATTERY );
-#endif
   HCI_EXT_ClkDivOnHaltCmd( HCI_EXT_ENABLE_CLK_DIVIDE_ON_HALT );
 #endif
 }
+#endif /* KEY_BUZZER_FEEDBACK */
 
 //Passcode callback in bonding process
 static void ProcessPasscodeCB(uint8 *deviceAddr,uint16 connectionHandle,uint8 uiInputs,uint8 uiOutputs )
 {
   uint32  passcode;
 
-  #if (defined HAL_UART) && (HAL_UART == TRUE)
-    HalUARTWrite ( HAL_UART_PORT_1, "ProcessPasscodeCB\n", 18 );
-  #endif
+  HAL_LOG_INFO( HAL_LOG_ID_PASSCODE, NULL, 0 );
 
   // Create random passcode
   LL_Rand( ((uint8 *) &passcode), sizeof( uint32 ));
@@ -1042,42 +1536,25 @@ static void ProcessPasscodeCB(uint8 *deviceAddr,uint16 connectionHandle,uint8 ui
 static void ProcessPairStateCB( uint16 connHandle, uint8 state, uint8 status )
 {
   
-  #if (defined HAL_UART) && (HAL_UART == TRUE)
-    //HalUARTWrite ( HAL_UART_PORT_1, "ProcessPairStateCB\n", 19 );
-  #endif
-     
   if ( state == GAPBOND_PAIRING_STATE_STARTED )  
   {  
-    #if (defined HAL_UART) && (HAL_UART == TRUE)
-      HalUARTWrite ( HAL_UART_PORT_1, "Pairing started\n", 16 );
-    #endif 
+    HAL_LOG_INFO( HAL_LOG_ID_PAIR_START, NULL, 0 );
     gPairStatus = PAIRSTATUS_NO_PAIRED;  
   }  
      
   else if ( state == GAPBOND_PAIRING_STATE_COMPLETE ){  
     if ( status == SUCCESS ){  
-      #if (defined HAL_UART) && (HAL_UART == TRUE)
-        HalUARTWrite ( HAL_UART_PORT_1, "Pairing success\n", 16 );
-      #endif 
+      HAL_LOG_INFO( HAL_LOG_ID_PAIR_OK, NULL, 0 );
       gPairStatus = PAIRSTATUS_PAIRED;  
     }  
       
     else if(status == SMP_PAIRING_FAILED_UNSPECIFIED) { 
-      #if (defined HAL_UART) && (HAL_UART == TRUE)
-        HalUARTWrite ( HAL_UART_PORT_1, "Paired device\n", 14 );
-      #endif 
+      HAL_LOG_INFO( HAL_LOG_ID_PAIR_BONDED_DEV, NULL, 0 );
       gPairStatus = PAIRSTATUS_PAIRED;  
     }  
       
     else  {  
-      #if (defined HAL_UART) && (HAL_UART == TRUE)
-        {
-          char buf[32];
-          sprintf(buf,"Pairing fail: %d\n",status);
-          uint8 strLength=strlen(buf);
-          HalUARTWrite ( HAL_UART_PORT_1, (uint8 *)buf, strLength );
-        }
-      #endif  
+      HAL_LOG_WARN( HAL_LOG_ID_PAIR_FAIL, &status, 1 );
       gPairStatus = PAIRSTATUS_NO_PAIRED;  
     }  
        
@@ -1090,11 +1567,17 @@ static void ProcessPairStateCB( uint16 connHandle, uint8 state, uint8 status )
   {  
     if ( status == SUCCESS )  
     {  
-      #if (defined HAL_UART) && (HAL_UART == TRUE)
-        HalUARTWrite ( HAL_UART_PORT_1, "Bonding success\n", 16 );
-      #endif
+      HAL_LOG_INFO( HAL_LOG_ID_BOND_OK, NULL, 0 );
+      simpleBLEPeripheral_AdvSetPeer( connHandle );
     }  
   }  
+  else if ( state == GAPBOND_PAIRING_STATE_BOND_SAVED )
+  {
+    if ( status == SUCCESS )
+    {
+      simpleBLEPeripheral_AdvSetPeer( connHandle );
+    }
+  }
 }
 
 /*********************************************************************
@@ -68,6 +68,10 @@ extern "C"
 #define SBP_PERIODIC_EVT                                  0x0002
 #define BATT_PERIODIC_EVT                                 0x0004
 #define BUZZER_PROGRESS_TIMER_EVT                         0x0008
+#define SBP_ADV_STEP_EVT                                  0x0010
+#define SBP_CONN_PARAM_EVT                                0x0020
+#define SBP_CONN_ACTIVITY_EVT                             0x0040
+#define SBP_NOTI_RETRY_EVT                                0x0080
 
 /*********************************************************************
  * MACROS
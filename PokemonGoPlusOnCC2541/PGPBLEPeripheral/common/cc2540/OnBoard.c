@@ -219,7 +219,7 @@ uint8 RegisterForKeys( uint8 task_id )
  * @brief   Send "Key Pressed" message to application.
  *
  * @param   keys  - keys that were pressed
- *          state - shifted
+ *          state - gesture (HAL_KEY_GESTURE_*)
  *
  * @return  status
  *********************************************************************/
@@ -251,47 +251,21 @@ uint8 OnBoard_SendKeys( uint8 keys, uint8 state )
  * @brief   Callback service for keys
  *
  * @param   keys  - keys that were pressed
- *          state - shifted
+ *          state - gesture (HAL_KEY_GESTURE_*)
  *
  * @return  void
  *********************************************************************/
 void OnBoard_KeyCallback ( uint8 keys, uint8 state )
 {
-  uint8 shift;
-  (void)state;
-
-  // shift key (S1) is used to generate key interrupt
-  // applications should not use S1 when key interrupt is enabled
-  shift = (OnboardKeyIntEnable == HAL_KEY_INTERRUPT_ENABLE) ? false : ((keys & 0) ? true : false);
-
-  if ( OnBoard_SendKeys( keys, shift ) != SUCCESS )
+  // The HAL reports whole gestures off edge interrupts, so the key
+  // interrupt stays enabled and there is no switching to polling.
+  if ( OnBoard_SendKeys( keys, state ) != SUCCESS )
   {
     // Process SW1 here
     if ( keys & HAL_PUSH_BUTTON )  // Switch 1
     {
     }
   }
-
-  /* If any key is currently pressed down and interrupt
-     is still enabled, disable interrupt and switch to polling */
-  if( keys != 0 )
-  {
-    if( OnboardKeyIntEnable == HAL_KEY_INTERRUPT_ENABLE )
-    {
-      OnboardKeyIntEnable = HAL_KEY_INTERRUPT_DISABLE;
-      HalKeyConfig( OnboardKeyIntEnable, OnBoard_KeyCallback);
-    }
-  }
-  /* If no key is currently pressed down and interrupt
-     is disabled, enable interrupt and turn off polling */
-  else
-  {
-    if( OnboardKeyIntEnable == HAL_KEY_INTERRUPT_DISABLE )
-    {
-      OnboardKeyIntEnable = HAL_KEY_INTERRUPT_ENABLE;
-      HalKeyConfig( OnboardKeyIntEnable, OnBoard_KeyCallback);
-    }
-  }
 }
 
 /*********************************************************************
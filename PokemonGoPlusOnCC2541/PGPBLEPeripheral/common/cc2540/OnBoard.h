@@ -82,7 +82,7 @@
 typedef struct
 {
   osal_event_hdr_t hdr;
-  uint8             state; // shift
+  uint8             state; // gesture, HAL_KEY_GESTURE_*
   uint8             keys;  // keys
 } keyChange_t;
 
@@ -0,0 +1,35 @@
+/**************************************************************************************************
+  Filename:       hal_log_caller.c
+
+  Description:    A logging caller for test_hal_log_levels.c, built once with HAL_LOG off
+                  and once per HAL_LOG_LEVEL, as the function TEST_CALLER. It logs with
+                  every macro of every level; each argument is a call into the test,
+                  which so sees the arguments that were evaluated.
+**************************************************************************************************/
+
+#include "hal_log.h"
+
+// In test_hal_log_levels.c: the argument block and the 16-bit value of a
+// level, counted as evaluated
+extern uint8 *testLogArgs( uint8 level );
+extern uint16 testLogValue( uint8 level );
+
+void TEST_CALLER( void )
+{
+  // The level is the event id
+  HAL_LOG_ERROR( HAL_LOG_LEVEL_ERROR, testLogArgs( HAL_LOG_LEVEL_ERROR ), 1 );
+  HAL_LOG_ERROR_U16( HAL_LOG_LEVEL_ERROR, testLogValue( HAL_LOG_LEVEL_ERROR ) );
+  HAL_LOG_ERROR_DUMP( HAL_LOG_LEVEL_ERROR, testLogArgs( HAL_LOG_LEVEL_ERROR ), 1 );
+
+  HAL_LOG_WARN( HAL_LOG_LEVEL_WARN, testLogArgs( HAL_LOG_LEVEL_WARN ), 1 );
+  HAL_LOG_WARN_U16( HAL_LOG_LEVEL_WARN, testLogValue( HAL_LOG_LEVEL_WARN ) );
+  HAL_LOG_WARN_DUMP( HAL_LOG_LEVEL_WARN, testLogArgs( HAL_LOG_LEVEL_WARN ), 1 );
+
+  HAL_LOG_INFO( HAL_LOG_LEVEL_INFO, testLogArgs( HAL_LOG_LEVEL_INFO ), 1 );
+  HAL_LOG_INFO_U16( HAL_LOG_LEVEL_INFO, testLogValue( HAL_LOG_LEVEL_INFO ) );
+  HAL_LOG_INFO_DUMP( HAL_LOG_LEVEL_INFO, testLogArgs( HAL_LOG_LEVEL_INFO ), 1 );
+
+  HAL_LOG_DEBUG( HAL_LOG_LEVEL_DEBUG, testLogArgs( HAL_LOG_LEVEL_DEBUG ), 1 );
+  HAL_LOG_DEBUG_U16( HAL_LOG_LEVEL_DEBUG, testLogValue( HAL_LOG_LEVEL_DEBUG ) );
+  HAL_LOG_DEBUG_DUMP( HAL_LOG_LEVEL_DEBUG, testLogArgs( HAL_LOG_LEVEL_DEBUG ), 1 );
+}
@@ -0,0 +1,589 @@
+/**************************************************************************************************
+  Filename:       host_ble.c
+
+  Description:    Host model of the parts of the closed BLE stack libraries the profiles
+                  call: the link database with one link, the GATT server's service
+                  registry, and notification and indication delivery.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "bcomdef.h"
+#include "OSAL.h"
+#include "linkdb.h"
+#include "hci.h"
+#include "gatt.h"
+#include "gattservapp.h"
+#include "gatt_uuid.h"
+#include "host_ble.h"
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct
+{
+  gattAttribute_t *pAttrs;
+  uint16 numAttrs;
+  CONST gattServiceCBs_t *pCBs;
+} hostService_t;
+
+typedef struct
+{
+  uint16 handle;
+  uint16 offset;
+  uint8 len;
+  uint8 value[ATT_MTU_SIZE - 5];
+} hostPrepWrite_t;
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+hostNoti_t hostNoti[HOST_NOTI_MAX];
+uint8 hostNotiCount;
+bStatus_t hostNotiStatus;
+uint8 hostNotiBusy;
+int hostBmOutstanding;
+uint8 hostConnEventTaskId;
+uint16 hostConnEventEvent;
+
+uint8 linkDBNumConns = 1;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static hostService_t hostServices[HOST_SERVICE_MAX];
+static uint8 hostServiceCnt;
+static uint16 hostNextHandle;
+
+static linkDBItem_t hostLink;
+
+// Task registered for GATT server messages
+static uint8 hostServMsgTaskId;
+
+// Prepare Write queue of the link's client
+static hostPrepWrite_t hostPrepWrites[GATT_MAX_NUM_PREPARE_WRITES];
+static uint8 hostPrepWriteCnt;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static hostService_t *hostFindService( uint16 handle, gattAttribute_t **ppAttr )
+{
+  uint8 i;
+
+  for ( i = 0; i < hostServiceCnt; i++ )
+  {
+    hostService_t *pService = &hostServices[i];
+
+    if ( handle >= pService->pAttrs[0].handle &&
+         handle < pService->pAttrs[0].handle + pService->numAttrs )
+    {
+      *ppAttr = &pService->pAttrs[handle - pService->pAttrs[0].handle];
+      return ( pService );
+    }
+  }
+
+  return ( NULL );
+}
+
+static void hostRecordNoti( uint16 connHandle, uint16 handle, uint8 len,
+                            uint8 *pValue, uint8 indication )
+{
+  if ( hostNotiCount < HOST_NOTI_MAX )
+  {
+    hostNoti_t *pNoti = &hostNoti[hostNotiCount++];
+
+    pNoti->connHandle = connHandle;
+    pNoti->handle = handle;
+    pNoti->len = len;
+    pNoti->indication = indication;
+    memcpy( pNoti->value, pValue, len );
+  }
+}
+
+// As the stack when a link goes down, forget what its client configured in
+// every CCC
+static void hostResetCCCs( void )
+{
+  uint8 i;
+  uint16 j;
+
+  for ( i = 0; i < hostServiceCnt; i++ )
+  {
+    hostService_t *pService = &hostServices[i];
+
+    for ( j = 0; j < pService->numAttrs; j++ )
+    {
+      gattAttribute_t *pAttr = &pService->pAttrs[j];
+
+      if ( pAttr->type.len == ATT_BT_UUID_SIZE &&
+           osal_memcmp( pAttr->type.uuid, clientCharCfgUUID, ATT_BT_UUID_SIZE ) )
+      {
+        GATTServApp_InitCharCfg( HOST_CONN_HANDLE, GATT_CCC_TBL( pAttr->pValue ) );
+      }
+    }
+  }
+}
+
+/*********************************************************************
+ * LINK DATABASE
+ */
+
+uint8 linkDB_State( uint16 connectionHandle, uint8 state )
+{
+  return ( ( connectionHandle == hostLink.connectionHandle ) &&
+           ( hostLink.stateFlags & state ) == state &&
+           ( hostLink.stateFlags & LINK_CONNECTED ) );
+}
+
+linkDBItem_t *linkDB_Find( uint16 connectionHandle )
+{
+  if ( connectionHandle == hostLink.connectionHandle &&
+       ( hostLink.stateFlags & LINK_CONNECTED ) )
+  {
+    return ( &hostLink );
+  }
+
+  return ( NULL );
+}
+
+uint8 linkDB_NumActive( void )
+{
+  return ( ( hostLink.stateFlags & LINK_CONNECTED ) ? 1 : 0 );
+}
+
+uint16 linkDB_MTU( uint16 connectionHandle )
+{
+  (void)connectionHandle;
+  return ( hostLink.MTU );
+}
+
+void linkDB_PerformFunc( pfnPerformFuncCB_t cb )
+{
+  // The stack calls back for every record, connected or not
+  cb( &hostLink );
+}
+
+/*********************************************************************
+ * GATT
+ */
+
+bStatus_t GATTServApp_RegisterService( gattAttribute_t *pAttrs, uint16 numAttrs,
+                                       uint8 encKeySize,
+                                       CONST gattServiceCBs_t *pServiceCBs )
+{
+  hostService_t *pService;
+  uint16 i;
+
+  (void)encKeySize;
+
+  if ( hostServiceCnt == HOST_SERVICE_MAX )
+  {
+    return ( bleNoResources );
+  }
+
+  pService = &hostServices[hostServiceCnt++];
+  pService->pAttrs = pAttrs;
+  pService->numAttrs = numAttrs;
+  pService->pCBs = pServiceCBs;
+
+  for ( i = 0; i < numAttrs; i++ )
+  {
+    pAttrs[i].handle = hostNextHandle++;
+  }
+
+  return ( SUCCESS );
+}
+
+// The GAP and GATT services live in the stack library; the model has neither
+bStatus_t GATTServApp_AddService( uint32 services )
+{
+  (void)services;
+  return ( SUCCESS );
+}
+
+void GATTServApp_RegisterForMsg( uint8 taskID )
+{
+  hostServMsgTaskId = taskID;
+}
+
+void GATTServApp_SendCCCUpdatedEvent( uint16 connHandle, uint16 attrHandle, uint16 value )
+{
+  gattClientCharCfgUpdatedEvent_t *pMsg;
+
+  if ( hostServMsgTaskId == INVALID_TASK_ID )
+  {
+    return;
+  }
+
+  pMsg = (gattClientCharCfgUpdatedEvent_t *)osal_msg_allocate( sizeof ( *pMsg ) );
+  if ( pMsg != NULL )
+  {
+    pMsg->hdr.event = GATT_SERV_MSG_EVENT;
+    pMsg->hdr.status = SUCCESS;
+    pMsg->connHandle = connHandle;
+    pMsg->method = GATT_CLIENT_CHAR_CFG_UPDATED_EVENT;
+    pMsg->attrHandle = attrHandle;
+    pMsg->value = value;
+
+    VOID osal_msg_send( hostServMsgTaskId, (uint8 *)pMsg );
+  }
+}
+
+bStatus_t GATTServApp_SendServiceChangedInd( uint16 connHandle, uint8 taskId )
+{
+  (void)connHandle;
+  (void)taskId;
+  return ( FAILURE );
+}
+
+gattAttribute_t *GATT_FindHandleUUID( uint16 startHandle, uint16 endHandle, const uint8 *pUUID,
+                                      uint16 len, uint16 *pHandle )
+{
+  uint8 i;
+  uint16 j;
+
+  for ( i = 0; i < hostServiceCnt; i++ )
+  {
+    hostService_t *pService = &hostServices[i];
+
+    for ( j = 0; j < pService->numAttrs; j++ )
+    {
+      gattAttribute_t *pAttr = &pService->pAttrs[j];
+
+      if ( pAttr->handle >= startHandle && pAttr->handle <= endHandle &&
+           pAttr->type.len == len && memcmp( pAttr->type.uuid, pUUID, len ) == 0 )
+      {
+        if ( pHandle != NULL )
+        {
+          *pHandle = pService->pAttrs[0].handle;
+        }
+        return ( pAttr );
+      }
+    }
+  }
+
+  return ( NULL );
+}
+
+gattAttribute_t *GATT_FindNextAttr( gattAttribute_t *pAttr, uint16 endHandle,
+                                    uint16 service, uint16 *pLastHandle )
+{
+  (void)service;
+
+  if ( pAttr->handle == endHandle )
+  {
+    return ( NULL );
+  }
+
+  return ( GATT_FindHandleUUID( pAttr->handle + 1, endHandle, pAttr->type.uuid,
+                                pAttr->type.len, pLastHandle ) );
+}
+
+uint8 GATTServApp_ReadAttr( uint16 connHandle, gattAttribute_t *pAttr,
+                            uint16 service, uint8 *pValue, uint8 *pLen,
+                            uint16 offset, uint8 maxLen, uint8 method )
+{
+  gattAttribute_t *pFound;
+  hostService_t *pService = hostFindService( pAttr->handle, &pFound );
+
+  (void)service;
+
+  if ( pService == NULL || pService->pCBs->pfnReadAttrCB == NULL )
+  {
+    return ( ATT_ERR_INVALID_HANDLE );
+  }
+
+  return ( pService->pCBs->pfnReadAttrCB( connHandle, pAttr, pValue, pLen,
+                                          offset, maxLen, method ) );
+}
+
+// As the stack, the bond manager's restore is a write of the CCC through the
+// service, so the service sees it as a client enabling notifications
+bStatus_t GATTServApp_UpdateCharCfg( uint16 connHandle, uint16 attrHandle, uint16 value )
+{
+  gattAttribute_t *pAttr;
+  hostService_t *pService = hostFindService( attrHandle, &pAttr );
+  uint8 buf[2];
+
+  if ( pService == NULL || pService->pCBs->pfnWriteAttrCB == NULL )
+  {
+    return ( INVALIDPARAMETER );
+  }
+
+  buf[0] = LO_UINT16( value );
+  buf[1] = HI_UINT16( value );
+
+  return ( pService->pCBs->pfnWriteAttrCB( connHandle, pAttr, buf, sizeof ( buf ),
+                                           0, ATT_WRITE_REQ ) );
+}
+
+void *GATT_bm_alloc(uint16 connHandle, uint8 opcode, uint16 size, uint16 *pSizeAlloc )
+{
+  void *p;
+
+  (void)connHandle;
+  (void)opcode;
+
+  // As the stack, never more than fits in one PDU
+  if ( size > hostLink.MTU - 3 )
+  {
+    size = hostLink.MTU - 3;
+  }
+
+  p = malloc( size ? size : 1 );
+  hostBmOutstanding++;
+
+  if ( pSizeAlloc != NULL )
+  {
+    *pSizeAlloc = size;
+  }
+
+  return ( p );
+}
+
+void GATT_bm_free( gattMsg_t *pMsg, uint8 opcode )
+{
+  (void)opcode;
+
+  // Notifications and indications keep the value pointer at the same place
+  free( pMsg->handleValueNoti.pValue );
+  pMsg->handleValueNoti.pValue = NULL;
+  hostBmOutstanding--;
+}
+
+bStatus_t GATT_Notification( uint16 connHandle, attHandleValueNoti_t *pNoti,
+                             uint8 authenticated )
+{
+  (void)authenticated;
+
+  if ( !linkDB_Up( connHandle ) )
+  {
+    return ( bleNotConnected );
+  }
+
+  if ( hostNotiBusy > 0 )
+  {
+    hostNotiBusy--;
+    return ( MSG_BUFFER_NOT_AVAIL );
+  }
+
+  if ( hostNotiStatus != SUCCESS )
+  {
+    return ( hostNotiStatus );
+  }
+
+  hostRecordNoti( connHandle, pNoti->handle, pNoti->len, pNoti->pValue, FALSE );
+
+  // Sent: the stack owns the buffer now
+  free( pNoti->pValue );
+  hostBmOutstanding--;
+
+  return ( SUCCESS );
+}
+
+bStatus_t GATT_Indication( uint16 connHandle, attHandleValueInd_t *pInd,
+                           uint8 authenticated, uint8 taskId )
+{
+  (void)authenticated;
+  (void)taskId;
+
+  if ( !linkDB_Up( connHandle ) )
+  {
+    return ( bleNotConnected );
+  }
+
+  if ( hostNotiStatus != SUCCESS )
+  {
+    return ( hostNotiStatus );
+  }
+
+  hostRecordNoti( connHandle, pInd->handle, pInd->len, pInd->pValue, TRUE );
+
+  free( pInd->pValue );
+  hostBmOutstanding--;
+
+  return ( SUCCESS );
+}
+
+hciStatus_t HCI_EXT_ConnEventNoticeCmd( uint16 connHandle, uint8 taskID, uint16 taskEvent )
+{
+  (void)connHandle;
+
+  hostConnEventTaskId = taskID;
+  hostConnEventEvent = taskEvent;
+
+  return ( HCI_SUCCESS );
+}
+
+hciStatus_t HCI_EXT_ClkDivOnHaltCmd( uint8 control )
+{
+  (void)control;
+  return ( HCI_SUCCESS );
+}
+
+/*********************************************************************
+ * HOST CONTROL
+ */
+
+void hostBleInit( void )
+{
+  memset( hostServices, 0, sizeof ( hostServices ) );
+  hostServiceCnt = 0;
+  hostNextHandle = 1;
+
+  memset( hostNoti, 0, sizeof ( hostNoti ) );
+  hostNotiCount = 0;
+  hostNotiStatus = SUCCESS;
+  hostNotiBusy = 0;
+  hostBmOutstanding = 0;
+  hostConnEventTaskId = INVALID_TASK_ID;
+  hostConnEventEvent = 0;
+  hostPrepWriteCnt = 0;
+  hostServMsgTaskId = INVALID_TASK_ID;
+
+  hostBleLink( LINK_NOT_CONNECTED );
+}
+
+void hostBleLink( uint8 stateFlags )
+{
+  if ( ( hostLink.stateFlags & LINK_CONNECTED ) && !( stateFlags & LINK_CONNECTED ) )
+  {
+    hostResetCCCs();
+  }
+
+  memset( &hostLink, 0, sizeof ( hostLink ) );
+  hostLink.connectionHandle = ( stateFlags & LINK_CONNECTED ) ?
+                              HOST_CONN_HANDLE : INVALID_CONNHANDLE;
+  hostLink.stateFlags = stateFlags;
+  hostLink.MTU = ATT_MTU_SIZE;
+}
+
+void hostBleLinkPeer( uint8 addrType, uint8 *pAddr )
+{
+  hostLink.addrType = addrType;
+  memcpy( hostLink.addr, pAddr, B_ADDR_LEN );
+}
+
+gattAttribute_t *hostBleAttr( uint16 handle )
+{
+  gattAttribute_t *pAttr;
+
+  return ( hostFindService( handle, &pAttr ) ? pAttr : NULL );
+}
+
+CONST gattServiceCBs_t *hostBleServiceCBs( uint16 handle )
+{
+  gattAttribute_t *pAttr;
+  hostService_t *pService = hostFindService( handle, &pAttr );
+
+  return ( pService ? pService->pCBs : NULL );
+}
+
+bStatus_t hostBleRead( uint16 handle, uint8 *pValue, uint8 *pLen,
+                       uint16 offset, uint8 maxLen )
+{
+  gattAttribute_t *pAttr;
+  hostService_t *pService = hostFindService( handle, &pAttr );
+
+  if ( pService == NULL || pService->pCBs->pfnReadAttrCB == NULL )
+  {
+    return ( ATT_ERR_INVALID_HANDLE );
+  }
+
+  return ( pService->pCBs->pfnReadAttrCB( HOST_CONN_HANDLE, pAttr, pValue, pLen,
+                                          offset, maxLen, ATT_READ_REQ ) );
+}
+
+bStatus_t hostBleWrite( uint16 handle, uint8 *pValue, uint8 len,
+                        uint16 offset, uint8 method )
+{
+  gattAttribute_t *pAttr;
+  hostService_t *pService = hostFindService( handle, &pAttr );
+
+  bStatus_t status;
+
+  if ( pService == NULL || pService->pCBs->pfnWriteAttrCB == NULL )
+  {
+    return ( ATT_ERR_INVALID_HANDLE );
+  }
+
+  status = pService->pCBs->pfnWriteAttrCB( HOST_CONN_HANDLE, pAttr, pValue, len,
+                                           offset, method );
+
+  // As the stack, tell the registered task, the bond manager, of a CCC the
+  // client wrote
+  if ( status == SUCCESS && len == 2 && pAttr->type.len == ATT_BT_UUID_SIZE &&
+       osal_memcmp( pAttr->type.uuid, clientCharCfgUUID, ATT_BT_UUID_SIZE ) )
+  {
+    GATTServApp_SendCCCUpdatedEvent( HOST_CONN_HANDLE, handle,
+                                     BUILD_UINT16( pValue[0], pValue[1] ) );
+  }
+
+  return ( status );
+}
+
+bStatus_t hostBleWriteCCC( uint16 handle, uint16 value )
+{
+  uint8 buf[2];
+
+  buf[0] = LO_UINT16( value );
+  buf[1] = HI_UINT16( value );
+
+  return ( hostBleWrite( handle, buf, sizeof ( buf ), 0, ATT_WRITE_REQ ) );
+}
+
+bStatus_t hostBlePrepareWrite( uint16 handle, uint8 *pValue, uint8 len, uint16 offset )
+{
+  hostPrepWrite_t *pPrep;
+
+  if ( hostBleAttr( handle ) == NULL )
+  {
+    return ( ATT_ERR_INVALID_HANDLE );
+  }
+
+  if ( len > hostLink.MTU - 5 )
+  {
+    return ( ATT_ERR_INVALID_PDU );
+  }
+
+  if ( hostPrepWriteCnt == GATT_MAX_NUM_PREPARE_WRITES )
+  {
+    return ( ATT_ERR_PREPARE_QUEUE_FULL );
+  }
+
+  pPrep = &hostPrepWrites[hostPrepWriteCnt++];
+  pPrep->handle = handle;
+  pPrep->offset = offset;
+  pPrep->len = len;
+  memcpy( pPrep->value, pValue, len );
+
+  return ( SUCCESS );
+}
+
+bStatus_t hostBleExecuteWrite( uint8 execute )
+{
+  bStatus_t status = SUCCESS;
+  uint8 i;
+
+  for ( i = 0; execute && i < hostPrepWriteCnt && status == SUCCESS; i++ )
+  {
+    hostPrepWrite_t *pPrep = &hostPrepWrites[i];
+
+    status = hostBleWrite( pPrep->handle, pPrep->value, pPrep->len, pPrep->offset,
+                           ATT_EXECUTE_WRITE_REQ );
+  }
+
+  // Applied or not, the queue is gone
+  hostPrepWriteCnt = 0;
+
+  return ( status );
+}
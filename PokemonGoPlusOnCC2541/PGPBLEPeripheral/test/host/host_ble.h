@@ -0,0 +1,131 @@
+/**************************************************************************************************
+  Filename:       host_ble.h
+
+  Description:    Control of the host model of the BLE stack used by the host tests: one
+                  link, the GATT server's attribute database and the notifications sent.
+                  The GAP layer is modelled in host_gap.c.
+**************************************************************************************************/
+
+#ifndef HOST_BLE_H
+#define HOST_BLE_H
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "bcomdef.h"
+#include "att.h"
+#include "gatt.h"
+#include "gattservapp.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Connection handle of the one link
+#define HOST_CONN_HANDLE   0
+
+// Services GATTServApp_RegisterService() accepts
+#define HOST_SERVICE_MAX   8
+
+// Notifications and indications kept since hostBleInit()
+#define HOST_NOTI_MAX      32
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct
+{
+  uint16 connHandle;
+  uint16 handle;
+  uint8 len;
+  uint8 indication;
+  uint8 value[ATT_MTU_SIZE];
+} hostNoti_t;
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+// Sent notifications and indications, oldest first
+extern hostNoti_t hostNoti[HOST_NOTI_MAX];
+extern uint8 hostNotiCount;
+
+// Status GATT_Notification() and GATT_Indication() return; anything but
+// SUCCESS drops the value, as a link with no TX buffer left does
+extern bStatus_t hostNotiStatus;
+
+// GATT_Notification() calls still to find no TX buffer and return
+// MSG_BUFFER_NOT_AVAIL, one less each call, as a link busy for a while does
+extern uint8 hostNotiBusy;
+
+// GATT_bm_alloc() buffers not yet sent or freed
+extern int hostBmOutstanding;
+
+// Last HCI_EXT_ConnEventNoticeCmd() request
+extern uint8 hostConnEventTaskId;
+extern uint16 hostConnEventEvent;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Forget the services, the link and the notifications.
+ */
+extern void hostBleInit( void );
+
+/*
+ * Bring the link up with the given LINK_* state flags, or take it down
+ * with LINK_NOT_CONNECTED, which clears the link's CCC values.
+ */
+extern void hostBleLink( uint8 stateFlags );
+
+/*
+ * Set the address the link's peer connected with.
+ */
+extern void hostBleLinkPeer( uint8 addrType, uint8 *pAddr );
+
+/*
+ * The registered attribute with this handle, or NULL.
+ */
+extern gattAttribute_t *hostBleAttr( uint16 handle );
+
+/*
+ * The callbacks of the service the attribute with this handle belongs to,
+ * or NULL.
+ */
+extern CONST gattServiceCBs_t *hostBleServiceCBs( uint16 handle );
+
+/*
+ * Read or write an attribute through its service's callbacks, as the
+ * GATT server does for a client request. A CCC written is reported to the
+ * task registered with GATTServApp_RegisterForMsg().
+ */
+extern bStatus_t hostBleRead( uint16 handle, uint8 *pValue, uint8 *pLen,
+                              uint16 offset, uint8 maxLen );
+extern bStatus_t hostBleWrite( uint16 handle, uint8 *pValue, uint8 len,
+                               uint16 offset, uint8 method );
+
+/*
+ * Enable (GATT_CLIENT_CFG_NOTIFY) or disable notifications on the CCC
+ * descriptor with this handle.
+ */
+extern bStatus_t hostBleWriteCCC( uint16 handle, uint16 value );
+
+/*
+ * Queue a Prepare Write fragment of at most ATT_MTU - 5 bytes, as the GATT
+ * server does: up to GATT_MAX_NUM_PREPARE_WRITES of them, none reaching the
+ * service yet.
+ */
+extern bStatus_t hostBlePrepareWrite( uint16 handle, uint8 *pValue, uint8 len, uint16 offset );
+
+/*
+ * Execute Write: with execute TRUE, hand the queued fragments in order to
+ * their services' write callbacks with ATT_EXECUTE_WRITE_REQ, stopping at
+ * the first that fails; with FALSE, cancel them. Either way the queue is
+ * emptied.
+ */
+extern bStatus_t hostBleExecuteWrite( uint8 execute );
+
+#endif /* HOST_BLE_H */
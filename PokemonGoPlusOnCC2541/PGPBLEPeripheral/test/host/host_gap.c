@@ -0,0 +1,544 @@
+/**************************************************************************************************
+  Filename:       host_gap.c
+
+  Description:    Host model of the GAP layer of the closed BLE stack libraries, with the
+                  bits of the GAP GATT server, HCI and link layer the role and the bond
+                  manager call. It is an OSAL task of its own, so its events reach the
+                  GAP role and the bond manager as GAP_MSG_EVENT messages, as they do
+                  from the stack.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <string.h>
+
+#include "bcomdef.h"
+#include "OSAL.h"
+#include "gap.h"
+#include "sm.h"
+#include "linkdb.h"
+#include "hci.h"
+#include "ll.h"
+#include "gapgattserver.h"
+#include "host_ble.h"
+#include "host_gap.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Model task events
+#define HOST_GAP_HDC_END_EVT    0x0001    // directed advertising ran out
+#define HOST_GAP_LIM_END_EVT    0x0002    // limited discoverable timeout
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+uint8 hostGapAdvertising;
+gapAdvertisingParams_t hostGapAdvParams;
+uint16 hostGapAdvInterval;
+uint16 hostGapAdvStarts;
+uint16 hostGapResolves;
+
+hostGapParamReq_t hostGapParamReqs[HOST_GAP_PARAM_REQ_MAX];
+uint8 hostGapParamReqCount;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static uint8 hostGapTaskId;
+
+// Task GAP_RegisterForMsgs() asked for the link events: the GAP role
+static uint8 hostGapRoleTaskId;
+
+static uint16 hostGapParams[TGAP_PARAMID_MAX];
+
+static uint8 hostGapAdvData[B_MAX_ADV_LEN];
+static uint8 hostGapAdvDataLen;
+
+static uint8 hostGapOwnAddr[B_ADDR_LEN] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static void *hostGapMsg( uint8 opcode, uint8 status, uint16 len )
+{
+  gapEventHdr_t *pMsg = (gapEventHdr_t *)osal_msg_allocate( len );
+
+  memset( pMsg, 0, len );
+  pMsg->hdr.event = GAP_MSG_EVENT;
+  pMsg->hdr.status = status;
+  pMsg->opcode = opcode;
+
+  return ( pMsg );
+}
+
+static void hostGapSend( uint8 taskId, void *pMsg )
+{
+  VOID osal_msg_send( taskId, (uint8 *)pMsg );
+}
+
+// Whether the advertising data carries the limited discoverable flag
+static uint8 hostGapLimited( void )
+{
+  uint8 i = 0;
+
+  while ( i + 2 < hostGapAdvDataLen && hostGapAdvData[i] != 0 )
+  {
+    if ( hostGapAdvData[i + 1] == GAP_ADTYPE_FLAGS )
+    {
+      return ( ( hostGapAdvData[i + 2] & GAP_ADTYPE_FLAGS_LIMITED ) ? TRUE : FALSE );
+    }
+    i += hostGapAdvData[i] + 1;
+  }
+
+  return ( FALSE );
+}
+
+static void hostGapAdvStop( void )
+{
+  hostGapAdvertising = FALSE;
+  VOID osal_stop_timerEx( hostGapTaskId, HOST_GAP_HDC_END_EVT );
+  VOID osal_stop_timerEx( hostGapTaskId, HOST_GAP_LIM_END_EVT );
+}
+
+// Stand-in for the AES based ah() of the Security Manager: FNV-1a over the
+// whole IRK and prand, so that two IRKs hardly ever resolve the same address
+static void hostGapHash( uint8 *pIRK, uint8 *pRand, uint8 *pHash )
+{
+  uint32 hash = 2166136261UL;
+  uint8 i;
+
+  for ( i = 0; i < KEYLEN; i++ )
+  {
+    hash = ( hash ^ pIRK[i] ) * 16777619UL;
+  }
+
+  for ( i = 0; i < 3; i++ )
+  {
+    hash = ( hash ^ pRand[i] ) * 16777619UL;
+  }
+
+  for ( i = 0; i < 3; i++ )
+  {
+    pHash[i] = (uint8)( hash >> ( 8 * i ) );
+  }
+}
+
+/*********************************************************************
+ * GAP
+ */
+
+bStatus_t GAP_DeviceInit( uint8 taskID, uint8 profileRole, uint8 maxScanResponses,
+                          uint8 *pIRK, uint8 *pSRK, uint32 *pSignCounter )
+{
+  gapDeviceInitDoneEvent_t *pMsg;
+
+  (void)profileRole;
+  (void)maxScanResponses;
+  (void)pIRK;
+  (void)pSRK;
+  (void)pSignCounter;
+
+  pMsg = hostGapMsg( GAP_DEVICE_INIT_DONE_EVENT, SUCCESS, sizeof ( gapDeviceInitDoneEvent_t ) );
+  memcpy( pMsg->devAddr, hostGapOwnAddr, B_ADDR_LEN );
+  pMsg->dataPktLen = 27;
+  pMsg->numDataPkts = 4;
+  hostGapSend( taskID, pMsg );
+
+  return ( SUCCESS );
+}
+
+void GAP_RegisterForMsgs( uint8 taskID )
+{
+  hostGapRoleTaskId = taskID;
+}
+
+bStatus_t GAP_SetParamValue( gapParamIDs_t paramID, uint16 paramValue )
+{
+  if ( paramID >= TGAP_PARAMID_MAX )
+  {
+    return ( INVALIDPARAMETER );
+  }
+
+  hostGapParams[paramID] = paramValue;
+
+  return ( SUCCESS );
+}
+
+uint16 GAP_GetParamValue( gapParamIDs_t paramID )
+{
+  return ( ( paramID < TGAP_PARAMID_MAX ) ? hostGapParams[paramID] : 0xFFFF );
+}
+
+bStatus_t GAP_UpdateAdvertisingData( uint8 taskID, uint8 adType,
+                                     uint8 dataLen, uint8 *pAdvertData )
+{
+  gapAdvDataUpdateEvent_t *pMsg;
+
+  if ( dataLen > B_MAX_ADV_LEN )
+  {
+    return ( bleInvalidRange );
+  }
+
+  if ( adType )
+  {
+    memcpy( hostGapAdvData, pAdvertData, dataLen );
+    hostGapAdvDataLen = dataLen;
+  }
+
+  pMsg = hostGapMsg( GAP_ADV_DATA_UPDATE_DONE_EVENT, SUCCESS, sizeof ( gapAdvDataUpdateEvent_t ) );
+  pMsg->adType = adType;
+  hostGapSend( taskID, pMsg );
+
+  return ( SUCCESS );
+}
+
+bStatus_t GAP_MakeDiscoverable( uint8 taskID, gapAdvertisingParams_t *pParams )
+{
+  if ( hostGapAdvertising )
+  {
+    return ( bleAlreadyInRequestedMode );
+  }
+
+  hostGapAdvertising = TRUE;
+  hostGapAdvParams = *pParams;
+  hostGapAdvStarts++;
+
+  if ( pParams->eventType == GAP_ADTYPE_ADV_HDC_DIRECT_IND )
+  {
+    // The controller picks the interval, at most 3.75ms
+    hostGapAdvInterval = 0;
+    VOID osal_start_timerEx( hostGapTaskId, HOST_GAP_HDC_END_EVT, HOST_GAP_HDC_DURATION );
+  }
+  else if ( hostGapLimited() )
+  {
+    hostGapAdvInterval = hostGapParams[TGAP_LIM_DISC_ADV_INT_MIN];
+    if ( hostGapParams[TGAP_LIM_ADV_TIMEOUT] )
+    {
+      VOID osal_start_timerEx( hostGapTaskId, HOST_GAP_LIM_END_EVT,
+                               hostGapParams[TGAP_LIM_ADV_TIMEOUT] * 1000UL );
+    }
+  }
+  else
+  {
+    hostGapAdvInterval = hostGapParams[TGAP_GEN_DISC_ADV_INT_MIN];
+  }
+
+  hostGapSend( taskID, hostGapMsg( GAP_MAKE_DISCOVERABLE_DONE_EVENT, SUCCESS,
+                                   sizeof ( gapMakeDiscoverableRspEvent_t ) ) );
+
+  return ( SUCCESS );
+}
+
+bStatus_t GAP_EndDiscoverable( uint8 taskID )
+{
+  if ( !hostGapAdvertising )
+  {
+    return ( bleIncorrectMode );
+  }
+
+  hostGapAdvStop();
+  hostGapSend( taskID, hostGapMsg( GAP_END_DISCOVERABLE_DONE_EVENT, SUCCESS,
+                                   sizeof ( gapEndDiscoverableRspEvent_t ) ) );
+
+  return ( SUCCESS );
+}
+
+bStatus_t GAP_TerminateLinkReq( uint8 taskID, uint16 connectionHandle, uint8 reason )
+{
+  (void)taskID;
+  (void)reason;
+
+  if ( !linkDB_Up( connectionHandle ) )
+  {
+    return ( bleNotConnected );
+  }
+
+  // The controller reports a disconnect it was asked for as by the local host
+  hostGapDisconnect( HCI_ERROR_CODE_CONN_TERM_BY_LOCAL_HOST );
+
+  return ( SUCCESS );
+}
+
+bStatus_t GAP_UpdateLinkParamReq( gapUpdateLinkParamReq_t *pParams )
+{
+  if ( !linkDB_Up( pParams->connectionHandle ) )
+  {
+    return ( bleNotConnected );
+  }
+
+  if ( hostGapParamReqCount < HOST_GAP_PARAM_REQ_MAX )
+  {
+    hostGapParamReq_t *pReq = &hostGapParamReqs[hostGapParamReqCount++];
+
+    pReq->time = osal_GetSystemClock();
+    pReq->req = *pParams;
+  }
+
+  return ( SUCCESS );
+}
+
+uint8 GAP_NumActiveConnections( void )
+{
+  return ( linkDB_NumActive() );
+}
+
+bStatus_t GAP_ResolvePrivateAddr( uint8 *pIRK, uint8 *pAddr )
+{
+  uint8 hash[3];
+
+  hostGapResolves++;
+  hostGapHash( pIRK, &pAddr[3], hash );
+
+  return ( ( memcmp( hash, pAddr, sizeof ( hash ) ) == 0 ) ? SUCCESS : FAILURE );
+}
+
+// Pairing itself is the central's doing, see hostGapBond()
+bStatus_t GAP_Authenticate( gapAuthParams_t *pParams, gapPairingReq_t *pPairReq )
+{
+  (void)pParams;
+  (void)pPairReq;
+  return ( SUCCESS );
+}
+
+bStatus_t GAP_TerminateAuth( uint16 connectionHandle, uint8 reason )
+{
+  (void)connectionHandle;
+  (void)reason;
+  return ( SUCCESS );
+}
+
+bStatus_t GAP_PasscodeUpdate( uint32 passcode, uint16 connectionHandle )
+{
+  (void)passcode;
+  (void)connectionHandle;
+  return ( SUCCESS );
+}
+
+bStatus_t GAP_SendSlaveSecurityRequest( uint16 connectionHandle, uint8 authReq )
+{
+  (void)connectionHandle;
+  (void)authReq;
+  return ( SUCCESS );
+}
+
+bStatus_t GAP_Signable( uint16 connectionHandle, uint8 authenticated, smSigningInfo_t *pParams )
+{
+  (void)connectionHandle;
+  (void)authenticated;
+  (void)pParams;
+  return ( SUCCESS );
+}
+
+bStatus_t GAP_Bond( uint16 connectionHandle, uint8 authenticated,
+                    smSecurityInfo_t *pParams, uint8 startEncryption )
+{
+  (void)connectionHandle;
+  (void)authenticated;
+  (void)pParams;
+  (void)startEncryption;
+  return ( SUCCESS );
+}
+
+/*********************************************************************
+ * GAP GATT SERVER, HCI AND LINK LAYER
+ */
+
+bStatus_t GGS_AddService( uint32 services )
+{
+  (void)services;
+  return ( SUCCESS );
+}
+
+bStatus_t GGS_SetParameter( uint8 param, uint8 len, void *value )
+{
+  (void)param;
+  (void)len;
+  (void)value;
+  return ( SUCCESS );
+}
+
+hciStatus_t HCI_ReadRssiCmd( uint16 connHandle )
+{
+  (void)connHandle;
+  return ( HCI_SUCCESS );
+}
+
+hciStatus_t HCI_LE_ClearWhiteListCmd( void )
+{
+  return ( HCI_SUCCESS );
+}
+
+hciStatus_t HCI_LE_AddWhiteListCmd( uint8 addrType, uint8 *devAddr )
+{
+  (void)addrType;
+  (void)devAddr;
+  return ( HCI_SUCCESS );
+}
+
+llStatus_t LL_Rand( uint8 *randData, uint8 dataLen )
+{
+  while ( dataLen-- )
+  {
+    *randData++ = (uint8)osal_rand();
+  }
+
+  return ( LL_STATUS_SUCCESS );
+}
+
+/*********************************************************************
+ * MODEL TASK
+ */
+
+uint16 hostGapProcessEvent( uint8 taskId, uint16 events )
+{
+  (void)taskId;
+
+  if ( events & HOST_GAP_HDC_END_EVT )
+  {
+    // Reported as a connection that was not accepted
+    gapEstLinkReqEvent_t *pMsg;
+
+    hostGapAdvStop();
+    pMsg = hostGapMsg( GAP_LINK_ESTABLISHED_EVENT, bleGAPConnNotAcceptable,
+                       sizeof ( gapEstLinkReqEvent_t ) );
+    pMsg->connectionHandle = INVALID_CONNHANDLE;
+    hostGapSend( hostGapRoleTaskId, pMsg );
+
+    return ( events ^ HOST_GAP_HDC_END_EVT );
+  }
+
+  if ( events & HOST_GAP_LIM_END_EVT )
+  {
+    hostGapAdvStop();
+    hostGapSend( hostGapRoleTaskId, hostGapMsg( GAP_END_DISCOVERABLE_DONE_EVENT, SUCCESS,
+                                                sizeof ( gapEndDiscoverableRspEvent_t ) ) );
+
+    return ( events ^ HOST_GAP_LIM_END_EVT );
+  }
+
+  return ( 0 );
+}
+
+/*********************************************************************
+ * HOST CONTROL
+ */
+
+void hostGapInit( uint8 taskId )
+{
+  hostGapTaskId = taskId;
+  hostGapRoleTaskId = INVALID_TASK_ID;
+
+  // The stack's defaults for what the firmware does not set
+  memset( hostGapParams, 0, sizeof ( hostGapParams ) );
+  hostGapParams[TGAP_LIM_ADV_TIMEOUT] = 180;
+  hostGapParams[TGAP_GEN_DISC_ADV_INT_MIN] = 160;
+  hostGapParams[TGAP_GEN_DISC_ADV_INT_MAX] = 160;
+  hostGapParams[TGAP_LIM_DISC_ADV_INT_MIN] = 160;
+  hostGapParams[TGAP_LIM_DISC_ADV_INT_MAX] = 160;
+  hostGapParams[TGAP_CONN_PARAM_TIMEOUT] = 30000;
+  hostGapParams[TGAP_CONN_PAUSE_PERIPHERAL] = 5;
+  hostGapParams[TGAP_AUTH_TASK_ID] = INVALID_TASK_ID;
+
+  hostGapAdvertising = FALSE;
+  memset( &hostGapAdvParams, 0, sizeof ( hostGapAdvParams ) );
+  hostGapAdvInterval = 0;
+  hostGapAdvStarts = 0;
+  hostGapResolves = 0;
+  hostGapAdvDataLen = 0;
+
+  memset( hostGapParamReqs, 0, sizeof ( hostGapParamReqs ) );
+  hostGapParamReqCount = 0;
+}
+
+uint8 hostGapConnect( uint8 addrType, uint8 *pAddr )
+{
+  gapEstLinkReqEvent_t *pMsg;
+  uint8 eventType = hostGapAdvParams.eventType;
+
+  if ( !hostGapAdvertising ||
+       eventType == GAP_ADTYPE_ADV_SCAN_IND || eventType == GAP_ADTYPE_ADV_NONCONN_IND )
+  {
+    return ( FALSE );
+  }
+
+  // A central only answers directed advertisements that carry its own address
+  if ( ( eventType == GAP_ADTYPE_ADV_HDC_DIRECT_IND ||
+         eventType == GAP_ADTYPE_ADV_LDC_DIRECT_IND ) &&
+       ( addrType != hostGapAdvParams.initiatorAddrType ||
+         memcmp( pAddr, hostGapAdvParams.initiatorAddr, B_ADDR_LEN ) != 0 ) )
+  {
+    return ( FALSE );
+  }
+
+  hostGapAdvStop();
+  hostBleLink( LINK_CONNECTED );
+  hostBleLinkPeer( addrType, pAddr );
+
+  pMsg = hostGapMsg( GAP_LINK_ESTABLISHED_EVENT, SUCCESS, sizeof ( gapEstLinkReqEvent_t ) );
+  pMsg->devAddrType = addrType;
+  memcpy( pMsg->devAddr, pAddr, B_ADDR_LEN );
+  pMsg->connectionHandle = HOST_CONN_HANDLE;
+  pMsg->connInterval = HOST_GAP_CONN_INTERVAL;
+  pMsg->connLatency = HOST_GAP_CONN_LATENCY;
+  pMsg->connTimeout = HOST_GAP_CONN_TIMEOUT;
+  hostGapSend( hostGapRoleTaskId, pMsg );
+
+  return ( TRUE );
+}
+
+void hostGapDisconnect( uint8 reason )
+{
+  gapTerminateLinkEvent_t *pMsg;
+
+  if ( linkDB_NumActive() == 0 )
+  {
+    return;
+  }
+
+  hostBleLink( LINK_NOT_CONNECTED );
+
+  pMsg = hostGapMsg( GAP_LINK_TERMINATED_EVENT, SUCCESS, sizeof ( gapTerminateLinkEvent_t ) );
+  pMsg->connectionHandle = HOST_CONN_HANDLE;
+  pMsg->reason = reason;
+  hostGapSend( hostGapRoleTaskId, pMsg );
+}
+
+void hostGapBond( uint8 *pIRK, uint8 *pIdAddr )
+{
+  gapAuthCompleteEvent_t *pMsg;
+  smSecurityInfo_t *pSecurityInfo;
+  smIdentityInfo_t *pIdentityInfo;
+
+  // The keys travel in the same message, as from the stack
+  pMsg = hostGapMsg( GAP_AUTHENTICATION_COMPLETE_EVENT, SUCCESS,
+                     sizeof ( gapAuthCompleteEvent_t ) + sizeof ( smSecurityInfo_t ) +
+                     sizeof ( smIdentityInfo_t ) );
+  pSecurityInfo = (smSecurityInfo_t *)( pMsg + 1 );
+  pIdentityInfo = (smIdentityInfo_t *)( pSecurityInfo + 1 );
+
+  memset( pSecurityInfo->ltk, 0x5A, KEYLEN );
+  pSecurityInfo->keySize = KEYLEN;
+  memcpy( pIdentityInfo->irk, pIRK, KEYLEN );
+  memcpy( pIdentityInfo->bd_addr, pIdAddr, B_ADDR_LEN );
+
+  pMsg->connectionHandle = HOST_CONN_HANDLE;
+  pMsg->authState = SM_AUTH_STATE_BONDING | SM_AUTH_STATE_AUTHENTICATED;
+  pMsg->pSecurityInfo = pSecurityInfo;
+  pMsg->pIdentityInfo = pIdentityInfo;
+  hostGapSend( (uint8)hostGapParams[TGAP_AUTH_TASK_ID], pMsg );
+}
+
+void hostGapMakeRPA( uint8 *pIRK, uint8 prand, uint8 *pAddr )
+{
+  // The two top bits of a resolvable private address are 01
+  pAddr[3] = prand;
+  pAddr[4] = prand ^ 0xA5;
+  pAddr[5] = 0x40 | ( prand & 0x3F );
+  hostGapHash( pIRK, &pAddr[3], pAddr );
+}
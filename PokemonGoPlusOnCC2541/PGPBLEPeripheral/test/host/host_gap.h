@@ -0,0 +1,97 @@
+/**************************************************************************************************
+  Filename:       host_gap.h
+
+  Description:    Control of the host model of the GAP layer used by the host tests:
+                  advertising, the one link of host_ble.c coming up and going down,
+                  connection parameter requests and pairing.
+**************************************************************************************************/
+
+#ifndef HOST_GAP_H
+#define HOST_GAP_H
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "bcomdef.h"
+#include "gap.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// The controller ends high duty cycle directed advertising after 1.28s
+#define HOST_GAP_HDC_DURATION      1280
+
+// Connection parameter requests kept since hostGapInit()
+#define HOST_GAP_PARAM_REQ_MAX     16
+
+// Connection parameters of a new link: 30ms, as phones pick
+#define HOST_GAP_CONN_INTERVAL     24
+#define HOST_GAP_CONN_LATENCY      0
+#define HOST_GAP_CONN_TIMEOUT      200
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct
+{
+  uint32 time;                  // osal_GetSystemClock() when it was sent
+  gapUpdateLinkParamReq_t req;
+} hostGapParamReq_t;
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+// Advertising now, with these parameters, at this interval (625us units)
+extern uint8 hostGapAdvertising;
+extern gapAdvertisingParams_t hostGapAdvParams;
+extern uint16 hostGapAdvInterval;
+
+// GAP_MakeDiscoverable() calls that started advertising
+extern uint16 hostGapAdvStarts;
+
+// GAP_UpdateLinkParamReq() calls, oldest first
+extern hostGapParamReq_t hostGapParamReqs[HOST_GAP_PARAM_REQ_MAX];
+extern uint8 hostGapParamReqCount;
+
+// GAP_ResolvePrivateAddr() calls, each an AES operation on the target
+extern uint16 hostGapResolves;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Reset the model and make it OSAL task taskId, which the test installs
+ * hostGapProcessEvent() for. Call after hostInit() and hostBleInit().
+ */
+extern void hostGapInit( uint8 taskId );
+extern uint16 hostGapProcessEvent( uint8 taskId, uint16 events );
+
+/*
+ * A central with this address connects. It only can while connectable
+ * advertisements are out, and directed ones only reach the central whose
+ * address they carry. Returns TRUE if the link came up.
+ */
+extern uint8 hostGapConnect( uint8 addrType, uint8 *pAddr );
+
+/*
+ * The link goes down for this reason, e.g. LL_SUPERVISION_TIMEOUT_TERM.
+ */
+extern void hostGapDisconnect( uint8 reason );
+
+/*
+ * The central pairs and bonds, distributing its identity: this IRK and
+ * identity address.
+ */
+extern void hostGapBond( uint8 *pIRK, uint8 *pIdAddr );
+
+/*
+ * A resolvable private address of the central with this IRK. The hash is
+ * a stand-in for the AES based ah(); GAP_ResolvePrivateAddr() checks it.
+ */
+extern void hostGapMakeRPA( uint8 *pIRK, uint8 prand, uint8 *pAddr );
+
+#endif /* HOST_GAP_H */
@@ -0,0 +1,269 @@
+/**************************************************************************************************
+  Filename:       host_hal.c
+
+  Description:    Host side of the HAL and the OSAL port for the host tests: interrupt
+                  flag, RAM backed flash, the link layer's 625 us clock, assertions and
+                  the OSAL task table.
+**************************************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal_types.h"
+#include "hal_adc.h"
+#include "hal_board.h"
+#include "hal_flash.h"
+#include "hal_uart.h"
+#include "OSAL.h"
+#include "OSAL_Tasks.h"
+#include "host_hal.h"
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+// Flash access counters
+hostFlashStats_t hostFlashStats;
+
+// Failed HOST_CHECKs of the running test program
+int hostTestFailures;
+
+// Bytes written to the UART and the room left in its Tx buffer
+uint8 hostUartTx[HOST_UART_TX_MAX];
+uint16 hostUartTxLen;
+uint16 hostUartTxRoom;
+
+// Code of every ADC conversion, and how many were made
+uint16 hostAdcCode;
+uint32 hostAdcReads;
+uint32 hostSleeps;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// All 128 pages of the CC2541 flash; only the NV pages are used
+static uint8 hostFlash[128][HAL_FLASH_PAGE_SIZE];
+
+// Free running count of 625 us ticks, as ll_McuPrecisionCount()
+static uint16 hostTicks;
+static uint32 hostUs;
+
+static hostTaskFn_t hostTaskFns[HOST_TASK_CNT];
+static uint8 hostAsserts;
+
+/*********************************************************************
+ * OSAL TASK TABLE
+ */
+
+static uint16 hostTask0( uint8 id, uint16 events ) { return hostTaskFns[0] ? hostTaskFns[0]( id, events ) : 0; }
+static uint16 hostTask1( uint8 id, uint16 events ) { return hostTaskFns[1] ? hostTaskFns[1]( id, events ) : 0; }
+static uint16 hostTask2( uint8 id, uint16 events ) { return hostTaskFns[2] ? hostTaskFns[2]( id, events ) : 0; }
+static uint16 hostTask3( uint8 id, uint16 events ) { return hostTaskFns[3] ? hostTaskFns[3]( id, events ) : 0; }
+static uint16 hostTask4( uint8 id, uint16 events ) { return hostTaskFns[4] ? hostTaskFns[4]( id, events ) : 0; }
+static uint16 hostTask5( uint8 id, uint16 events ) { return hostTaskFns[5] ? hostTaskFns[5]( id, events ) : 0; }
+static uint16 hostTask6( uint8 id, uint16 events ) { return hostTaskFns[6] ? hostTaskFns[6]( id, events ) : 0; }
+static uint16 hostTask7( uint8 id, uint16 events ) { return hostTaskFns[7] ? hostTaskFns[7]( id, events ) : 0; }
+
+const pTaskEventHandlerFn tasksArr[HOST_TASK_CNT] =
+{
+  hostTask0,
+  hostTask1,
+  hostTask2,
+  hostTask3,
+  hostTask4,
+  hostTask5,
+  hostTask6,
+  hostTask7
+};
+
+const uint8 tasksCnt = HOST_TASK_CNT;
+uint16 *tasksEvents;
+
+void osalInitTasks( void )
+{
+  tasksEvents = (uint16 *)osal_mem_alloc( sizeof ( uint16 ) * tasksCnt );
+  osal_memset( tasksEvents, 0, ( sizeof ( uint16 ) * tasksCnt ) );
+}
+
+/*********************************************************************
+ * HAL
+ */
+
+void HalFlashRead( uint8 pg, uint16 offset, uint8 *buf, uint16 cnt )
+{
+  hostFlashStats.reads++;
+  hostFlashStats.readBytes += cnt;
+  memcpy( buf, &hostFlash[pg][offset], cnt );
+}
+
+// addr is in flash words and cnt counts words, as on the CC2541
+void HalFlashWrite( uint16 addr, uint8 *buf, uint16 cnt )
+{
+  uint8 *pFlash = &hostFlash[0][0] + ( (uint32)addr * HAL_FLASH_WORD_SIZE );
+  uint16 i;
+
+  hostFlashStats.writes++;
+  for ( i = 0; i < cnt * HAL_FLASH_WORD_SIZE; i++ )
+  {
+    // Programming can only clear bits
+    pFlash[i] &= buf[i];
+  }
+}
+
+void HalFlashErase( uint8 pg )
+{
+  hostFlashStats.erases++;
+  memset( hostFlash[pg], 0xFF, HAL_FLASH_PAGE_SIZE );
+}
+
+// All or nothing, as the DMA driver
+uint16 HalUARTWrite( uint8 port, uint8 *buf, uint16 len )
+{
+  (void)port;
+
+  if ( ( len > hostUartTxRoom ) || ( hostUartTxLen + len > HOST_UART_TX_MAX ) )
+  {
+    return ( 0 );
+  }
+
+  memcpy( &hostUartTx[hostUartTxLen], buf, len );
+  hostUartTxLen += len;
+  hostUartTxRoom -= len;
+
+  return ( len );
+}
+
+uint16 HalAdcRead( uint8 channel, uint8 resolution )
+{
+  (void)channel;
+  (void)resolution;
+  hostAdcReads++;
+  return ( hostAdcCode );
+}
+
+void HalAdcSetReference( uint8 reference )
+{
+  (void)reference;
+}
+
+bool HalAdcCheckVdd( uint8 vdd )
+{
+  (void)vdd;
+  return ( TRUE );
+}
+
+void Hal_ProcessPoll( void )
+{
+}
+
+uint16 Onboard_rand( void )
+{
+  return ( (uint16)rand() );
+}
+
+void halAssertHandler( void )
+{
+  hostAsserts++;
+}
+
+void hostSystemReset( void )
+{
+  fprintf( stderr, "HAL_SYSTEM_RESET\n" );
+  abort();
+}
+
+// The host never sleeps; the OSAL power manager only asks to
+void halSleep( uint32 osal_timeout )
+{
+  (void)osal_timeout;
+  hostSleeps++;
+}
+
+uint32 TimerElapsed( void )
+{
+  return ( 0 );
+}
+
+uint16 ll_McuPrecisionCount( void )
+{
+  return ( hostTicks );
+}
+
+/*********************************************************************
+ * HOST CONTROL
+ */
+
+void hostInit( void )
+{
+  // The clock runs on: OSAL_ClockBLE.c keeps the last tick it saw
+  memset( hostFlash, 0xFF, sizeof ( hostFlash ) );
+  memset( &hostFlashStats, 0, sizeof ( hostFlashStats ) );
+  memset( hostTaskFns, 0, sizeof ( hostTaskFns ) );
+  hostAsserts = 0;
+  hostUartTxLen = 0;
+  hostUartTxRoom = HOST_UART_TX_MAX;
+  hostAdcReads = 0;
+  hostSleeps = 0;
+  EA = 1;
+
+  VOID osal_init_system();
+}
+
+void hostSetTask( uint8 taskId, hostTaskFn_t pFn )
+{
+  hostTaskFns[taskId] = pFn;
+}
+
+uint8 hostAssertCount( void )
+{
+  return ( hostAsserts );
+}
+
+void hostRun( void )
+{
+  uint8 idx;
+
+  for ( ;; )
+  {
+    osal_run_system();
+
+    for ( idx = 0; idx < tasksCnt; idx++ )
+    {
+      if ( tasksEvents[idx] )
+      {
+        break;
+      }
+    }
+
+    // Pending messages show as SYS_EVENT_MSG, so no events means idle
+    if ( idx == tasksCnt )
+    {
+      return;
+    }
+  }
+}
+
+void hostStall( uint32 ms )
+{
+  hostUs += ms * 1000;
+  while ( hostUs >= 625 )
+  {
+    hostUs -= 625;
+    hostTicks++;
+  }
+}
+
+void hostAdvance( uint32 ms )
+{
+  // Step a millisecond at a time so timers fire in order
+  while ( ms-- )
+  {
+    hostStall( 1 );
+    hostRun();
+  }
+}
@@ -0,0 +1,95 @@
+/**************************************************************************************************
+  Filename:       host_hal.h
+
+  Description:    Control of the host HAL and OSAL port used by the host tests.
+**************************************************************************************************/
+
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+/*********************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// OSAL tasks a test can install handlers for
+#define HOST_TASK_CNT     8
+
+// Capacity of the UART capture
+#define HOST_UART_TX_MAX  1024
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef uint16 (*hostTaskFn_t)( uint8 taskId, uint16 events );
+
+typedef struct
+{
+  uint32 reads;       // HalFlashRead calls
+  uint32 readBytes;   // bytes read
+  uint32 writes;      // HalFlashWrite calls
+  uint32 erases;      // page erases
+} hostFlashStats_t;
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+extern hostFlashStats_t hostFlashStats;
+
+// Everything HalUARTWrite() accepted since hostInit(), and how much more it
+// will accept; a test lowers hostUartTxRoom to model a full Tx buffer
+extern uint8 hostUartTx[HOST_UART_TX_MAX];
+extern uint16 hostUartTxLen;
+extern uint16 hostUartTxRoom;
+
+// Code HalAdcRead() returns; a 10-bit conversion is 0-511, as on the CC2541
+extern uint16 hostAdcCode;
+
+// HalAdcRead() calls
+extern uint32 hostAdcReads;
+
+// halSleep() calls: the times the OSAL power manager would have slept
+extern uint32 hostSleeps;
+
+/*********************************************************************
+ * FUNCTIONS
+ */
+
+/*
+ * Erase the flash and run osal_init_system().
+ */
+extern void hostInit( void );
+
+/*
+ * Install the event handler of OSAL task taskId (0 - HOST_TASK_CNT-1).
+ */
+extern void hostSetTask( uint8 taskId, hostTaskFn_t pFn );
+
+/*
+ * Run OSAL passes until no task has an event pending.
+ */
+extern void hostRun( void );
+
+/*
+ * Let ms milliseconds pass, running the OSAL after each one.
+ */
+extern void hostAdvance( uint32 ms );
+
+/*
+ * Let ms milliseconds pass without running the OSAL, as a task that holds
+ * the CPU that long would.
+ */
+extern void hostStall( uint32 ms );
+
+/*
+ * Number of HAL_ASSERT failures since hostInit().
+ */
+extern uint8 hostAssertCount( void );
+
+#endif /* HOST_HAL_H */
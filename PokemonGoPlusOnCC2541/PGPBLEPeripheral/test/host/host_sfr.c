@@ -0,0 +1,8 @@
+/**************************************************************************************************
+  Filename:       host_sfr.c
+
+  Description:    Storage for the SFRs declared by the host ioCC2541.h.
+**************************************************************************************************/
+
+#define HOST_SFR( name )  volatile unsigned char name;
+#include "ioCC2541_sfr.h"
@@ -0,0 +1,45 @@
+/**************************************************************************************************
+  Filename:       host_test.h
+
+  Description:    Checks and test runner of the host tests. Each test program is a list
+                  of test functions run from main() with HOST_RUN; a failed check
+                  prints where it failed and the program exits non-zero.
+**************************************************************************************************/
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+
+extern int hostTestFailures;
+
+#define HOST_CHECK( cond )                                                     \
+  do {                                                                         \
+    if ( !( cond ) )                                                           \
+    {                                                                          \
+      printf( "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond );        \
+      hostTestFailures++;                                                      \
+    }                                                                          \
+  } while ( 0 )
+
+#define HOST_CHECK_EQ( a, b )                                                  \
+  do {                                                                         \
+    long _a = (long)( a ), _b = (long)( b );                                   \
+    if ( _a != _b )                                                            \
+    {                                                                          \
+      printf( "%s:%d: check failed: %s == %s (%ld != %ld)\n",                  \
+              __FILE__, __LINE__, #a, #b, _a, _b );                            \
+      hostTestFailures++;                                                      \
+    }                                                                          \
+  } while ( 0 )
+
+#define HOST_RUN( test )                                                       \
+  do {                                                                         \
+    int _before = hostTestFailures;                                            \
+    test();                                                                    \
+    printf( "%-4s %s\n", ( hostTestFailures == _before ) ? "ok" : "FAIL", #test ); \
+  } while ( 0 )
+
+#define HOST_RESULT()  ( hostTestFailures ? 1 : 0 )
+
+#endif /* HOST_TEST_H */
@@ -0,0 +1,22 @@
+#ifndef _HAL_MCU_H
+#define _HAL_MCU_H
+#include "hal_defs.h"
+#include "hal_types.h"
+#include "ioCC2541.h"
+#define HAL_MCU_CC2540
+#define HAL_MCU_LITTLE_ENDIAN()   1
+#define HAL_ISR_FUNCTION(f,v)     void f(void)
+#define HAL_ENABLE_INTERRUPTS()         st( EA = 1; )
+#define HAL_DISABLE_INTERRUPTS()        st( EA = 0; )
+#define HAL_INTERRUPTS_ARE_ENABLED()    (EA)
+typedef unsigned char halIntState_t;
+#define HAL_ENTER_CRITICAL_SECTION(x)   st( x = EA;  HAL_DISABLE_INTERRUPTS(); )
+#define HAL_EXIT_CRITICAL_SECTION(x)    st( EA = x; )
+#define HAL_CRITICAL_STATEMENT(x)       st( halIntState_t _s; HAL_ENTER_CRITICAL_SECTION(_s); x; HAL_EXIT_CRITICAL_SECTION(_s); )
+#define HAL_ENTER_ISR()
+#define HAL_EXIT_ISR()
+#define CLEAR_SLEEP_MODE()
+#define ALLOW_SLEEP_MODE()
+#define HAL_SYSTEM_RESET()  st( hostSystemReset(); )
+extern void hostSystemReset( void );
+#endif
@@ -0,0 +1,7 @@
+#define __near_func
+#define __data
+#define __xdata
+#define __code
+#define __no_init
+#define PTR_TYPE unsigned long *   /* holds a pointer, as unsigned int does on the 8051 */
+#include "hal_mcu.h"
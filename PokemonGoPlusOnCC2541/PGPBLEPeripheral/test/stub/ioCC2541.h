@@ -0,0 +1,12 @@
+/*
+ * Host stand-in for the IAR SFR header: every SFR and SFR bit the host built
+ * sources use is a plain variable, defined in host/host_sfr.c.
+ */
+#ifndef IOCC2541_H
+#define IOCC2541_H
+
+#define HOST_SFR( name )  extern volatile unsigned char name;
+#include "ioCC2541_sfr.h"
+#undef HOST_SFR
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ * SFRs and SFR bits modelled on the host. No include guard: expanded once
+ * for the declarations and once in host_sfr.c for the definitions.
+ */
+
+/* Interrupts */
+HOST_SFR( EA )
+HOST_SFR( T1IE )
+HOST_SFR( T1IF )
+
+/* Ports */
+HOST_SFR( P0 )
+HOST_SFR( P0SEL )
+HOST_SFR( P0DIR )
+HOST_SFR( P0IEN )
+HOST_SFR( P0IFG )
+HOST_SFR( P0IF )
+HOST_SFR( PICTL )
+HOST_SFR( IEN1 )
+HOST_SFR( P1 )
+HOST_SFR( P1_0 )
+HOST_SFR( P1_1 )
+HOST_SFR( P1_4 )
+HOST_SFR( P2_0 )
+HOST_SFR( P1DIR )
+HOST_SFR( P2DIR )
+HOST_SFR( P1SEL )
+HOST_SFR( P2SEL )
+HOST_SFR( PERCFG )
+
+/* Timer 1 */
+HOST_SFR( T1CTL )
+HOST_SFR( T1STAT )
+HOST_SFR( T1CCTL0 )
+HOST_SFR( T1CCTL1 )
+HOST_SFR( T1CCTL2 )
+HOST_SFR( T1CC0L )
+HOST_SFR( T1CC0H )
+HOST_SFR( T1CC1L )
+HOST_SFR( T1CC1H )
+HOST_SFR( T1CC2L )
+HOST_SFR( T1CC2H )
+HOST_SFR( TIMIF )
+
+/* Timer 3 */
+HOST_SFR( T3CTL )
+HOST_SFR( T3CCTL1 )
+HOST_SFR( T3CC0 )
+
+/* Timer 4 */
+HOST_SFR( T4CTL )
+HOST_SFR( T4CCTL0 )
+HOST_SFR( T4CC0 )
+
+/* Memory arbiter and DMA */
+HOST_SFR( MEMCTR )
+HOST_SFR( DMAARM )
+HOST_SFR( DMAREQ )
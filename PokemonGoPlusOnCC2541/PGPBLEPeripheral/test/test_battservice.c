@@ -0,0 +1,163 @@
+/**************************************************************************************************
+  Filename:       test_battservice.c
+
+  Description:    Host tests of the Battery service's voltage to level mapping: the CR2032
+                  curve, its clamps and interpolation, the VDD/3 channel scaling and the
+                  calibration, and the notification of a level change.
+**************************************************************************************************/
+
+#include "bcomdef.h"
+#include "OSAL.h"
+#include "osal_snv.h"
+#include "hal_adc.h"
+#include "linkdb.h"
+#include "battservice.h"
+#include "host_hal.h"
+#include "host_ble.h"
+#include "host_test.h"
+
+// Full scale at which one 10-bit ADC code is exactly 10 mV after decimation
+#define TEST_FULL_SCALE   5110
+
+static uint16 battCccHandle;
+
+static void testSetup( uint16 fullScale )
+{
+  hostInit();
+  hostBleInit();
+  VOID osal_snv_init();
+
+  HOST_CHECK_EQ( Batt_AddService(), SUCCESS );
+  Batt_Setup( HAL_ADC_CHANNEL_VDD, fullScale, NULL, NULL, NULL );
+
+  // The level's CCC follows the service and characteristic declarations
+  // and the level value
+  VOID Batt_GetParameter( BATT_PARAM_SERVICE_HANDLE, &battCccHandle );
+  battCccHandle += 3;
+}
+
+// Level measured for a battery at mV, on the TEST_FULL_SCALE channel
+static uint8 testLevelAt( uint16 mV )
+{
+  uint8 level;
+
+  hostAdcCode = mV / 10;
+  VOID Batt_MeasLevel();
+  VOID Batt_GetParameter( BATT_PARAM_LEVEL, &level );
+
+  return ( level );
+}
+
+static void testCurvePoints( void )
+{
+  testSetup( TEST_FULL_SCALE );
+
+  HOST_CHECK_EQ( testLevelAt( 3000 ), 100 );
+  HOST_CHECK_EQ( testLevelAt( 2900 ), 42 );
+  HOST_CHECK_EQ( testLevelAt( 2740 ), 18 );
+  HOST_CHECK_EQ( testLevelAt( 2440 ), 6 );
+  HOST_CHECK_EQ( testLevelAt( 2000 ), 0 );
+}
+
+static void testInterpolation( void )
+{
+  testSetup( TEST_FULL_SCALE );
+
+  // Rounded to nearest between the points around each voltage
+  HOST_CHECK_EQ( testLevelAt( 2950 ), 71 );
+  HOST_CHECK_EQ( testLevelAt( 2820 ), 30 );
+  HOST_CHECK_EQ( testLevelAt( 2600 ), 12 );
+  HOST_CHECK_EQ( testLevelAt( 2220 ), 3 );
+}
+
+static void testClamps( void )
+{
+  testSetup( TEST_FULL_SCALE );
+
+  HOST_CHECK_EQ( testLevelAt( 3300 ), 100 );
+  HOST_CHECK_EQ( testLevelAt( 1900 ), 0 );
+  HOST_CHECK_EQ( testLevelAt( 0 ), 0 );
+}
+
+static void testMonotonic( void )
+{
+  uint16 mV;
+  uint8 last = 100;
+  uint8 level;
+
+  testSetup( TEST_FULL_SCALE );
+
+  for ( mV = 3300; mV >= 1800; mV -= 10 )
+  {
+    level = testLevelAt( mV );
+    HOST_CHECK( level <= last );
+    last = level;
+  }
+}
+
+static void testVddChannel( void )
+{
+  uint16 mV;
+  uint8 level;
+
+  testSetup( BATT_FULL_SCALE_VDD );
+
+  // A fresh cell on the VDD/3 channel: 4 x 409 of 2044 codes at 3750 mV
+  hostAdcCode = 409;
+  VOID Batt_MeasLevel();
+  VOID Batt_GetParameter( BATT_PARAM_VOLTAGE, &mV );
+  VOID Batt_GetParameter( BATT_PARAM_LEVEL, &level );
+  HOST_CHECK_EQ( mV, 3001 );
+  HOST_CHECK_EQ( level, 100 );
+
+  // A spent one
+  hostAdcCode = 273;
+  VOID Batt_MeasLevel();
+  VOID Batt_GetParameter( BATT_PARAM_VOLTAGE, &mV );
+  VOID Batt_GetParameter( BATT_PARAM_LEVEL, &level );
+  HOST_CHECK_EQ( mV, 2003 );
+  HOST_CHECK_EQ( level, 0 );
+}
+
+static void testCalibration( void )
+{
+  battCal_t cal = { BATT_CAL_GAIN_UNITY, -100 };
+  battCal_t loaded;
+
+  testSetup( TEST_FULL_SCALE );
+
+  HOST_CHECK_EQ( Batt_SetParameter( BATT_PARAM_CALIBRATION, sizeof ( cal ), &cal ), SUCCESS );
+  HOST_CHECK_EQ( testLevelAt( 3000 ), 42 );
+
+  // Loaded from SNV by the next start
+  HOST_CHECK_EQ( osal_snv_read( BATT_NVID_CAL, sizeof ( loaded ), &loaded ), SUCCESS );
+  HOST_CHECK_EQ( loaded.offset, -100 );
+}
+
+static void testNotifiesLevel( void )
+{
+  testSetup( TEST_FULL_SCALE );
+  hostBleLink( LINK_CONNECTED );
+
+  HOST_CHECK_EQ( testLevelAt( 3000 ), 100 );
+  HOST_CHECK_EQ( hostBleWriteCCC( battCccHandle, GATT_CLIENT_CFG_NOTIFY ), SUCCESS );
+
+  HOST_CHECK_EQ( testLevelAt( 2900 ), 42 );
+  HOST_CHECK_EQ( hostNotiCount, 1 );
+  HOST_CHECK_EQ( hostNoti[0].handle, battCccHandle - 1 );
+  HOST_CHECK_EQ( hostNoti[0].value[0], 42 );
+  HOST_CHECK_EQ( hostBmOutstanding, 0 );
+}
+
+int main( void )
+{
+  HOST_RUN( testCurvePoints );
+  HOST_RUN( testInterpolation );
+  HOST_RUN( testClamps );
+  HOST_RUN( testMonotonic );
+  HOST_RUN( testVddChannel );
+  HOST_RUN( testCalibration );
+  HOST_RUN( testNotifiesLevel );
+
+  return ( HOST_RESULT() );
+}
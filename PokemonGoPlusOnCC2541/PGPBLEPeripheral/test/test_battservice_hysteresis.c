@@ -0,0 +1,135 @@
+/**************************************************************************************************
+  Filename:       test_battservice_hysteresis.c
+
+  Description:    Host test of the Battery service's level notifications at the default
+                  BATT_LEVEL_HYSTERESIS, over a noisy trace of a cell draining from full
+                  to empty: the noise within the band is not notified, while crossing
+                  the critical level and reaching 0% always are.
+**************************************************************************************************/
+
+#include "bcomdef.h"
+#include "OSAL.h"
+#include "osal_snv.h"
+#include "hal_adc.h"
+#include "linkdb.h"
+#include "battservice.h"
+#include "host_hal.h"
+#include "host_ble.h"
+#include "host_test.h"
+
+// Full scale at which one 10-bit ADC code is exactly 10 mV after decimation
+#define TEST_FULL_SCALE   5110
+
+// As simpleBLEPeripheral.c sets it
+#define TEST_CRITICAL     6
+
+// The trace: a measurement every TEST_STEP mV down from TEST_FULL_MV to
+// TEST_EMPTY_MV, then TEST_EMPTY_CNT more at TEST_EMPTY_MV, each off by up
+// to TEST_NOISE mV
+#define TEST_FULL_MV      3000
+#define TEST_EMPTY_MV     2000
+#define TEST_STEP         5
+#define TEST_EMPTY_CNT    20
+#define TEST_NOISE        20
+
+static uint16 battCccHandle;
+
+// Notifications so far, those across the critical level, and the last
+// level notified
+static uint16 testNotis;
+static uint8 testCrossings;
+static uint8 testLast;
+
+// Noise in -TEST_NOISE..TEST_NOISE mV, the same on every run
+static int16 testNoise( void )
+{
+  static uint32 seed = 1;
+
+  seed = seed * 1103515245UL + 12345;
+
+  return ( (int16)( ( seed >> 16 ) % ( 2 * TEST_NOISE + 1 ) ) - TEST_NOISE );
+}
+
+// Measure a battery at mV plus noise and check the notification, if any: a
+// change of less than the hysteresis is only notified across the critical
+// level or down to 0%
+static void testMeasure( uint16 mV )
+{
+  uint8 i;
+
+  hostAdcCode = ( mV + testNoise() ) / 10;
+  VOID Batt_MeasLevel();
+
+  for ( i = 0; i < hostNotiCount; i++ )
+  {
+    uint8 value = hostNoti[i].value[0];
+    uint8 delta = ( value > testLast ) ? value - testLast : testLast - value;
+
+    HOST_CHECK_EQ( hostNoti[i].handle, battCccHandle - 1 );
+    if ( ( value < TEST_CRITICAL ) != ( testLast < TEST_CRITICAL ) )
+    {
+      testCrossings++;
+    }
+    else if ( value != 0 )
+    {
+      HOST_CHECK( delta >= 3 );
+    }
+    testLast = value;
+    testNotis++;
+  }
+  hostNotiCount = 0;
+}
+
+static void testNoisyDrain( void )
+{
+  uint8 critical = TEST_CRITICAL;
+  uint16 measurements = 0;
+  uint8 level;
+  uint8 i;
+  uint16 mV;
+
+  hostInit();
+  hostBleInit();
+  VOID osal_snv_init();
+
+  HOST_CHECK_EQ( Batt_AddService(), SUCCESS );
+  Batt_Setup( HAL_ADC_CHANNEL_VDD, TEST_FULL_SCALE, NULL, NULL, NULL );
+  VOID Batt_SetParameter( BATT_PARAM_CRITICAL_LEVEL, sizeof ( uint8 ), &critical );
+  VOID Batt_GetParameter( BATT_PARAM_SERVICE_HANDLE, &battCccHandle );
+  battCccHandle += 3;
+
+  hostBleLink( LINK_CONNECTED );
+  HOST_CHECK_EQ( hostBleWriteCCC( battCccHandle, GATT_CLIENT_CFG_NOTIFY ), SUCCESS );
+  testLast = 100;
+
+  for ( mV = TEST_FULL_MV; mV > TEST_EMPTY_MV; mV -= TEST_STEP )
+  {
+    testMeasure( mV );
+    measurements++;
+  }
+  for ( i = 0; i < TEST_EMPTY_CNT; i++ )
+  {
+    testMeasure( TEST_EMPTY_MV );
+    measurements++;
+  }
+
+  printf( "     %u measurements, %u notifications, %u across the critical level\n",
+          measurements, testNotis, testCrossings );
+
+  VOID Batt_GetParameter( BATT_PARAM_LEVEL, &level );
+  HOST_CHECK_EQ( level, 0 );
+  HOST_CHECK_EQ( testLast, 0 );
+  // Above 2.75 V, where the curve is steep, the noise spans the hysteresis
+  // and some of it is notified; below, only the drain is. The noise also
+  // takes the level back over the critical one once before it stays below.
+  HOST_CHECK_EQ( testNotis, 35 );
+  HOST_CHECK_EQ( testCrossings, 3 );
+  HOST_CHECK_EQ( hostBmOutstanding, 0 );
+}
+
+int main( void )
+{
+  HOST_RUN( testNoisyDrain );
+
+  return ( HOST_RESULT() );
+}
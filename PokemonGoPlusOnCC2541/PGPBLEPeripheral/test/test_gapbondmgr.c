@@ -0,0 +1,400 @@
+/**************************************************************************************************
+  Filename:       test_gapbondmgr.c
+
+  Description:    Host tests of the bond store of the bond manager at GAP_BONDINGS_MAX
+                  bonds, on osal_snv.c over the RAM backed flash: every slot filled,
+                  the least recently connected bond replaced when all are in use, the
+                  connection order kept across a reset, the flash a reconnection and a
+                  replacement cost, bonds surviving the compaction of the page, and
+                  the AES operations resolving a private address costs.
+**************************************************************************************************/
+
+#include "bcomdef.h"
+#include "OSAL.h"
+#include "osal_snv.h"
+#include "linkdb.h"
+#include "gap.h"
+#include "gapbondmgr.h"
+#include "host_hal.h"
+#include "host_ble.h"
+#include "host_gap.h"
+#include "host_test.h"
+
+// OSAL tasks
+#define TASK_GAP          0
+#define TASK_GAPBONDMGR   1
+
+// Bond NV items, as gapbondmgr.c lays them out
+#define TEST_BOND_REC_IDS         6
+#define TEST_DEV_CSRK_OFFSET      4
+#define TEST_DEV_SIGN_OFFSET      5
+#define testNvID(idx, offset)     ( BLE_NVID_GAP_BOND_START + \
+                                    (idx) * TEST_BOND_REC_IDS + (offset) )
+
+// Centrals in the tests: more than the store holds
+#define TEST_CENTRAL_CNT  ( GAP_BONDINGS_MAX + 2 )
+
+// New bonds in the churn, enough to compact the SNV page several times
+#define TEST_CHURN        200
+
+/*********************************************************************
+ * HELPERS
+ */
+
+// Public address and IRK of central n
+static void testCentral( uint16 n, uint8 *pAddr, uint8 *pIRK )
+{
+  uint8 i;
+
+  for ( i = 0; i < B_ADDR_LEN; i++ )
+  {
+    pAddr[i] = 0x10 + i;
+  }
+  pAddr[0] = LO_UINT16( n );
+  pAddr[1] = HI_UINT16( n );
+
+  if ( pIRK != NULL )
+  {
+    VOID osal_memset( pIRK, LO_UINT16( n ) ^ 0x5A, KEYLEN );
+  }
+}
+
+static uint8 testBondIdx( uint16 n )
+{
+  uint8 addr[B_ADDR_LEN];
+
+  testCentral( n, addr, NULL );
+
+  return ( GAPBondMgr_ResolveAddr( ADDRTYPE_PUBLIC, addr, NULL ) );
+}
+
+// Resolve a private address, counting the AES operations it takes
+static uint8 testResolve( uint8 *pAddr, uint16 *pResolves )
+{
+  uint16 resolves = hostGapResolves;
+  uint8 idx = GAPBondMgr_ResolveAddr( ADDRTYPE_PRIVATE_RESOLVE, pAddr, NULL );
+
+  *pResolves = hostGapResolves - resolves;
+
+  return ( idx );
+}
+
+// Resolvable private address prand of central n
+static void testRPA( uint16 n, uint8 prand, uint8 *pAddr )
+{
+  uint8 idAddr[B_ADDR_LEN];
+  uint8 irk[KEYLEN];
+
+  testCentral( n, idAddr, irk );
+  hostGapMakeRPA( irk, prand, pAddr );
+}
+
+static uint8 testBondCount( void )
+{
+  uint8 count = 0;
+
+  VOID GAPBondMgr_GetParameter( GAPBOND_BOND_COUNT, &count );
+
+  return ( count );
+}
+
+// The bond manager starting on the flash as it is, as after a reset
+static void testStart( void )
+{
+  uint8 bonding = TRUE;
+
+  hostBleInit();
+  hostGapInit( TASK_GAP );
+
+  hostSetTask( TASK_GAP, hostGapProcessEvent );
+  hostSetTask( TASK_GAPBONDMGR, GAPBondMgr_ProcessEvent );
+
+  GAPBondMgr_Init( TASK_GAPBONDMGR );
+
+  // As the GAP role and the application do
+  GAPBondMgr_Register( NULL );
+  VOID GAPBondMgr_SetParameter( GAPBOND_BONDING_ENABLED, sizeof ( uint8 ), &bonding );
+  hostRun();
+}
+
+// Erased flash and an empty store
+static void testSetup( void )
+{
+  hostInit();
+  VOID osal_snv_init();
+  testStart();
+
+  HOST_CHECK_EQ( testBondCount(), 0 );
+}
+
+// Central n connects, and pairs and bonds if asked to; the link stays up
+static void testConnect( uint16 n, uint8 bond )
+{
+  uint8 addr[B_ADDR_LEN];
+  uint8 irk[KEYLEN];
+
+  testCentral( n, addr, irk );
+
+  hostBleLink( LINK_CONNECTED );
+  hostBleLinkPeer( ADDRTYPE_PUBLIC, addr );
+  VOID GAPBondMgr_LinkEst( ADDRTYPE_PUBLIC, addr, HOST_CONN_HANDLE, GAP_PROFILE_PERIPHERAL );
+  hostRun();
+
+  if ( bond )
+  {
+    hostGapBond( irk, addr );
+    hostRun();
+  }
+}
+
+static void testDisconnect( void )
+{
+  hostBleLink( LINK_NOT_CONNECTED );
+  GAPBondMgr_LinkTerm( HOST_CONN_HANDLE );
+  hostRun();
+}
+
+// Central n connects, bonds and disconnects
+static void testBond( uint16 n )
+{
+  testConnect( n, TRUE );
+  testDisconnect();
+}
+
+static void testReconnect( uint16 n )
+{
+  testConnect( n, FALSE );
+  testDisconnect();
+}
+
+// Bond centrals 0 to GAP_BONDINGS_MAX-1, filling the store
+static void testFill( void )
+{
+  uint16 n;
+
+  for ( n = 0; n < GAP_BONDINGS_MAX; n++ )
+  {
+    testBond( n );
+  }
+}
+
+/*********************************************************************
+ * TESTS
+ */
+
+static void testFillsEverySlot( void )
+{
+  uint16 n;
+  uint8 used[GAP_BONDINGS_MAX] = { 0 };
+
+  testSetup();
+  testFill();
+
+  HOST_CHECK_EQ( testBondCount(), GAP_BONDINGS_MAX );
+
+  for ( n = 0; n < GAP_BONDINGS_MAX; n++ )
+  {
+    uint8 idx = testBondIdx( n );
+
+    HOST_CHECK( idx < GAP_BONDINGS_MAX );
+    if ( idx < GAP_BONDINGS_MAX )
+    {
+      HOST_CHECK( !used[idx] );
+      used[idx] = TRUE;
+    }
+  }
+}
+
+// With every slot in use a new bond takes the slot of the bond that
+// connected longest ago, not the one bonded first
+static void testReplacesLeastRecentlyConnected( void )
+{
+  uint8 idx;
+
+  testSetup();
+  testFill();
+
+  testReconnect( 0 );
+  idx = testBondIdx( 1 );
+  testBond( GAP_BONDINGS_MAX );
+
+  HOST_CHECK_EQ( testBondCount(), GAP_BONDINGS_MAX );
+  HOST_CHECK_EQ( testBondIdx( 1 ), GAP_BONDINGS_MAX );
+  HOST_CHECK_EQ( testBondIdx( GAP_BONDINGS_MAX ), idx );
+  HOST_CHECK( testBondIdx( 0 ) < GAP_BONDINGS_MAX );
+  HOST_CHECK( testBondIdx( 2 ) < GAP_BONDINGS_MAX );
+}
+
+// The connection order is in NV, so after a reset the next bond still
+// replaces the least recently connected one
+static void testOrderSurvivesReset( void )
+{
+  testSetup();
+  testFill();
+  testReconnect( 0 );
+  testReconnect( 1 );
+
+  testStart();
+  HOST_CHECK_EQ( testBondCount(), GAP_BONDINGS_MAX );
+
+  testBond( GAP_BONDINGS_MAX );
+  testBond( GAP_BONDINGS_MAX + 1 );
+
+  HOST_CHECK_EQ( testBondIdx( 2 ), GAP_BONDINGS_MAX );
+  HOST_CHECK_EQ( testBondIdx( 3 ), GAP_BONDINGS_MAX );
+  HOST_CHECK( testBondIdx( 0 ) < GAP_BONDINGS_MAX );
+  HOST_CHECK( testBondIdx( 1 ) < GAP_BONDINGS_MAX );
+}
+
+// Looking a bond up by address reads no flash, and the bond that connected
+// last reconnecting writes none
+static void testLookupAndReconnectCost( void )
+{
+  hostFlashStats_t before;
+  uint16 n;
+
+  testSetup();
+  testFill();
+
+  before = hostFlashStats;
+  for ( n = 0; n < GAP_BONDINGS_MAX; n++ )
+  {
+    HOST_CHECK( testBondIdx( n ) < GAP_BONDINGS_MAX );
+  }
+  HOST_CHECK_EQ( hostFlashStats.reads, before.reads );
+
+  before = hostFlashStats;
+  testReconnect( GAP_BONDINGS_MAX - 1 );
+  testReconnect( GAP_BONDINGS_MAX - 1 );
+  HOST_CHECK_EQ( hostFlashStats.writes, before.writes );
+  HOST_CHECK_EQ( hostFlashStats.erases, before.erases );
+}
+
+// Replacing a bond writes over only the items the old bond had: the
+// centrals send no CSRK, so no CSRK or sign counter item appears
+static void testReplaceCreatesNoItems( void )
+{
+  uint8 idx;
+  uint8 buf[KEYLEN];
+
+  testSetup();
+  testFill();
+
+  idx = testBondIdx( 0 );
+  testBond( GAP_BONDINGS_MAX );
+  HOST_CHECK_EQ( testBondIdx( GAP_BONDINGS_MAX ), idx );
+
+  HOST_CHECK( osal_snv_read( testNvID( idx, TEST_DEV_CSRK_OFFSET ), KEYLEN, buf ) != SUCCESS );
+  HOST_CHECK( osal_snv_read( testNvID( idx, TEST_DEV_SIGN_OFFSET ), sizeof ( uint32 ),
+                             buf ) != SUCCESS );
+}
+
+// New centrals bonding one after the other with the store full keep the
+// page compacting; the last GAP_BONDINGS_MAX of them stay bonded through it
+static void testChurnThroughCompaction( void )
+{
+  uint32 erases;
+  uint16 n;
+
+  testSetup();
+  testFill();
+
+  erases = hostFlashStats.erases;
+  for ( n = GAP_BONDINGS_MAX; n < GAP_BONDINGS_MAX + TEST_CHURN; n++ )
+  {
+    testBond( n );
+  }
+  HOST_CHECK( hostFlashStats.erases > erases );
+
+  testStart();
+  HOST_CHECK_EQ( testBondCount(), GAP_BONDINGS_MAX );
+  for ( n = TEST_CHURN; n < GAP_BONDINGS_MAX + TEST_CHURN; n++ )
+  {
+    HOST_CHECK( testBondIdx( n ) < GAP_BONDINGS_MAX );
+  }
+  HOST_CHECK_EQ( testBondIdx( TEST_CHURN - 1 ), GAP_BONDINGS_MAX );
+}
+
+// With every slot holding an IRK: the address that resolved last costs no
+// AES operation, a new address of the same central one, another central's
+// the probe and at most the other bonds, and an address no bond resolves
+// every bond. Overwriting or erasing the bond that resolved last leaves no
+// stale address or IRK behind.
+static void testResolveCost( void )
+{
+  uint8 rpa[B_ADDR_LEN];
+  uint8 addr[B_ADDR_LEN];
+  uint8 irk[KEYLEN];
+  uint8 value[1 + B_ADDR_LEN];
+  uint8 idx3, idx7;
+  uint16 resolves;
+
+  testSetup();
+  testFill();
+  idx3 = testBondIdx( 3 );
+  idx7 = testBondIdx( 7 );
+
+  // Nothing resolved yet: the bonds in slot order up to central 3's
+  testRPA( 3, 1, rpa );
+  HOST_CHECK_EQ( testResolve( rpa, &resolves ), idx3 );
+  HOST_CHECK_EQ( resolves, idx3 + 1 );
+
+  HOST_CHECK_EQ( testResolve( rpa, &resolves ), idx3 );
+  HOST_CHECK_EQ( resolves, 0 );
+
+  testRPA( 3, 2, rpa );
+  HOST_CHECK_EQ( testResolve( rpa, &resolves ), idx3 );
+  HOST_CHECK_EQ( resolves, 1 );
+
+  // The probe of central 3, then the slots up to central 7's but 3's
+  testRPA( 7, 1, rpa );
+  HOST_CHECK_EQ( testResolve( rpa, &resolves ), idx7 );
+  HOST_CHECK_EQ( resolves, 1 + idx7 + 1 - ( idx3 < idx7 ) );
+  HOST_CHECK( resolves <= GAP_BONDINGS_MAX );
+
+  testRPA( GAP_BONDINGS_MAX, 1, addr );
+  HOST_CHECK_EQ( testResolve( addr, &resolves ), GAP_BONDINGS_MAX );
+  HOST_CHECK_EQ( resolves, GAP_BONDINGS_MAX );
+
+  // Central 7 bonds again with a new IRK, in the same slot: its old
+  // address, the one that resolved last, no longer resolves
+  testCentral( 7, addr, NULL );
+  VOID osal_memset( irk, 0xC3, KEYLEN );
+  hostBleLink( LINK_CONNECTED );
+  hostBleLinkPeer( ADDRTYPE_PUBLIC, addr );
+  VOID GAPBondMgr_LinkEst( ADDRTYPE_PUBLIC, addr, HOST_CONN_HANDLE, GAP_PROFILE_PERIPHERAL );
+  hostGapBond( irk, addr );
+  hostRun();
+  testDisconnect();
+  HOST_CHECK_EQ( testBondIdx( 7 ), idx7 );
+
+  HOST_CHECK_EQ( testResolve( rpa, &resolves ), GAP_BONDINGS_MAX );
+  HOST_CHECK_EQ( resolves, GAP_BONDINGS_MAX );
+
+  hostGapMakeRPA( irk, 1, rpa );
+  HOST_CHECK_EQ( testResolve( rpa, &resolves ), idx7 );
+
+  // Erased, central 7's bond resolves nothing and costs no AES operation
+  value[0] = ADDRTYPE_PUBLIC;
+  VOID osal_revmemcpy( &value[1], addr, B_ADDR_LEN );
+  HOST_CHECK_EQ( GAPBondMgr_SetParameter( GAPBOND_ERASE_SINGLEBOND, sizeof ( value ), value ),
+                 SUCCESS );
+  hostRun();
+  HOST_CHECK_EQ( testBondCount(), GAP_BONDINGS_MAX - 1 );
+
+  HOST_CHECK_EQ( testResolve( rpa, &resolves ), GAP_BONDINGS_MAX );
+  HOST_CHECK_EQ( resolves, GAP_BONDINGS_MAX - 1 );
+}
+
+int main( void )
+{
+  HOST_RUN( testFillsEverySlot );
+  HOST_RUN( testReplacesLeastRecentlyConnected );
+  HOST_RUN( testOrderSurvivesReset );
+  HOST_RUN( testLookupAndReconnectCost );
+  HOST_RUN( testReplaceCreatesNoItems );
+  HOST_RUN( testChurnThroughCompaction );
+  HOST_RUN( testResolveCost );
+
+  return ( HOST_RESULT() );
+}
@@ -0,0 +1,545 @@
+/**************************************************************************************************
+  Filename:       test_gattservapp_util.c
+
+  Description:    Host tests and micro-benchmark of the notification path of
+                  gattservapp_util.c over the real attribute tables of the PGP and OAD
+                  services: the record a profile indexes is the one the table search
+                  finds, the CCC tables taking no OSAL heap, the retry queueover a link short of TX buffers (what bursts
+                  to Button Notif and SFIDA Commands deliver, coalesce and drop, and
+                  what a closed link or a disabled CCC drops), what the search costs
+                  next to the index, and what the read and write callbacks of the PGP
+                  services cost.
+**************************************************************************************************/
+
+#include <time.h>
+
+#include "bcomdef.h"
+#include "OSAL.h"
+#include "linkdb.h"
+#include "gatt_uuid.h"
+#include "hal_dma.h"
+#include "pgpCertificate.h"
+#include "pgpDeviceControl.h"
+#include "oad.h"
+#include "oad_target.h"
+#include "host_hal.h"
+#include "host_ble.h"
+#include "host_test.h"
+
+// Calls timed per notified characteristic
+#define TEST_BENCH_CALLS  1000000UL
+
+// Services the tables are taken from, in the order they are added
+#define TEST_TBL_CNT      3
+
+// Tables of the two notified PGP characteristics
+#define TEST_TBL_BUTTON   0
+#define TEST_TBL_SFIDA    1
+
+// Tables of the PGP services, whose callbacks are timed
+#define TEST_TBL_PGP_CNT  2
+
+// Task and event the retry queue sets at the end of a connection event
+#define TEST_TASK         0
+#define TEST_NOTI_EVT     0x0001
+
+// GATT_Notification() calls that find no TX buffer in each burst
+#define TEST_BUSY         3
+
+// Connection events the queue gets to drain a burst
+#define TEST_EVENTS_MAX   10
+
+// Updates per characteristic in the bursts
+#define TEST_BURST_CNT    4
+
+typedef struct
+{
+  const char *name;
+  gattAttribute_t *pAttrs;
+  uint16 numAttrs;
+} testTbl_t;
+
+// What became of a burst of updates to one characteristic or both: sent,
+// replaced by a later value that was sent, or lost with no later value sent
+typedef struct
+{
+  uint8 delivered;
+  uint8 coalesced;
+  uint8 dropped;
+} testBurst_t;
+
+// A burst of k updates to each characteristic, and what it should come to
+// with the queue and without it
+typedef struct
+{
+  uint8 k;
+  testBurst_t queued;
+  testBurst_t unqueued;
+} testBurstCase_t;
+
+static testTbl_t testTbls[TEST_TBL_CNT] =
+{
+  { "pgpDeviceControl" },
+  { "pgpCertificate" },
+  { "oad" }
+};
+
+// Bytes each PGP service's values are written with in the benchmark: a
+// Device Control value is one byte, a certificate value takes as much as
+// one Write Request carries
+static const uint8 testWriteLens[TEST_TBL_PGP_CNT] = { 1, ATT_MTU_SIZE - 3 };
+
+// The queue sends each characteristic's latest value once the link has a
+// buffer again. Without it the first TEST_BUSY updates are lost, and a
+// characteristic whose every update was among them keeps a stale value.
+static const testBurstCase_t testBurstCases[TEST_BURST_CNT] =
+{
+  { 1, { 2,  0, 0 }, {  0, 0, 2 } },
+  { 2, { 2,  2, 0 }, {  1, 1, 2 } },
+  { 4, { 2,  6, 0 }, {  5, 3, 0 } },
+  { 8, { 2, 14, 0 }, { 13, 3, 0 } }
+};
+
+/*********************************************************************
+ * STUBS
+ */
+
+// Only an image block write reaches the CRC engine and the DMA; no test
+// makes one
+halDMADesc_t dmaCh0;
+void HalCRCInit( uint16 seed ) {}
+uint16 HalCRCCalc( void ) { return ( 0 ); }
+
+static bStatus_t testReadAttrCB( uint16 connHandle, gattAttribute_t *pAttr,
+                                 uint8 *pValue, uint8 *pLen, uint16 offset,
+                                 uint8 maxLen, uint8 method )
+{
+  return ( ATT_ERR_ATTR_NOT_FOUND );
+}
+
+/*********************************************************************
+ * HELPERS
+ */
+
+// Add the services and find their tables: each starts at a primary service
+// declaration and runs to the next one
+static void testSetup( void )
+{
+  uint16 handle;
+  int8 tbl = -1;
+  gattAttribute_t *pAttr;
+
+  hostInit();
+  hostBleInit();
+
+  HOST_CHECK_EQ( PgpDeviceControl_AddService( GATT_ALL_SERVICES ), SUCCESS );
+  HOST_CHECK_EQ( PgpCertificate_AddService( GATT_ALL_SERVICES ), SUCCESS );
+  HOST_CHECK_EQ( OADTarget_AddService(), SUCCESS );
+
+  for ( handle = 1; ( pAttr = hostBleAttr( handle ) ) != NULL; handle++ )
+  {
+    if ( osal_memcmp( pAttr->type.uuid, primaryServiceUUID, ATT_BT_UUID_SIZE ) &&
+         tbl < TEST_TBL_CNT - 1 )
+    {
+      testTbls[++tbl].pAttrs = pAttr;
+      testTbls[tbl].numAttrs = 0;
+    }
+    testTbls[tbl].numAttrs++;
+  }
+
+  HOST_CHECK_EQ( tbl, TEST_TBL_CNT - 1 );
+}
+
+// Whether the record is a characteristic value with a CCC after it
+static uint8 testIsNotified( gattAttribute_t *pAttrs, uint16 numAttrs, uint16 idx )
+{
+  return ( idx + 1 < numAttrs &&
+           pAttrs[idx + 1].type.len == ATT_BT_UUID_SIZE &&
+           osal_memcmp( pAttrs[idx + 1].type.uuid, clientCharCfgUUID, ATT_BT_UUID_SIZE ) );
+}
+
+// Handle of the one notified value of a table
+static uint16 testNotifiedHandle( uint8 tbl )
+{
+  testTbl_t *pTbl = &testTbls[tbl];
+  uint16 idx;
+
+  for ( idx = 0; idx < pTbl->numAttrs; idx++ )
+  {
+    if ( testIsNotified( pTbl->pAttrs, pTbl->numAttrs, idx ) )
+    {
+      return ( pTbl->pAttrs[idx].handle );
+    }
+  }
+
+  return ( GATT_INVALID_HANDLE );
+}
+
+// Connect and turn notifications on for Button Notif and SFIDA Commands
+static void testConnect( void )
+{
+  hostBleLink( LINK_CONNECTED );
+
+  HOST_CHECK_EQ( hostBleWriteCCC( testNotifiedHandle( TEST_TBL_BUTTON ) + 1,
+                                  GATT_CLIENT_CFG_NOTIFY ), SUCCESS );
+  HOST_CHECK_EQ( hostBleWriteCCC( testNotifiedHandle( TEST_TBL_SFIDA ) + 1,
+                                  GATT_CLIENT_CFG_NOTIFY ), SUCCESS );
+}
+
+// Update n of a burst: both characteristics take the value n
+static void testUpdate( uint8 n )
+{
+  uint8 cmd[4];
+
+  VOID osal_memset( cmd, n, sizeof ( cmd ) );
+
+  HOST_CHECK_EQ( PgpDeviceControl_SetParameter( BUTTON_NOTIF_CHAR, sizeof ( uint8 ), &n ),
+                 SUCCESS );
+  HOST_CHECK_EQ( PgpCertificate_SetParameter( SFIDA_COMMANDS_CHAR, sizeof ( cmd ), cmd ),
+                 SUCCESS );
+}
+
+// Add up what became of updates 1 to k of the characteristic of this table:
+// the values sent must rise, and those after the last one sent are lost
+static void testTally( uint8 tbl, uint8 k, testBurst_t *pBurst )
+{
+  uint16 handle = testNotifiedHandle( tbl );
+  uint8 delivered = 0;
+  uint8 last = 0;
+  uint8 i;
+
+  for ( i = 0; i < hostNotiCount; i++ )
+  {
+    if ( hostNoti[i].handle == handle )
+    {
+      HOST_CHECK( hostNoti[i].value[0] > last );
+      last = hostNoti[i].value[0];
+      delivered++;
+    }
+  }
+
+  pBurst->delivered += delivered;
+  pBurst->dropped += k - last;
+  pBurst->coalesced += last - delivered;
+}
+
+// A burst of k updates to each characteristic over a link that has no
+// buffer for the next TEST_BUSY notifications, then one pass of the queue
+// per connection event until the link has nothing left queued. Returns the
+// number of connection events that took.
+static uint8 testBurst( uint8 k, testBurst_t *pBurst )
+{
+  uint8 events = 0;
+  uint8 n;
+
+  hostNotiCount = 0;
+  hostNotiBusy = TEST_BUSY;
+
+  for ( n = 1; n <= k; n++ )
+  {
+    testUpdate( n );
+  }
+
+  while ( hostConnEventEvent != 0 && events < TEST_EVENTS_MAX )
+  {
+    GATTServApp_ProcessNotiQueue();
+    events++;
+  }
+
+  VOID osal_memset( pBurst, 0, sizeof ( testBurst_t ) );
+  testTally( TEST_TBL_BUTTON, k, pBurst );
+  testTally( TEST_TBL_SFIDA, k, pBurst );
+
+  HOST_CHECK_EQ( hostBmOutstanding, 0 );
+
+  return ( events );
+}
+
+static double testNow( void )
+{
+  struct timespec ts;
+
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+
+  return ( ts.tv_sec * 1e9 + ts.tv_nsec );
+}
+
+/*********************************************************************
+ * TESTS
+ */
+
+// The index a profile keeps for a notified value stands for the record the
+// search finds: no other record of the table shares its value
+static void testIndexIsSearchResult( void )
+{
+  uint8 tbl;
+  uint16 idx;
+  uint8 notified = 0;
+
+  testSetup();
+
+  for ( tbl = 0; tbl < TEST_TBL_CNT; tbl++ )
+  {
+    testTbl_t *pTbl = &testTbls[tbl];
+
+    for ( idx = 0; idx < pTbl->numAttrs; idx++ )
+    {
+      if ( testIsNotified( pTbl->pAttrs, pTbl->numAttrs, idx ) )
+      {
+        HOST_CHECK( GATTServApp_FindAttr( pTbl->pAttrs, pTbl->numAttrs,
+                                          pTbl->pAttrs[idx].pValue ) == &pTbl->pAttrs[idx] );
+        notified++;
+      }
+    }
+  }
+
+  // Button notification and SFIDA commands, OAD image identify and block
+  HOST_CHECK_EQ( notified, 4 );
+}
+
+// The CCC tables come from the static pool of GATTServApp_AllocCharCfg():
+// adding the services leaves no block of the OSAL heap allocated
+static void testCCCTablesTakeNoHeap( void )
+{
+  uint16 blocks, bytes;
+
+  hostInit();
+  hostBleInit();
+
+  blocks = osal_heap_block_cnt();
+  bytes = osal_heap_mem_used();
+
+  HOST_CHECK_EQ( PgpDeviceControl_AddService( GATT_ALL_SERVICES ), SUCCESS );
+  HOST_CHECK_EQ( PgpCertificate_AddService( GATT_ALL_SERVICES ), SUCCESS );
+  HOST_CHECK_EQ( OADTarget_AddService(), SUCCESS );
+
+  HOST_CHECK_EQ( osal_heap_block_cnt(), blocks );
+  HOST_CHECK_EQ( osal_heap_mem_used(), bytes );
+}
+
+// Bursts over a busy link: with the queuenothing is lost and each
+// characteristic gets its latest value once the link has a buffer, after
+// the connection events the link stays busy for; without it what the link
+// refuses is lost
+static void testBurstsOverBusyLink( void )
+{
+  uint8 i;
+
+  testSetup();
+  testConnect();
+
+  for ( i = 0; i < TEST_BURST_CNT; i++ )
+  {
+    const testBurstCase_t *pCase = &testBurstCases[i];
+    testBurst_t queued, unqueued;
+    uint8 events;
+
+    GATTServApp_InitNotiQueue( TEST_TASK, TEST_NOTI_EVT );
+    events = testBurst( pCase->k, &queued );
+
+    HOST_CHECK_EQ( events, TEST_BUSY );
+    HOST_CHECK_EQ( queued.delivered, pCase->queued.delivered );
+    HOST_CHECK_EQ( queued.coalesced, pCase->queued.coalesced );
+    HOST_CHECK_EQ( queued.dropped, pCase->queued.dropped );
+
+    GATTServApp_InitNotiQueue( INVALID_TASK_ID, 0 );
+    HOST_CHECK_EQ( testBurst( pCase->k, &unqueued ), 0 );
+
+    HOST_CHECK_EQ( unqueued.delivered, pCase->unqueued.delivered );
+    HOST_CHECK_EQ( unqueued.coalesced, pCase->unqueued.coalesced );
+    HOST_CHECK_EQ( unqueued.dropped, pCase->unqueued.dropped );
+
+    printf( "     burst of %u: queued %2u sent %2u coalesced %u dropped in %u events, "
+            "unqueued %2u sent %u coalesced %u dropped\n",
+            pCase->k, queued.delivered, queued.coalesced, queued.dropped, events,
+            unqueued.delivered, unqueued.coalesced, unqueued.dropped );
+  }
+}
+
+// Entries of a link that closes are dropped, not sent on the next link
+static void testQueueDroppedOnLinkDown( void )
+{
+  testSetup();
+  testConnect();
+  GATTServApp_InitNotiQueue( TEST_TASK, TEST_NOTI_EVT );
+
+  hostNotiBusy = 1;
+  testUpdate( 1 );
+  HOST_CHECK_EQ( hostNotiCount, 0 );
+  HOST_CHECK_EQ( hostConnEventEvent, TEST_NOTI_EVT );
+
+  hostBleLink( LINK_NOT_CONNECTED );
+  GATTServApp_ProcessNotiQueue();
+
+  testConnect();
+  GATTServApp_ProcessNotiQueue();
+  HOST_CHECK_EQ( hostNotiCount, 0 );
+
+  // Nothing left queued for the update to wait behind
+  testUpdate( 2 );
+  HOST_CHECK_EQ( hostNotiCount, 2 );
+  HOST_CHECK_EQ( hostBmOutstanding, 0 );
+}
+
+// The entry of a characteristic whose client turned notifications off is
+// dropped; the other one on the link is still sent
+static void testQueueDroppedOnCCCDisable( void )
+{
+  testSetup();
+  testConnect();
+  GATTServApp_InitNotiQueue( TEST_TASK, TEST_NOTI_EVT );
+
+  hostNotiBusy = 1;
+  testUpdate( 1 );
+  HOST_CHECK_EQ( hostNotiCount, 0 );
+
+  HOST_CHECK_EQ( hostBleWriteCCC( testNotifiedHandle( TEST_TBL_BUTTON ) + 1,
+                                  GATT_CFG_NO_OPERATION ), SUCCESS );
+  GATTServApp_ProcessNotiQueue();
+
+  HOST_CHECK_EQ( hostNotiCount, 1 );
+  HOST_CHECK_EQ( hostNoti[0].handle, testNotifiedHandle( TEST_TBL_SFIDA ) );
+  HOST_CHECK_EQ( hostConnEventEvent, 0 );
+  HOST_CHECK_EQ( hostBmOutstanding, 0 );
+}
+
+// Both entry points with notifications off on every link, so what is timed
+// is the lookup and the walk of the CCC table, not the sending. The records
+// the search compares are what it costs on the target; the times only
+// compare the two on this host.
+static void testBenchProcessCharCfg( void )
+{
+  gattCharCfg_t charCfg[1] = { { INVALID_CONNHANDLE, GATT_CFG_NO_OPERATION } };
+  uint8 tbl;
+  uint16 idx;
+  uint32 n;
+
+  testSetup();
+
+  HOST_CHECK_EQ( linkDBNumConns, 1 );
+
+  for ( tbl = 0; tbl < TEST_TBL_CNT; tbl++ )
+  {
+    testTbl_t *pTbl = &testTbls[tbl];
+
+    for ( idx = 0; idx < pTbl->numAttrs; idx++ )
+    {
+      gattAttribute_t *pAttr = &pTbl->pAttrs[idx];
+      bStatus_t status = SUCCESS;
+      double start, search, index;
+
+      if ( !testIsNotified( pTbl->pAttrs, pTbl->numAttrs, idx ) )
+      {
+        continue;
+      }
+
+      start = testNow();
+      for ( n = 0; n < TEST_BENCH_CALLS; n++ )
+      {
+        status |= GATTServApp_ProcessCharCfg( charCfg, pAttr->pValue, FALSE,
+                                              pTbl->pAttrs, pTbl->numAttrs,
+                                              INVALID_TASK_ID, testReadAttrCB );
+      }
+      search = ( testNow() - start ) / TEST_BENCH_CALLS;
+
+      start = testNow();
+      for ( n = 0; n < TEST_BENCH_CALLS; n++ )
+      {
+        status |= GATTServApp_ProcessCharCfgAttr( charCfg, pAttr, FALSE,
+                                                  INVALID_TASK_ID, testReadAttrCB );
+      }
+      index = ( testNow() - start ) / TEST_BENCH_CALLS;
+
+      HOST_CHECK_EQ( status, SUCCESS );
+
+      printf( "     %-16s value %2u: search %2u records %5.1f ns, index %5.1f ns\n",
+              pTbl->name, idx, idx + 1, search, index );
+    }
+  }
+}
+
+// The read and write callbacks of the PGP services on each characteristic
+// value, as the GATT server calls them for a Read Request and a Write
+// Request. As above, only the comparison between the times carries over
+// to the 8051.
+static void testBenchAttrCBs( void )
+{
+  uint8 value[ATT_MTU_SIZE];
+  uint8 tbl;
+  uint16 idx;
+  uint32 n;
+
+  testSetup();
+  hostBleLink( LINK_CONNECTED );
+  VOID osal_memset( value, 0x5A, sizeof ( value ) );
+
+  for ( tbl = 0; tbl < TEST_TBL_PGP_CNT; tbl++ )
+  {
+    testTbl_t *pTbl = &testTbls[tbl];
+    CONST gattServiceCBs_t *pCBs = hostBleServiceCBs( pTbl->pAttrs[0].handle );
+
+    HOST_CHECK( pCBs != NULL );
+    if ( pCBs == NULL )
+    {
+      continue;
+    }
+
+    for ( idx = 0; idx < pTbl->numAttrs; idx++ )
+    {
+      gattAttribute_t *pAttr = &pTbl->pAttrs[idx];
+      bStatus_t status = SUCCESS;
+      double start, read;
+      uint8 len;
+
+      // The values are the records with 128-bit types
+      if ( pAttr->type.len != ATT_UUID_SIZE )
+      {
+        continue;
+      }
+
+      if ( pAttr->permissions & GATT_PERMIT_READ )
+      {
+        start = testNow();
+        for ( n = 0; n < TEST_BENCH_CALLS; n++ )
+        {
+          status |= pCBs->pfnReadAttrCB( HOST_CONN_HANDLE, pAttr, value, &len, 0,
+                                         ATT_MTU_SIZE - 1, ATT_READ_REQ );
+        }
+        read = ( testNow() - start ) / TEST_BENCH_CALLS;
+
+        printf( "     %-16s value %2u: read           %5.1f ns\n", pTbl->name, idx, read );
+      }
+
+      if ( pAttr->permissions & GATT_PERMIT_WRITE )
+      {
+        double write;
+
+        start = testNow();
+        for ( n = 0; n < TEST_BENCH_CALLS; n++ )
+        {
+          status |= pCBs->pfnWriteAttrCB( HOST_CONN_HANDLE, pAttr, value, testWriteLens[tbl],
+                                          0, ATT_WRITE_REQ );
+        }
+        write = ( testNow() - start ) / TEST_BENCH_CALLS;
+
+        printf( "     %-16s value %2u: write %2u bytes %5.1f ns\n",
+                pTbl->name, idx, testWriteLens[tbl], write );
+      }
+
+      HOST_CHECK_EQ( status, SUCCESS );
+    }
+  }
+}
+
+int main( void )
+{
+  HOST_RUN( testIndexIsSearchResult );
+  HOST_RUN( testCCCTablesTakeNoHeap );
+  HOST_RUN( testBurstsOverBusyLink );
+  HOST_RUN( testQueueDroppedOnLinkDown );
+  HOST_RUN( testQueueDroppedOnCCCDisable );
+  HOST_RUN( testBenchProcessCharCfg );
+  HOST_RUN( testBenchAttrCBs );
+
+  return ( HOST_RESULT() );
+}
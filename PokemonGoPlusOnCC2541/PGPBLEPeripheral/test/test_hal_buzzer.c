@@ -0,0 +1,166 @@
+/**************************************************************************************************
+  Filename:       test_hal_buzzer.c
+
+  Description:    Host tests of the melody and arpeggio sequencing in hal_buzzer.c against
+                  a model of the Timer3 registers.
+**************************************************************************************************/
+
+#include "hal_drivers.h"
+#include "hal_buzzer.h"
+#include "host_hal.h"
+#include "host_test.h"
+
+#define TEST_HAL_TASK  0
+
+#define TEST_T3_START  0x10
+
+uint8 Hal_TaskID = TEST_HAL_TASK;
+
+typedef struct
+{
+  uint8 ctl;
+  uint8 cc0;
+} testTone_t;
+
+static const testTone_t testTones[] =
+{
+  HAL_BUZZER_TONE_TABLE
+};
+
+static uint8 completions;
+
+static uint16 testHalTask( uint8 taskId, uint16 events )
+{
+  (void)taskId;
+
+  if ( events & HAL_BUZZER_EVENT )
+  {
+    HalBuzzerTone();
+    return ( events ^ HAL_BUZZER_EVENT );
+  }
+
+  return ( 0 );
+}
+
+static void testComplete( void )
+{
+  completions++;
+}
+
+// Tone Timer3 is generating, or 0 when silent
+static uint8 testSounding( void )
+{
+  uint8 i;
+
+  if ( !( T3CTL & TEST_T3_START ) )
+  {
+    return ( 0 );
+  }
+
+  for ( i = 0; i < sizeof ( testTones ) / sizeof ( testTones[0] ); i++ )
+  {
+    if ( ( testTones[i].cc0 == T3CC0 ) && ( testTones[i].ctl == ( T3CTL & 0xE0 ) ) )
+    {
+      return ( HAL_BUZZER_TONE_FIRST + i );
+    }
+  }
+
+  return ( 0xFF );
+}
+
+static void testSetup( void )
+{
+  hostInit();
+  hostSetTask( TEST_HAL_TASK, testHalTask );
+  HalBuzzerInit();
+  completions = 0;
+}
+
+static void testMelody( void )
+{
+  static const uint8 melody[] =
+  {
+    HAL_BUZZER_TONE_C6, 2, HAL_BUZZER_TONE_NONE, 1, HAL_BUZZER_TONE_E6, 4
+  };
+
+  testSetup();
+
+  HalBuzzerPlay( melody, sizeof ( melody ), testComplete );
+  HOST_CHECK_EQ( testSounding(), HAL_BUZZER_TONE_C6 );
+  hostAdvance( 49 );
+  HOST_CHECK_EQ( testSounding(), HAL_BUZZER_TONE_C6 );
+  hostAdvance( 1 );
+  HOST_CHECK_EQ( testSounding(), 0 );
+  hostAdvance( 25 );
+  HOST_CHECK_EQ( testSounding(), HAL_BUZZER_TONE_E6 );
+  hostAdvance( 100 );
+  HOST_CHECK_EQ( testSounding(), 0 );
+  HOST_CHECK_EQ( T3CTL, 0 );
+  HOST_CHECK_EQ( completions, 1 );
+}
+
+static void testArpeggioCycles( void )
+{
+  static const uint8 chord[] =
+  {
+    HAL_BUZZER_ARPEGGIO | 3, 4, HAL_BUZZER_TONE_C6, HAL_BUZZER_TONE_E6, HAL_BUZZER_TONE_G6
+  };
+
+  testSetup();
+
+  HalBuzzerPlay( chord, sizeof ( chord ), testComplete );
+  HOST_CHECK_EQ( testSounding(), HAL_BUZZER_TONE_C6 );
+  hostAdvance( 20 );
+  HOST_CHECK_EQ( testSounding(), HAL_BUZZER_TONE_E6 );
+  hostAdvance( 20 );
+  HOST_CHECK_EQ( testSounding(), HAL_BUZZER_TONE_G6 );
+  hostAdvance( 20 );
+  HOST_CHECK_EQ( testSounding(), HAL_BUZZER_TONE_C6 );
+  hostAdvance( 40 );
+  HOST_CHECK_EQ( testSounding(), 0 );
+  HOST_CHECK_EQ( completions, 1 );
+}
+
+/*
+ * A melody started while a chord plays starts at its own first note; the
+ * rest of the chord is dropped.
+ */
+static void testPlayDropsOldChord( void )
+{
+  static const uint8 chord[] =
+  {
+    HAL_BUZZER_ARPEGGIO | 3, 40, HAL_BUZZER_TONE_C6, HAL_BUZZER_TONE_E6, HAL_BUZZER_TONE_G6
+  };
+  static const uint8 note[] =
+  {
+    HAL_BUZZER_TONE_A6, 2
+  };
+
+  testSetup();
+
+  HalBuzzerPlay( chord, sizeof ( chord ), testComplete );
+  hostAdvance( 30 );
+  HalBuzzerPlay( note, sizeof ( note ), testComplete );
+  HOST_CHECK_EQ( testSounding(), HAL_BUZZER_TONE_A6 );
+  hostAdvance( 50 );
+  HOST_CHECK_EQ( testSounding(), 0 );
+  hostAdvance( 1000 );
+  HOST_CHECK_EQ( testSounding(), 0 );
+  HOST_CHECK_EQ( completions, 1 );
+
+  // Same after an explicit stop
+  HalBuzzerPlay( chord, sizeof ( chord ), testComplete );
+  hostAdvance( 30 );
+  HalBuzzerStop();
+  HalBuzzerPlay( note, sizeof ( note ), testComplete );
+  HOST_CHECK_EQ( testSounding(), HAL_BUZZER_TONE_A6 );
+}
+
+int main( void )
+{
+  HOST_RUN( testMelody );
+  HOST_RUN( testArpeggioCycles );
+  HOST_RUN( testPlayDropsOldChord );
+
+  return ( HOST_RESULT() );
+}
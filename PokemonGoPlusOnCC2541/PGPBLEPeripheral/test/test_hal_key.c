@@ -0,0 +1,234 @@
+/**************************************************************************************************
+  Filename:       test_hal_key.c
+
+  Description:    Host tests of the key gesture engine in hal_key.c, driven by edges on a
+                  modelled port 0.
+**************************************************************************************************/
+
+#include "hal_drivers.h"
+#include "hal_key.h"
+#include "host_hal.h"
+#include "host_test.h"
+
+#define TEST_HAL_TASK  0
+#define TEST_KEY_BIT   0x02     // P0.1, active low
+
+uint8 Hal_TaskID = TEST_HAL_TASK;
+
+// Port 0 vector
+extern void halKeyPort0Isr( void );
+
+static uint8 gestures[8];
+static uint8 numGestures;
+static uint32 gestureTime[8];
+static uint32 now;
+static uint16 wakeups;
+
+static uint16 testHalTask( uint8 taskId, uint16 events )
+{
+  (void)taskId;
+
+  wakeups++;
+  if ( events & HAL_KEY_EVENT )
+  {
+    HalKeyPoll();
+    return ( events ^ HAL_KEY_EVENT );
+  }
+
+  if ( events & HAL_KEY_GESTURE_EVENT )
+  {
+    HalKeyPoll();
+    return ( events ^ HAL_KEY_GESTURE_EVENT );
+  }
+
+  return ( 0 );
+}
+
+static void testKeyCB( uint8 keys, uint8 state )
+{
+  HOST_CHECK_EQ( keys, HAL_PUSH_BUTTON );
+  if ( numGestures < sizeof ( gestures ) )
+  {
+    gestureTime[numGestures] = now;
+    gestures[numGestures++] = state;
+  }
+}
+
+/*
+ * Move the pin, interrupting on the edge the driver armed.
+ */
+static void testPin( uint8 down )
+{
+  uint8 falling = ( PICTL & 0x01 ) != 0;
+
+  if ( down )
+  {
+    P0 &= ~TEST_KEY_BIT;
+  }
+  else
+  {
+    P0 |= TEST_KEY_BIT;
+  }
+
+  if ( ( P0IEN & TEST_KEY_BIT ) && ( down == falling ) )
+  {
+    P0IFG |= TEST_KEY_BIT;
+    halKeyPort0Isr();
+  }
+}
+
+static void testWait( uint32 ms )
+{
+  while ( ms-- )
+  {
+    hostAdvance( 1 );
+    now++;
+  }
+}
+
+static void testSetup( void )
+{
+  hostInit();
+  hostSetTask( TEST_HAL_TASK, testHalTask );
+  P0 = 0xFF;
+  HalKeyInit();
+  HalKeyConfig( HAL_KEY_INTERRUPT_ENABLE, testKeyCB );
+  numGestures = 0;
+  now = 0;
+  wakeups = 0;
+}
+
+/*
+ * A click is reported when the debounce after the release runs out, not
+ * after a double click window.
+ */
+static void testClickIsNotDelayed( void )
+{
+  testSetup();
+
+  testPin( TRUE );
+  testWait( 100 );
+  testPin( FALSE );
+  testWait( 1000 );
+
+  HOST_CHECK_EQ( numGestures, 1 );
+  HOST_CHECK_EQ( gestures[0], HAL_KEY_GESTURE_CLICK );
+  HOST_CHECK( gestureTime[0] <= 100 + 30 );
+
+  // Press, release, and nothing after: two debounce wakeups
+  HOST_CHECK_EQ( wakeups, 2 );
+}
+
+static void testDoubleClick( void )
+{
+  testSetup();
+
+  testPin( TRUE );
+  testWait( 80 );
+  testPin( FALSE );
+  testWait( 120 );
+  testPin( TRUE );
+  testWait( 80 );
+  testPin( FALSE );
+  testWait( 1000 );
+
+  HOST_CHECK_EQ( numGestures, 2 );
+  HOST_CHECK_EQ( gestures[0], HAL_KEY_GESTURE_CLICK );
+  HOST_CHECK_EQ( gestures[1], HAL_KEY_GESTURE_DOUBLE );
+
+  // A second click after the window is a click again
+  testPin( TRUE );
+  testWait( 80 );
+  testPin( FALSE );
+  testWait( 100 );
+  HOST_CHECK_EQ( numGestures, 3 );
+  HOST_CHECK_EQ( gestures[2], HAL_KEY_GESTURE_CLICK );
+}
+
+static void testPressAndLongPress( void )
+{
+  testSetup();
+
+  testPin( TRUE );
+  testWait( 1000 );
+  testPin( FALSE );
+  testWait( 100 );
+  HOST_CHECK_EQ( numGestures, 1 );
+  HOST_CHECK_EQ( gestures[0], HAL_KEY_GESTURE_PRESS );
+
+  // Long press is reported while the key is still held
+  testPin( TRUE );
+  testWait( 2600 );
+  HOST_CHECK_EQ( numGestures, 2 );
+  HOST_CHECK_EQ( gestures[1], HAL_KEY_GESTURE_LONG );
+  HOST_CHECK( gestureTime[1] >= 1100 + 2500 );
+  HOST_CHECK( gestureTime[1] <= 1100 + 2500 + 30 );
+  testPin( FALSE );
+  testWait( 100 );
+  HOST_CHECK_EQ( numGestures, 2 );
+}
+
+/*
+ * Bounce while the key is held is debounced on its own event and does not
+ * move the long press deadline.
+ */
+static void testBounceWhileHeld( void )
+{
+  testSetup();
+
+  testPin( TRUE );
+  testWait( 1000 );
+  testPin( FALSE );
+  testWait( 2 );
+  testPin( TRUE );
+  testWait( 1700 );
+
+  HOST_CHECK_EQ( numGestures, 1 );
+  HOST_CHECK_EQ( gestures[0], HAL_KEY_GESTURE_LONG );
+  HOST_CHECK( gestureTime[0] <= 2500 + 30 );
+  testPin( FALSE );
+  testWait( 100 );
+}
+
+/*
+ * A bouncy click is still one click.
+ */
+static void testBouncyClick( void )
+{
+  uint8 n;
+
+  testSetup();
+
+  for ( n = 0; n < 4; n++ )
+  {
+    testPin( TRUE );
+    testWait( 1 );
+    testPin( FALSE );
+    testWait( 1 );
+  }
+  testPin( TRUE );
+  testWait( 100 );
+  for ( n = 0; n < 3; n++ )
+  {
+    testPin( FALSE );
+    testWait( 2 );
+    testPin( TRUE );
+    testWait( 1 );
+  }
+  testPin( FALSE );
+  testWait( 500 );
+
+  HOST_CHECK_EQ( numGestures, 1 );
+  HOST_CHECK_EQ( gestures[0], HAL_KEY_GESTURE_CLICK );
+}
+
+int main( void )
+{
+  HOST_RUN( testClickIsNotDelayed );
+  HOST_RUN( testDoubleClick );
+  HOST_RUN( testPressAndLongPress );
+  HOST_RUN( testBounceWhileHeld );
+  HOST_RUN( testBouncyClick );
+
+  return ( HOST_RESULT() );
+}
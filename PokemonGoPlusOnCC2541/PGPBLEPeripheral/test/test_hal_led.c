@@ -0,0 +1,127 @@
+/**************************************************************************************************
+  Filename:       test_hal_led.c
+
+  Description:    Host tests of the LED blink and pattern timing in hal_led.c.
+**************************************************************************************************/
+
+#include "hal_drivers.h"
+#include "hal_led.h"
+#include "host_hal.h"
+#include "host_test.h"
+
+#define TEST_HAL_TASK  0
+
+uint8 Hal_TaskID = TEST_HAL_TASK;
+
+// Internal to the HAL, as in hal_drivers.c
+extern void HalLedUpdate( void );
+
+static uint16 testHalTask( uint8 taskId, uint16 events )
+{
+  (void)taskId;
+
+  if ( events & HAL_LED_BLINK_EVENT )
+  {
+    HalLedUpdate();
+    return ( events ^ HAL_LED_BLINK_EVENT );
+  }
+
+  return ( 0 );
+}
+
+static void testSetup( void )
+{
+  hostInit();
+  hostSetTask( TEST_HAL_TASK, testHalTask );
+  HalLedInit();
+}
+
+/*
+ * Advance until the red LED turns on; returns the ms taken, or 0 if it did
+ * not within limit.
+ */
+static uint32 testUntilOn( uint32 limit )
+{
+  uint32 ms;
+
+  for ( ms = 1; ms <= limit; ms++ )
+  {
+    hostAdvance( 1 );
+    if ( HalLedGetState() & HAL_LED_1_RED )
+    {
+      return ( ms );
+    }
+  }
+
+  return ( 0 );
+}
+
+static uint32 testUntilOff( uint32 limit )
+{
+  uint32 ms;
+
+  for ( ms = 1; ms <= limit; ms++ )
+  {
+    hostAdvance( 1 );
+    if ( !( HalLedGetState() & HAL_LED_1_RED ) )
+    {
+      return ( ms );
+    }
+  }
+
+  return ( 0 );
+}
+
+static void testBlinkTiming( void )
+{
+  testSetup();
+
+  HalLedBlink( HAL_LED_1_RED, 3, 25, 400 );
+  hostRun();
+  HOST_CHECK( HalLedGetState() & HAL_LED_1_RED );
+  HOST_CHECK_EQ( testUntilOff( 1000 ), 100 );
+  HOST_CHECK_EQ( testUntilOn( 1000 ), 300 );
+  HOST_CHECK_EQ( testUntilOff( 1000 ), 100 );
+  HOST_CHECK_EQ( testUntilOn( 1000 ), 300 );
+  HOST_CHECK_EQ( testUntilOff( 1000 ), 100 );
+
+  // Three blinks and back to the state before them
+  HOST_CHECK_EQ( testUntilOn( 2000 ), 0 );
+}
+
+/*
+ * Updates that run late must not push every later edge back: each period
+ * still starts on the 1 s grid.
+ */
+static void testLateUpdatesDoNotDrift( void )
+{
+  uint32 now = 0;
+  uint8 n;
+
+  testSetup();
+
+  HalLedBlink( HAL_LED_1_RED, 0, 50, 1000 );
+  hostRun();
+
+  for ( n = 1; n <= 10; n++ )
+  {
+    // Something else holds the CPU across the off edge
+    hostAdvance( 499 );
+    hostStall( 7 );
+    now += 506;
+    now += testUntilOn( 1000 );
+    HOST_CHECK_EQ( now, n * 1000UL );
+    if ( now != n * 1000UL )
+    {
+      break;
+    }
+  }
+}
+
+int main( void )
+{
+  HOST_RUN( testBlinkTiming );
+  HOST_RUN( testLateUpdatesDoNotDrift );
+
+  return ( HOST_RESULT() );
+}
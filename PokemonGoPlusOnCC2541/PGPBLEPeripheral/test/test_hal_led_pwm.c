@@ -0,0 +1,181 @@
+/**************************************************************************************************
+  Filename:       test_hal_led_pwm.c
+
+  Description:    Host tests of the Timer1/Timer4 LED PWM in hal_led.c against a model of
+                  the timer and port registers it programs.
+**************************************************************************************************/
+
+#include "hal_board.h"
+#include "hal_drivers.h"
+#include "hal_led.h"
+#include "OSAL.h"
+#include "OSAL_PwrMgr.h"
+#include "host_hal.h"
+#include "host_test.h"
+
+#define TEST_HAL_TASK  0
+
+uint8 Hal_TaskID = TEST_HAL_TASK;
+
+// Internal to the HAL, as in hal_drivers.c
+extern void HalLedUpdate( void );
+
+// Timer1 overflow vector
+extern void halLedPwmIsr( void );
+
+static uint16 blinkEvents;
+
+static uint16 testHalTask( uint8 taskId, uint16 events )
+{
+  (void)taskId;
+
+  if ( events & HAL_LED_BLINK_EVENT )
+  {
+    blinkEvents++;
+    HalLedUpdate();
+    return ( events ^ HAL_LED_BLINK_EVENT );
+  }
+
+  return ( 0 );
+}
+
+static uint8 testPwmHolds( void )
+{
+  pwrmgr_hold_stats_t stats;
+
+  VOID osal_pwrmgr_hold_stats( PWRMGR_REASON_LED_PWM, &stats );
+
+  return ( stats.count );
+}
+
+static void testSetup( void )
+{
+  hostInit();
+  hostSetTask( TEST_HAL_TASK, testHalTask );
+  HalLedInit();
+  HalLedSet( HAL_LED_ALL, HAL_LED_MODE_OFF );
+  blinkEvents = 0;
+}
+
+static void testLevelProgramsTimer1( void )
+{
+  testSetup();
+
+  HalLedSetLevel( HAL_LED_1_RED, 128 );
+  HOST_CHECK( P1SEL & LED1_BV );
+  HOST_CHECK( PERCFG & 0x40 );
+  HOST_CHECK_EQ( T1CTL, 0x0E );
+  HOST_CHECK_EQ( T1CC0L, 0xFF );
+  HOST_CHECK_EQ( T1CCTL2, 0x24 );
+  HOST_CHECK_EQ( T1CC2L, 128 );
+  HOST_CHECK_EQ( T1IE, 0 );
+  HOST_CHECK( HalLedGetState() & HAL_LED_1_RED );
+  HOST_CHECK_EQ( testPwmHolds(), 1 );
+
+  // Blue shares Timer1; the power hold is taken once
+  HalLedSetLevel( HAL_LED_2_BLUE, 10 );
+  HOST_CHECK( P1SEL & LED2_BV );
+  HOST_CHECK_EQ( T1CCTL1, 0x24 );
+  HOST_CHECK_EQ( T1CC1L, 10 );
+  HOST_CHECK_EQ( testPwmHolds(), 1 );
+
+  // Full off gives both pins back to GPIO and stops the timer
+  HalLedSetLevel( HAL_LED_1_RED | HAL_LED_2_BLUE, HAL_LED_LEVEL_OFF );
+  HOST_CHECK_EQ( P1SEL & ( LED1_BV | LED2_BV ), 0 );
+  HOST_CHECK_EQ( T1CCTL1, 0 );
+  HOST_CHECK_EQ( T1CCTL2, 0 );
+  HOST_CHECK_EQ( T1CTL, 0 );
+  HOST_CHECK_EQ( HalLedGetState() & ( HAL_LED_1_RED | HAL_LED_2_BLUE ), 0 );
+  HOST_CHECK_EQ( testPwmHolds(), 0 );
+}
+
+static void testGreenUsesTimer4( void )
+{
+  testSetup();
+
+  HalLedSetColor( 0, 64, 0 );
+  HOST_CHECK( P2SEL & LED3_BV );
+  HOST_CHECK( PERCFG & 0x10 );
+  HOST_CHECK_EQ( T4CTL, 0xF4 );
+  HOST_CHECK_EQ( T4CCTL0, 0x24 );
+  HOST_CHECK_EQ( T4CC0, 64 );
+
+  HalLedSet( HAL_LED_3_GREEN, HAL_LED_MODE_ON );
+  HOST_CHECK_EQ( P2SEL & LED3_BV, 0 );
+  HOST_CHECK_EQ( T4CTL, 0 );
+  HOST_CHECK_EQ( testPwmHolds(), 0 );
+}
+
+/*
+ * A fade is driven by the Timer1 overflow alone: one interrupt per PWM
+ * period, one OSAL event at the end, then the pin is released.
+ */
+static void testFadeRunsOffOverflow( void )
+{
+  uint16 n;
+  uint8 last = 0;
+  uint8 rising = TRUE;
+
+  testSetup();
+
+  HalLedFade( HAL_LED_1_RED, HAL_LED_LEVEL_MAX, 200 );
+  HOST_CHECK_EQ( T1IE, 1 );
+
+  for ( n = 0; ( n < 1000 ) && T1IE; n++ )
+  {
+    halLedPwmIsr();
+    rising &= ( T1CC2L >= last );
+    last = T1CC2L;
+    hostRun();
+  }
+
+  HOST_CHECK_EQ( n, 200 );
+  HOST_CHECK( rising );
+  HOST_CHECK_EQ( last, HAL_LED_LEVEL_MAX );
+  HOST_CHECK_EQ( blinkEvents, 1 );
+
+  // Settled at max: on through GPIO, timer stopped, sleep allowed
+  HOST_CHECK_EQ( P1SEL & LED1_BV, 0 );
+  HOST_CHECK_EQ( T1CTL, 0 );
+  HOST_CHECK( HalLedGetState() & HAL_LED_1_RED );
+  HOST_CHECK_EQ( testPwmHolds(), 0 );
+}
+
+/*
+ * A fade that ends part way stays on the timer without waking the task.
+ */
+static void testFadeToLevelKeepsTimer( void )
+{
+  uint16 n;
+
+  testSetup();
+
+  HalLedFade( HAL_LED_2_BLUE, 100, 50 );
+  for ( n = 0; ( n < 1000 ) && T1IE; n++ )
+  {
+    halLedPwmIsr();
+    hostRun();
+  }
+
+  HOST_CHECK_EQ( n, 50 );
+  HOST_CHECK_EQ( T1CC1L, 100 );
+  HOST_CHECK_EQ( blinkEvents, 0 );
+  HOST_CHECK( P1SEL & LED2_BV );
+  HOST_CHECK_EQ( testPwmHolds(), 1 );
+
+  // A blink takes the pin back when it first drives it
+  HalLedBlink( HAL_LED_2_BLUE, 1, 50, 100 );
+  hostRun();
+  HOST_CHECK_EQ( P1SEL & LED2_BV, 0 );
+  HOST_CHECK_EQ( testPwmHolds(), 0 );
+}
+
+int main( void )
+{
+  HOST_RUN( testLevelProgramsTimer1 );
+  HOST_RUN( testGreenUsesTimer4 );
+  HOST_RUN( testFadeRunsOffOverflow );
+  HOST_RUN( testFadeToLevelKeepsTimer );
+
+  return ( HOST_RESULT() );
+}
@@ -0,0 +1,178 @@
+/**************************************************************************************************
+  Filename:       test_hal_log.c
+
+  Description:    Host tests of the binary log ring in hal_log.c and of the host decoder,
+                  which reads the stream this program leaves in build/hal_log.bin.
+**************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal_log.h"
+#include "host_hal.h"
+#include "host_test.h"
+
+// pgpCertificate.c's write trace, which the decoder reads from that file
+#define TEST_LOG_ID_WRITE       0x61
+#define TEST_LOG_ID_WRITE_DATA  0x62
+
+static uint8 testFcs( uint8 *pFrame )
+{
+  uint8 fcs = pFrame[1] ^ pFrame[2];
+  uint8 i;
+
+  for ( i = 0; i < pFrame[2]; i++ )
+  {
+    fcs ^= pFrame[3 + i];
+  }
+
+  return ( fcs );
+}
+
+static void testFrameLayout( void )
+{
+  uint8 args[2] = { 0x34, 0x12 };
+
+  hostInit();
+  HalLogInit();
+
+  HOST_CHECK( HalLogEvent( HAL_LOG_ID_KEY_UP, args, sizeof ( args ) ) );
+  HOST_CHECK_EQ( hostUartTxLen, 0 );
+  HalLogPoll();
+  HOST_CHECK_EQ( hostUartTxLen, 6 );
+  HOST_CHECK_EQ( hostUartTx[0], HAL_LOG_SYNC );
+  HOST_CHECK_EQ( hostUartTx[1], HAL_LOG_ID_KEY_UP );
+  HOST_CHECK_EQ( hostUartTx[2], 2 );
+  HOST_CHECK_EQ( hostUartTx[3], 0x34 );
+  HOST_CHECK_EQ( hostUartTx[4], 0x12 );
+  HOST_CHECK_EQ( hostUartTx[5], testFcs( hostUartTx ) );
+}
+
+static void testDumpSplitsIntoFrames( void )
+{
+  uint8 value[40];
+  uint8 i, *pFrame;
+
+  hostInit();
+  HalLogInit();
+  for ( i = 0; i < sizeof ( value ); i++ )
+  {
+    value[i] = i;
+  }
+
+  HOST_CHECK( HalLogDump( TEST_LOG_ID_WRITE_DATA, value, sizeof ( value ) ) );
+  HalLogPoll();
+  HOST_CHECK_EQ( hostUartTxLen, sizeof ( value ) + 3 * HAL_LOG_FRAME_OVERHEAD );
+
+  // 16 + 16 + 8 bytes, in order, every frame whole
+  pFrame = hostUartTx;
+  for ( i = 0; i < 3; i++ )
+  {
+    HOST_CHECK_EQ( pFrame[1], TEST_LOG_ID_WRITE_DATA );
+    HOST_CHECK_EQ( pFrame[2], ( i < 2 ) ? HAL_LOG_ARGS_MAX : 8 );
+    HOST_CHECK_EQ( pFrame[3], i * HAL_LOG_ARGS_MAX );
+    HOST_CHECK_EQ( pFrame[3 + pFrame[2]], testFcs( pFrame ) );
+    pFrame += pFrame[2] + HAL_LOG_FRAME_OVERHEAD;
+  }
+}
+
+static void testDropsAreReported( void )
+{
+  uint8 sent = 0;
+
+  hostInit();
+  HalLogInit();
+
+  // UART busy: frames pile up in the ring until it is full
+  hostUartTxRoom = 0;
+  while ( HalLogEvent( HAL_LOG_ID_BOOT, NULL, 0 ) )
+  {
+    sent++;
+  }
+  HOST_CHECK_EQ( sent, ( HAL_LOG_BUF_SIZE - 1 ) / HAL_LOG_FRAME_OVERHEAD );
+  HOST_CHECK( !HalLogEvent( HAL_LOG_ID_BOOT, NULL, 0 ) );
+  HalLogPoll();
+  HOST_CHECK_EQ( hostUartTxLen, 0 );
+
+  // The next frame to fit is preceded by the count of the two dropped
+  hostUartTxRoom = HOST_UART_TX_MAX;
+  HalLogPoll();
+  HOST_CHECK_EQ( hostUartTxLen, sent * HAL_LOG_FRAME_OVERHEAD );
+  HOST_CHECK( HalLogEvent( HAL_LOG_ID_GAPROLE_ADV, NULL, 0 ) );
+  HalLogPoll();
+  HOST_CHECK_EQ( hostUartTx[sent * HAL_LOG_FRAME_OVERHEAD + 1], HAL_LOG_ID_DROPPED );
+  HOST_CHECK_EQ( hostUartTx[sent * HAL_LOG_FRAME_OVERHEAD + 3], 2 );
+  HOST_CHECK_EQ( hostUartTx[sent * HAL_LOG_FRAME_OVERHEAD + 6], HAL_LOG_ID_GAPROLE_ADV );
+}
+
+static void testCriticalSectionRestoresEA( void )
+{
+  hostInit();
+  HalLogInit();
+
+  HOST_CHECK( HalLogEvent( HAL_LOG_ID_BOOT, NULL, 0 ) );
+  HOST_CHECK_EQ( EA, 1 );
+
+  // As from an interrupt handler
+  EA = 0;
+  HOST_CHECK( HalLogEvent( HAL_LOG_ID_BOOT, NULL, 0 ) );
+  HOST_CHECK_EQ( EA, 0 );
+  EA = 1;
+
+  hostUartTxRoom = 0;
+  while ( HalLogEvent( HAL_LOG_ID_BOOT, NULL, 0 ) );
+  HOST_CHECK_EQ( EA, 1 );
+}
+
+/*
+ * The stream of one long certificate write as pgpCertificate.c logs it,
+ * left for the decoder check in the Makefile.
+ */
+static void testDecoderStream( void )
+{
+  uint8 header[5] = { 0x25, 0x00, 0x00, 0x00, 40 };
+  uint8 value[40];
+  uint8 up[2] = { 0xD2, 0x04 };
+  uint8 i;
+  FILE *pFile;
+
+  hostInit();
+  HalLogInit();
+  for ( i = 0; i < sizeof ( value ); i++ )
+  {
+    value[i] = 0xC0 + i;
+  }
+
+  HalLogEvent( HAL_LOG_ID_BOOT, NULL, 0 );
+  HalLogEvent( HAL_LOG_ID_KEY_UP, up, sizeof ( up ) );
+  HalLogEvent( TEST_LOG_ID_WRITE, header, sizeof ( header ) );
+  HalLogDump( TEST_LOG_ID_WRITE_DATA, value, sizeof ( value ) );
+  HalLogPoll();
+
+  // A frame garbled on the line, which the decoder skips
+  hostUartTx[hostUartTxLen++] = HAL_LOG_SYNC;
+  hostUartTx[hostUartTxLen++] = HAL_LOG_ID_GAPROLE_CONN;
+  hostUartTx[hostUartTxLen++] = 0;
+  hostUartTx[hostUartTxLen++] = 0xFF;
+  HalLogEvent( HAL_LOG_ID_GAPROLE_CONN, NULL, 0 );
+  HalLogPoll();
+
+  pFile = fopen( "build/hal_log.bin", "wb" );
+  HOST_CHECK( pFile != NULL );
+  if ( pFile != NULL )
+  {
+    fwrite( hostUartTx, 1, hostUartTxLen, pFile );
+    fclose( pFile );
+  }
+}
+
+int main( void )
+{
+  HOST_RUN( testFrameLayout );
+  HOST_RUN( testDumpSplitsIntoFrames );
+  HOST_RUN( testDropsAreReported );
+  HOST_RUN( testCriticalSectionRestoresEA );
+  HOST_RUN( testDecoderStream );
+
+  return ( HOST_RESULT() );
+}
@@ -0,0 +1,116 @@
+/**************************************************************************************************
+  Filename:       test_hal_log_levels.c
+
+  Description:    Host test of the compile-time log levels of hal_log.h, over the caller
+                  in hal_log_caller.c built with HAL_LOG off and at each level: a level
+                  compiled out makes no call into hal_log.c and evaluates none of its
+                  arguments, and an enabled one evaluates each argument once. The
+                  Makefile prints the code size of each build of the caller.
+**************************************************************************************************/
+
+#include <string.h>
+
+#include "hal_log.h"
+#include "host_test.h"
+
+// Calls of each macro set in the caller: event, 16-bit value and dump
+#define TEST_CALLS_PER_LEVEL  3
+
+typedef struct
+{
+  const char *name;
+  void (*pfnCaller)( void );
+  uint8 level;                  // Highest level logged, HAL_LOG_LEVEL_NONE for none
+} testCaller_t;
+
+// The builds of hal_log_caller.c, see the Makefile
+extern void testLogCallerOFF( void );
+extern void testLogCallerNONE( void );
+extern void testLogCallerERROR( void );
+extern void testLogCallerWARN( void );
+extern void testLogCallerINFO( void );
+extern void testLogCallerDEBUG( void );
+
+static const testCaller_t testCallers[] =
+{
+  { "HAL_LOG off", testLogCallerOFF,   HAL_LOG_LEVEL_NONE },
+  { "NONE",        testLogCallerNONE,  HAL_LOG_LEVEL_NONE },
+  { "ERROR",       testLogCallerERROR, HAL_LOG_LEVEL_ERROR },
+  { "WARN",        testLogCallerWARN,  HAL_LOG_LEVEL_WARN },
+  { "INFO",        testLogCallerINFO,  HAL_LOG_LEVEL_INFO },
+  { "DEBUG",       testLogCallerDEBUG, HAL_LOG_LEVEL_DEBUG }
+};
+
+// Calls into the log and arguments evaluated, per level
+static uint8 testCalls[HAL_LOG_LEVEL_DEBUG + 1];
+static uint8 testEvals[HAL_LOG_LEVEL_DEBUG + 1];
+
+static uint8 testArgs[1];
+
+/*********************************************************************
+ * STUBS
+ */
+
+// The log itself, counting the calls; the caller logs the level as the id
+uint8 HalLogEvent( uint8 id, uint8 *pArgs, uint8 len )
+{
+  testCalls[id]++;
+  return ( TRUE );
+}
+
+uint8 HalLogDump( uint8 id, uint8 *pArgs, uint8 len )
+{
+  testCalls[id]++;
+  return ( TRUE );
+}
+
+uint8 *testLogArgs( uint8 level )
+{
+  testEvals[level]++;
+  return ( testArgs );
+}
+
+uint16 testLogValue( uint8 level )
+{
+  testEvals[level]++;
+  return ( level );
+}
+
+/*********************************************************************
+ * TESTS
+ */
+
+static void testLevelsCompiledOut( void )
+{
+  uint8 i, level;
+
+  for ( i = 0; i < sizeof ( testCallers ) / sizeof ( testCallers[0] ); i++ )
+  {
+    const testCaller_t *pCaller = &testCallers[i];
+
+    memset( testCalls, 0, sizeof ( testCalls ) );
+    memset( testEvals, 0, sizeof ( testEvals ) );
+
+    pCaller->pfnCaller();
+
+    for ( level = HAL_LOG_LEVEL_ERROR; level <= HAL_LOG_LEVEL_DEBUG; level++ )
+    {
+      uint8 expected = ( level <= pCaller->level ) ? TEST_CALLS_PER_LEVEL : 0;
+
+      if ( testCalls[level] != expected || testEvals[level] != expected )
+      {
+        printf( "     %s, level %u: %u calls, %u arguments evaluated, expected %u\n",
+                pCaller->name, level, testCalls[level], testEvals[level], expected );
+      }
+      HOST_CHECK_EQ( testCalls[level], expected );
+      HOST_CHECK_EQ( testEvals[level], expected );
+    }
+  }
+}
+
+int main( void )
+{
+  HOST_RUN( testLevelsCompiledOut );
+
+  return ( HOST_RESULT() );
+}
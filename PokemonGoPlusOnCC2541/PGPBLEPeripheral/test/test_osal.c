@@ -0,0 +1,213 @@
+/**************************************************************************************************
+  Filename:       test_osal.c
+
+  Description:    Host tests of the OSAL port itself: timers against the link layer
+                  clock, the heap, SNV on RAM backed flash, and the power manager's
+                  named holds.
+**************************************************************************************************/
+
+#include <string.h>
+
+#include "OSAL.h"
+#include "OSAL_Timers.h"
+#include "osal_snv.h"
+#include "OSAL_PwrMgr.h"
+#include "OnBoard.h"
+#include "host_hal.h"
+#include "host_test.h"
+
+#define TEST_TASK   0
+#define TEST_EVT    0x0001
+#define TEST_NV_ID  0x80
+
+static uint16 fired;
+
+static uint16 testTask( uint8 taskId, uint16 events )
+{
+  (void)taskId;
+
+  if ( events & TEST_EVT )
+  {
+    fired++;
+    return ( events ^ TEST_EVT );
+  }
+
+  return ( 0 );
+}
+
+static void testTimerFiresOnTime( void )
+{
+  hostInit();
+  hostSetTask( TEST_TASK, testTask );
+  fired = 0;
+
+  HOST_CHECK_EQ( osal_start_timerEx( TEST_TASK, TEST_EVT, 100 ), SUCCESS );
+  hostAdvance( 99 );
+  HOST_CHECK_EQ( fired, 0 );
+  hostAdvance( 1 );
+  HOST_CHECK_EQ( fired, 1 );
+  hostAdvance( 500 );
+  HOST_CHECK_EQ( fired, 1 );
+}
+
+static void testReloadTimer( void )
+{
+  hostInit();
+  hostSetTask( TEST_TASK, testTask );
+  fired = 0;
+
+  VOID osal_start_reload_timer( TEST_TASK, TEST_EVT, 30 );
+  hostAdvance( 300 );
+  HOST_CHECK_EQ( fired, 10 );
+  VOID osal_stop_timerEx( TEST_TASK, TEST_EVT );
+  hostAdvance( 300 );
+  HOST_CHECK_EQ( fired, 10 );
+}
+
+static void testHeap( void )
+{
+  void *p1, *p2;
+
+  hostInit();
+
+  p1 = osal_mem_alloc( 100 );
+  p2 = osal_mem_alloc( 100 );
+  HOST_CHECK( p1 != NULL );
+  HOST_CHECK( p2 != NULL );
+  HOST_CHECK( p1 != p2 );
+  osal_mem_free( p1 );
+  HOST_CHECK( osal_mem_alloc( 100 ) == p1 );
+  HOST_CHECK( osal_mem_alloc( INT_HEAP_LEN ) == NULL );
+}
+
+static void testSnvSurvivesCompaction( void )
+{
+  uint8 value[20];
+  uint8 other[4] = { 1, 2, 3, 4 };
+  uint16 n;
+
+  hostInit();
+  HOST_CHECK_EQ( osal_snv_init(), SUCCESS );
+  HOST_CHECK_EQ( osal_snv_write( TEST_NV_ID + 1, sizeof ( other ), other ), SUCCESS );
+
+  // Enough writes of one item to fill the page several times over
+  for ( n = 0; n < 500; n++ )
+  {
+    memset( value, (uint8)n, sizeof ( value ) );
+    HOST_CHECK_EQ( osal_snv_write( TEST_NV_ID, sizeof ( value ), value ), SUCCESS );
+  }
+  HOST_CHECK( hostFlashStats.erases >= 4 );
+
+  // As after a reset
+  HOST_CHECK_EQ( osal_snv_init(), SUCCESS );
+  memset( value, 0, sizeof ( value ) );
+  HOST_CHECK_EQ( osal_snv_read( TEST_NV_ID, sizeof ( value ), value ), SUCCESS );
+  HOST_CHECK_EQ( value[0], (uint8)499 );
+  HOST_CHECK_EQ( value[19], (uint8)499 );
+  memset( other, 0, sizeof ( other ) );
+  HOST_CHECK_EQ( osal_snv_read( TEST_NV_ID + 1, sizeof ( other ), other ), SUCCESS );
+  HOST_CHECK_EQ( other[3], 4 );
+  HOST_CHECK( osal_snv_read( TEST_NV_ID + 2, sizeof ( other ), other ) != SUCCESS );
+}
+
+static uint16 testHoldCount( uint8 reason, pwrmgr_hold_stats_t *pStats )
+{
+  HOST_CHECK_EQ( osal_pwrmgr_hold_stats( reason, pStats ), SUCCESS );
+
+  return ( pStats->count );
+}
+
+// Holds nest per reason and each needs its own release; a release with
+// nothing held fails and leaves the count alone
+static void testHoldsNest( void )
+{
+  pwrmgr_hold_stats_t stats;
+
+  hostInit();
+
+  HOST_CHECK_EQ( osal_pwrmgr_hold( PWRMGR_REASON_LED_PWM ), SUCCESS );
+  HOST_CHECK_EQ( osal_pwrmgr_hold( PWRMGR_REASON_LED_PWM ), SUCCESS );
+  HOST_CHECK_EQ( osal_pwrmgr_hold( PWRMGR_REASON_UART ), SUCCESS );
+  HOST_CHECK_EQ( testHoldCount( PWRMGR_REASON_LED_PWM, &stats ), 2 );
+  HOST_CHECK_EQ( stats.holds, 1 );
+  HOST_CHECK_EQ( testHoldCount( PWRMGR_REASON_UART, &stats ), 1 );
+
+  HOST_CHECK_EQ( osal_pwrmgr_release( PWRMGR_REASON_LED_PWM ), SUCCESS );
+  HOST_CHECK_EQ( testHoldCount( PWRMGR_REASON_LED_PWM, &stats ), 1 );
+  HOST_CHECK_EQ( osal_pwrmgr_release( PWRMGR_REASON_LED_PWM ), SUCCESS );
+  HOST_CHECK_EQ( testHoldCount( PWRMGR_REASON_LED_PWM, &stats ), 0 );
+
+  HOST_CHECK_EQ( osal_pwrmgr_release( PWRMGR_REASON_LED_PWM ), FAILURE );
+  HOST_CHECK_EQ( testHoldCount( PWRMGR_REASON_LED_PWM, &stats ), 0 );
+  HOST_CHECK_EQ( testHoldCount( PWRMGR_REASON_UART, &stats ), 1 );
+
+  HOST_CHECK_EQ( osal_pwrmgr_hold( PWRMGR_NUM_REASONS ), INVALIDPARAMETER );
+  HOST_CHECK_EQ( osal_pwrmgr_release( PWRMGR_NUM_REASONS ), INVALIDPARAMETER );
+
+  // hostInit() does not clear the holds, so leave none behind
+  HOST_CHECK_EQ( osal_pwrmgr_release( PWRMGR_REASON_UART ), SUCCESS );
+}
+
+// The idle loop sleeps only while no reason is held
+static void testHoldKeepsAwake( void )
+{
+  hostInit();
+  osal_pwrmgr_device( PWRMGR_BATTERY );
+
+  hostAdvance( 10 );
+  HOST_CHECK( hostSleeps > 0 );
+
+  HOST_CHECK_EQ( osal_pwrmgr_hold( PWRMGR_REASON_UART ), SUCCESS );
+  hostSleeps = 0;
+  hostAdvance( 10 );
+  HOST_CHECK_EQ( hostSleeps, 0 );
+
+  HOST_CHECK_EQ( osal_pwrmgr_release( PWRMGR_REASON_UART ), SUCCESS );
+  hostAdvance( 10 );
+  HOST_CHECK( hostSleeps > 0 );
+}
+
+// A hold that outlasts PWRMGR_HOLD_WARN_TIME counts one overrun, however
+// much longer it goes on; the next hold can overrun again
+static void testHoldOverrun( void )
+{
+  pwrmgr_hold_stats_t stats;
+
+  hostInit();
+  osal_pwrmgr_device( PWRMGR_BATTERY );
+  osal_pwrmgr_reset_stats();
+
+  HOST_CHECK_EQ( osal_pwrmgr_hold( PWRMGR_REASON_LED_PWM ), SUCCESS );
+  hostAdvance( PWRMGR_HOLD_WARN_TIME );
+  VOID testHoldCount( PWRMGR_REASON_LED_PWM, &stats );
+  HOST_CHECK_EQ( stats.overruns, 0 );
+
+  hostAdvance( 2 );
+  VOID testHoldCount( PWRMGR_REASON_LED_PWM, &stats );
+  HOST_CHECK_EQ( stats.overruns, 1 );
+  hostAdvance( PWRMGR_HOLD_WARN_TIME );
+  VOID testHoldCount( PWRMGR_REASON_LED_PWM, &stats );
+  HOST_CHECK_EQ( stats.overruns, 1 );
+  HOST_CHECK( stats.longest > 2 * PWRMGR_HOLD_WARN_TIME );
+
+  HOST_CHECK_EQ( osal_pwrmgr_release( PWRMGR_REASON_LED_PWM ), SUCCESS );
+  HOST_CHECK_EQ( osal_pwrmgr_hold( PWRMGR_REASON_LED_PWM ), SUCCESS );
+  hostAdvance( PWRMGR_HOLD_WARN_TIME + 2 );
+  VOID testHoldCount( PWRMGR_REASON_LED_PWM, &stats );
+  HOST_CHECK_EQ( stats.overruns, 2 );
+  HOST_CHECK_EQ( stats.holds, 2 );
+  HOST_CHECK_EQ( osal_pwrmgr_release( PWRMGR_REASON_LED_PWM ), SUCCESS );
+}
+
+int main( void )
+{
+  HOST_RUN( testTimerFiresOnTime );
+  HOST_RUN( testReloadTimer );
+  HOST_RUN( testHeap );
+  HOST_RUN( testSnvSurvivesCompaction );
+  HOST_RUN( testHoldsNest );
+  HOST_RUN( testHoldKeepsAwake );
+  HOST_RUN( testHoldOverrun );
+
+  return ( HOST_RESULT() );
+}
@@ -0,0 +1,329 @@
+/**************************************************************************************************
+  Filename:       test_pgpCertificate.c
+
+  Description:    Host tests of the PGP Certificate service: writes reaching each
+                  characteristic through its attribute position, a client enabling,
+                  receiving and disabling SFIDA Commands notifications, and long
+                  values reassembled from Prepare Write fragments whole or not at all.
+**************************************************************************************************/
+
+#include "bcomdef.h"
+#include "OSAL.h"
+#include "osal_cbtimer.h"
+#include "linkdb.h"
+#include "pgpCertificate.h"
+#include "host_hal.h"
+#include "host_ble.h"
+#include "host_test.h"
+
+// OSAL task of the callback timers
+#define TASK_CBTIMER      0
+
+// Application callbacks kept since testSetup()
+#define TEST_CHANGE_MAX   8
+
+// Longest a zero-length callback timer takes to fire: up to the next whole
+// millisecond of the 625us clock
+#define TEST_TIMER_ZERO   2
+
+// Prepare Write fragments at the default MTU
+#define TEST_FRAG_LEN     ( ATT_MTU_SIZE - 5 )
+
+static uint8 testChanges[TEST_CHANGE_MAX];
+static uint8 testChangeCount;
+
+/*********************************************************************
+ * HELPERS
+ */
+
+static void testChangeCB( uint8 paramID )
+{
+  if ( testChangeCount < TEST_CHANGE_MAX )
+  {
+    testChanges[testChangeCount++] = paramID;
+  }
+}
+
+static pgpCertificateCBs_t testCBs = { testChangeCB };
+
+static void testSetup( void )
+{
+  hostInit();
+  hostBleInit();
+  hostBleLink( LINK_CONNECTED );
+  hostSetTask( TASK_CBTIMER, osal_CbTimerProcessEvent );
+  osal_CbTimerInit( TASK_CBTIMER );
+
+  HOST_CHECK_EQ( PgpCertificate_AddService( GATT_ALL_SERVICES ), SUCCESS );
+  HOST_CHECK_EQ( PgpCertificate_RegisterAppCBs( &testCBs ), SUCCESS );
+  testChangeCount = 0;
+}
+
+// Handle of the value of the characteristic with this UUID
+static uint16 testHandle( uint16 charUUID )
+{
+  uint8 uuid[ATT_UUID_SIZE] = { CERTIFICATE_SERVICE_BASE_UUID_128( charUUID ) };
+  gattAttribute_t *pAttr = GATT_FindHandleUUID( GATT_MIN_HANDLE, GATT_MAX_HANDLE, uuid,
+                                                ATT_UUID_SIZE, NULL );
+
+  HOST_CHECK( pAttr != NULL );
+
+  return ( pAttr != NULL ? pAttr->handle : GATT_INVALID_HANDLE );
+}
+
+// Fill with a pattern that differs per characteristic and per byte
+static void testFill( uint8 *pBuf, uint8 len, uint8 seed )
+{
+  uint8 i;
+
+  for ( i = 0; i < len; i++ )
+  {
+    pBuf[i] = seed + i;
+  }
+}
+
+// Queue len bytes for the characteristic in fragments, from offset on
+static void testPrepare( uint16 handle, uint8 *pValue, uint8 len, uint16 offset )
+{
+  uint8 n;
+
+  for ( ; len > 0; len -= n, pValue += n, offset += n )
+  {
+    n = MIN( len, TEST_FRAG_LEN );
+    HOST_CHECK_EQ( hostBlePrepareWrite( handle, pValue, n, offset ), SUCCESS );
+  }
+}
+
+// Read the whole value with Read and Read Blob requests, as a client does
+static uint8 testReadLong( uint16 handle, uint8 *pBuf )
+{
+  uint8 len = 0;
+  uint8 n;
+
+  do
+  {
+    HOST_CHECK_EQ( hostBleRead( handle, &pBuf[len], &n, len, ATT_MTU_SIZE - 1 ), SUCCESS );
+    len += n;
+  } while ( n == ATT_MTU_SIZE - 1 );
+
+  return ( len );
+}
+
+// Give the characteristic a short value and forget the change it makes
+static void testShortValue( uint16 handle, uint8 *pValue )
+{
+  testFill( pValue, 4, 0xE0 );
+  HOST_CHECK_EQ( hostBleWrite( handle, pValue, 4, 0, ATT_WRITE_REQ ), SUCCESS );
+  testChangeCount = 0;
+}
+
+// The characteristic still has the short value and the application heard
+// of nothing
+static void testUnchanged( uint16 handle, uint8 *pValue )
+{
+  uint8 got[PGP_CERT_CHAR_MAX_LEN + ATT_MTU_SIZE];
+
+  HOST_CHECK_EQ( testReadLong( handle, got ), 4 );
+  HOST_CHECK( osal_memcmp( got, pValue, 4 ) );
+  HOST_CHECK_EQ( testChangeCount, 0 );
+}
+
+/*********************************************************************
+ * TESTS
+ */
+
+// Each value written lands in its own characteristic, and the application
+// hears which one
+static void testWritesReachTheirCharacteristic( void )
+{
+  uint8 sent[3][ATT_MTU_SIZE - 3];
+  uint8 got[PGP_CERT_CHAR_MAX_LEN];
+  uint8 len;
+  uint8 param;
+  uint16 uuids[3] = { CENTRAL_TO_SFIDA_CHAR_UUID, SFIDA_COMMANDS_CHAR_UUID,
+                      SFIDA_TO_CENTRAL_CHAR_UUID };
+
+  testSetup();
+
+  // Parameter IDs are in the order of the characteristics
+  for ( param = CENTRAL_TO_SFIDA_CHAR; param <= SFIDA_TO_CENTRAL_CHAR; param++ )
+  {
+    testFill( sent[param], sizeof ( sent[param] ), 0x10 * ( param + 1 ) );
+    HOST_CHECK_EQ( hostBleWrite( testHandle( uuids[param] ), sent[param],
+                                 sizeof ( sent[param] ), 0, ATT_WRITE_REQ ), SUCCESS );
+  }
+
+  for ( param = CENTRAL_TO_SFIDA_CHAR; param <= SFIDA_TO_CENTRAL_CHAR; param++ )
+  {
+    HOST_CHECK_EQ( hostBleRead( testHandle( uuids[param] ), got, &len, 0, ATT_MTU_SIZE - 1 ),
+                   SUCCESS );
+    HOST_CHECK_EQ( len, sizeof ( sent[param] ) );
+    HOST_CHECK( osal_memcmp( got, sent[param], sizeof ( sent[param] ) ) );
+
+    HOST_CHECK_EQ( PgpCertificate_GetParameter( param, got ), SUCCESS );
+    HOST_CHECK( osal_memcmp( got, sent[param], sizeof ( sent[param] ) ) );
+
+    HOST_CHECK_EQ( testChanges[param], param );
+  }
+
+  HOST_CHECK_EQ( testChangeCount, 3 );
+
+  // Nothing goes out as a notification for a client write
+  HOST_CHECK_EQ( hostNotiCount, 0 );
+}
+
+// A client enables notifications on the CCC after SFIDA Commands, which the
+// application hears of, gets each command the application sets, then
+// disables them and gets none
+static void testCommandsNotifyCycle( void )
+{
+  uint16 handle;
+  uint8 cmd[ATT_MTU_SIZE - 3];
+
+  testSetup();
+  handle = testHandle( SFIDA_COMMANDS_CHAR_UUID );
+  testFill( cmd, sizeof ( cmd ), 0x40 );
+
+  // Nothing goes out before the client asks
+  HOST_CHECK_EQ( PgpCertificate_SetParameter( SFIDA_COMMANDS_CHAR, 4, cmd ), SUCCESS );
+  HOST_CHECK_EQ( hostNotiCount, 0 );
+
+  HOST_CHECK_EQ( hostBleWriteCCC( handle + 1, GATT_CLIENT_CFG_NOTIFY ), SUCCESS );
+  HOST_CHECK_EQ( GATTServApp_ReadCharCfg( HOST_CONN_HANDLE,
+                                          GATT_CCC_TBL( hostBleAttr( handle + 1 )->pValue ) ),
+                 GATT_CLIENT_CFG_NOTIFY );
+  HOST_CHECK_EQ( testChangeCount, 1 );
+  HOST_CHECK_EQ( testChanges[0], SFIDA_COMMANDS_NOTIFY_SET );
+
+  HOST_CHECK_EQ( PgpCertificate_SetParameter( SFIDA_COMMANDS_CHAR, 4, cmd ), SUCCESS );
+  HOST_CHECK_EQ( PgpCertificate_SetParameter( SFIDA_COMMANDS_CHAR, sizeof ( cmd ), cmd ),
+                 SUCCESS );
+
+  HOST_CHECK_EQ( hostNotiCount, 2 );
+  HOST_CHECK_EQ( hostNoti[0].handle, handle );
+  HOST_CHECK_EQ( hostNoti[0].len, 4 );
+  HOST_CHECK_EQ( hostNoti[0].indication, FALSE );
+  HOST_CHECK_EQ( hostNoti[1].len, sizeof ( cmd ) );
+  HOST_CHECK( osal_memcmp( hostNoti[1].value, cmd, sizeof ( cmd ) ) );
+
+  HOST_CHECK_EQ( hostBleWriteCCC( handle + 1, GATT_CFG_NO_OPERATION ), SUCCESS );
+  HOST_CHECK_EQ( PgpCertificate_SetParameter( SFIDA_COMMANDS_CHAR, 4, cmd ), SUCCESS );
+
+  HOST_CHECK_EQ( hostNotiCount, 2 );
+  HOST_CHECK_EQ( hostBmOutstanding, 0 );
+
+  // Disabling is not news to the application
+  HOST_CHECK_EQ( testChangeCount, 1 );
+}
+
+// A long write whose last fragment runs past PGP_CERT_CHAR_MAX_LEN leaves
+// the value as it was, the fragments before it included
+static void testLongWriteTooLong( void )
+{
+  uint16 handle;
+  uint8 shortValue[4];
+  uint8 value[PGP_CERT_CHAR_MAX_LEN + 1];
+
+  testSetup();
+  handle = testHandle( CENTRAL_TO_SFIDA_CHAR_UUID );
+  testShortValue( handle, shortValue );
+
+  testFill( value, sizeof ( value ), 0x01 );
+  testPrepare( handle, value, sizeof ( value ), 0 );
+  HOST_CHECK_EQ( hostBleExecuteWrite( TRUE ), ATT_ERR_INVALID_VALUE_SIZE );
+  hostAdvance( TEST_TIMER_ZERO );
+
+  testUnchanged( handle, shortValue );
+}
+
+// A fragment past the end of the value so far leaves it as it was
+static void testLongWriteGap( void )
+{
+  uint16 handle;
+  uint8 shortValue[4];
+  uint8 value[PGP_CERT_CHAR_MAX_LEN];
+
+  testSetup();
+  handle = testHandle( CENTRAL_TO_SFIDA_CHAR_UUID );
+  testShortValue( handle, shortValue );
+
+  testFill( value, sizeof ( value ), 0x01 );
+  testPrepare( handle, value, TEST_FRAG_LEN, 0 );
+  testPrepare( handle, &value[TEST_FRAG_LEN + 1], TEST_FRAG_LEN, TEST_FRAG_LEN + 1 );
+  HOST_CHECK_EQ( hostBleExecuteWrite( TRUE ), ATT_ERR_INVALID_OFFSET );
+  hostAdvance( TEST_TIMER_ZERO );
+
+  testUnchanged( handle, shortValue );
+}
+
+// One Execute Write writes one characteristic; a queue for two writes
+// neither
+static void testLongWriteOneCharacteristic( void )
+{
+  uint16 handle, otherHandle;
+  uint8 shortValue[4], otherShortValue[4];
+  uint8 value[TEST_FRAG_LEN];
+
+  testSetup();
+  handle = testHandle( CENTRAL_TO_SFIDA_CHAR_UUID );
+  otherHandle = testHandle( SFIDA_TO_CENTRAL_CHAR_UUID );
+  testShortValue( handle, shortValue );
+  testShortValue( otherHandle, otherShortValue );
+
+  testFill( value, sizeof ( value ), 0x01 );
+  testPrepare( handle, value, sizeof ( value ), 0 );
+  testPrepare( otherHandle, value, sizeof ( value ), 0 );
+  HOST_CHECK_EQ( hostBleExecuteWrite( TRUE ), ATT_ERR_PREPARE_QUEUE_FULL );
+  hostAdvance( TEST_TIMER_ZERO );
+
+  testUnchanged( handle, shortValue );
+  testUnchanged( otherHandle, otherShortValue );
+}
+
+// A full PGP_CERT_CHAR_MAX_LEN value in GATT_MAX_NUM_PREPARE_WRITES
+// fragments is applied once the stack has handed over all of them, and
+// the application hears of it once; a client reads it back whole
+static void testLongWriteReassembles( void )
+{
+  uint16 handle;
+  uint8 shortValue[4];
+  uint8 value[PGP_CERT_CHAR_MAX_LEN];
+  uint8 got[PGP_CERT_CHAR_MAX_LEN + ATT_MTU_SIZE];
+
+  testSetup();
+  handle = testHandle( CENTRAL_TO_SFIDA_CHAR_UUID );
+  testShortValue( handle, shortValue );
+
+  HOST_CHECK_EQ( ( sizeof ( value ) + TEST_FRAG_LEN - 1 ) / TEST_FRAG_LEN,
+                 GATT_MAX_NUM_PREPARE_WRITES );
+
+  testFill( value, sizeof ( value ), 0x01 );
+  testPrepare( handle, value, sizeof ( value ), 0 );
+  HOST_CHECK_EQ( hostBleExecuteWrite( TRUE ), SUCCESS );
+
+  // Not before the stack is through the queue and the service's callback
+  // timer has fired
+  testUnchanged( handle, shortValue );
+
+  hostAdvance( TEST_TIMER_ZERO );
+
+  HOST_CHECK_EQ( testReadLong( handle, got ), sizeof ( value ) );
+  HOST_CHECK( osal_memcmp( got, value, sizeof ( value ) ) );
+  HOST_CHECK_EQ( PgpCertificate_GetParameter( CENTRAL_TO_SFIDA_CHAR, got ), SUCCESS );
+  HOST_CHECK( osal_memcmp( got, value, sizeof ( value ) ) );
+
+  HOST_CHECK_EQ( testChangeCount, 1 );
+  HOST_CHECK_EQ( testChanges[0], CENTRAL_TO_SFIDA_CHAR );
+}
+
+int main( void )
+{
+  HOST_RUN( testWritesReachTheirCharacteristic );
+  HOST_RUN( testCommandsNotifyCycle );
+  HOST_RUN( testLongWriteTooLong );
+  HOST_RUN( testLongWriteGap );
+  HOST_RUN( testLongWriteOneCharacteristic );
+  HOST_RUN( testLongWriteReassembles );
+
+  return ( HOST_RESULT() );
+}
@@ -0,0 +1,171 @@
+/**************************************************************************************************
+  Filename:       test_pgpDeviceControl.c
+
+  Description:    Host tests of the PGP Device Control service: reads and writes reaching
+                  each characteristic through its attribute position, and a client
+                  enabling, receiving and disabling Button Notif notifications.
+**************************************************************************************************/
+
+#include "bcomdef.h"
+#include "OSAL.h"
+#include "linkdb.h"
+#include "pgpDeviceControl.h"
+#include "host_hal.h"
+#include "host_ble.h"
+#include "host_test.h"
+
+// Application callbacks kept since testSetup()
+#define TEST_CHANGE_MAX   8
+
+static uint8 testChanges[TEST_CHANGE_MAX];
+static uint8 testChangeCount;
+
+/*********************************************************************
+ * HELPERS
+ */
+
+static void testChangeCB( uint8 paramID )
+{
+  if ( testChangeCount < TEST_CHANGE_MAX )
+  {
+    testChanges[testChangeCount++] = paramID;
+  }
+}
+
+static pgpDeviceControlCBs_t testCBs = { testChangeCB };
+
+static void testSetup( void )
+{
+  hostInit();
+  hostBleInit();
+  hostBleLink( LINK_CONNECTED );
+
+  HOST_CHECK_EQ( PgpDeviceControl_AddService( GATT_ALL_SERVICES ), SUCCESS );
+  HOST_CHECK_EQ( PgpDeviceControl_RegisterAppCBs( &testCBs ), SUCCESS );
+  testChangeCount = 0;
+}
+
+// Handle of the value of the characteristic with this UUID
+static uint16 testHandle( uint16 charUUID )
+{
+  uint8 uuid[ATT_UUID_SIZE] = { DEVICE_CONTROL_SERVICE_BASE_UUID_128( charUUID ) };
+  gattAttribute_t *pAttr = GATT_FindHandleUUID( GATT_MIN_HANDLE, GATT_MAX_HANDLE, uuid,
+                                                ATT_UUID_SIZE, NULL );
+
+  HOST_CHECK( pAttr != NULL );
+
+  return ( pAttr != NULL ? pAttr->handle : GATT_INVALID_HANDLE );
+}
+
+static uint8 testRead( uint16 handle )
+{
+  uint8 value[ATT_MTU_SIZE] = { 0 };
+  uint8 len = 0;
+
+  HOST_CHECK_EQ( hostBleRead( handle, value, &len, 0, sizeof ( value ) ), SUCCESS );
+  HOST_CHECK_EQ( len, 1 );
+
+  return ( value[0] );
+}
+
+/*********************************************************************
+ * TESTS
+ */
+
+// Each value written lands in its own characteristic, and the application
+// hears which one
+static void testWritesReachTheirCharacteristic( void )
+{
+  uint16 ledHandle, fwReqHandle;
+  uint8 value;
+
+  testSetup();
+  ledHandle = testHandle( LED_VIBRATE_CTRL_CHAR_UUID );
+  fwReqHandle = testHandle( FW_UPDATE_REQUEST_CHAR_UUID );
+
+  value = 0x5A;
+  HOST_CHECK_EQ( hostBleWrite( ledHandle, &value, 1, 0, ATT_WRITE_REQ ), SUCCESS );
+  value = 0xA5;
+  HOST_CHECK_EQ( hostBleWrite( fwReqHandle, &value, 1, 0, ATT_WRITE_REQ ), SUCCESS );
+
+  HOST_CHECK_EQ( testRead( ledHandle ), 0x5A );
+  HOST_CHECK_EQ( testRead( fwReqHandle ), 0xA5 );
+  VOID PgpDeviceControl_GetParameter( LED_VIBRATE_CTRL_CHAR, &value );
+  HOST_CHECK_EQ( value, 0x5A );
+  VOID PgpDeviceControl_GetParameter( FW_UPDATE_REQUEST_CHAR, &value );
+  HOST_CHECK_EQ( value, 0xA5 );
+
+  HOST_CHECK_EQ( testChangeCount, 2 );
+  HOST_CHECK_EQ( testChanges[0], LED_VIBRATE_CTRL_CHAR );
+  HOST_CHECK_EQ( testChanges[1], FW_UPDATE_REQUEST_CHAR );
+}
+
+// The read-only version and malformed writes are refused without a change
+static void testWritesRefused( void )
+{
+  uint8 value[2] = { 1, 2 };
+
+  testSetup();
+
+  HOST_CHECK_EQ( hostBleWrite( testHandle( FW_VERSION_CHAR_UUID ), value, 1, 0, ATT_WRITE_REQ ),
+                 ATT_ERR_ATTR_NOT_FOUND );
+  HOST_CHECK_EQ( hostBleWrite( testHandle( LED_VIBRATE_CTRL_CHAR_UUID ), value, 2, 0,
+                               ATT_WRITE_REQ ), ATT_ERR_INVALID_VALUE_SIZE );
+  HOST_CHECK_EQ( hostBleWrite( testHandle( LED_VIBRATE_CTRL_CHAR_UUID ), value, 1, 1,
+                               ATT_WRITE_REQ ), ATT_ERR_ATTR_NOT_LONG );
+
+  HOST_CHECK_EQ( testChangeCount, 0 );
+}
+
+// A client enables notifications on the CCC after the value, gets each
+// button state the application sets, then disables them and gets none
+static void testButtonNotifyCycle( void )
+{
+  uint16 handle;
+  uint8 value;
+
+  testSetup();
+  handle = testHandle( BUTTON_NOTIF_CHAR_UUID );
+
+  // Nothing goes out before the client asks
+  value = 1;
+  HOST_CHECK_EQ( PgpDeviceControl_SetParameter( BUTTON_NOTIF_CHAR, 1, &value ), SUCCESS );
+  HOST_CHECK_EQ( hostNotiCount, 0 );
+
+  HOST_CHECK_EQ( hostBleWriteCCC( handle + 1, GATT_CLIENT_CFG_NOTIFY ), SUCCESS );
+  HOST_CHECK_EQ( GATTServApp_ReadCharCfg( HOST_CONN_HANDLE,
+                                          GATT_CCC_TBL( hostBleAttr( handle + 1 )->pValue ) ),
+                 GATT_CLIENT_CFG_NOTIFY );
+
+  value = 2;
+  HOST_CHECK_EQ( PgpDeviceControl_SetParameter( BUTTON_NOTIF_CHAR, 1, &value ), SUCCESS );
+  value = 3;
+  HOST_CHECK_EQ( PgpDeviceControl_SetParameter( BUTTON_NOTIF_CHAR, 1, &value ), SUCCESS );
+
+  HOST_CHECK_EQ( hostNotiCount, 2 );
+  HOST_CHECK_EQ( hostNoti[0].handle, handle );
+  HOST_CHECK_EQ( hostNoti[0].len, 1 );
+  HOST_CHECK_EQ( hostNoti[0].value[0], 2 );
+  HOST_CHECK_EQ( hostNoti[0].indication, FALSE );
+  HOST_CHECK_EQ( hostNoti[1].value[0], 3 );
+
+  HOST_CHECK_EQ( hostBleWriteCCC( handle + 1, GATT_CFG_NO_OPERATION ), SUCCESS );
+  value = 4;
+  HOST_CHECK_EQ( PgpDeviceControl_SetParameter( BUTTON_NOTIF_CHAR, 1, &value ), SUCCESS );
+
+  HOST_CHECK_EQ( hostNotiCount, 2 );
+  HOST_CHECK_EQ( hostBmOutstanding, 0 );
+
+  // The CCC only takes notifications
+  HOST_CHECK_EQ( hostBleWriteCCC( handle + 1, GATT_CLIENT_CFG_INDICATE ),
+                 ATT_ERR_INVALID_VALUE );
+}
+
+int main( void )
+{
+  HOST_RUN( testWritesReachTheirCharacteristic );
+  HOST_RUN( testWritesRefused );
+  HOST_RUN( testButtonNotifyCycle );
+
+  return ( HOST_RESULT() );
+}
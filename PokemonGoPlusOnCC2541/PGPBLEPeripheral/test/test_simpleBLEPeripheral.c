@@ -0,0 +1,563 @@
+/**************************************************************************************************
+  Filename:       test_simpleBLEPeripheral.c
+
+  Description:    Host tests of the application task running with the GAP role, the bond
+                  manager and the services on the host model of the stack. The device
+                  boots once and the tests follow each other on it, as a session would:
+                  the battery measurement schedule over a day of connection, the
+                  advertising policy after button presses and disconnects, the
+                  connection parameters following the activity on the link, and a
+                  bonded central's notifications restored on reconnection.
+**************************************************************************************************/
+
+#include "bcomdef.h"
+#include "OSAL.h"
+#include "osal_snv.h"
+#include "osal_cbtimer.h"
+#include "hal_adc.h"
+#include "hal_key.h"
+#include "OnBoard.h"
+#include "hci.h"
+#include "linkdb.h"
+#include "peripheral.h"
+#include "gapbondmgr.h"
+#include "battservice.h"
+#include "devinfoservice.h"
+#include "pgpCertificate.h"
+#include "pgpDeviceControl.h"
+#include "simpleBLEPeripheral.h"
+#include "host_hal.h"
+#include "host_ble.h"
+#include "host_gap.h"
+#include "host_test.h"
+
+// OSAL tasks, in the order of OSAL_SimpleBLEPeripheral.c
+#define TASK_CBTIMER      0
+#define TASK_GAP          1
+#define TASK_GAPROLE      2
+#define TASK_GAPBONDMGR   3
+#define TASK_APP          4
+
+// Conversions per battery measurement, as battservice.c oversamples
+#define TEST_BATT_SAMPLES 16
+
+// Battery on the VDD/3 channel: 400 is 2.94V, 395 is 2.90V and 320 is
+// 2.35V, below the application's critical level
+#define TEST_BATT_STABLE  400
+#define TEST_BATT_DROP    395
+#define TEST_BATT_LOW     320
+
+// Measurement periods of the application
+#define TEST_BATT_PERIOD      15000UL
+#define TEST_BATT_PERIOD_MAX  240000UL
+
+// Granularity of the long simulations
+#define TEST_STEP         100
+
+// Advertising policy steps, as advPolicy[] in simpleBLEPeripheral.c
+#define TEST_ADV_BURST_INT    32
+#define TEST_ADV_MID_INT      244
+#define TEST_ADV_SLOW_INT     1636
+#define TEST_ADV_BURST_TIME   5000
+#define TEST_ADV_MID_TIME     10000
+#define TEST_ADV_SLOW_TIME    15000
+
+static uint8 testCentral[B_ADDR_LEN] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+static uint8 testCentralIRK[KEYLEN] = { 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8,
+                                        0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF, 0xC0 };
+
+// Connection parameter profiles, as connParamProfiles[] in
+// simpleBLEPeripheral.c: minimum and maximum interval
+#define TEST_CONN_FAST_MIN    6
+#define TEST_CONN_FAST_MAX    12
+#define TEST_CONN_NOTIFY_MIN  24
+#define TEST_CONN_NOTIFY_MAX  40
+#define TEST_CONN_IDLE_MIN    80
+#define TEST_CONN_IDLE_MAX    800
+
+// Timing of the connection parameter manager: the connection pause, how
+// long an activity is held and the minimum gap between two requests
+#define TEST_CONN_PAUSE       6000
+#define TEST_CONN_HOLD        3000
+#define TEST_CONN_GAP         5000
+
+// A phone with privacy: its identity address and IRK
+static uint8 testPhone[B_ADDR_LEN] = { 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xC6 };
+static uint8 testPhoneIRK[KEYLEN] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF,
+                                      0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10 };
+
+static uint16 testBattCcc;
+
+// Times of the last two battery measurements
+static uint32 testBattLast;
+static uint32 testBattPrev;
+
+/*********************************************************************
+ * STUBS
+ */
+
+// The device information service is not part of this test; the LEDs and
+// keys have their own
+bStatus_t DevInfo_AddService( void ) { return ( SUCCESS ); }
+bStatus_t DevInfo_SetParameter( uint8 param, uint8 len, void *value ) { return ( SUCCESS ); }
+uint8 HalLedSet( uint8 led, uint8 mode ) { return ( 0 ); }
+void HalLedBlink( uint8 leds, uint8 cnt, uint8 duty, uint16 time ) {}
+uint8 RegisterForKeys( uint8 task_id ) { return ( TRUE ); }
+
+/*********************************************************************
+ * HELPERS
+ */
+
+static void testBoot( void )
+{
+  hostInit();
+  hostBleInit();
+  hostGapInit( TASK_GAP );
+  VOID osal_snv_init();
+
+  hostSetTask( TASK_CBTIMER, osal_CbTimerProcessEvent );
+  hostSetTask( TASK_GAP, hostGapProcessEvent );
+  hostSetTask( TASK_GAPROLE, GAPRole_ProcessEvent );
+  hostSetTask( TASK_GAPBONDMGR, GAPBondMgr_ProcessEvent );
+  hostSetTask( TASK_APP, SimpleBLEPeripheral_ProcessEvent );
+
+  osal_CbTimerInit( TASK_CBTIMER );
+  GAPRole_Init( TASK_GAPROLE );
+  GAPBondMgr_Init( TASK_GAPBONDMGR );
+  SimpleBLEPeripheral_Init( TASK_APP );
+
+  hostAdcCode = TEST_BATT_STABLE;
+  hostRun();
+
+  VOID Batt_GetParameter( BATT_PARAM_SERVICE_HANDLE, &testBattCcc );
+  testBattCcc += 3;
+}
+
+static uint8 testState( void )
+{
+  uint8 state;
+
+  VOID GAPRole_GetParameter( GAPROLE_STATE, &state );
+
+  return ( state );
+}
+
+// Let ms pass in TEST_STEP steps, noting when the battery was measured
+static void testRun( uint32 ms )
+{
+  uint32 reads = hostAdcReads;
+
+  while ( ms )
+  {
+    uint32 step = ( ms < TEST_STEP ) ? ms : TEST_STEP;
+
+    hostStall( step );
+    hostRun();
+    ms -= step;
+
+    if ( hostAdcReads != reads )
+    {
+      reads = hostAdcReads;
+      testBattPrev = testBattLast;
+      testBattLast = osal_GetSystemClock();
+    }
+  }
+}
+
+static uint32 testBattMeasurements( void )
+{
+  return ( hostAdcReads / TEST_BATT_SAMPLES );
+}
+
+// A click of the button, as the HAL key driver reports it
+static void testPress( void )
+{
+  keyChange_t *pMsg = (keyChange_t *)osal_msg_allocate( sizeof ( keyChange_t ) );
+
+  pMsg->hdr.event = KEY_CHANGE;
+  pMsg->state = HAL_KEY_GESTURE_CLICK;
+  pMsg->keys = HAL_PUSH_BUTTON;
+  VOID osal_msg_send( TASK_APP, (uint8 *)pMsg );
+  hostRun();
+}
+
+// Handle of the value of the device control characteristic with this UUID
+static uint16 testDeviceControlHandle( uint16 charUUID )
+{
+  uint8 uuid[ATT_UUID_SIZE] = { DEVICE_CONTROL_SERVICE_BASE_UUID_128( charUUID ) };
+  gattAttribute_t *pAttr = GATT_FindHandleUUID( GATT_MIN_HANDLE, GATT_MAX_HANDLE, uuid,
+                                                ATT_UUID_SIZE, NULL );
+
+  HOST_CHECK( pAttr != NULL );
+
+  return ( pAttr != NULL ? pAttr->handle : GATT_INVALID_HANDLE );
+}
+
+// A write to the certificate service, as during the handshake
+static void testCertWrite( void )
+{
+  uint8 uuid[ATT_UUID_SIZE] = { CERTIFICATE_SERVICE_BASE_UUID_128( CENTRAL_TO_SFIDA_CHAR_UUID ) };
+  gattAttribute_t *pAttr = GATT_FindHandleUUID( GATT_MIN_HANDLE, GATT_MAX_HANDLE, uuid,
+                                                ATT_UUID_SIZE, NULL );
+  uint8 value[4] = { 0 };
+
+  HOST_CHECK( pAttr != NULL );
+  HOST_CHECK_EQ( hostBleWrite( pAttr->handle, value, sizeof ( value ), 0, ATT_WRITE_REQ ),
+                 SUCCESS );
+  hostRun();
+}
+
+// Request n asked for this interval range this many ms after start
+static uint8 testParamReq( uint8 n, uint32 start, uint32 ms, uint16 min, uint16 max )
+{
+  hostGapParamReq_t *pReq = &hostGapParamReqs[n];
+
+  return ( n < hostGapParamReqCount && pReq->time - start == ms &&
+           pReq->req.intervalMin == min && pReq->req.intervalMax == max );
+}
+
+// Undirected connectable advertising at this interval
+static uint8 testAdvAt( uint16 interval )
+{
+  return ( hostGapAdvertising && hostGapAdvParams.eventType == GAP_ADTYPE_ADV_IND &&
+           hostGapAdvInterval == interval );
+}
+
+/*********************************************************************
+ * TESTS
+ */
+
+static void testBattMeasuredOnlyWhenNotified( void )
+{
+  HOST_CHECK_EQ( testState(), GAPROLE_ADVERTISING );
+  HOST_CHECK( hostGapConnect( ADDRTYPE_PUBLIC, testCentral ) );
+  hostRun();
+  HOST_CHECK_EQ( testState(), GAPROLE_CONNECTED );
+
+  testRun( 60000 );
+  HOST_CHECK_EQ( testBattMeasurements(), 0 );
+}
+
+static void testBattPeriodStretchesOverADay( void )
+{
+  uint32 start;
+  uint32 count;
+
+  hostAdcReads = 0;
+  HOST_CHECK_EQ( hostBleWriteCCC( testBattCcc, GATT_CLIENT_CFG_NOTIFY ), SUCCESS );
+  start = osal_GetSystemClock();
+
+  // 15, 30, 60, 120 and 240s apart, then every 240s
+  testRun( 24 * 3600000UL );
+  count = testBattMeasurements();
+  HOST_CHECK_EQ( count, 4 + 24 * 3600000UL / TEST_BATT_PERIOD_MAX );
+  HOST_CHECK_EQ( ( testBattLast - testBattPrev + TEST_STEP / 2 ) / 1000,
+                 TEST_BATT_PERIOD_MAX / 1000 );
+
+  // Over fifteen times fewer wakeups than a fixed 15s period
+  HOST_CHECK( count * 15 < ( osal_GetSystemClock() - start ) / TEST_BATT_PERIOD );
+}
+
+static void testBattPeriodResetsOnChange( void )
+{
+  uint32 count = testBattMeasurements();
+
+  // The next measurement sees the drop and falls back to the short period
+  hostAdcCode = TEST_BATT_DROP;
+  testRun( TEST_BATT_PERIOD_MAX );
+  HOST_CHECK_EQ( testBattMeasurements(), count + 1 );
+  testRun( TEST_BATT_PERIOD );
+  HOST_CHECK_EQ( testBattMeasurements(), count + 2 );
+  HOST_CHECK_EQ( ( testBattLast - testBattPrev + TEST_STEP / 2 ) / 1000,
+                 TEST_BATT_PERIOD / 1000 );
+
+  // Stable again: it stretches back
+  testRun( 3600000UL );
+  HOST_CHECK_EQ( ( testBattLast - testBattPrev + TEST_STEP / 2 ) / 1000,
+                 TEST_BATT_PERIOD_MAX / 1000 );
+}
+
+static void testBattCriticalStaysShort( void )
+{
+  uint32 count;
+
+  hostAdcCode = TEST_BATT_LOW;
+  testRun( TEST_BATT_PERIOD_MAX );
+  count = testBattMeasurements();
+
+  // A steady voltage below the critical level keeps the 15s period
+  testRun( 600000UL );
+  HOST_CHECK_EQ( testBattMeasurements() - count, 600000UL / TEST_BATT_PERIOD );
+
+  hostAdcCode = TEST_BATT_STABLE;
+  testRun( 3600000UL );
+}
+
+static void testBattPiggybackLeavesGattCallback( void )
+{
+  uint8 uuid[ATT_UUID_SIZE] = { DEVICE_CONTROL_SERVICE_BASE_UUID_128( LED_VIBRATE_CTRL_CHAR_UUID ) };
+  gattAttribute_t *pAttr = GATT_FindHandleUUID( GATT_MIN_HANDLE, GATT_MAX_HANDLE, uuid,
+                                                ATT_UUID_SIZE, NULL );
+  uint8 value = 1;
+  uint32 reads;
+
+  HOST_CHECK( pAttr != NULL );
+
+  // Inside the last quarter of the 240s period the measurement is due
+  testRun( TEST_BATT_PERIOD_MAX - ( osal_GetSystemClock() - testBattLast ) -
+           TEST_BATT_PERIOD_MAX / 8 );
+  reads = hostAdcReads;
+
+  // The write brings it forward, but not into the write callback
+  HOST_CHECK_EQ( hostBleWrite( pAttr->handle, &value, 1, 0, ATT_WRITE_REQ ), SUCCESS );
+  HOST_CHECK_EQ( hostAdcReads, reads );
+  hostRun();
+  HOST_CHECK_EQ( hostAdcReads, reads + TEST_BATT_SAMPLES );
+  HOST_CHECK_EQ( osal_get_timeoutEx( TASK_APP, BATT_PERIODIC_EVT ), TEST_BATT_PERIOD_MAX );
+
+  // Outside it the write leaves the schedule alone
+  hostStall( 1 );
+  HOST_CHECK_EQ( hostBleWrite( pAttr->handle, &value, 1, 0, ATT_WRITE_REQ ), SUCCESS );
+  hostRun();
+  HOST_CHECK_EQ( hostAdcReads, reads + TEST_BATT_SAMPLES );
+}
+
+static void testBattStopsWithTheLink( void )
+{
+  uint32 count;
+
+  hostGapDisconnect( HCI_ERROR_CODE_REMOTE_USER_TERM_CONN );
+  hostRun();
+  HOST_CHECK( testState() != GAPROLE_CONNECTED );
+
+  count = testBattMeasurements();
+  testRun( 3600000UL );
+  HOST_CHECK_EQ( testBattMeasurements(), count );
+}
+
+static void testAdvBacksOffThroughPolicy( void )
+{
+  // The hour without a link ran the policy to its end
+  HOST_CHECK( !hostGapAdvertising );
+
+  testPress();
+  HOST_CHECK( testAdvAt( TEST_ADV_BURST_INT ) );
+
+  // Each step stops advertising and starts it again with the next interval
+  testRun( TEST_ADV_BURST_TIME );
+  HOST_CHECK( testAdvAt( TEST_ADV_MID_INT ) );
+  testRun( TEST_ADV_MID_TIME );
+  HOST_CHECK( testAdvAt( TEST_ADV_SLOW_INT ) );
+  testRun( TEST_ADV_SLOW_TIME );
+  HOST_CHECK( !hostGapAdvertising );
+  HOST_CHECK_EQ( testState(), GAPROLE_WAITING );
+}
+
+static void testAdvPressRestartsBurst( void )
+{
+  testPress();
+  testRun( TEST_ADV_BURST_TIME + TEST_ADV_MID_TIME / 2 );
+  HOST_CHECK( testAdvAt( TEST_ADV_MID_INT ) );
+
+  // A press while advertising goes back to the burst
+  testPress();
+  HOST_CHECK( testAdvAt( TEST_ADV_BURST_INT ) );
+  testRun( TEST_ADV_BURST_TIME );
+  HOST_CHECK( testAdvAt( TEST_ADV_MID_INT ) );
+}
+
+static void testAdvDirectedToBondedCentral( void )
+{
+  uint8 other[B_ADDR_LEN] = { 0x99, 0x88, 0x77, 0x66, 0x55, 0x44 };
+
+  HOST_CHECK( hostGapConnect( ADDRTYPE_PUBLIC, testCentral ) );
+  hostRun();
+  hostGapBond( testCentralIRK, testCentral );
+  hostRun();
+
+  // After a supervision timeout only the bonded central is invited
+  hostGapDisconnect( LL_SUPERVISION_TIMEOUT_TERM );
+  hostRun();
+  HOST_CHECK( hostGapAdvertising );
+  HOST_CHECK_EQ( hostGapAdvParams.eventType, GAP_ADTYPE_ADV_HDC_DIRECT_IND );
+  HOST_CHECK_EQ( hostGapAdvParams.initiatorAddrType, ADDRTYPE_PUBLIC );
+  HOST_CHECK( osal_memcmp( hostGapAdvParams.initiatorAddr, testCentral, B_ADDR_LEN ) );
+  HOST_CHECK( !hostGapConnect( ADDRTYPE_PUBLIC, other ) );
+
+  // When the controller ends it, the policy goes on with the burst
+  testRun( HOST_GAP_HDC_DURATION );
+  HOST_CHECK( testAdvAt( TEST_ADV_BURST_INT ) );
+  testRun( TEST_ADV_BURST_TIME );
+  HOST_CHECK( testAdvAt( TEST_ADV_MID_INT ) );
+
+  // The bonded central reconnects on a directed advertisement
+  HOST_CHECK( hostGapConnect( ADDRTYPE_PUBLIC, testCentral ) );
+  hostRun();
+  hostGapDisconnect( HCI_ERROR_CODE_REMOTE_USER_TERM_CONN );
+  hostRun();
+  HOST_CHECK_EQ( hostGapAdvParams.eventType, GAP_ADTYPE_ADV_HDC_DIRECT_IND );
+  HOST_CHECK( hostGapConnect( ADDRTYPE_PUBLIC, testCentral ) );
+  hostRun();
+  HOST_CHECK_EQ( testState(), GAPROLE_CONNECTED );
+}
+
+static void testAdvNotDirectedToPrivateCentral( void )
+{
+  uint8 rpa[B_ADDR_LEN];
+
+  hostGapDisconnect( HCI_ERROR_CODE_REMOTE_USER_TERM_CONN );
+  hostRun();
+  testRun( HOST_GAP_HDC_DURATION );
+  HOST_CHECK( testAdvAt( TEST_ADV_BURST_INT ) );
+
+  // The phone connects and bonds from a resolvable private address
+  hostGapMakeRPA( testPhoneIRK, 0x12, rpa );
+  HOST_CHECK( hostGapConnect( ADDRTYPE_PRIVATE_RESOLVE, rpa ) );
+  hostRun();
+  hostGapBond( testPhoneIRK, testPhone );
+  hostRun();
+
+  // Directed advertisements to its identity address would go unanswered,
+  // so it gets the burst, where its next address connects
+  hostGapDisconnect( LL_SUPERVISION_TIMEOUT_TERM );
+  hostRun();
+  HOST_CHECK( testAdvAt( TEST_ADV_BURST_INT ) );
+  hostGapMakeRPA( testPhoneIRK, 0x34, rpa );
+  HOST_CHECK( hostGapConnect( ADDRTYPE_PRIVATE_RESOLVE, rpa ) );
+  hostRun();
+  HOST_CHECK_EQ( testState(), GAPROLE_CONNECTED );
+}
+
+static void testConnFastThroughHandshake( void )
+{
+  uint32 start;
+
+  hostGapDisconnect( HCI_ERROR_CODE_REMOTE_USER_TERM_CONN );
+  hostRun();
+  hostGapParamReqCount = 0;
+
+  HOST_CHECK( hostGapConnect( ADDRTYPE_PUBLIC, testCentral ) );
+  hostRun();
+  start = osal_GetSystemClock();
+  // A handshake write early in the pause does not cut the hold short
+  testRun( 1000 );
+  testCertWrite();
+
+  // The first request waits out the pause and is for the handshake
+  testRun( TEST_CONN_PAUSE - 1000 - TEST_STEP );
+  HOST_CHECK_EQ( hostGapParamReqCount, 0 );
+  testRun( TEST_STEP );
+  HOST_CHECK( testParamReq( 0, start, TEST_CONN_PAUSE, TEST_CONN_FAST_MIN, TEST_CONN_FAST_MAX ) );
+
+  // Quiet for the hold after it, idle as soon as the gap allows
+  testRun( TEST_CONN_GAP );
+  HOST_CHECK( testParamReq( 1, start, TEST_CONN_PAUSE + TEST_CONN_GAP,
+                            TEST_CONN_IDLE_MIN, TEST_CONN_IDLE_MAX ) );
+  testRun( 60000 );
+  HOST_CHECK_EQ( hostGapParamReqCount, 2 );
+}
+
+static void testConnNotifyBurst( void )
+{
+  uint32 start = osal_GetSystemClock();
+  uint8 i;
+
+  // Presses a second apart are one burst and one request
+  for ( i = 0; i < 10; i++ )
+  {
+    testPress();
+    testRun( 1000 );
+  }
+  HOST_CHECK( testParamReq( 2, start, 0, TEST_CONN_NOTIFY_MIN, TEST_CONN_NOTIFY_MAX ) );
+  HOST_CHECK_EQ( hostGapParamReqCount, 3 );
+
+  // Back to idle once the hold after the last press runs out
+  testRun( TEST_CONN_HOLD );
+  HOST_CHECK( testParamReq( 3, start, 9000 + TEST_CONN_HOLD,
+                            TEST_CONN_IDLE_MIN, TEST_CONN_IDLE_MAX ) );
+}
+
+static void testConnHandshakeOverridesNotify( void )
+{
+  uint32 start;
+  uint8 i;
+
+  testRun( TEST_CONN_GAP );
+  start = osal_GetSystemClock();
+
+  // Notifying while the certificate is exchanged needs the fast profile
+  testPress();
+  HOST_CHECK( testParamReq( 4, start, 0, TEST_CONN_NOTIFY_MIN, TEST_CONN_NOTIFY_MAX ) );
+  for ( i = 0; i < 4; i++ )
+  {
+    testRun( 1000 );
+    testCertWrite();
+  }
+  HOST_CHECK_EQ( hostGapParamReqCount, 5 );
+
+  // Rate limited: picked up when the gap closes
+  testRun( TEST_CONN_GAP - 4000 );
+  HOST_CHECK( testParamReq( 5, start, TEST_CONN_GAP, TEST_CONN_FAST_MIN, TEST_CONN_FAST_MAX ) );
+
+  // The link going down stops the manager
+  hostGapDisconnect( HCI_ERROR_CODE_REMOTE_USER_TERM_CONN );
+  hostRun();
+  testRun( 60000 );
+  HOST_CHECK_EQ( hostGapParamReqCount, 6 );
+}
+
+static void testBondRestoresNotify( void )
+{
+  uint16 handle = testDeviceControlHandle( BUTTON_NOTIF_CHAR_UUID );
+  uint8 notis;
+
+  // The bonded central enables button notifications
+  testPress();
+  HOST_CHECK( hostGapConnect( ADDRTYPE_PUBLIC, testCentral ) );
+  hostRun();
+  HOST_CHECK_EQ( hostBleWriteCCC( handle + 1, GATT_CLIENT_CFG_NOTIFY ), SUCCESS );
+  hostRun();
+
+  // The link going down clears the CCC
+  hostGapDisconnect( HCI_ERROR_CODE_REMOTE_USER_TERM_CONN );
+  hostRun();
+  HOST_CHECK_EQ( GATTServApp_ReadCharCfg( HOST_CONN_HANDLE,
+                                          GATT_CCC_TBL( hostBleAttr( handle + 1 )->pValue ) ),
+                 GATT_CFG_NO_OPERATION );
+
+  // On reconnection the bond manager restores it as the link is established,
+  // so the first press notifies without the central writing it again
+  HOST_CHECK( hostGapConnect( ADDRTYPE_PUBLIC, testCentral ) );
+  hostRun();
+  HOST_CHECK_EQ( GATTServApp_ReadCharCfg( HOST_CONN_HANDLE,
+                                          GATT_CCC_TBL( hostBleAttr( handle + 1 )->pValue ) ),
+                 GATT_CLIENT_CFG_NOTIFY );
+
+  notis = hostNotiCount;
+  testPress();
+  HOST_CHECK( hostNotiCount > notis );
+  HOST_CHECK_EQ( hostNoti[notis].handle, handle );
+  HOST_CHECK_EQ( hostNoti[notis].value[0], 0x0F );
+}
+
+int main( void )
+{
+  testBoot();
+
+  HOST_RUN( testBattMeasuredOnlyWhenNotified );
+  HOST_RUN( testBattPeriodStretchesOverADay );
+  HOST_RUN( testBattPeriodResetsOnChange );
+  HOST_RUN( testBattCriticalStaysShort );
+  HOST_RUN( testBattPiggybackLeavesGattCallback );
+  HOST_RUN( testBattStopsWithTheLink );
+  HOST_RUN( testAdvBacksOffThroughPolicy );
+  HOST_RUN( testAdvPressRestartsBurst );
+  HOST_RUN( testAdvDirectedToBondedCentral );
+  HOST_RUN( testAdvNotDirectedToPrivateCentral );
+  HOST_RUN( testConnFastThroughHandshake );
+  HOST_RUN( testConnNotifyBurst );
+  HOST_RUN( testConnHandshakeOverridesNotify );
+  HOST_RUN( testBondRestoresNotify );
+
+  return ( HOST_RESULT() );
+}
@@ -0,0 +1,142 @@
+#!/usr/bin/env python
+"""
+Estimate discovery latency against average current for the advertising
+policy in simpleBLEPeripheral.c.
+
+The policy table is read straight from the firmware source (every
+"{ GAP_ADTYPE_ADV_<type>, <interval>, <duration> }" row of advPolicy[]), so
+the model never drifts from the target.
+
+Model:
+  * an advertising event goes out every interval + 5 ms (the mean of the
+    0-10 ms advDelay) and is sent on all three channels, so a scanner catches
+    the first event that starts inside one of its scan windows;
+  * a scanner opens a window of W ms every I ms at a uniformly random phase;
+    latency is averaged over PHASES evenly spaced phases;
+  * each undirected event costs --event-uc of charge, each high duty cycle
+    directed packet (one every 3.75 ms for 1.28 s) costs --direct-uc, and the
+    chip sleeps at --sleep-ua in between.
+
+Usage:
+    adv_policy_model.py [--reconnect] [--event-uc 15] [--direct-uc 1.5]
+"""
+
+import argparse
+import os
+import re
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SOURCE = os.path.join(HERE, '..', 'Source', 'simpleBLEPeripheral.c')
+
+ROW_RE = re.compile(r'\{\s*GAP_ADTYPE_ADV_(\w+)\s*,\s*(\d+)\s*,\s*(\d+)\s*\}')
+
+ADV_DELAY_MEAN = 5.0        # ms
+HDC_PERIOD = 3.75           # ms between high duty cycle directed packets
+HDC_DURATION = 1280.0       # ms, fixed by the spec
+PHASES = 500
+
+# name, scan window ms, scan interval ms
+SCANNERS = [
+    ('android low latency', 4096.0, 4096.0),
+    ('android balanced',    1024.0, 4096.0),
+    ('android low power',    512.0, 5120.0),
+    ('ios foreground',        30.0,   40.0),
+    ('ios background',        30.0,  300.0),
+]
+
+
+def load_policy(path):
+    with open(path, 'rb') as f:
+        text = f.read().decode('latin-1')
+    start = text.index('advPolicy[] =')
+    body = text[start:text.index('};', start)]
+    steps = []
+    for kind, interval, duration in ROW_RE.findall(body):
+        steps.append((kind, int(interval), int(duration)))
+    return steps
+
+
+def timeline(steps, reconnect):
+    """Return [(name, start, end, event period)] in ms."""
+    out = []
+    t = 0.0
+    for kind, interval, duration in steps:
+        if kind.startswith('HDC_DIRECT'):
+            if not reconnect:
+                continue
+            out.append(('directed', t, t + HDC_DURATION, HDC_PERIOD))
+            t += HDC_DURATION
+        else:
+            period = interval * 0.625 + ADV_DELAY_MEAN
+            out.append(('%.1f ms' % (interval * 0.625), t, t + duration, period))
+            t += duration
+    return out
+
+
+def events(line, directed):
+    """Yield event start times; directed packets only count for the bonded central."""
+    for name, start, end, period in line:
+        if name == 'directed' and not directed:
+            continue
+        t = start
+        while t < end:
+            yield t
+            t += period
+
+
+def latency(line, window, interval, directed):
+    found = []
+    total = 0
+    for k in range(PHASES):
+        phase = interval * k / PHASES
+        total += 1
+        for t in events(line, directed):
+            if (t - phase) % interval < window:
+                found.append(t)
+                break
+    if not found:
+        return None, 0.0
+    return sum(found) / len(found), float(len(found)) / total
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('--reconnect', action='store_true',
+                    help='start with the directed step, as after a disconnect')
+    ap.add_argument('--event-uc', type=float, default=15.0,
+                    help='charge of one undirected advertising event in uC')
+    ap.add_argument('--direct-uc', type=float, default=1.5,
+                    help='charge of one directed packet in uC')
+    ap.add_argument('--sleep-ua', type=float, default=1.0)
+    ap.add_argument('-S', '--source', default=SOURCE)
+    opts = ap.parse_args()
+
+    line = timeline(load_policy(opts.source), opts.reconnect)
+
+    print('%-10s %8s %8s %10s' % ('step', 'start s', 'end s', 'avg uA'))
+    total_uc = 0.0
+    for name, start, end, period in line:
+        per_event = opts.direct_uc if name == 'directed' else opts.event_uc
+        span = (end - start) / 1000.0
+        uc = per_event * (end - start) / period + opts.sleep_ua * span
+        total_uc += uc
+        print('%-10s %8.2f %8.2f %10.1f' % (name, start / 1000.0, end / 1000.0, uc / span))
+    length = line[-1][2] / 1000.0
+    print('policy: %.1f s, %.0f uC, %.1f uA average' % (length, total_uc, total_uc / length))
+    print('')
+
+    print('%-22s %12s %10s' % ('scanner', 'latency ms', 'found'))
+    for name, window, interval in SCANNERS:
+        mean, ratio = latency(line, window, interval, False)
+        if mean is None:
+            print('%-22s %12s %9.0f%%' % (name, '-', 0.0))
+        else:
+            print('%-22s %12.0f %9.0f%%' % (name, mean, ratio * 100))
+    if opts.reconnect:
+        mean, ratio = latency(line, 30.0, 40.0, True)
+        print('%-22s %12.0f %9.0f%%' % ('bonded, directed', mean, ratio * 100))
+
+
+if __name__ == '__main__':
+    main()
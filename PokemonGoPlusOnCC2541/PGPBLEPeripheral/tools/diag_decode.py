@@ -0,0 +1,132 @@
+#!/usr/bin/env python
+"""
+Decode a value read from the diagnostics service (diagservice.c, TI base UUID).
+
+  sleep  Sleep Stats, 0xFFD1: a version byte, the number of histogram bins,
+         then every field of halSleepStats_t as a little-endian uint16. The
+         field names and order are read from hal_sleep.h.
+  holds  Power Holds, 0xFFD2: a version byte, the number of reasons, then per
+         PWRMGR_REASON_* count (u8), holds, overruns (u16), total and longest
+         hold in ms (u32). The reason names are read from OSAL_PwrMgr.h.
+
+Usage:
+    diag_decode.py sleep 01 0C 2A 00 ...    hex bytes as copied from a BLE app
+    diag_decode.py holds 0102000100...
+    diag_decode.py sleep - < value.hex
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+HEADER = os.path.join(HERE, '..', 'Components', 'hal', 'include', 'hal_sleep.h')
+PWRMGR = os.path.join(HERE, '..', 'Components', 'osal', 'include', 'OSAL_PwrMgr.h')
+
+VERSION = 1
+
+FIELD_RE = re.compile(r'uint16\s+(\w+)(?:\[(\w+)\])?\s*;\s*(?://\s*(.*))?')
+
+
+def load_fields(path):
+    """Return [(name, count, comment)] for halSleepStats_t."""
+    with open(path, 'rb') as f:
+        text = f.read().decode('latin-1')
+    body = text[text.index('typedef struct'):text.index('} halSleepStats_t;')]
+    fields = []
+    for name, dim, comment in FIELD_RE.findall(body):
+        count = 1
+        if dim:
+            m = re.search(r'#define\s+%s\s+(\d+)' % dim, text)
+            count = int(m.group(1))
+        fields.append((name, count, comment.strip()))
+    return fields
+
+
+def load_reasons(path):
+    """Return the PWRMGR_REASON_* names ordered by value."""
+    with open(path, 'rb') as f:
+        text = f.read().decode('latin-1')
+    found = re.findall(r'#define\s+PWRMGR_REASON_(\w+)\s+(\d+)', text)
+    return [name for name, _ in sorted(found, key=lambda r: int(r[1]))]
+
+
+def parse_hex(args):
+    text = ' '.join(args)
+    if text.strip() == '-':
+        text = sys.stdin.read()
+    text = re.sub(r'0x|[\s,:-]', '', text)
+    return bytearray.fromhex(text)
+
+
+def decode_sleep(data, header):
+    fields = load_fields(header)
+    words = sum(count for _, count, _ in fields)
+
+    if len(data) < 2 or data[0] != VERSION:
+        raise SystemExit('unknown format version %s' % (data[0] if data else '-'))
+    if len(data) != 2 + 2 * words:
+        raise SystemExit('expected %d bytes, got %d' % (2 + 2 * words, len(data)))
+    values = struct.unpack('<%dH' % words, bytes(data[2:]))
+
+    n = 0
+    for name, count, comment in fields:
+        if count == 1:
+            print('%-10s %6d  %s' % (name, values[n], comment))
+        else:
+            if count != data[1]:
+                raise SystemExit('%d histogram bins in the value, %d in hal_sleep.h'
+                                 % (data[1], count))
+            print('%s (%s)' % (name, comment))
+            for b in range(count):
+                low = 0 if b == 0 else 2 ** b
+                high = '' if b == count - 1 else '%d' % 2 ** (b + 1)
+                print('  %5d - %-5s ms %6d' % (low, high, values[n + b]))
+        n += count
+
+    names = [name for name, _, _ in fields]
+    sleeps = values[names.index('sleeps')]
+    if sleeps:
+        wakes = ['wakeRF', 'wakeTimer', 'wakePort', 'wakeOther']
+        print('')
+        print('wake reasons: ' + ', '.join(
+            '%s %.0f%%' % (w, 100.0 * values[names.index(w)] / sleeps) for w in wakes))
+
+
+def decode_holds(data, header):
+    reasons = load_reasons(header)
+
+    if len(data) < 2 or data[0] != VERSION:
+        raise SystemExit('unknown format version %s' % (data[0] if data else '-'))
+    if data[1] != len(reasons):
+        raise SystemExit('%d reasons in the value, %d in OSAL_PwrMgr.h' % (data[1], len(reasons)))
+    if len(data) != 2 + 13 * len(reasons):
+        raise SystemExit('expected %d bytes, got %d' % (2 + 13 * len(reasons), len(data)))
+
+    print('%-10s %6s %6s %8s %12s %12s' % ('reason', 'held', 'holds', 'overruns',
+                                           'total s', 'longest s'))
+    for n, name in enumerate(reasons):
+        count, holds, overruns, total, longest = struct.unpack_from('<BHHII', bytes(data), 2 + 13 * n)
+        print('%-10s %6d %6d %8d %12.1f %12.1f' % (name, count, holds, overruns,
+                                                  total / 1000.0, longest / 1000.0))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('char', choices=['sleep', 'holds'], help='characteristic the value came from')
+    ap.add_argument('value', nargs='+', help='characteristic value in hex')
+    ap.add_argument('--header', help='header to take the layout from')
+    opts = ap.parse_args()
+
+    data = parse_hex(opts.value)
+    if opts.char == 'sleep':
+        decode_sleep(data, opts.header or HEADER)
+    else:
+        decode_holds(data, opts.header or PWRMGR)
+
+
+if __name__ == '__main__':
+    main()
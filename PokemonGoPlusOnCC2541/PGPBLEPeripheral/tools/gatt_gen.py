@@ -0,0 +1,317 @@
+#!/usr/bin/env python
+"""
+Generate a profile's attribute table from a compact service description.
+
+A description (<profile>.gatt, next to the profile source) lists one service
+and its characteristics:
+
+    service pgpDeviceControl DEVICE_CONTROL_SERV_UUID uuid=deviceControlServUUID
+            base=DEVICE_CONTROL_SERVICE_BASE_UUID_128 title="Device Control"
+    char    buttonNotifChar BUTTON_NOTIF_CHAR_UUID notify desc="Button Notif"
+
+A line starting with whitespace continues the previous one; # starts a
+comment. A char takes a C name, a 16-bit UUID macro and these words:
+
+    read write write_no_rsp notify indicate   characteristic properties
+    array        the value is an array, not a scalar
+    perms=...    value permissions, GATT_PERMIT_ prefix optional; the default
+                 is READ for read, WRITE for write/write_no_rsp
+    desc="..."   adds a User Description descriptor
+
+Names derive from the C name: <name>UUID, <name>Props, <name>UserDesp and,
+for notify/indicate, the CCC table pointer <name>Config. The value itself,
+<name>, is declared by the profile source before it includes the header.
+Attribute positions are emitted as <NAME>_VALUE_IDX and <NAME>_CCCD_IDX, with
+a trailing "Char" dropped, for the read/write callbacks to switch on.
+
+The generated <profile>_attrs.h holds the UUIDs, properties, descriptions
+and the attribute table; everything immutable is CONST and stays in flash.
+The table itself stays in RAM: the GATT server writes each handle at
+registration.
+
+Usage:
+    gatt_gen.py                   regenerate every Profiles/**/*.gatt
+    gatt_gen.py a.gatt b.gatt     regenerate the given descriptions
+    gatt_gen.py --report          RAM moved to flash per profile
+"""
+
+import argparse
+import glob
+import os
+import re
+import shlex
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+PROFILES = os.path.join(HERE, '..', 'Profiles')
+
+# Header of each OSAL heap block on the 8051
+OSAL_MEM_HDR = 2
+
+PROPS = {
+    'read': 'GATT_PROP_READ',
+    'write_no_rsp': 'GATT_PROP_WRITE_NO_RSP',
+    'write': 'GATT_PROP_WRITE',
+    'notify': 'GATT_PROP_NOTIFY',
+    'indicate': 'GATT_PROP_INDICATE',
+}
+
+
+class Char(object):
+    def __init__(self, name, uuid):
+        self.name = name
+        self.uuid = uuid
+        self.props = []
+        self.perms = None
+        self.array = False
+        self.desc = None
+
+    @property
+    def title(self):
+        return self.desc or self.name
+
+    @property
+    def idx_base(self):
+        base = re.sub(r'Char$', '', self.name)
+        return re.sub(r'(?<=[a-z0-9])([A-Z])', r'_\1', base).upper()
+
+    @property
+    def has_ccc(self):
+        return 'notify' in self.props or 'indicate' in self.props
+
+    def value_perms(self):
+        if self.perms is not None:
+            return self.perms
+        perms = []
+        if 'read' in self.props:
+            perms.append('GATT_PERMIT_READ')
+        if 'write' in self.props or 'write_no_rsp' in self.props:
+            perms.append('GATT_PERMIT_WRITE')
+        return perms
+
+
+class Service(object):
+    def __init__(self, path):
+        self.path = path
+        self.name = None
+        self.uuid = None
+        self.uuid_name = None
+        self.base = None
+        self.title = None
+        self.chars = []
+        self.parse(path)
+
+    def parse(self, path):
+        with open(path) as f:
+            text = f.read()
+        lines = []
+        for line in text.splitlines():
+            line = line.split('#', 1)[0].rstrip()
+            if not line:
+                continue
+            if line[0].isspace() and lines:
+                lines[-1] += ' ' + line.strip()
+            else:
+                lines.append(line)
+
+        for line in lines:
+            words = shlex.split(line)
+            kind, name, uuid, opts = words[0], words[1], words[2], words[3:]
+            if kind == 'service':
+                self.name, self.uuid = name, uuid
+                for opt in opts:
+                    key, _, value = opt.partition('=')
+                    if key == 'uuid':
+                        self.uuid_name = value
+                    elif key == 'base':
+                        self.base = value
+                    elif key == 'title':
+                        self.title = value
+                    else:
+                        raise SystemExit('%s: unknown service option %r' % (path, opt))
+            elif kind == 'char':
+                char = Char(name, uuid)
+                for opt in opts:
+                    key, _, value = opt.partition('=')
+                    if key in PROPS:
+                        char.props.append(key)
+                    elif key == 'array':
+                        char.array = True
+                    elif key == 'perms':
+                        char.perms = [p if p.startswith('GATT_PERMIT_') else 'GATT_PERMIT_' + p
+                                      for p in value.split('|')]
+                    elif key == 'desc':
+                        char.desc = value
+                    else:
+                        raise SystemExit('%s: unknown char option %r' % (path, opt))
+                self.chars.append(char)
+            else:
+                raise SystemExit('%s: unknown line %r' % (path, line))
+
+        if self.name is None:
+            raise SystemExit('%s: no service line' % path)
+        self.uuid_name = self.uuid_name or self.name + 'ServUUID'
+        self.title = self.title or self.name
+
+    @property
+    def output(self):
+        return os.path.splitext(self.path)[0] + '_attrs.h'
+
+    @property
+    def uuid_size(self):
+        return 'ATT_UUID_SIZE' if self.base else 'ATT_BT_UUID_SIZE'
+
+    def uuid_init(self, uuid):
+        if self.base:
+            return '%s( %s )' % (self.base, uuid)
+        return 'LO_UINT16( %s ), HI_UINT16( %s )' % (uuid, uuid)
+
+    def records(self):
+        """Return [(comment, type, perms, pValue, idx_name)] in table order."""
+        recs = [('%s Service' % self.title, ('ATT_BT_UUID_SIZE', 'primaryServiceUUID'),
+                 ['GATT_PERMIT_READ'], '(uint8 *)&%sService' % self.name, None)]
+        for c in self.chars:
+            recs.append(('%s Declaration' % c.title, ('ATT_BT_UUID_SIZE', 'characterUUID'),
+                         ['GATT_PERMIT_READ'], '(uint8 *)&%sProps' % c.name, None))
+            recs.append(('%s Value' % c.title, (self.uuid_size, c.name + 'UUID'),
+                         c.value_perms(), c.name if c.array else '&' + c.name,
+                         c.idx_base + '_VALUE_IDX'))
+            if c.has_ccc:
+                recs.append(('%s Client Characteristic Configuration' % c.title,
+                             ('ATT_BT_UUID_SIZE', 'clientCharCfgUUID'),
+                             ['GATT_PERMIT_READ', 'GATT_PERMIT_WRITE'],
+                             '(uint8 *)&%sConfig' % c.name, c.idx_base + '_CCCD_IDX'))
+            if c.desc is not None:
+                recs.append(('%s User Description' % c.title, ('ATT_BT_UUID_SIZE', 'charUserDescUUID'),
+                             ['GATT_PERMIT_READ'], '(uint8 *)%sUserDesp' % c.name, None))
+        return recs
+
+    def flash_bytes(self):
+        """Return (props, descriptions) bytes held as CONST instead of RAM."""
+        props = len(self.chars)
+        descs = sum(len(c.desc) + 1 for c in self.chars if c.desc is not None)
+        return props, descs
+
+
+def render(svc):
+    stem = os.path.basename(svc.output)
+    guard = re.sub(r'\W', '_', stem).upper()
+    source = os.path.basename(os.path.splitext(svc.path)[0]) + '.c'
+    recs = svc.records()
+    out = []
+    out.append('/**************************************************************************************************')
+    out.append('  Filename:       %s' % stem)
+    out.append('')
+    out.append('  Description:    Attribute table of the %s service, included once by' % svc.title)
+    out.append('                  %s after the characteristic values it points to.' % source)
+    out.append('')
+    out.append('                  Generated by tools/gatt_gen.py from %s - do not edit.'
+               % os.path.basename(svc.path))
+    out.append('**************************************************************************************************/')
+    out.append('#ifndef %s' % guard)
+    out.append('#define %s' % guard)
+    out.append('')
+    out.append('/* Positions in %sAttrTbl */' % svc.name)
+    for n, rec in enumerate(recs):
+        if rec[4]:
+            out.append('#define %-32s %d' % (rec[4], n))
+    out.append('')
+    out.append('/* Service and characteristic UUIDs */')
+    out.append('CONST uint8 %s[%s] =' % (svc.uuid_name, svc.uuid_size))
+    out.append('{')
+    out.append('  %s' % svc.uuid_init(svc.uuid))
+    out.append('};')
+    for c in svc.chars:
+        out.append('')
+        out.append('CONST uint8 %sUUID[%s] =' % (c.name, svc.uuid_size))
+        out.append('{')
+        out.append('  %s' % svc.uuid_init(c.uuid))
+        out.append('};')
+    out.append('')
+    out.append('static CONST gattAttrType_t %sService = { %s, %s };'
+               % (svc.name, svc.uuid_size, svc.uuid_name))
+    for c in svc.chars:
+        out.append('')
+        out.append('/* %s */' % c.title)
+        out.append('static CONST uint8 %sProps = %s;'
+                   % (c.name, ' | '.join(PROPS[p] for p in c.props) or '0'))
+        if c.has_ccc:
+            out.append('static gattCharCfg_t *%sConfig;' % c.name)
+        if c.desc is not None:
+            out.append('static CONST uint8 %sUserDesp[] = "%s";' % (c.name, c.desc))
+    out.append('')
+    out.append('static gattAttribute_t %sAttrTbl[] =' % svc.name)
+    out.append('{')
+    for n, (comment, (size, uuid), perms, value, _) in enumerate(recs):
+        out.append('  /* %s */' % comment)
+        out.append('  {')
+        out.append('    { %s, %s },' % (size, uuid))
+        out.append('    %s,' % (' | '.join(perms) or '0'))
+        out.append('    0,')
+        out.append('    %s' % value)
+        if n < len(recs) - 1:
+            out.append('  },')
+            out.append('')
+        else:
+            out.append('  }')
+    out.append('};')
+
+    cccs = [c for c in svc.chars if c.has_ccc]
+    if cccs:
+        out.append('')
+        out.append('/* Take the Client Characteristic Configuration tables from the shared pool */')
+        out.append('static bStatus_t %sAllocCharCfg( void )' % svc.name)
+        out.append('{')
+        for c in cccs:
+            out.append('  %sConfig = GATTServApp_AllocCharCfg();' % c.name)
+            out.append('  if ( %sConfig == NULL )' % c.name)
+            out.append('  {')
+            out.append('    return ( bleMemAllocError );')
+            out.append('  }')
+            out.append('')
+        out.append('  return ( SUCCESS );')
+        out.append('}')
+    out.append('')
+    out.append('#endif')
+    out.append('')
+    return '\r\n'.join(out)
+
+
+def report(services):
+    print('%-18s %6s %5s %7s %6s %6s' % ('service', 'attrs', 'ccc', 'props', 'descs', 'saved'))
+    total = 0
+    for svc in services:
+        props, descs = svc.flash_bytes()
+        cccs = len([c for c in svc.chars if c.has_ccc])
+        total += props + descs
+        print('%-18s %6d %5d %7d %6d %6d' % (svc.name, len(svc.records()), cccs,
+                                             props, descs, props + descs))
+    print('%d bytes of XDATA moved to flash; attribute tables and CCC pointers stay in RAM'
+          % total)
+    cccs = sum(len([c for c in svc.chars if c.has_ccc]) for svc in services)
+    print('%d CCC tables come from the static pool: %d fewer heap blocks, %d bytes of headers'
+          % (cccs, cccs, cccs * OSAL_MEM_HDR))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('gatt', nargs='*', help='service descriptions (default: all under Profiles)')
+    ap.add_argument('--report', action='store_true',
+                    help='print the RAM moved to flash instead of writing headers')
+    opts = ap.parse_args()
+
+    paths = opts.gatt or sorted(glob.glob(os.path.join(PROFILES, '**', '*.gatt'), recursive=True))
+    services = [Service(p) for p in paths]
+    if opts.report:
+        report(services)
+        return
+
+    for svc in services:
+        with open(svc.output, 'wb') as f:
+            f.write(render(svc).encode('ascii'))
+        sys.stderr.write('wrote %s (%d attributes)\n' % (svc.output, len(svc.records())))
+
+
+if __name__ == '__main__':
+    main()
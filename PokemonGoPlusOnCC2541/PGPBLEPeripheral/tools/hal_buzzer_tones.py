@@ -0,0 +1,124 @@
+#!/usr/bin/env python
+"""
+Generate the Timer3 tone table used by hal_buzzer.c.
+
+The buzzer is driven from Timer3 channel 1 in modulo mode with the output
+toggling on every compare, so a tone plays at
+
+    f = 32 MHz / div / (2 * (T3CC0 + 1))      div = 1, 2, 4 ... 128
+
+For every MIDI note the timer can reach, the divider/compare pair with the
+smallest error in cents is chosen. The lowest reachable note is B4
+(32 MHz / 128 / 512 = 488 Hz); hal_buzzer.c folds lower notes up by octaves.
+
+Usage:
+    hal_buzzer_tones.py              regenerate hal_buzzer_tones.h
+    hal_buzzer_tones.py --report     print the frequency error of every note
+"""
+
+import argparse
+import math
+import os
+import sys
+
+F_TICK = 32000000.0
+DIVIDERS = [1, 2, 4, 8, 16, 32, 64, 128]    # T3CTL.DIV = index << 5
+MIDI_LAST = 127
+
+NAMES = ['C', 'CS', 'D', 'DS', 'E', 'F', 'FS', 'G', 'GS', 'A', 'AS', 'B']
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+OUTPUT = os.path.join(HERE, '..', 'Components', 'hal', 'target', 'CC2540EB',
+                      'hal_buzzer_tones.h')
+
+
+def note_name(note):
+    return '%s%d' % (NAMES[note % 12], note // 12 - 1)
+
+
+def note_freq(note):
+    return 440.0 * 2 ** ((note - 69) / 12.0)
+
+
+def best_setting(note):
+    """Return (cents, div_index, cc0, freq) with the smallest |cents|, or None."""
+    target = note_freq(note)
+    best = None
+    for i, div in enumerate(DIVIDERS):
+        for cc0 in (int(F_TICK / div / (2 * target)) - 1,
+                    int(F_TICK / div / (2 * target))):
+            if not 0 <= cc0 <= 255:
+                continue
+            freq = F_TICK / div / (2 * (cc0 + 1))
+            cents = 1200 * math.log(freq / target, 2)
+            if best is None or abs(cents) < abs(best[0]):
+                best = (cents, i, cc0, freq)
+    return best
+
+
+def table():
+    rows = []
+    for note in range(0, MIDI_LAST + 1):
+        setting = best_setting(note)
+        if setting is not None:
+            rows.append((note,) + setting)
+    return rows
+
+
+def render(rows):
+    first = rows[0][0]
+    out = []
+    out.append('/**************************************************************************************************')
+    out.append('  Filename:       hal_buzzer_tones.h')
+    out.append('')
+    out.append('  Description:    Timer3 settings for every MIDI note the buzzer can play.')
+    out.append('')
+    out.append('                  Generated by tools/hal_buzzer_tones.py - do not edit.')
+    out.append('**************************************************************************************************/')
+    out.append('#ifndef HAL_BUZZER_TONES_H')
+    out.append('#define HAL_BUZZER_TONES_H')
+    out.append('')
+    out.append('/* Tones are MIDI note numbers; 0 is a rest */')
+    out.append('#define HAL_BUZZER_TONE_NONE    0')
+    for row in rows:
+        out.append('#define HAL_BUZZER_TONE_%-5s %4d' % (note_name(row[0]), row[0]))
+    out.append('')
+    out.append('#define HAL_BUZZER_TONE_FIRST   %d' % first)
+    out.append('#define HAL_BUZZER_TONE_LAST    %d' % rows[-1][0])
+    out.append('')
+    out.append('/* T3CTL divider bits and T3CC0 for HAL_BUZZER_TONE_FIRST .. HAL_BUZZER_TONE_LAST */')
+    out.append('#define HAL_BUZZER_TONE_TABLE \\')
+    for n, (note, cents, div_index, cc0, freq) in enumerate(rows):
+        sep = ',' if n < len(rows) - 1 else ' '
+        out.append('  { 0x%02X, %3d }%s  /* %-4s %8.1f Hz -> %8.1f Hz %+6.2f cents */ \\'
+                   % (div_index << 5, cc0, sep, note_name(note), note_freq(note), freq, cents))
+    out.append('')
+    out.append('#endif')
+    out.append('')
+    return '\r\n'.join(out)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('--report', action='store_true',
+                    help='print the error of every note instead of writing the header')
+    ap.add_argument('-o', '--output', default=OUTPUT)
+    opts = ap.parse_args()
+
+    rows = table()
+    if opts.report:
+        worst = max(abs(r[1]) for r in rows)
+        for note, cents, div_index, cc0, freq in rows:
+            print('%-4s %3d  div %3d  T3CC0 %3d  %8.1f Hz  %+6.2f cents'
+                  % (note_name(note), note, DIVIDERS[div_index], cc0, freq, cents))
+        print('%d notes, worst error %.2f cents' % (len(rows), worst))
+        return
+
+    with open(opts.output, 'wb') as f:
+        f.write(render(rows).encode('ascii'))
+    sys.stderr.write('wrote %s (%d notes)\n' % (opts.output, len(rows)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,131 @@
+#!/usr/bin/env python
+"""
+Host-side decoder for the binary log stream produced by hal_log.c.
+
+Frame layout (see hal_log.h):
+
+    0xA5 | id | len | args[len] | fcs        fcs = id ^ len ^ args[0] ^ ...
+
+The event table is read straight from the firmware sources: every
+"#define <PREFIX>_LOG_ID_<NAME> <value>  /* "<format>" */" line becomes one
+entry, so the decoder never drifts from the target.
+
+Usage:
+    hal_log_decode.py [-S source ...] [capture.bin | /dev/ttyUSB0 [-b 115200]]
+
+Reads stdin when no input is given.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+MAX_ARGS = 64     # anything longer is a false sync byte
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.join(HERE, '..')
+DEFAULT_SOURCES = [
+    os.path.join(ROOT, 'Components', 'hal', 'include', 'hal_log.h'),
+    os.path.join(ROOT, 'Profiles', 'PokemonGoPlus', 'pgpDeviceControl.c'),
+    os.path.join(ROOT, 'Profiles', 'PokemonGoPlus', 'pgpCertificate.c'),
+]
+
+DEFINE_RE = re.compile(
+    r'#define\s+(\w+LOG_ID_\w+)\s+(0x[0-9A-Fa-f]+|\d+)\s*/\*\s*"(.*)"\s*\*/')
+FIELD_RE = re.compile(r'\{(u8|u16|x8|x16|hex)\}')
+
+
+def load_table(sources):
+    table = {}
+    for path in sources:
+        with open(path, 'rb') as f:
+            text = f.read().decode('latin-1')
+        for name, value, fmt in DEFINE_RE.findall(text):
+            table[int(value, 0)] = (name, fmt)
+    return table
+
+
+def render(fmt, args):
+    pos = [0]
+
+    def field(m):
+        kind = m.group(1)
+        i = pos[0]
+        if kind == 'hex':
+            pos[0] = len(args)
+            return ' '.join('%02X' % b for b in args[i:])
+        size = 2 if kind.endswith('16') else 1
+        if i + size > len(args):
+            return '<?>'
+        pos[0] += size
+        v = args[i] if size == 1 else struct.unpack_from('<H', bytes(args), i)[0]
+        if kind.startswith('x'):
+            return '%0*X' % (size * 2, v)
+        return str(v)
+
+    return FIELD_RE.sub(field, fmt)
+
+
+def frames(stream):
+    """Yield (id, args) for every frame with a good FCS, resyncing on errors."""
+    buf = bytearray()
+    while True:
+        chunk = stream.read(64)
+        if not chunk:
+            return
+        buf.extend(chunk)
+        while True:
+            start = buf.find(bytes([SYNC]))
+            if start < 0:
+                del buf[:]
+                break
+            del buf[:start]
+            if len(buf) < 4:
+                break
+            ev_id, n = buf[1], buf[2]
+            if n > MAX_ARGS:
+                del buf[:1]
+                continue
+            if len(buf) < n + 4:
+                break
+            args = buf[3:3 + n]
+            fcs = ev_id ^ n
+            for b in args:
+                fcs ^= b
+            if fcs != buf[3 + n]:
+                del buf[:1]
+                continue
+            yield ev_id, bytes(args)
+            del buf[:n + 4]
+
+
+def open_input(path, baud):
+    if path is None:
+        return getattr(sys.stdin, 'buffer', sys.stdin)
+    if path.startswith('/dev/') or path.upper().startswith('COM'):
+        import serial  # pyserial, only needed for live capture
+        return serial.Serial(path, baud)
+    return open(path, 'rb')
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('input', nargs='?', help='capture file or serial port')
+    ap.add_argument('-b', '--baud', type=int, default=115200)
+    ap.add_argument('-S', '--source', action='append',
+                    help='file(s) holding *LOG_ID_* definitions')
+    opts = ap.parse_args()
+
+    table = load_table(opts.source or DEFAULT_SOURCES)
+    for ev_id, args in frames(open_input(opts.input, opts.baud)):
+        name, fmt = table.get(ev_id, ('0x%02X' % ev_id, '{hex}'))
+        print(render(fmt, bytearray(args)))
+        sys.stdout.flush()
+
+
+if __name__ == '__main__':
+    main()
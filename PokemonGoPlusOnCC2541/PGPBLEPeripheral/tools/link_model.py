@@ -0,0 +1,170 @@
+#!/usr/bin/env python
+"""
+Link model of the certificate handshake: ATT PDUs, link layer packets and
+connection events per handshake at each ATT_MTU.
+
+A handshake is a list of steps on the certificate service (pgpCertificate.c):
+
+    notify  SFIDA Commands notification; carries the first ATT_MTU - 3 bytes
+    read    Read Request, then Read Blob Requests for the rest of the value
+    write   Write Request, or Prepare Write Requests and an Execute Write
+            Request when the value does not fit in ATT_MTU - 3 bytes
+
+The default handshake is three rounds of a 4-byte notification, a read of
+SFIDA to Central and a write of Central to SFIDA, both PGP_CERT_CHAR_MAX_LEN
+long. The value bound, the default MTU and the prepare queue depth are read
+from the sources.
+
+The link layer carries 27-byte payloads (Bluetooth 4.0, no data length
+extension); each ATT PDU gains a 4-byte L2CAP header and is fragmented into
+as many packets as needed. A request goes out in one or more connection
+events and its response starts in the next one, because the stack answers
+after the event that received the request. Notifications are sent back to
+back. --per-event bounds the packets the central exchanges per event.
+
+The CC2541 stack answers Exchange MTU with ATT_MTU_SIZE, so only that row
+applies to this firmware; the others show what a larger MTU would buy.
+
+Usage:
+    link_model.py                         default handshake, common MTUs
+    link_model.py --mtu 23 --mtu 185      chosen MTUs
+    link_model.py --step read:378 --step write:52 --step notify:4
+    link_model.py --oad 120               add an OAD image of 120 KB
+"""
+
+import argparse
+import math
+import os
+import re
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.join(HERE, '..')
+CERT_H = os.path.join(ROOT, 'Profiles', 'PokemonGoPlus', 'pgpCertificate.h')
+GATT_H = os.path.join(ROOT, 'Components', 'ble', 'include', 'gatt.h')
+L2CAP_H = os.path.join(ROOT, 'Components', 'ble', 'include', 'l2cap.h')
+OAD_H = os.path.join(ROOT, 'Profiles', 'OAD', 'oad.h')
+
+LL_PAYLOAD = 27
+L2CAP_HDR = 4
+MTUS = [23, 27, 51, 65, 100, 185, 247]
+
+
+def read_define(path, name):
+    with open(path, 'rb') as f:
+        text = f.read().decode('latin-1')
+    m = re.search(r'#\s*define\s+%s\s+(\d+)' % name, text)
+    if not m:
+        raise SystemExit('%s not found in %s' % (name, path))
+    return int(m.group(1))
+
+
+class Link(object):
+    """Counts PDUs, packets and connection events of sequential ATT traffic."""
+
+    def __init__(self, mtu, per_event):
+        self.mtu = mtu
+        self.per_event = per_event
+        self.pdus = 0
+        self.packets = 0
+        self.events = 0
+
+    def send(self, size):
+        packets = int(math.ceil((size + L2CAP_HDR) / float(LL_PAYLOAD)))
+        self.pdus += 1
+        self.packets += packets
+        return packets
+
+    def transaction(self, req, rsp):
+        self.events += int(math.ceil(self.send(req) / float(self.per_event)))
+        self.events += int(math.ceil(self.send(rsp) / float(self.per_event)))
+
+    def notify(self, length):
+        self.events += int(math.ceil(self.send(3 + min(length, self.mtu - 3))
+                                     / float(self.per_event)))
+
+    def read(self, length):
+        chunk = self.mtu - 1
+        self.transaction(3, 1 + min(length, chunk))
+        offset = chunk
+        while offset < length:
+            self.transaction(5, 1 + min(length - offset, chunk))
+            offset += chunk
+
+    def write(self, length, queue):
+        if length <= self.mtu - 3:
+            self.transaction(3 + length, 1)
+            return True
+        chunk = self.mtu - 5
+        fragments = int(math.ceil(length / float(chunk)))
+        for n in range(fragments):
+            size = min(length - n * chunk, chunk)
+            self.transaction(5 + size, 5 + size)
+        self.transaction(2, 1)
+        return fragments <= queue
+
+
+def parse_step(text):
+    kind, _, length = text.partition(':')
+    if kind not in ('notify', 'read', 'write') or not length.isdigit():
+        raise argparse.ArgumentTypeError('expected notify|read|write:LENGTH, got %r' % text)
+    return kind, int(length)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('--mtu', type=int, action='append', help='ATT_MTU to model (repeatable)')
+    ap.add_argument('--step', type=parse_step, action='append',
+                    help='handshake step KIND:LENGTH (repeatable, replaces the default)')
+    ap.add_argument('--rounds', type=int, default=3, help='rounds of the default handshake')
+    ap.add_argument('--per-event', type=int, default=4, help='LL packets per connection event')
+    ap.add_argument('--interval', type=float, default=30.0, help='connection interval in ms')
+    ap.add_argument('--oad', type=float, help='also model an OAD image of this many KB')
+    opts = ap.parse_args()
+
+    max_len = read_define(CERT_H, 'PGP_CERT_CHAR_MAX_LEN')
+    queue = read_define(GATT_H, 'GATT_MAX_NUM_PREPARE_WRITES')
+    default_mtu = read_define(L2CAP_H, 'L2CAP_MTU_SIZE')
+    steps = opts.step or [('notify', 4), ('read', max_len), ('write', max_len)] * opts.rounds
+    mtus = sorted(set(opts.mtu or MTUS + [default_mtu]))
+
+    print('handshake: %s' % ', '.join('%s %d' % s for s in steps))
+    print('%6s %6s %8s %8s %9s  %s' % ('mtu', 'pdus', 'packets', 'events', 'time ms', ''))
+    for mtu in mtus:
+        link = Link(mtu, opts.per_event)
+        notes = []
+        for kind, length in steps:
+            if kind == 'notify':
+                if length > mtu - 3:
+                    notes.append('notify %d truncated' % length)
+                link.notify(length)
+            elif kind == 'read':
+                link.read(length)
+            elif length > max_len:
+                link.write(length, queue)
+                notes.append('write %d exceeds PGP_CERT_CHAR_MAX_LEN' % length)
+            elif not link.write(length, queue):
+                notes.append('write %d exceeds %d prepared writes' % (length, queue))
+        if mtu == default_mtu:
+            notes.insert(0, 'this stack')
+        print('%6d %6d %8d %8d %9.0f  %s' % (mtu, link.pdus, link.packets, link.events,
+                                             link.events * opts.interval, '; '.join(notes)))
+
+    if opts.oad:
+        # Block size is fixed by the OAD protocol, not by the MTU: each block
+        # is a 2-byte request notification and an 18-byte write command.
+        block = read_define(OAD_H, 'OAD_BLOCK_SIZE')
+        blocks = int(math.ceil(opts.oad * 1024 / block))
+        link = Link(default_mtu, opts.per_event)
+        for _ in range(blocks):
+            link.notify(2)
+            link.send(3 + 2 + block)
+        events = int(math.ceil(link.packets / float(opts.per_event)))
+        print('')
+        print('oad %.0f KB: %d blocks, %d pdus, %d packets, %d events, %.0f s at any MTU'
+              % (opts.oad, blocks, link.pdus, link.packets, events,
+                 events * opts.interval / 1000.0))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,420 @@
+#!/usr/bin/env python
+"""
+Discrete-event power model of the firmware: connection events, advertising
+events, OSAL timers and the sleep timer, with a current model per power mode.
+
+Every parameter the firmware decides on is read from the sources: the
+advertising policy and the limited discoverable timeout, the connection
+parameter profiles and their timing, the battery measurement schedule, the
+LED blink settings and the halSleep() thresholds. Only the electrical
+figures below are assumptions; they are typical CC2541 datasheet values and
+can be overridden on the command line.
+
+The behaviour follows simpleBLEPeripheral.c:
+  * advertising steps through advPolicy[] from the burst (no bond at boot),
+    each step cut short by the limited discoverable timeout, and stops after
+    the last step;
+  * the certificate handshake is held from the connection until
+    CONN_ACTIVITY_HOLD after the connection pause, so the first request is
+    for the fast profile; later activity never shortens a running hold, and
+    a request is only sent, and the rate limit only restarted, when the
+    wanted profile changes;
+  * the battery is measured only while the central has its notifications
+    enabled. The first reading counts as a change, so the period stays at
+    DEFAULT_BATT_PERIOD once and then doubles up to BATT_PERIOD_MAX for a
+    stable battery. A central write within the last 1/2^BATT_PIGGYBACK_SHIFT
+    of the period takes the measurement in the same wake.
+
+Between two events the model sleeps the way halSleep() does: not at all when
+the gap is below PM_MIN_SLEEP_TIME, PM2 while any timer or radio event is
+pending and PM3 otherwise. Every wake pays HAL_SLEEP_ADJ_TICKS of 32 MHz
+start-up before the event itself.
+
+Usage:
+    power_model.py [scenario ...] [--list] [--capacity-mah 230]
+"""
+
+import argparse
+import collections
+import heapq
+import math
+import os
+import re
+
+import adv_policy_model
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.join(HERE, '..')
+APP = os.path.join(ROOT, 'Source', 'simpleBLEPeripheral.c')
+SLEEP = os.path.join(ROOT, 'Components', 'hal', 'target', 'CC2540EB', 'hal_sleep.c')
+
+# Electrical assumptions, mA unless noted
+I_ACTIVE = 6.7          # CPU running from the 32 MHz XOSC
+I_RADIO = 18.0          # RX or TX at 0 dBm
+I_PM2_UA = 1.0
+I_PM3_UA = 0.5
+I_LED = 2.0             # one LED at full level
+I_ADC = 1.2             # ADC on top of the CPU
+
+# Durations in ms
+T_RADIO_EMPTY = 0.40    # one connection event exchanging empty packets
+T_RADIO_DATA = 0.80     # one connection event carrying data
+T_RADIO_ADV = 0.75      # three advertising channels, no scan request
+T_POST = 0.60           # LL and OSAL processing after a radio event
+T_TIMER = 0.20          # an OSAL timer event without radio
+T_ADC = 16 * 0.036      # 16 oversampled 10-bit conversions
+T_KEY_POLL = 0.10       # one debounce poll
+
+# Central's parameters before the first update request: 30 ms, no latency
+CENTRAL_DEFAULT = (24, 24, 0)
+
+SCENARIOS = collections.OrderedDict([
+    ('advertise', dict(
+        doc='boot, run the advertising policy, then sleep',
+        horizon=60.0, connect=None, writes=0, clicks=0, batt_noti=False)),
+    ('idle', dict(
+        doc='connected for an hour, a Pokestop write every 5 min, battery notified',
+        horizon=3600.0, connect=0.0, writes=300.0, clicks=0, batt_noti=True)),
+    ('active', dict(
+        doc='connected for 10 min, a write every 20 s answered by a click, battery notified',
+        horizon=600.0, connect=0.0, writes=20.0, clicks=2.0, batt_noti=True)),
+])
+
+
+def _read(path):
+    with open(path, 'rb') as f:
+        return f.read().decode('latin-1')
+
+
+def _define(text, name):
+    m = re.search(r'#define\s+%s\s+\(?\s*(\d+)' % name, text)
+    if m is None:
+        raise SystemExit('%s not found' % name)
+    return int(m.group(1))
+
+
+def load_firmware():
+    app = _read(APP)
+    sleep = _read(SLEEP)
+    fw = {}
+
+    fw['adv_policy'] = adv_policy_model.load_policy(APP)
+    m = re.search(r'tgap_LimitAdvertTimeout\s*=\s*(\d+)', app)
+    fw['lim_adv_timeout'] = float(m.group(1))
+
+    # connParamProfiles[]: first two rows are literal, the idle row uses the defaults
+    body = app[app.index('connParamProfiles[] ='):]
+    body = body[:body.index('};')]
+    rows = re.findall(r'\{\s*(\d+)\s*,\s*(\d+)\s*,\s*(\d+)\s*,\s*(\d+)\s*\}', body)
+    fw['fast'] = tuple(int(v) for v in rows[0][:3])
+    fw['notify'] = tuple(int(v) for v in rows[1][:3])
+    fw['idle'] = (_define(app, 'DEFAULT_DESIRED_MIN_CONN_INTERVAL'),
+                  _define(app, 'DEFAULT_DESIRED_MAX_CONN_INTERVAL'),
+                  _define(app, 'DEFAULT_DESIRED_SLAVE_LATENCY'))
+    fw['activity_hold'] = _define(app, 'CONN_ACTIVITY_HOLD') / 1000.0
+    fw['param_gap'] = _define(app, 'CONN_PARAM_MIN_GAP') / 1000.0
+    fw['conn_pause'] = float(_define(app, 'DEFAULT_CONN_PAUSE_PERIPHERAL'))
+
+    fw['batt_period'] = _define(app, 'DEFAULT_BATT_PERIOD') / 1000.0
+    fw['batt_period_max'] = _define(app, 'BATT_PERIOD_MAX') / 1000.0
+    fw['batt_piggyback'] = 1.0 / (1 << _define(app, 'BATT_PIGGYBACK_SHIFT'))
+
+    def blink(state):
+        part = app[app.index('case %s:' % state):]
+        m = re.search(r'HalLedBlink\(\s*\w+\s*,\s*(\d+)\s*,\s*(\d+)\s*,\s*(\d+)\s*\)', part)
+        return int(m.group(2)), int(m.group(3)) / 1000.0
+    fw['led_adv'] = blink('GAPROLE_ADVERTISING')
+    fw['led_conn'] = blink('GAPROLE_CONNECTED')
+
+    fw['min_sleep'] = _define(sleep, 'PM_MIN_SLEEP_TIME') / 32768.0
+    fw['wake'] = _define(sleep, 'HAL_SLEEP_ADJ_TICKS') / 32768.0
+    return fw
+
+
+class Sim(object):
+    def __init__(self, fw, scenario):
+        self.fw = fw
+        self.sc = scenario
+        self.queue = []
+        self.seq = 0
+        self.now = 0.0
+        self.charge = collections.Counter()      # mC per source
+        self.wakes = collections.Counter()
+        self.mode_time = collections.Counter()
+        self.sleeps = collections.Counter()      # log2(ms) bin -> count
+        self.led_on = 0.0                        # LED on time, s
+        self.last_busy = 0.0
+
+        self.conn = None            # (interval s, latency) in use
+        self.pending_data = False
+        self.activity = set()
+        self.profile = None
+        self.param_ready = 0.0
+        self.activity_end = 0.0
+        self.adv_step = None
+        self.batt_period = fw['batt_period']
+        self.batt_first = True
+        self.batt_due = None
+
+    # -- scheduling ---------------------------------------------------------
+    def at(self, t, kind, data=None):
+        self.seq += 1
+        heapq.heappush(self.queue, (t, self.seq, kind, data))
+
+    def cancel(self, kind):
+        self.queue = [e for e in self.queue if e[2] != kind]
+        heapq.heapify(self.queue)
+
+    def busy(self, source, segments):
+        """Account one wake: start-up plus (ms, mA) segments."""
+        mc = self.fw['wake'] * I_ACTIVE
+        t = self.fw['wake']
+        for ms, ma in segments:
+            mc += ms / 1000.0 * ma
+            t += ms / 1000.0
+        self.charge[source] += mc
+        self.wakes[source] += 1
+        self.mode_time['active'] += t
+        self.last_busy = t
+
+    def sleep_until(self, t):
+        gap = t - self.now - self.last_busy
+        self.last_busy = 0.0
+        if gap <= 0:
+            return
+        if gap < self.fw['min_sleep']:
+            self.mode_time['active'] += gap
+            self.charge['awake, no sleep'] += gap * I_ACTIVE
+            return
+        mode = 'PM2' if self.queue else 'PM3'
+        self.mode_time[mode] += gap
+        self.charge['sleep'] += gap * (I_PM2_UA if mode == 'PM2' else I_PM3_UA) / 1000.0
+        self.sleeps[int(math.floor(math.log(gap * 1000.0, 2)))] += 1
+
+    # -- firmware behaviour -------------------------------------------------
+    def led(self, setting):
+        percent, period = setting
+        self.led_setting = (percent / 100.0 * period, period)
+        self.cancel('led')
+        self.at(self.now + period, 'led')
+
+    def start_adv(self):
+        self.adv_step = 1   # skip the directed step, no bond at boot
+        self.apply_adv()
+        self.led(self.fw['led_adv'])
+
+    def apply_adv(self):
+        steps = self.fw['adv_policy']
+        if self.adv_step >= len(steps):
+            self.adv_step = None
+            self.cancel('adv')
+            self.cancel('led')
+            return
+        _, interval, duration = steps[self.adv_step]
+        self.adv_interval = interval * 0.000625 + 0.005
+        self.cancel('adv')
+        self.at(self.now, 'adv')
+        limit = self.fw['lim_adv_timeout']
+        if duration and duration / 1000.0 < limit:
+            self.at(self.now + duration / 1000.0, 'adv_step')
+        else:
+            # The limited discoverable timeout ends advertising and the policy
+            self.at(self.now + limit, 'adv_end')
+
+    def set_conn(self, params):
+        self.conn = (params[1] * 0.00125, params[2])
+
+    def connect(self):
+        self.cancel('adv')
+        self.cancel('adv_step')
+        self.adv_step = None
+        self.set_conn(CENTRAL_DEFAULT)
+        self.at(self.now, 'conn')
+        self.led(self.fw['led_conn'])
+        self.activity = set(['cert'])
+        self.hold(self.fw['conn_pause'] + self.fw['activity_hold'])
+        self.param_ready = self.now + self.fw['conn_pause']
+        self.at(self.param_ready, 'param')
+        if self.sc['batt_noti']:
+            self.batt_at(self.now + self.batt_period)
+        if self.sc['writes']:
+            self.at(self.now + self.sc['writes'], 'write')
+
+    def hold(self, duration):
+        self.activity_end = self.now + duration
+        self.cancel('activity_end')
+        self.at(self.activity_end, 'activity_end')
+
+    def note_activity(self, name):
+        self.activity.add(name)
+        if self.activity_end - self.now < self.fw['activity_hold']:
+            self.hold(self.fw['activity_hold'])
+        self.update_params()
+
+    def update_params(self):
+        if self.now < self.param_ready:
+            return
+        if self.activity & set(['cert', 'oad']):
+            profile = 'fast'
+        elif 'notify' in self.activity:
+            profile = 'notify'
+        else:
+            profile = 'idle'
+        if profile == self.profile:
+            return
+        self.profile = profile
+        self.set_conn(self.fw[profile])
+        self.param_ready = self.now + self.fw['param_gap']
+        self.cancel('param')
+        self.at(self.param_ready, 'param')
+
+    def batt_at(self, t):
+        self.batt_due = t
+        self.cancel('batt')
+        self.at(t, 'batt')
+
+    def measure_batt(self):
+        # A stable battery: the period doubles up to the maximum, except
+        # after the first reading, which counts as a change
+        if self.batt_first:
+            self.batt_first = False
+        else:
+            self.batt_period = min(self.batt_period * 2, self.fw['batt_period_max'])
+        self.batt_at(self.now + self.batt_period)
+
+    # -- event loop ---------------------------------------------------------
+    def run(self):
+        horizon = self.sc['horizon']
+        if self.sc['connect'] is None:
+            self.start_adv()
+        else:
+            self.at(self.sc['connect'], 'connect')
+
+        while self.queue:
+            t, _, kind, data = heapq.heappop(self.queue)
+            if t > horizon:
+                break
+            self.sleep_until(t)
+            self.now = t
+            getattr(self, 'on_' + kind)(data)
+
+        self.queue = []
+        self.sleep_until(horizon)
+        self.now = horizon
+        self.charge['LED'] += self.led_on * I_LED
+
+    def on_connect(self, _):
+        self.connect()
+
+    def on_conn(self, _):
+        radio = T_RADIO_DATA if self.pending_data else T_RADIO_EMPTY
+        self.busy('connection event', [(radio, I_RADIO), (T_POST, I_ACTIVE)])
+        interval, latency = self.conn
+        step = interval if self.pending_data else interval * (latency + 1)
+        self.pending_data = False
+        self.at(self.now + step, 'conn')
+
+    def on_adv(self, _):
+        self.busy('advertising event', [(T_RADIO_ADV, I_RADIO), (T_POST, I_ACTIVE)])
+        self.at(self.now + self.adv_interval, 'adv')
+
+    def on_adv_step(self, _):
+        self.adv_step += 1
+        self.apply_adv()
+
+    def on_adv_end(self, _):
+        self.adv_step = None
+        self.cancel('adv')
+        self.cancel('led')
+
+    def on_led(self, _):
+        on, period = self.led_setting
+        self.busy('LED timer', [(T_TIMER, I_ACTIVE)])
+        self.led_on += on
+        self.at(self.now + period, 'led')
+
+    def on_batt(self, _):
+        self.busy('battery', [(T_ADC, I_ACTIVE + I_ADC), (T_TIMER, I_ACTIVE)])
+        self.measure_batt()
+
+    def on_write(self, _):
+        # The central's write lands in the next connection event the slave listens to
+        self.busy('central write', [(T_TIMER, I_ACTIVE)])
+        if (self.batt_due is not None and
+                self.batt_due - self.now <= self.batt_period * self.fw['batt_piggyback']):
+            # Brought forward into this wake
+            self.charge['battery'] += T_ADC / 1000.0 * (I_ACTIVE + I_ADC)
+            self.mode_time['active'] += T_ADC / 1000.0
+            self.last_busy += T_ADC / 1000.0
+            self.measure_batt()
+        self.at(self.now + self.sc['writes'], 'write')
+        if self.sc['clicks']:
+            self.at(self.now + self.sc['clicks'], 'click')
+
+    def on_click(self, _):
+        # Edge interrupt plus debounce and gesture polls, then a notification
+        for _ in range(5):
+            self.busy('key', [(T_KEY_POLL, I_ACTIVE)])
+        self.pending_data = True
+        self.note_activity('notify')
+
+    def on_activity_end(self, _):
+        self.activity = set()
+        self.update_params()
+
+    def on_param(self, _):
+        self.update_params()
+
+
+def report(name, sim, capacity):
+    total = sum(sim.charge.values())
+    horizon = sim.sc['horizon']
+    avg_ua = total / horizon * 1000.0
+    print('== %s: %s' % (name, sim.sc['doc']))
+    print('average current %.1f uA over %.0f s' % (avg_ua, horizon))
+    if capacity:
+        print('battery life    %.0f days on %.0f mAh' % (capacity / (avg_ua / 1000.0) / 24.0, capacity))
+    print('')
+    print('%-20s %10s %8s' % ('charge by source', 'uC', 'share'))
+    for source, mc in sim.charge.most_common():
+        print('%-20s %10.0f %7.1f%%' % (source, mc * 1000.0, 100.0 * mc / total))
+    print('')
+    print('%-20s %10s' % ('time in mode', 's'))
+    for mode in ('active', 'PM2', 'PM3'):
+        print('%-20s %10.2f' % (mode, sim.mode_time[mode]))
+    print('')
+    print('%-20s %10s' % ('wakeups', 'count'))
+    for source, n in sim.wakes.most_common():
+        print('%-20s %10d' % (source, n))
+    print('')
+    print('%-20s %10s' % ('sleep duration', 'count'))
+    for b in sorted(sim.sleeps):
+        print('%7d - %-7d ms %10d' % (2 ** b, 2 ** (b + 1), sim.sleeps[b]))
+    print('')
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('scenario', nargs='*', help='scenarios to run, default all')
+    ap.add_argument('--list', action='store_true', help='list the scenarios')
+    ap.add_argument('--capacity-mah', type=float, default=230.0,
+                    help='battery capacity for the lifetime estimate, 0 to skip')
+    opts = ap.parse_args()
+
+    if opts.list:
+        for name, sc in SCENARIOS.items():
+            print('%-10s %s' % (name, sc['doc']))
+        return
+
+    fw = load_firmware()
+    for name in opts.scenario or SCENARIOS.keys():
+        if name not in SCENARIOS:
+            raise SystemExit('unknown scenario %s' % name)
+        sim = Sim(fw, SCENARIOS[name])
+        sim.run()
+        report(name, sim, opts.capacity_mah)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,92 @@
+#!/usr/bin/env python
+"""
+Time from link established to the first notification a bonded phone can
+receive, with and without the bond manager's RAM caches (gapbondmgr.c).
+
+GAPBondMgr_LinkEst runs in the OSAL pass that handles GAP_LINK_ESTABLISHED.
+It resolves the phone's private address and loads the bond's keys, state
+flags and characteristic configuration, then restores the CCCs; only then
+can the application notify. Its cost is AES operations and osal_snv_read
+calls. Each read walks the item headers of the active NV page backwards
+from the newest item (findItem in osal_snv.c), so it costs in proportion
+to the items on the page; on average half of them are walked.
+
+    no cache    IRKs read from NV, bonds tried in order; state flags and
+                CCC table read from NV
+    cache       GAP_BOND_IRK_CACHE and GAP_BOND_CFG_CACHE: IRKs, state
+                flags and the last bond's CCC table come from RAM; the
+                last bond is tried first, and its last address is free
+
+Still read from NV in both: the LTK, the CSRK and the sign counter.
+
+The first notification leaves in the first connection event that starts
+after LinkEst returns. The link is established at the anchor of event 0.
+
+--aes-us and --hdr-us are estimates for the 32 MHz CC2541, not measurements;
+vary them to see how much the result depends on them.
+
+Usage:
+    reconnect_model.py [--bond 9] [--items 80] [--interval 30]
+"""
+
+import argparse
+import math
+import os
+import re
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+BONDMGR_H = os.path.join(HERE, '..', 'Profiles', 'Roles', 'gapbondmgr.h')
+BONDMGR_C = os.path.join(HERE, '..', 'Profiles', 'Roles', 'gapbondmgr.c')
+
+
+def read_define(path, name):
+    with open(path, 'rb') as f:
+        text = f.read().decode('latin-1')
+    m = re.search(r'#\s*define\s+%s\s+(\d+)' % name, text)
+    if not m:
+        raise SystemExit('%s not found in %s' % (name, path))
+    return int(m.group(1))
+
+
+def link_est(bond, cached, same_addr):
+    """Return (aes, nv reads) of GAPBondMgr_LinkEst for the given bond."""
+    keys = 3  # LTK, CSRK, sign counter
+    if not cached:
+        return bond + 1, (bond + 1) + 1 + 1 + keys
+    aes = 0 if same_addr else 1
+    return aes, keys
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('--bond', type=int, help='index of the reconnecting bond (default the last)')
+    ap.add_argument('--items', type=int, help='items on the active NV page '
+                    '(default all bonds plus 4 others)')
+    ap.add_argument('--interval', type=float, default=30.0, help='connection interval in ms')
+    ap.add_argument('--aes-us', type=float, default=90.0, help='one address resolution, us')
+    ap.add_argument('--hdr-us', type=float, default=4.0, help='one NV item header read, us')
+    opts = ap.parse_args()
+
+    bonds = read_define(BONDMGR_H, 'GAP_BONDINGS_MAX')
+    per_bond = read_define(BONDMGR_C, 'GAP_BOND_REC_IDS') + 1  # plus the CCC table
+    bond = bonds - 1 if opts.bond is None else opts.bond
+    items = opts.items or bonds * per_bond + 4
+    read_us = items / 2.0 * opts.hdr_us
+
+    print('bond %d of %d, %d NV items (%.0f us per read), %.0f us per AES, %.1f ms interval'
+          % (bond, bonds, items, read_us, opts.aes_us, opts.interval))
+    print('%-24s %5s %9s %10s %6s' % ('', 'aes', 'nv reads', 'linkest us', 'event'))
+    for label, cached, same in (('no cache', False, False),
+                                ('cache, rotated address', True, False),
+                                ('cache, same address', True, True)):
+        aes, reads = link_est(bond, cached, same)
+        us = aes * opts.aes_us + reads * read_us
+        event = int(math.floor(us / 1000.0 / opts.interval)) + 1
+        print('%-24s %5d %9d %10.0f %6d' % (label, aes, reads, us, event))
+    print('the cache applies to the bond that connected last; another bond costs '
+          'one NV read for its CCC table and at most one extra AES')
+
+
+if __name__ == '__main__':
+    main()